@@ -19,6 +19,8 @@
 // commonly used as acoustic features in speech and other audio tasks.
 // Both calculators expect as input the SQUARED_MAGNITUDE-domain outputs
 // from the MediaPipe SpectrogramCalculator object.
+#include <algorithm>
+#include <cmath>
 #include <memory>
 #include <vector>
 
@@ -33,6 +35,7 @@
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/util/time_series_util.h"
 
@@ -54,6 +57,67 @@ std::string PortableDebugString(const TimeSeriesHeader& header) {
                           header.packet_rate(), header.audio_sample_rate());
 }
 
+// Lower bound on the Mel spectrum values before the log, as in
+// audio_dsp::Mfcc.
+constexpr float kFilterbankFloor = 1e-12f;
+
+// audio_dsp::MelFilterbank as a float matrix, to transform all frames of a
+// packet with a single matrix product.
+class MelFilterbankMatrix {
+ public:
+  // Reads the weights of an initialized "filterbank" that takes
+  // "input_length" spectrogram bins.
+  void Initialize(const audio_dsp::MelFilterbank& filterbank,
+                  int input_length);
+
+  // Writes the Mel spectrum of each squared-magnitude spectrum column of
+  // "input" to the same column of "output".
+  absl::Status Compute(const Matrix& input, Matrix* output) const;
+
+ private:
+  int input_length_ = 0;
+  // The weights of the bins from first_bin_ on that feed any channel, with
+  // one row per channel.
+  int first_bin_ = 0;
+  Matrix weights_;
+};
+
+void MelFilterbankMatrix::Initialize(const audio_dsp::MelFilterbank& filterbank,
+                                     int input_length) {
+  // MelFilterbank::Compute() sums the weighted square roots of the bins, so
+  // passing each unit vector in turn yields the weights of one bin.
+  Eigen::MatrixXd weights;
+  std::vector<double> unit_frame(input_length, 0.0);
+  std::vector<double> channels;
+  int first_bin = input_length;
+  int last_bin = -1;
+  for (int bin = 0; bin < input_length; ++bin) {
+    unit_frame[bin] = 1.0;
+    filterbank.Compute(unit_frame, &channels);
+    unit_frame[bin] = 0.0;
+    if (bin == 0) weights.setZero(channels.size(), input_length);
+    weights.col(bin) =
+        Eigen::Map<const Eigen::VectorXd>(channels.data(), channels.size());
+    if (!weights.col(bin).isZero(0.0)) {
+      first_bin = std::min(first_bin, bin);
+      last_bin = bin;
+    }
+  }
+  input_length_ = input_length;
+  first_bin_ = last_bin < first_bin ? 0 : first_bin;
+  weights_ = weights.middleCols(first_bin_, last_bin - first_bin_ + 1)
+                 .cast<float>();
+}
+
+absl::Status MelFilterbankMatrix::Compute(const Matrix& input,
+                                          Matrix* output) const {
+  RET_CHECK_EQ(input.rows(), input_length_)
+      << "Input frames do not match the num_channels of the input header.";
+  output->noalias() =
+      weights_ * input.middleRows(first_bin_, weights_.cols()).cwiseSqrt();
+  return absl::OkStatus();
+}
+
 }  // namespace
 
 // Abstract base class for Calculators that transform feature vectors on a
@@ -98,6 +162,13 @@ class FramewiseTransformCalculatorBase : public CalculatorBase {
   virtual void TransformFrame(const std::vector<double>& input,
                               std::vector<double>* output) const = 0;
 
+  // Transforms every frame (column) of "input" into the same column of
+  // "output", which has num_output_channels() rows. The default calls
+  // TransformFrame() on each frame in double precision; subclasses can
+  // override it to transform all frames at once in float.
+  virtual absl::Status TransformFrames(const Matrix& input,
+                                       Matrix* output) const;
+
  private:
   int num_output_channels_;
 };
@@ -120,8 +191,17 @@ absl::Status FramewiseTransformCalculatorBase::Open(CalculatorContext* cc) {
 
 absl::Status FramewiseTransformCalculatorBase::Process(CalculatorContext* cc) {
   const Matrix& input = cc->Inputs().Index(0).Get<Matrix>();
+  std::unique_ptr<Matrix> output(
+      new Matrix(num_output_channels_, input.cols()));
+  MP_RETURN_IF_ERROR(TransformFrames(input, output.get()));
+  cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
+absl::Status FramewiseTransformCalculatorBase::TransformFrames(
+    const Matrix& input, Matrix* output) const {
   const int num_frames = input.cols();
-  std::unique_ptr<Matrix> output(new Matrix(num_output_channels_, num_frames));
   // The main work here is converting each column of the float Matrix
   // into a vector of doubles, which is what our target functions from
   // dsp_core consume, and doing the reverse with their output.
@@ -143,7 +223,6 @@ absl::Status FramewiseTransformCalculatorBase::Process(CalculatorContext* cc) {
                                                        output_frame.size(), 1);
     output->col(frame) = output_frame_map.cast<float>();
   }
-  cc->Outputs().Index(0).Add(output.release(), cc->InputTimestamp());
 
   return absl::OkStatus();
 }
@@ -202,12 +281,30 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
     bool initialized =
         mfcc_->Initialize(input_length, header.audio_sample_rate());
 
-    if (initialized) {
-      return absl::OkStatus();
-    } else {
+    if (!initialized) {
       return absl::Status(absl::StatusCode::kInternal,
                           "Mfcc::Initialize returned uninitialized");
     }
+
+    // Mfcc does not expose its filterbank, so set up an identical one.
+    const int filterbank_channel_count =
+        mfcc_options.mel_spectrum_params().channel_count();
+    audio_dsp::MelFilterbank mel_filterbank;
+    RET_CHECK(mel_filterbank.Initialize(
+        input_length, header.audio_sample_rate(), filterbank_channel_count,
+        mfcc_options.mel_spectrum_params().min_frequency_hertz(),
+        mfcc_options.mel_spectrum_params().max_frequency_hertz()));
+    mel_filterbank_matrix_.Initialize(mel_filterbank, input_length);
+    // The DCT-II basis of audio_dsp::MfccDct, one row per coefficient.
+    dct_.resize(num_output_channels(), filterbank_channel_count);
+    const double norm = std::sqrt(2.0 / filterbank_channel_count);
+    for (int i = 0; i < dct_.rows(); ++i) {
+      for (int j = 0; j < dct_.cols(); ++j) {
+        dct_(i, j) =
+            norm * std::cos(M_PI * i * (j + 0.5) / filterbank_channel_count);
+      }
+    }
+    return absl::OkStatus();
   }
 
   void TransformFrame(const std::vector<double>& input,
@@ -215,8 +312,19 @@ class MfccCalculator : public FramewiseTransformCalculatorBase {
     mfcc_->Compute(input, output);
   }
 
+  absl::Status TransformFrames(const Matrix& input,
+                               Matrix* output) const override {
+    Matrix log_mel_spectra;
+    MP_RETURN_IF_ERROR(mel_filterbank_matrix_.Compute(input, &log_mel_spectra));
+    log_mel_spectra = log_mel_spectra.array().max(kFilterbankFloor).log();
+    output->noalias() = dct_ * log_mel_spectra;
+    return absl::OkStatus();
+  }
+
  private:
   std::unique_ptr<audio_dsp::Mfcc> mfcc_;
+  MelFilterbankMatrix mel_filterbank_matrix_;
+  Matrix dct_;
 };
 REGISTER_CALCULATOR(MfccCalculator);
 
@@ -255,6 +363,7 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
         mel_spectrum_options.max_frequency_hertz());
 
     if (initialized) {
+      mel_filterbank_matrix_.Initialize(*mel_filterbank_, input_length);
       return absl::OkStatus();
     } else {
       return absl::Status(absl::StatusCode::kInternal,
@@ -267,8 +376,14 @@ class MelSpectrumCalculator : public FramewiseTransformCalculatorBase {
     mel_filterbank_->Compute(input, output);
   }
 
+  absl::Status TransformFrames(const Matrix& input,
+                               Matrix* output) const override {
+    return mel_filterbank_matrix_.Compute(input, output);
+  }
+
  private:
   std::unique_ptr<audio_dsp::MelFilterbank> mel_filterbank_;
+  MelFilterbankMatrix mel_filterbank_matrix_;
 };
 REGISTER_CALCULATOR(MelSpectrumCalculator);
 
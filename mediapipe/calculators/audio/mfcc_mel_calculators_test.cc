@@ -11,12 +11,19 @@
 // WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
 // See the License for the specific language governing permissions and
 // limitations under the License.
+#include <algorithm>
+#include <cmath>
 #include <vector>
 
 #include "Eigen/Core"
+#include "audio/dsp/mfcc/mel_filterbank.h"
+#include "audio/dsp/mfcc/mfcc.h"
 #include "mediapipe/calculators/audio/mfcc_mel_calculators.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/matrix.h"
+#include "mediapipe/framework/formats/time_series_header.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/util/time_series_test_util.h"
@@ -99,6 +106,33 @@ class FramewiseTransformCalculatorTest
     }
   }
 
+  // Checks that each output frame matches "transform_frame" applied to the
+  // input frame in double precision.
+  template <typename TransformFrame>
+  void CheckResultsMatch(TransformFrame transform_frame, double tolerance) {
+    const auto& inputs = this->input().packets;
+    const auto& outputs = this->output().packets;
+    ASSERT_EQ(inputs.size(), outputs.size());
+    std::vector<double> input_frame(this->num_input_channels_);
+    std::vector<double> expected_frame;
+    for (int i = 0; i < inputs.size(); ++i) {
+      const Matrix& input_matrix = inputs[i].template Get<Matrix>();
+      const Matrix& output_matrix = outputs[i].template Get<Matrix>();
+      for (int frame = 0; frame < input_matrix.cols(); ++frame) {
+        for (int c = 0; c < input_matrix.rows(); ++c) {
+          input_frame[c] = input_matrix(c, frame);
+        }
+        transform_frame(input_frame, &expected_frame);
+        ASSERT_EQ(expected_frame.size(), output_matrix.rows());
+        for (int c = 0; c < output_matrix.rows(); ++c) {
+          EXPECT_NEAR(expected_frame[c], output_matrix(c, frame),
+                      tolerance * std::max(1.0, std::abs(expected_frame[c])))
+              << "packet " << i << " frame " << frame << " channel " << c;
+        }
+      }
+    }
+  }
+
   // Allows SetupRandomInputPackets() to inform CheckResults() about how
   // big the packets are supposed to be.
   int num_samples_per_packet_;
@@ -116,6 +150,29 @@ TEST_F(MfccCalculatorTest, AudioSampleRateFromInputHeader) {
 
   CheckResults(options_.mfcc_count());
 }
+TEST_F(MfccCalculatorTest, MatchesFramewiseMfcc) {
+  options_.mutable_mel_spectrum_params()->set_channel_count(40);
+  options_.set_mfcc_count(20);
+  audio_sample_rate_ = kAudioSampleRate;
+  SetupGraphAndHeader();
+  SetupRandomInputPackets();
+
+  MP_ASSERT_OK(Run());
+
+  audio_dsp::Mfcc mfcc;
+  mfcc.set_dct_coefficient_count(20);
+  mfcc.set_upper_frequency_limit(
+      options_.mel_spectrum_params().max_frequency_hertz());
+  mfcc.set_lower_frequency_limit(
+      options_.mel_spectrum_params().min_frequency_hertz());
+  mfcc.set_filterbank_channel_count(40);
+  ASSERT_TRUE(mfcc.Initialize(num_input_channels_, kAudioSampleRate));
+  CheckResultsMatch(
+      [&mfcc](const std::vector<double>& input, std::vector<double>* output) {
+        mfcc.Compute(input, output);
+      },
+      1e-4);
+}
 TEST_F(MfccCalculatorTest, NoAudioSampleRate) {
   // Leave audio_sample_rate_ == kUnset, so it is not present in the
   // input TimeSeriesHeader; expect failure.
@@ -138,6 +195,26 @@ TEST_F(MelSpectrumCalculatorTest, AudioSampleRateFromInputHeader) {
 
   CheckResults(options_.channel_count());
 }
+TEST_F(MelSpectrumCalculatorTest, MatchesFramewiseMelFilterbank) {
+  options_.set_channel_count(64);
+  options_.set_min_frequency_hertz(50.0);
+  options_.set_max_frequency_hertz(4400.0);
+  audio_sample_rate_ = kAudioSampleRate;
+  SetupGraphAndHeader();
+  SetupRandomInputPackets();
+
+  MP_ASSERT_OK(Run());
+
+  audio_dsp::MelFilterbank mel_filterbank;
+  ASSERT_TRUE(mel_filterbank.Initialize(num_input_channels_, kAudioSampleRate,
+                                        64, 50.0, 4400.0));
+  CheckResultsMatch(
+      [&mel_filterbank](const std::vector<double>& input,
+                        std::vector<double>* output) {
+        mel_filterbank.Compute(input, output);
+      },
+      1e-5);
+}
 TEST_F(MelSpectrumCalculatorTest, NoAudioSampleRate) {
   // Leave audio_sample_rate_ == kUnset, so it is not present in the
   // input TimeSeriesHeader; expect failure.
@@ -146,4 +223,42 @@ TEST_F(MelSpectrumCalculatorTest, NoAudioSampleRate) {
 
   EXPECT_FALSE(Run().ok());
 }
+
+// Computes 40-coefficient MFCCs of 100 frames of 257-bin spectra per packet,
+// as in 16 kHz keyword spotting with 512-sample FFTs.
+void BM_Mfcc(benchmark::State& state) {
+  CalculatorGraphConfig::Node node_config;
+  node_config.set_calculator("MfccCalculator");
+  node_config.add_input_stream("spectrogram");
+  node_config.add_output_stream("mfcc");
+  MfccCalculatorOptions* options =
+      node_config.mutable_options()->MutableExtension(
+          MfccCalculatorOptions::ext);
+  options->mutable_mel_spectrum_params()->set_channel_count(40);
+  options->mutable_mel_spectrum_params()->set_min_frequency_hertz(20.0);
+  options->mutable_mel_spectrum_params()->set_max_frequency_hertz(7600.0);
+  options->set_mfcc_count(40);
+
+  const int num_bins = 257;
+  TimeSeriesHeader* header = new TimeSeriesHeader();
+  header->set_sample_rate(100.0);
+  header->set_num_channels(num_bins);
+  header->set_audio_sample_rate(16000.0);
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).header = Adopt(header);
+  for (int i = 0; i < 10; ++i) {
+    Matrix* payload =
+        new Matrix(Matrix::Random(num_bins, 100).array().square());
+    runner.MutableInputs()->Index(0).packets.push_back(
+        Adopt(payload).At(Timestamp(i * 1000000)));
+  }
+
+  for (auto _ : state) {
+    ASSERT_TRUE(runner.Run().ok());
+  }
+  state.SetItemsProcessed(state.iterations() * 10 * 100);
+}
+// The calculator runs on the graph's threads.
+BENCHMARK(BM_Mfcc)->UseRealTime();
+
 }  // namespace mediapipe
@@ -15,11 +15,14 @@
 // Defines TimeSeriesFramerCalculator.
 #include <math.h>
 
+#include <algorithm>
 #include <deque>
 #include <memory>
 #include <string>
+#include <utility>
 
 #include "Eigen/Core"
+#include "absl/memory/memory.h"
 #include "audio/dsp/window_functions.h"
 #include "mediapipe/calculators/audio/time_series_framer_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -93,6 +96,17 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   // Constructs and emits framed output packets.
   void FrameOutput(CalculatorContext* cc);
 
+  // Grows sample_buffer_, if needed, to hold at least "num_samples" samples.
+  void ReserveSamples(int num_samples);
+  // Copies the first "num_samples" buffered samples to the first columns of
+  // "frame".
+  void CopyBufferedSamples(int num_samples, Matrix* frame) const;
+  // Removes the first "num_samples" buffered samples.
+  void DropSamples(int num_samples);
+  // Returns the timestamp of the buffered sample with the given index, counted
+  // from the first input sample.
+  Timestamp BufferedSampleTimestamp(int64 sample_index) const;
+
   Timestamp CurrentOutputTimestamp() {
     if (use_local_timestamp_) {
       return current_timestamp_;
@@ -109,7 +123,7 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   // Returns the timestamp of a sample on a base, which is usually the time
   // stamp of a packet.
   Timestamp CurrentSampleTimestamp(const Timestamp& timestamp_base,
-                                   int64 number_of_samples) {
+                                   int64 number_of_samples) const {
     return timestamp_base + round(number_of_samples / sample_rate_ *
                                   Timestamp::kTimestampUnitsPerSecond);
   }
@@ -144,9 +158,16 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
   Timestamp current_timestamp_;
   int num_channels_;
 
-  // Each entry in this deque consists of a single sample, i.e. a
-  // single column vector, and its timestamp.
-  std::deque<std::pair<Matrix, Timestamp>> sample_buffer_;
+  // Ring buffer of input samples, one per column. The buffered samples start
+  // at column buffer_head_ and wrap around to column 0.
+  Matrix sample_buffer_;
+  int buffer_head_;
+  int num_buffered_samples_;
+  // Index of the first buffered sample, counted from the first input sample.
+  int64 first_buffered_sample_;
+  // Index of the first sample and timestamp of each input packet that still
+  // has buffered samples, from which the sample timestamps are derived.
+  std::deque<std::pair<int64, Timestamp>> packet_starts_;
 
   bool use_window_;
   Matrix window_;
@@ -155,44 +176,87 @@ class TimeSeriesFramerCalculator : public CalculatorBase {
 };
 REGISTER_CALCULATOR(TimeSeriesFramerCalculator);
 
-void TimeSeriesFramerCalculator::EnqueueInput(CalculatorContext* cc) {
-  const Matrix& input_frame = cc->Inputs().Index(0).Get<Matrix>();
+void TimeSeriesFramerCalculator::ReserveSamples(int num_samples) {
+  const int capacity = sample_buffer_.cols();
+  if (num_samples <= capacity) return;
+  Matrix grown(num_channels_, std::max(num_samples, 2 * capacity));
+  CopyBufferedSamples(num_buffered_samples_, &grown);
+  sample_buffer_.swap(grown);
+  buffer_head_ = 0;
+}
 
-  for (int i = 0; i < input_frame.cols(); ++i) {
-    sample_buffer_.emplace_back(std::make_pair(
-        input_frame.col(i), CurrentSampleTimestamp(cc->InputTimestamp(), i)));
+void TimeSeriesFramerCalculator::CopyBufferedSamples(int num_samples,
+                                                     Matrix* frame) const {
+  // Matrix is column-major, so each part is a single contiguous block.
+  const int first_part =
+      std::min<int>(num_samples, sample_buffer_.cols() - buffer_head_);
+  frame->leftCols(first_part) =
+      sample_buffer_.middleCols(buffer_head_, first_part);
+  frame->middleCols(first_part, num_samples - first_part) =
+      sample_buffer_.leftCols(num_samples - first_part);
+}
+
+void TimeSeriesFramerCalculator::DropSamples(int num_samples) {
+  if (num_samples == 0) return;
+  buffer_head_ = (buffer_head_ + num_samples) % sample_buffer_.cols();
+  num_buffered_samples_ -= num_samples;
+  first_buffered_sample_ += num_samples;
+  while (packet_starts_.size() > 1 &&
+         packet_starts_[1].first <= first_buffered_sample_) {
+    packet_starts_.pop_front();
   }
 }
 
+Timestamp TimeSeriesFramerCalculator::BufferedSampleTimestamp(
+    int64 sample_index) const {
+  // The last packet starting at or before the sample.
+  auto packet = std::upper_bound(
+      packet_starts_.begin(), packet_starts_.end(), sample_index,
+      [](int64 index, const std::pair<int64, Timestamp>& packet_start) {
+        return index < packet_start.first;
+      });
+  --packet;
+  return CurrentSampleTimestamp(packet->second, sample_index - packet->first);
+}
+
+void TimeSeriesFramerCalculator::EnqueueInput(CalculatorContext* cc) {
+  const Matrix& input_frame = cc->Inputs().Index(0).Get<Matrix>();
+  const int num_samples = input_frame.cols();
+  if (num_samples == 0) return;
+
+  packet_starts_.emplace_back(first_buffered_sample_ + num_buffered_samples_,
+                              cc->InputTimestamp());
+  ReserveSamples(num_buffered_samples_ + num_samples);
+  const int capacity = sample_buffer_.cols();
+  const int tail = (buffer_head_ + num_buffered_samples_) % capacity;
+  const int first_part = std::min(num_samples, capacity - tail);
+  sample_buffer_.middleCols(tail, first_part) =
+      input_frame.leftCols(first_part);
+  sample_buffer_.leftCols(num_samples - first_part) =
+      input_frame.rightCols(num_samples - first_part);
+  num_buffered_samples_ += num_samples;
+}
+
 void TimeSeriesFramerCalculator::FrameOutput(CalculatorContext* cc) {
-  while (sample_buffer_.size() >=
+  while (num_buffered_samples_ >=
          frame_duration_samples_ + samples_still_to_drop_) {
-    while (samples_still_to_drop_ > 0) {
-      sample_buffer_.pop_front();
-      --samples_still_to_drop_;
-    }
+    DropSamples(samples_still_to_drop_);
+    samples_still_to_drop_ = 0;
     const int frame_step_samples = next_frame_step_samples();
-    std::unique_ptr<Matrix> output_frame(
-        new Matrix(num_channels_, frame_duration_samples_));
-    for (int i = 0; i < std::min(frame_step_samples, frame_duration_samples_);
-         ++i) {
-      output_frame->col(i) = sample_buffer_.front().first;
-      current_timestamp_ = sample_buffer_.front().second;
-      sample_buffer_.pop_front();
-    }
+    auto output_frame =
+        absl::make_unique<Matrix>(num_channels_, frame_duration_samples_);
+    CopyBufferedSamples(frame_duration_samples_, output_frame.get());
+    current_timestamp_ = BufferedSampleTimestamp(first_buffered_sample_ +
+                                                 frame_duration_samples_ - 1);
+    DropSamples(std::min(frame_step_samples, frame_duration_samples_));
     const int frame_overlap_samples =
         frame_duration_samples_ - frame_step_samples;
-    if (frame_overlap_samples > 0) {
-      for (int i = 0; i < frame_overlap_samples; ++i) {
-        output_frame->col(i + frame_step_samples) = sample_buffer_[i].first;
-        current_timestamp_ = sample_buffer_[i].second;
-      }
-    } else {
+    if (frame_overlap_samples < 0) {
       samples_still_to_drop_ = -frame_overlap_samples;
     }
 
     if (use_window_) {
-      *output_frame = (output_frame->array() * window_.array()).matrix();
+      output_frame->array() *= window_.array();
     }
 
     cc->Outputs().Index(0).Add(output_frame.release(),
@@ -221,17 +285,16 @@ absl::Status TimeSeriesFramerCalculator::Process(CalculatorContext* cc) {
 }
 
 absl::Status TimeSeriesFramerCalculator::Close(CalculatorContext* cc) {
-  while (samples_still_to_drop_ > 0 && !sample_buffer_.empty()) {
-    sample_buffer_.pop_front();
-    --samples_still_to_drop_;
-  }
-  if (!sample_buffer_.empty() && pad_final_packet_) {
+  const int num_dropped =
+      std::min(samples_still_to_drop_, num_buffered_samples_);
+  DropSamples(num_dropped);
+  samples_still_to_drop_ -= num_dropped;
+  if (num_buffered_samples_ > 0 && pad_final_packet_) {
     std::unique_ptr<Matrix> output_frame(new Matrix);
     output_frame->setZero(num_channels_, frame_duration_samples_);
-    for (int i = 0; i < sample_buffer_.size(); ++i) {
-      output_frame->col(i) = sample_buffer_[i].first;
-      current_timestamp_ = sample_buffer_[i].second;
-    }
+    CopyBufferedSamples(num_buffered_samples_, output_frame.get());
+    current_timestamp_ = BufferedSampleTimestamp(first_buffered_sample_ +
+                                                 num_buffered_samples_ - 1);
 
     cc->Outputs().Index(0).Add(output_frame.release(),
                                CurrentOutputTimestamp());
@@ -293,6 +356,11 @@ absl::Status TimeSeriesFramerCalculator::Open(CalculatorContext* cc) {
   samples_still_to_drop_ = 0;
   initial_input_timestamp_ = Timestamp::Unstarted();
   current_timestamp_ = Timestamp::Unstarted();
+  sample_buffer_.resize(num_channels_, frame_duration_samples_);
+  buffer_head_ = 0;
+  num_buffered_samples_ = 0;
+  first_buffered_sample_ = 0;
+  packet_starts_.clear();
 
   std::vector<double> window_vector;
   use_window_ = false;
@@ -25,6 +25,7 @@
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/matrix.h"
 #include "mediapipe/framework/formats/time_series_header.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -481,5 +482,53 @@ TEST_F(TimeSeriesFramerCalculatorTimestampingTest, UseCumulativeTimeStamp) {
   CheckOutputTimestamps();
 }
 
+// Frames one second of 48 kHz stereo audio, arriving in 10 ms packets, into
+// Hann-windowed frames of state.range(0) ms overlapping by state.range(1)
+// percent.
+void BM_FrameAudio(benchmark::State& state) {
+  const double sample_rate = 48000.0;
+  const int num_channels = 2;
+  const int packet_size_samples = 480;
+
+  CalculatorGraphConfig::Node node_config;
+  node_config.set_calculator("TimeSeriesFramerCalculator");
+  node_config.add_input_stream("input_audio");
+  node_config.add_output_stream("framed_audio");
+  TimeSeriesFramerCalculatorOptions* options =
+      node_config.mutable_options()->MutableExtension(
+          TimeSeriesFramerCalculatorOptions::ext);
+  const double frame_duration_seconds = state.range(0) / 1000.0;
+  options->set_frame_duration_seconds(frame_duration_seconds);
+  options->set_frame_overlap_seconds(frame_duration_seconds * state.range(1) /
+                                     100.0);
+  options->set_window_function(TimeSeriesFramerCalculatorOptions::HANN);
+
+  TimeSeriesHeader* header = new TimeSeriesHeader();
+  header->set_sample_rate(sample_rate);
+  header->set_num_channels(num_channels);
+  CalculatorRunner runner(node_config);
+  runner.MutableInputs()->Index(0).header = Adopt(header);
+  for (int i = 0; i < sample_rate / packet_size_samples; ++i) {
+    Matrix* payload =
+        new Matrix(Matrix::Random(num_channels, packet_size_samples));
+    runner.MutableInputs()->Index(0).packets.push_back(
+        Adopt(payload).At(Timestamp(i * packet_size_samples * 1000000LL /
+                                    static_cast<int64>(sample_rate))));
+  }
+
+  for (auto _ : state) {
+    ASSERT_TRUE(runner.Run().ok());
+  }
+  state.SetItemsProcessed(state.iterations() * sample_rate);
+}
+BENCHMARK(BM_FrameAudio)
+    ->ArgPair(10, 0)
+    ->ArgPair(25, 60)
+    ->ArgPair(32, 50)
+    ->ArgPair(100, 90)
+    ->ArgPair(1000, 0)
+    // The calculator runs on the graph's threads.
+    ->UseRealTime();
+
 }  // namespace
 }  // namespace mediapipe
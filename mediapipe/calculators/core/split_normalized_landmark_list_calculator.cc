@@ -15,15 +15,54 @@
 #ifndef MEDIAPIPE_CALCULATORS_CORE_SPLIT_NORMALIZED_LANDMARK_LIST_CALCULATOR_H_  // NOLINT
 #define MEDIAPIPE_CALCULATORS_CORE_SPLIT_NORMALIZED_LANDMARK_LIST_CALCULATOR_H_  // NOLINT
 
+#include <utility>
+
 #include "mediapipe/calculators/core/split_vector_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
 
+namespace internal {
+
+inline const NormalizedLandmark& GetLandmark(const NormalizedLandmarkList& list,
+                                             int index) {
+  return list.landmark(index);
+}
+
+inline NormalizedLandmark GetLandmark(const NormalizedLandmarkSoa& list,
+                                      int index) {
+  const auto view = list.landmark(index);
+  NormalizedLandmark landmark;
+  landmark.set_x(view.x());
+  landmark.set_y(view.y());
+  landmark.set_z(view.z());
+  if (view.has_visibility()) landmark.set_visibility(view.visibility());
+  if (view.has_presence()) landmark.set_presence(view.presence());
+  return landmark;
+}
+
+// Appends the landmarks [begin, end) of `input` to `output`.
+inline void AppendLandmarks(const NormalizedLandmarkList& input, int begin,
+                            int end, NormalizedLandmarkList* output) {
+  for (int j = begin; j < end; ++j) {
+    *output->add_landmark() = input.landmark(j);
+  }
+}
+
+inline void AppendLandmarks(const NormalizedLandmarkSoa& input, int begin,
+                            int end, NormalizedLandmarkSoa* output) {
+  const int offset = output->size();
+  output->Resize(offset + end - begin);
+  output->CopyFrom(input, begin, end, offset);
+}
+
+}  // namespace internal
+
 // Splits an input packet with NormalizedLandmarkList into
 // multiple NormalizedLandmarkList output packets using the [begin, end) ranges
 // specified in SplitVectorCalculatorOptions. If the option "element_only" is
@@ -33,20 +72,25 @@ namespace mediapipe {
 // If the option "combine_outputs" is set to true, only one output stream can be
 // specified and all ranges of elements will be combined into one
 // NormalizedLandmarkList.
-class SplitNormalizedLandmarkListCalculator : public CalculatorBase {
+//
+// SplitNormalizedLandmarkSoaCalculator splits NormalizedLandmarkSoa packets
+// into NormalizedLandmarkSoa packets, or NormalizedLandmark packets with
+// "element_only", copying each range as a block.
+template <typename ListType>
+class SplitLandmarkListCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->Inputs().NumEntries() == 1);
     RET_CHECK(cc->Outputs().NumEntries() != 0);
 
-    cc->Inputs().Index(0).Set<NormalizedLandmarkList>();
+    cc->Inputs().Index(0).Set<ListType>();
 
     const auto& options =
         cc->Options<::mediapipe::SplitVectorCalculatorOptions>();
 
     if (options.combine_outputs()) {
       RET_CHECK_EQ(cc->Outputs().NumEntries(), 1);
-      cc->Outputs().Index(0).Set<NormalizedLandmarkList>();
+      cc->Outputs().Index(0).Set<ListType>();
       for (int i = 0; i < options.ranges_size() - 1; ++i) {
         for (int j = i + 1; j < options.ranges_size(); ++j) {
           const auto& range_0 = options.ranges(i);
@@ -83,7 +127,7 @@ class SplitNormalizedLandmarkListCalculator : public CalculatorBase {
           }
           cc->Outputs().Index(i).Set<NormalizedLandmark>();
         } else {
-          cc->Outputs().Index(i).Set<NormalizedLandmarkList>();
+          cc->Outputs().Index(i).Set<ListType>();
         }
       }
     }
@@ -110,40 +154,36 @@ class SplitNormalizedLandmarkListCalculator : public CalculatorBase {
   }
 
   absl::Status Process(CalculatorContext* cc) override {
-    const NormalizedLandmarkList& input =
-        cc->Inputs().Index(0).Get<NormalizedLandmarkList>();
+    const ListType& input = cc->Inputs().Index(0).Get<ListType>();
     RET_CHECK_GE(input.landmark_size(), max_range_end_)
         << "Max range end " << max_range_end_ << " exceeds landmarks size "
         << input.landmark_size();
 
     if (combine_outputs_) {
-      NormalizedLandmarkList output;
+      ListType output;
       for (int i = 0; i < ranges_.size(); ++i) {
-        for (int j = ranges_[i].first; j < ranges_[i].second; ++j) {
-          const NormalizedLandmark& input_landmark = input.landmark(j);
-          *output.add_landmark() = input_landmark;
-        }
+        internal::AppendLandmarks(input, ranges_[i].first, ranges_[i].second,
+                                  &output);
       }
       RET_CHECK_EQ(output.landmark_size(), total_elements_);
       cc->Outputs().Index(0).AddPacket(
-          MakePacket<NormalizedLandmarkList>(output).At(cc->InputTimestamp()));
+          MakePacket<ListType>(std::move(output)).At(cc->InputTimestamp()));
     } else {
       if (element_only_) {
         for (int i = 0; i < ranges_.size(); ++i) {
           cc->Outputs().Index(i).AddPacket(
-              MakePacket<NormalizedLandmark>(input.landmark(ranges_[i].first))
+              MakePacket<NormalizedLandmark>(
+                  internal::GetLandmark(input, ranges_[i].first))
                   .At(cc->InputTimestamp()));
         }
       } else {
         for (int i = 0; i < ranges_.size(); ++i) {
-          NormalizedLandmarkList output;
-          for (int j = ranges_[i].first; j < ranges_[i].second; ++j) {
-            const NormalizedLandmark& input_landmark = input.landmark(j);
-            *output.add_landmark() = input_landmark;
-          }
+          ListType output;
+          internal::AppendLandmarks(input, ranges_[i].first,
+                                    ranges_[i].second, &output);
           cc->Outputs().Index(i).AddPacket(
-              MakePacket<NormalizedLandmarkList>(output).At(
-                  cc->InputTimestamp()));
+              MakePacket<ListType>(std::move(output))
+                  .At(cc->InputTimestamp()));
         }
       }
     }
@@ -159,8 +199,14 @@ class SplitNormalizedLandmarkListCalculator : public CalculatorBase {
   bool combine_outputs_ = false;
 };
 
+typedef SplitLandmarkListCalculator<NormalizedLandmarkList>
+    SplitNormalizedLandmarkListCalculator;
 REGISTER_CALCULATOR(SplitNormalizedLandmarkListCalculator);
 
+typedef SplitLandmarkListCalculator<NormalizedLandmarkSoa>
+    SplitNormalizedLandmarkSoaCalculator;
+REGISTER_CALCULATOR(SplitNormalizedLandmarkSoaCalculator);
+
 }  // namespace mediapipe
 
 // NOLINTNEXTLINE
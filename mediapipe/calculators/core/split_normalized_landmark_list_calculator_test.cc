@@ -21,6 +21,7 @@
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/deps/file_path.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -401,4 +402,102 @@ TEST_F(SplitNormalizedLandmarkListCalculatorTest,
   ASSERT_FALSE(graph.Initialize(graph_config).ok());
 }
 
+TEST_F(SplitNormalizedLandmarkListCalculatorTest, SmokeTestSoa) {
+  PrepareNormalizedLandmarkList(/*list_size=*/5);
+  ASSERT_NE(input_landmarks_, nullptr);
+
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "SplitNormalizedLandmarkSoaCalculator"
+        input_stream: "landmarks_in"
+        output_stream: "range_0"
+        output_stream: "range_1"
+        options {
+          [mediapipe.SplitVectorCalculatorOptions.ext] {
+            ranges: { begin: 0 end: 1 }
+            ranges: { begin: 1 end: 4 }
+          }
+        }
+      )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<NormalizedLandmarkSoa>(
+          NormalizedLandmarkSoa::FromProto(*input_landmarks_))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  for (int i = 0; i < 2; ++i) {
+    const std::vector<Packet>& packets = runner.Outputs().Index(i).packets;
+    ASSERT_EQ(1, packets.size());
+    std::vector<Packet> list_packets = {MakePacket<NormalizedLandmarkList>(
+        packets[0].Get<NormalizedLandmarkSoa>().ToProto())};
+    ValidateListOutput(list_packets, /*expected_elements=*/i == 0 ? 1 : 3,
+                       /*input_begin_index=*/i);
+  }
+}
+
+TEST_F(SplitNormalizedLandmarkListCalculatorTest,
+       SmokeTestSoaCombiningOutputs) {
+  PrepareNormalizedLandmarkList(/*list_size=*/5);
+  ASSERT_NE(input_landmarks_, nullptr);
+
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "SplitNormalizedLandmarkSoaCalculator"
+        input_stream: "landmarks_in"
+        output_stream: "range_0"
+        options {
+          [mediapipe.SplitVectorCalculatorOptions.ext] {
+            ranges: { begin: 0 end: 1 }
+            ranges: { begin: 2 end: 3 }
+            ranges: { begin: 4 end: 5 }
+            combine_outputs: true
+          }
+        }
+      )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<NormalizedLandmarkSoa>(
+          NormalizedLandmarkSoa::FromProto(*input_landmarks_))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& packets = runner.Outputs().Index(0).packets;
+  ASSERT_EQ(1, packets.size());
+  std::vector<Packet> list_packets = {MakePacket<NormalizedLandmarkList>(
+      packets[0].Get<NormalizedLandmarkSoa>().ToProto())};
+  std::vector<int> input_begin_indices = {0, 2, 4};
+  std::vector<int> input_end_indices = {1, 3, 5};
+  ValidateCombinedListOutput(list_packets, /*expected_elements=*/3,
+                             input_begin_indices, input_end_indices);
+}
+
+TEST_F(SplitNormalizedLandmarkListCalculatorTest, SmokeTestSoaElementOnly) {
+  PrepareNormalizedLandmarkList(/*list_size=*/5);
+  ASSERT_NE(input_landmarks_, nullptr);
+
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      R"pb(
+        calculator: "SplitNormalizedLandmarkSoaCalculator"
+        input_stream: "landmarks_in"
+        output_stream: "range_0"
+        output_stream: "range_1"
+        options {
+          [mediapipe.SplitVectorCalculatorOptions.ext] {
+            ranges: { begin: 0 end: 1 }
+            ranges: { begin: 3 end: 4 }
+            element_only: true
+          }
+        }
+      )pb"));
+  runner.MutableInputs()->Index(0).packets.push_back(
+      MakePacket<NormalizedLandmarkSoa>(
+          NormalizedLandmarkSoa::FromProto(*input_landmarks_))
+          .At(Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  std::vector<Packet> range_0_packets = runner.Outputs().Index(0).packets;
+  std::vector<Packet> range_1_packets = runner.Outputs().Index(1).packets;
+  ValidateElementOutput(range_0_packets, /*input_begin_index=*/0);
+  ValidateElementOutput(range_1_packets, /*input_begin_index=*/3);
+}
+
 }  // namespace mediapipe
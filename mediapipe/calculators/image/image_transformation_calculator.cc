@@ -16,6 +16,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/formats/image_frame_pool.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -50,6 +51,9 @@ namespace {
 constexpr char kImageFrameTag[] = "IMAGE";
 constexpr char kGpuBufferTag[] = "IMAGE_GPU";
 
+// Number of output frames kept for reuse by the fused CPU path.
+constexpr int kOutputPoolKeepCount = 2;
+
 int RotationModeToDegrees(mediapipe::RotationMode_Mode rotation) {
   switch (rotation) {
     case mediapipe::RotationMode_Mode_UNKNOWN:
@@ -171,6 +175,8 @@ class ImageTransformationCalculator : public CalculatorBase {
 
  private:
   absl::Status RenderCpu(CalculatorContext* cc);
+  // Single-pass alternative to RenderCpu(), see fused_cpu_transform.
+  absl::Status RenderCpuFused(CalculatorContext* cc);
   absl::Status RenderGpu(CalculatorContext* cc);
   absl::Status GlSetup();
 
@@ -188,6 +194,10 @@ class ImageTransformationCalculator : public CalculatorBase {
   bool flip_horizontally_ = false;
   bool flip_vertically_ = false;
 
+  // Used by RenderCpuFused().
+  std::shared_ptr<ImageFramePool> output_pool_;
+  cv::Mat reduced_mat_;
+
   bool use_gpu_ = false;
 #if !MEDIAPIPE_DISABLE_GPU
   GlCalculatorHelper gpu_helper_;
@@ -342,6 +352,9 @@ absl::Status ImageTransformationCalculator::Process(CalculatorContext* cc) {
     if (cc->Inputs().Tag(kImageFrameTag).IsEmpty()) {
       return absl::OkStatus();
     }
+    if (options_.fused_cpu_transform()) {
+      return RenderCpuFused(cc);
+    }
     return RenderCpu(cc);
   }
   return absl::OkStatus();
@@ -480,6 +493,170 @@ absl::Status ImageTransformationCalculator::RenderCpu(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status ImageTransformationCalculator::RenderCpuFused(
+    CalculatorContext* cc) {
+  const auto& input = cc->Inputs().Tag(kImageFrameTag).Get<ImageFrame>();
+  cv::Mat input_mat = formats::MatView(&input);
+  const ImageFormat::Format format = input.Format();
+
+  const int input_width = input_mat.cols;
+  const int input_height = input_mat.rows;
+  int output_width;
+  int output_height;
+  ComputeOutputDimensions(input_width, input_height, &output_width,
+                          &output_height);
+
+  // The image size after scaling and padding, before rotation, and where the
+  // scaled input lies within it. Mirrors RenderCpu().
+  int scaled_width = input_width;
+  int scaled_height = input_height;
+  cv::Rect target(0, 0, input_width, input_height);
+  if (output_width_ > 0 && output_height_ > 0) {
+    if (scale_mode_ == mediapipe::ScaleMode_Mode_STRETCH) {
+      scaled_width = output_width_;
+      scaled_height = output_height_;
+      target = cv::Rect(0, 0, output_width_, output_height_);
+    } else {
+      const float scale =
+          std::min(static_cast<float>(output_width_) / input_width,
+                   static_cast<float>(output_height_) / input_height);
+      const int target_width = std::round(input_width * scale);
+      const int target_height = std::round(input_height * scale);
+      if (scale_mode_ == mediapipe::ScaleMode_Mode_FIT) {
+        scaled_width = output_width_;
+        scaled_height = output_height_;
+        target = cv::Rect((output_width_ - target_width) / 2,
+                          (output_height_ - target_height) / 2, target_width,
+                          target_height);
+      } else {
+        scaled_width = target_width;
+        scaled_height = target_height;
+        target = cv::Rect(0, 0, target_width, target_height);
+        output_width = target_width;
+        output_height = target_height;
+      }
+    }
+  }
+
+  if (cc->Outputs().HasTag("LETTERBOX_PADDING")) {
+    auto padding = absl::make_unique<std::array<float, 4>>();
+    ComputeOutputLetterboxPadding(input_width, input_height, output_width,
+                                  output_height, padding.get());
+    cc->Outputs()
+        .Tag("LETTERBOX_PADDING")
+        .Add(padding.release(), cc->InputTimestamp());
+  }
+
+  // Bilinear sampling aliases when shrinking by 2x or more, so average the
+  // input down by the integer part of the factor first, like INTER_AREA.
+  cv::Mat src = input_mat;
+  const int reduce_x = std::max(1, input_width / std::max(1, target.width));
+  const int reduce_y = std::max(1, input_height / std::max(1, target.height));
+  if (reduce_x > 1 || reduce_y > 1) {
+    cv::resize(input_mat, reduced_mat_,
+               cv::Size(input_width / reduce_x, input_height / reduce_y), 0, 0,
+               cv::INTER_AREA);
+    src = reduced_mat_;
+  }
+
+  // Forward mapping from source to output coordinates, with pixel centers at
+  // half-integer positions: scale and pad, rotate counterclockwise about the
+  // image centers, then flip.
+  const cv::Matx33d scale_and_pad(
+      static_cast<double>(target.width) / src.cols, 0, target.x,  //
+      0, static_cast<double>(target.height) / src.rows, target.y,  //
+      0, 0, 1);
+  double cos_angle = 1.0;
+  double sin_angle = 0.0;
+  switch (rotation_) {
+    case mediapipe::RotationMode_Mode_UNKNOWN:
+    case mediapipe::RotationMode_Mode_ROTATION_0:
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_90:
+      cos_angle = 0.0;
+      sin_angle = 1.0;
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_180:
+      cos_angle = -1.0;
+      break;
+    case mediapipe::RotationMode_Mode_ROTATION_270:
+      cos_angle = 0.0;
+      sin_angle = -1.0;
+      break;
+  }
+  const double cx = scaled_width / 2.0;
+  const double cy = scaled_height / 2.0;
+  const double tx = output_width / 2.0 - cos_angle * cx - sin_angle * cy;
+  const double ty = output_height / 2.0 + sin_angle * cx - cos_angle * cy;
+  const cv::Matx33d rotate(cos_angle, sin_angle, tx,  //
+                           -sin_angle, cos_angle, ty,  //
+                           0, 0, 1);
+  const cv::Matx33d flip(flip_horizontally_ ? -1 : 1, 0,
+                         flip_horizontally_ ? output_width : 0,  //
+                         0, flip_vertically_ ? -1 : 1,
+                         flip_vertically_ ? output_height : 0,  //
+                         0, 0, 1);
+  const cv::Matx33d to_output = flip * rotate;
+  const cv::Matx33d half_pixel(1, 0, 0.5, 0, 1, 0.5, 0, 0, 1);
+  const cv::Matx33d half_pixel_inv(1, 0, -0.5, 0, 1, -0.5, 0, 0, 1);
+  // warpAffine() expects the mapping from output to source pixel indices.
+  const cv::Matx33d inverse =
+      half_pixel_inv * (to_output * scale_and_pad).inv() * half_pixel;
+  const cv::Matx23d warp(inverse(0, 0), inverse(0, 1), inverse(0, 2),
+                         inverse(1, 0), inverse(1, 1), inverse(1, 2));
+
+  if (!output_pool_ || output_pool_->width() != output_width ||
+      output_pool_->height() != output_height ||
+      output_pool_->format() != format) {
+    output_pool_ = ImageFramePool::Create(output_width, output_height, format,
+                                          kOutputPoolKeepCount);
+  }
+  ImageFrameSharedPtr pooled_frame = output_pool_->GetBuffer();
+  RET_CHECK(pooled_frame);
+  // The deleter holds the pooled frame, returning it to the pool once the
+  // output frame is destroyed.
+  auto output_frame = absl::make_unique<ImageFrame>(
+      format, output_width, output_height, pooled_frame->WidthStep(),
+      pooled_frame->MutablePixelData(), [pooled_frame](uint8*) {});
+  cv::Mat output_mat = formats::MatView(output_frame.get());
+
+  // Samples replicate the edge pixels, like cv::resize(). Constant padding is
+  // filled in afterwards.
+  cv::warpAffine(src, output_mat, warp, output_mat.size(),
+                 cv::INTER_LINEAR | cv::WARP_INVERSE_MAP, cv::BORDER_REPLICATE);
+  if (scale_mode_ != mediapipe::ScaleMode_Mode_FIT ||
+      options_.constant_padding()) {
+    // The output area covered by the scaled input; everything else is
+    // padding.
+    const cv::Vec3d corner0 = to_output * cv::Vec3d(target.x, target.y, 1.0);
+    const cv::Vec3d corner1 =
+        to_output * cv::Vec3d(target.br().x, target.br().y, 1.0);
+    const int x0 = std::max(0, static_cast<int>(std::round(
+                                   std::min(corner0[0], corner1[0]))));
+    const int x1 = std::min(output_width, static_cast<int>(std::round(std::max(
+                                              corner0[0], corner1[0]))));
+    const int y0 = std::max(0, static_cast<int>(std::round(
+                                   std::min(corner0[1], corner1[1]))));
+    const int y1 = std::min(output_height, static_cast<int>(std::round(std::max(
+                                               corner0[1], corner1[1]))));
+    if (x0 >= x1 || y0 >= y1) {
+      output_mat.setTo(cv::Scalar::all(0));
+    } else {
+      output_mat.rowRange(0, y0).setTo(cv::Scalar::all(0));
+      output_mat.rowRange(y1, output_height).setTo(cv::Scalar::all(0));
+      output_mat(cv::Range(y0, y1), cv::Range(0, x0)).setTo(cv::Scalar::all(0));
+      output_mat(cv::Range(y0, y1), cv::Range(x1, output_width))
+          .setTo(cv::Scalar::all(0));
+    }
+  }
+
+  cc->Outputs()
+      .Tag(kImageFrameTag)
+      .Add(output_frame.release(), cc->InputTimestamp());
+
+  return absl::OkStatus();
+}
+
 absl::Status ImageTransformationCalculator::RenderGpu(CalculatorContext* cc) {
 #if !MEDIAPIPE_DISABLE_GPU
   const auto& input = cc->Inputs().Tag(kGpuBufferTag).Get<GpuBuffer>();
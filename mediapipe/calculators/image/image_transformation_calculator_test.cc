@@ -0,0 +1,212 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/substitute.h"
+#include "mediapipe/calculators/image/image_transformation_calculator.pb.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/image_frame.h"
+#include "mediapipe/framework/formats/image_frame_opencv.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kInputWidth = 64;
+constexpr int kInputHeight = 48;
+constexpr int kNumFrames = 2;
+
+// The step-by-step path rotates same-sized images about (width / 2,
+// height / 2) rather than about the center of the pixel grid, which shifts
+// its output by up to one pixel. So the outputs are compared away from the
+// edges, and the input changes by at most 2 levels per pixel.
+constexpr int kBorder = 2;
+constexpr double kMaxDifference = 4;
+
+// Returns an SRGB image with linear gradients, which bilinear and area
+// interpolation both reproduce exactly away from the edges.
+Packet GradientImage() {
+  auto frame = absl::make_unique<ImageFrame>(ImageFormat::SRGB, kInputWidth,
+                                             kInputHeight);
+  cv::Mat mat = formats::MatView(frame.get());
+  for (int y = 0; y < kInputHeight; ++y) {
+    for (int x = 0; x < kInputWidth; ++x) {
+      mat.at<cv::Vec3b>(y, x) = cv::Vec3b(32 + 2 * x, 64 + 2 * y, 96 + x + y);
+    }
+  }
+  return Adopt(frame.release());
+}
+
+// The output packets of one calculator run.
+struct TransformOutputs {
+  std::vector<Packet> images;
+  std::vector<Packet> paddings;
+};
+
+// Runs the ImageTransformationCalculator with the given options on
+// kNumFrames gradient images.
+TransformOutputs RunTransformation(const std::string& options, bool fused) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+        calculator: "ImageTransformationCalculator"
+        input_stream: "IMAGE:input"
+        output_stream: "IMAGE:output"
+        output_stream: "LETTERBOX_PADDING:padding"
+        options {
+          [mediapipe.ImageTransformationCalculatorOptions.ext] {
+            $0
+            fused_cpu_transform: $1
+          }
+        }
+      )pb",
+                       options, fused ? "true" : "false")));
+  const Packet input = GradientImage();
+  for (int i = 0; i < kNumFrames; ++i) {
+    runner.MutableInputs()->Tag("IMAGE").packets.push_back(
+        input.At(Timestamp(i)));
+  }
+  MP_EXPECT_OK(runner.Run());
+  return {runner.Outputs().Tag("IMAGE").packets,
+          runner.Outputs().Tag("LETTERBOX_PADDING").packets};
+}
+
+// Expects the fused path to give nearly the output of the step-by-step path,
+// and the same letterbox padding.
+void ExpectFusedMatchesStepByStep(const std::string& options) {
+  const TransformOutputs expected = RunTransformation(options, false);
+  const TransformOutputs actual = RunTransformation(options, true);
+  ASSERT_EQ(expected.images.size(), kNumFrames);
+  ASSERT_EQ(actual.images.size(), kNumFrames);
+  ASSERT_EQ(actual.paddings.size(), kNumFrames);
+  for (int i = 0; i < kNumFrames; ++i) {
+    const ImageFrame& expected_frame = expected.images[i].Get<ImageFrame>();
+    const ImageFrame& actual_frame = actual.images[i].Get<ImageFrame>();
+    ASSERT_EQ(actual_frame.Format(), expected_frame.Format());
+    ASSERT_EQ(actual_frame.Width(), expected_frame.Width());
+    ASSERT_EQ(actual_frame.Height(), expected_frame.Height());
+    const cv::Rect interior(kBorder, kBorder,
+                            expected_frame.Width() - 2 * kBorder,
+                            expected_frame.Height() - 2 * kBorder);
+    cv::Mat difference;
+    cv::absdiff(formats::MatView(&expected_frame)(interior),
+                formats::MatView(&actual_frame)(interior), difference);
+    double max_difference;
+    cv::minMaxLoc(difference.reshape(1), nullptr, &max_difference);
+    EXPECT_LE(max_difference, kMaxDifference) << options;
+
+    EXPECT_EQ(actual.paddings[i].Get<std::array<float, 4>>(),
+              expected.paddings[i].Get<std::array<float, 4>>())
+        << options;
+  }
+}
+
+TEST(ImageTransformationCalculatorTest, FusedStretch) {
+  // Shrinking by an integer factor, by a fraction, and enlarging.
+  ExpectFusedMatchesStepByStep(
+      "output_width: 16 output_height: 12 scale_mode: STRETCH");
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 40 scale_mode: STRETCH");
+  ExpectFusedMatchesStepByStep(
+      "output_width: 96 output_height: 72 scale_mode: STRETCH");
+}
+
+TEST(ImageTransformationCalculatorTest, FusedFit) {
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 40 scale_mode: FIT");
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 20 scale_mode: FIT");
+}
+
+TEST(ImageTransformationCalculatorTest, FusedFill) {
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 40 scale_mode: FILL");
+}
+
+TEST(ImageTransformationCalculatorTest, FusedRotation) {
+  ExpectFusedMatchesStepByStep("rotation_mode: ROTATION_90");
+  ExpectFusedMatchesStepByStep("rotation_mode: ROTATION_180");
+  ExpectFusedMatchesStepByStep("rotation_mode: ROTATION_270");
+}
+
+TEST(ImageTransformationCalculatorTest, FusedFlip) {
+  ExpectFusedMatchesStepByStep("flip_horizontally: true");
+  ExpectFusedMatchesStepByStep("flip_vertically: true");
+  ExpectFusedMatchesStepByStep("flip_horizontally: true flip_vertically: true");
+  // Flipping is applied after rotation.
+  ExpectFusedMatchesStepByStep(
+      "rotation_mode: ROTATION_90 flip_horizontally: true");
+}
+
+TEST(ImageTransformationCalculatorTest, FusedFitBorder) {
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 40 scale_mode: FIT "
+      "constant_padding: true");
+  ExpectFusedMatchesStepByStep(
+      "output_width: 40 output_height: 40 scale_mode: FIT "
+      "constant_padding: false");
+
+  // The 5 rows above the scaled image are black with constant padding, and
+  // repeat its top row otherwise.
+  const TransformOutputs constant = RunTransformation(
+      "output_width: 40 output_height: 40 scale_mode: FIT "
+      "constant_padding: true",
+      true);
+  const TransformOutputs replicate = RunTransformation(
+      "output_width: 40 output_height: 40 scale_mode: FIT "
+      "constant_padding: false",
+      true);
+  ASSERT_EQ(constant.images.size(), kNumFrames);
+  ASSERT_EQ(replicate.images.size(), kNumFrames);
+  const cv::Mat constant_mat =
+      formats::MatView(&constant.images[0].Get<ImageFrame>());
+  const cv::Mat replicate_mat =
+      formats::MatView(&replicate.images[0].Get<ImageFrame>());
+  EXPECT_EQ(cv::countNonZero(constant_mat.rowRange(0, 5).reshape(1)), 0);
+  cv::Mat difference;
+  cv::absdiff(replicate_mat.rowRange(0, 5),
+              cv::repeat(replicate_mat.row(5), 5, 1), difference);
+  double max_difference;
+  cv::minMaxLoc(difference.reshape(1), nullptr, &max_difference);
+  EXPECT_LE(max_difference, kMaxDifference);
+}
+
+TEST(ImageTransformationCalculatorTest, FusedLetterboxPadding) {
+  const TransformOutputs outputs = RunTransformation(
+      "output_width: 40 output_height: 40 scale_mode: FIT", true);
+  ASSERT_EQ(outputs.paddings.size(), kNumFrames);
+  // The 64x48 input is scaled to 40x30, with 5 rows above and below.
+  const auto& padding = outputs.paddings[0].Get<std::array<float, 4>>();
+  EXPECT_FLOAT_EQ(padding[0], 0.f);
+  EXPECT_FLOAT_EQ(padding[1], 0.125f);
+  EXPECT_FLOAT_EQ(padding[2], 0.f);
+  EXPECT_FLOAT_EQ(padding[3], 0.125f);
+
+  // Without scaling, there is no padding.
+  const TransformOutputs unscaled =
+      RunTransformation("rotation_mode: ROTATION_90", true);
+  ASSERT_EQ(unscaled.paddings.size(), kNumFrames);
+  const std::array<float, 4> no_padding = {0.f, 0.f, 0.f, 0.f};
+  EXPECT_EQ(unscaled.paddings[0].Get<std::array<float, 4>>(), no_padding);
+}
+
+}  // namespace
+}  // namespace mediapipe
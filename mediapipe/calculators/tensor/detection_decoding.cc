@@ -0,0 +1,268 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/detection_decoding.h"
+
+#include <cmath>
+#include <limits>
+
+namespace mediapipe {
+
+void DecodeBoxes(const float* raw_boxes, const std::vector<Anchor>& anchors,
+                 const TensorsToDetectionsCalculatorOptions& options,
+                 float* boxes) {
+  const int num_coords = options.num_coords();
+  for (int i = 0; i < options.num_boxes(); ++i) {
+    const int box_offset = i * num_coords + options.box_coord_offset();
+
+    float y_center = raw_boxes[box_offset];
+    float x_center = raw_boxes[box_offset + 1];
+    float h = raw_boxes[box_offset + 2];
+    float w = raw_boxes[box_offset + 3];
+    if (options.reverse_output_order()) {
+      x_center = raw_boxes[box_offset];
+      y_center = raw_boxes[box_offset + 1];
+      w = raw_boxes[box_offset + 2];
+      h = raw_boxes[box_offset + 3];
+    }
+
+    x_center =
+        x_center / options.x_scale() * anchors[i].w() + anchors[i].x_center();
+    y_center =
+        y_center / options.y_scale() * anchors[i].h() + anchors[i].y_center();
+
+    if (options.apply_exponential_on_box_size()) {
+      h = std::exp(h / options.h_scale()) * anchors[i].h();
+      w = std::exp(w / options.w_scale()) * anchors[i].w();
+    } else {
+      h = h / options.h_scale() * anchors[i].h();
+      w = w / options.w_scale() * anchors[i].w();
+    }
+
+    const float ymin = y_center - h / 2.f;
+    const float xmin = x_center - w / 2.f;
+    const float ymax = y_center + h / 2.f;
+    const float xmax = x_center + w / 2.f;
+
+    boxes[i * num_coords + 0] = ymin;
+    boxes[i * num_coords + 1] = xmin;
+    boxes[i * num_coords + 2] = ymax;
+    boxes[i * num_coords + 3] = xmax;
+
+    if (options.num_keypoints()) {
+      for (int k = 0; k < options.num_keypoints(); ++k) {
+        const int offset = i * num_coords + options.keypoint_coord_offset() +
+                           k * options.num_values_per_keypoint();
+
+        float keypoint_y = raw_boxes[offset];
+        float keypoint_x = raw_boxes[offset + 1];
+        if (options.reverse_output_order()) {
+          keypoint_x = raw_boxes[offset];
+          keypoint_y = raw_boxes[offset + 1];
+        }
+
+        boxes[offset] = keypoint_x / options.x_scale() * anchors[i].w() +
+                        anchors[i].x_center();
+        boxes[offset + 1] = keypoint_y / options.y_scale() * anchors[i].h() +
+                            anchors[i].y_center();
+      }
+    }
+  }
+}
+
+void ScoreBoxes(const float* raw_scores,
+                const TensorsToDetectionsCalculatorOptions& options,
+                const std::set<int>& ignore_classes, float* scores,
+                int* classes) {
+  const int num_classes = options.num_classes();
+  for (int i = 0; i < options.num_boxes(); ++i) {
+    int class_id = -1;
+    float max_score = -std::numeric_limits<float>::max();
+    // Find the top score for box i.
+    for (int score_idx = 0; score_idx < num_classes; ++score_idx) {
+      if (ignore_classes.find(score_idx) == ignore_classes.end()) {
+        auto score = raw_scores[i * num_classes + score_idx];
+        if (options.sigmoid_score()) {
+          if (options.has_score_clipping_thresh()) {
+            score = score < -options.score_clipping_thresh()
+                        ? -options.score_clipping_thresh()
+                        : score;
+            score = score > options.score_clipping_thresh()
+                        ? options.score_clipping_thresh()
+                        : score;
+          }
+          score = 1.0f / (1.0f + std::exp(-score));
+        }
+        if (max_score < score) {
+          max_score = score;
+          class_id = score_idx;
+        }
+      }
+    }
+    scores[i] = max_score;
+    classes[i] = class_id;
+  }
+}
+
+ScoreFirstDetectionDecoder::ScoreFirstDetectionDecoder(
+    const TensorsToDetectionsCalculatorOptions& options,
+    const std::vector<Anchor>& anchors)
+    : options_(options),
+      num_boxes_(options.num_boxes()),
+      num_classes_(options.num_classes()),
+      num_coords_(options.num_coords()),
+      anchor_y_center_(num_boxes_),
+      anchor_x_center_(num_boxes_),
+      anchor_h_(num_boxes_),
+      anchor_w_(num_boxes_),
+      max_scores_(num_boxes_),
+      max_classes_(num_boxes_) {
+  for (int c = 0; c < num_classes_; ++c) {
+    bool ignored = false;
+    for (int ignore_class : options_.ignore_classes()) {
+      ignored |= ignore_class == c;
+    }
+    if (!ignored) scored_classes_.push_back(c);
+  }
+  for (int i = 0; i < num_boxes_; ++i) {
+    anchor_y_center_[i] = anchors[i].y_center();
+    anchor_x_center_[i] = anchors[i].x_center();
+    anchor_h_[i] = anchors[i].h();
+    anchor_w_[i] = anchors[i].w();
+  }
+  candidates_.reserve(num_boxes_);
+}
+
+void ScoreFirstDetectionDecoder::Decode(const float* raw_boxes,
+                                        const float* raw_scores,
+                                        DecodedDetections* detections) {
+  ScoreAll(raw_scores);
+  SelectCandidates();
+  DecodeCandidates(raw_boxes, detections);
+}
+
+void ScoreFirstDetectionDecoder::ScoreAll(const float* raw_scores) {
+  // One column per box.
+  Eigen::Map<const Eigen::ArrayXXf> scores(raw_scores, num_classes_,
+                                           num_boxes_);
+  max_scores_.setConstant(-std::numeric_limits<float>::max());
+  max_classes_.setConstant(-1);
+  const bool clip =
+      options_.sigmoid_score() && options_.has_score_clipping_thresh();
+  const float clip_thresh = options_.score_clipping_thresh();
+  for (int c : scored_classes_) {
+    // Reuses y_ as the contiguous copy of the class scores.
+    y_ = scores.row(c).transpose();
+    if (clip) y_ = y_.max(-clip_thresh).min(clip_thresh);
+    // Strict comparison keeps the first class on ties, like ScoreBoxes().
+    max_classes_ = (y_ > max_scores_)
+                       .select(Eigen::ArrayXi::Constant(num_boxes_, c),
+                               max_classes_);
+    max_scores_ = max_scores_.max(y_);
+  }
+  if (options_.sigmoid_score() && !scored_classes_.empty()) {
+    max_scores_ = (1.0f + (-max_scores_).exp()).inverse();
+  }
+}
+
+void ScoreFirstDetectionDecoder::SelectCandidates() {
+  candidates_.clear();
+  if (!options_.has_min_score_thresh()) {
+    for (int i = 0; i < num_boxes_; ++i) candidates_.push_back(i);
+    return;
+  }
+  const float thresh = options_.min_score_thresh();
+  for (int i = 0; i < num_boxes_; ++i) {
+    if (max_scores_[i] < thresh) continue;
+    candidates_.push_back(i);
+  }
+}
+
+void ScoreFirstDetectionDecoder::DecodeCandidates(
+    const float* raw_boxes, DecodedDetections* detections) {
+  const int n = candidates_.size();
+  detections->boxes.resize(n * num_coords_);
+  detections->scores.resize(n);
+  detections->classes.resize(n);
+  if (n == 0) return;
+
+  y_.resize(n);
+  x_.resize(n);
+  h_.resize(n);
+  w_.resize(n);
+  a_y_center_.resize(n);
+  a_x_center_.resize(n);
+  a_h_.resize(n);
+  a_w_.resize(n);
+
+  // Gather the candidates into structure-of-arrays form.
+  const bool reverse = options_.reverse_output_order();
+  for (int j = 0; j < n; ++j) {
+    const int i = candidates_[j];
+    const float* raw = raw_boxes + i * num_coords_ + options_.box_coord_offset();
+    y_[j] = raw[reverse ? 1 : 0];
+    x_[j] = raw[reverse ? 0 : 1];
+    h_[j] = raw[reverse ? 3 : 2];
+    w_[j] = raw[reverse ? 2 : 3];
+    a_y_center_[j] = anchor_y_center_[i];
+    a_x_center_[j] = anchor_x_center_[i];
+    a_h_[j] = anchor_h_[i];
+    a_w_[j] = anchor_w_[i];
+    detections->scores[j] = max_scores_[i];
+    detections->classes[j] = max_classes_[i];
+  }
+
+  const float x_scale = options_.x_scale();
+  const float y_scale = options_.y_scale();
+  x_ = x_ / x_scale * a_w_ + a_x_center_;
+  y_ = y_ / y_scale * a_h_ + a_y_center_;
+  if (options_.apply_exponential_on_box_size()) {
+    h_ = (h_ / options_.h_scale()).exp() * a_h_;
+    w_ = (w_ / options_.w_scale()).exp() * a_w_;
+  } else {
+    h_ = h_ / options_.h_scale() * a_h_;
+    w_ = w_ / options_.w_scale() * a_w_;
+  }
+  h_ /= 2.f;
+  w_ /= 2.f;
+
+  float* boxes = detections->boxes.data();
+  for (int j = 0; j < n; ++j) {
+    float* box = boxes + j * num_coords_;
+    box[0] = y_[j] - h_[j];
+    box[1] = x_[j] - w_[j];
+    box[2] = y_[j] + h_[j];
+    box[3] = x_[j] + w_[j];
+  }
+
+  for (int k = 0; k < options_.num_keypoints(); ++k) {
+    const int keypoint_offset =
+        options_.keypoint_coord_offset() + k * options_.num_values_per_keypoint();
+    for (int j = 0; j < n; ++j) {
+      const float* raw =
+          raw_boxes + candidates_[j] * num_coords_ + keypoint_offset;
+      y_[j] = raw[reverse ? 1 : 0];
+      x_[j] = raw[reverse ? 0 : 1];
+    }
+    x_ = x_ / x_scale * a_w_ + a_x_center_;
+    y_ = y_ / y_scale * a_h_ + a_y_center_;
+    for (int j = 0; j < n; ++j) {
+      float* keypoint = boxes + j * num_coords_ + keypoint_offset;
+      keypoint[0] = x_[j];
+      keypoint[1] = y_[j];
+    }
+  }
+}
+
+}  // namespace mediapipe
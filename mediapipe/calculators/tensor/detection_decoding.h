@@ -0,0 +1,112 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_DECODING_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_DECODING_H_
+
+#include <set>
+#include <vector>
+
+#include "Eigen/Core"
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+
+namespace mediapipe {
+
+// CPU decoding of raw SSD-style detection model outputs, as used by
+// TensorsToDetectionsCalculator.
+//
+// Decoded boxes use num_coords values per box: [ymin, xmin, ymax, xmax] at
+// offset 0 and keypoints as (x, y) pairs at keypoint_coord_offset.
+
+// Decodes the boxes and keypoints of all options.num_boxes() anchors into
+// "boxes".
+void DecodeBoxes(const float* raw_boxes, const std::vector<Anchor>& anchors,
+                 const TensorsToDetectionsCalculatorOptions& options,
+                 float* boxes);
+
+// Stores the top score and class of each box into "scores" and "classes",
+// skipping "ignore_classes". The sigmoid, if enabled, is applied to every
+// class score.
+void ScoreBoxes(const float* raw_scores,
+                const TensorsToDetectionsCalculatorOptions& options,
+                const std::set<int>& ignore_classes, float* scores,
+                int* classes);
+
+// Boxes that passed the score threshold, in anchor order.
+struct DecodedDetections {
+  // size() * num_coords decoded values, in the layout described above.
+  std::vector<float> boxes;
+  std::vector<float> scores;
+  std::vector<int> classes;
+
+  int size() const { return scores.size(); }
+};
+
+// Decodes the boxes of a frame score first: the top class score of every box
+// is computed, boxes below options.min_score_thresh() are dropped, and only
+// the remaining anchors are decoded. Since clipping and the sigmoid are
+// monotonic, the top class is found on the raw scores and the sigmoid is
+// evaluated once per box. Anchors and scratch values are kept as structure of
+// arrays, so that the exp and affine ops run on Eigen's vectorized kernels.
+//
+// Results match DecodeBoxes() + ScoreBoxes() followed by thresholding, up to
+// the rounding of the vectorized exp.
+//
+// Not thread-safe; reuses its scratch buffers across calls.
+class ScoreFirstDetectionDecoder {
+ public:
+  ScoreFirstDetectionDecoder(
+      const TensorsToDetectionsCalculatorOptions& options,
+      const std::vector<Anchor>& anchors);
+
+  void Decode(const float* raw_boxes, const float* raw_scores,
+              DecodedDetections* detections);
+
+ private:
+  void ScoreAll(const float* raw_scores);
+  void SelectCandidates();
+  void DecodeCandidates(const float* raw_boxes,
+                        DecodedDetections* detections);
+
+  const TensorsToDetectionsCalculatorOptions options_;
+  const int num_boxes_;
+  const int num_classes_;
+  const int num_coords_;
+  std::vector<int> scored_classes_;
+
+  Eigen::ArrayXf anchor_y_center_;
+  Eigen::ArrayXf anchor_x_center_;
+  Eigen::ArrayXf anchor_h_;
+  Eigen::ArrayXf anchor_w_;
+
+  // Per box.
+  Eigen::ArrayXf max_scores_;
+  Eigen::ArrayXi max_classes_;
+  // Indices of the boxes above the threshold.
+  std::vector<int> candidates_;
+  // Per candidate.
+  Eigen::ArrayXf y_;
+  Eigen::ArrayXf x_;
+  Eigen::ArrayXf h_;
+  Eigen::ArrayXf w_;
+  Eigen::ArrayXf a_y_center_;
+  Eigen::ArrayXf a_x_center_;
+  Eigen::ArrayXf a_h_;
+  Eigen::ArrayXf a_w_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_DECODING_H_
@@ -0,0 +1,222 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/detection_decoding.h"
+
+#include <random>
+#include <set>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/formats/object_detection/anchor.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+// Options of the short-range face detection model.
+TensorsToDetectionsCalculatorOptions FaceDetectionOptions(int num_boxes) {
+  TensorsToDetectionsCalculatorOptions options;
+  options.set_num_classes(1);
+  options.set_num_boxes(num_boxes);
+  options.set_num_coords(16);
+  options.set_box_coord_offset(0);
+  options.set_keypoint_coord_offset(4);
+  options.set_num_keypoints(6);
+  options.set_num_values_per_keypoint(2);
+  options.set_sigmoid_score(true);
+  options.set_score_clipping_thresh(100.0);
+  options.set_reverse_output_order(true);
+  options.set_x_scale(128.0);
+  options.set_y_scale(128.0);
+  options.set_h_scale(128.0);
+  options.set_w_scale(128.0);
+  options.set_min_score_thresh(0.5);
+  return options;
+}
+
+struct RawOutputs {
+  std::vector<Anchor> anchors;
+  std::vector<float> boxes;
+  std::vector<float> scores;
+};
+
+// Random model outputs where about "positive_fraction" of the boxes score
+// above 0.5 after the sigmoid.
+RawOutputs MakeRawOutputs(const TensorsToDetectionsCalculatorOptions& options,
+                          float positive_fraction) {
+  std::mt19937 rng(42);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::normal_distribution<float> normal(0.0f, 8.0f);
+  RawOutputs outputs;
+  for (int i = 0; i < options.num_boxes(); ++i) {
+    Anchor anchor;
+    anchor.set_x_center(unit(rng));
+    anchor.set_y_center(unit(rng));
+    anchor.set_w(1.0f);
+    anchor.set_h(1.0f);
+    outputs.anchors.push_back(anchor);
+  }
+  outputs.boxes.resize(options.num_boxes() * options.num_coords());
+  for (float& value : outputs.boxes) value = normal(rng);
+  outputs.scores.resize(options.num_boxes() * options.num_classes());
+  for (float& score : outputs.scores) {
+    score = unit(rng) < positive_fraction ? 1.0f + 5.0f * unit(rng)
+                                          : -1.0f - 5.0f * unit(rng);
+  }
+  return outputs;
+}
+
+std::set<int> IgnoreClasses(
+    const TensorsToDetectionsCalculatorOptions& options) {
+  return {options.ignore_classes().begin(), options.ignore_classes().end()};
+}
+
+// Decodes all boxes and keeps those passing the threshold, like the default
+// path of TensorsToDetectionsCalculator.
+DecodedDetections DecodeAllBoxes(
+    const TensorsToDetectionsCalculatorOptions& options,
+    const std::set<int>& ignore_classes, const RawOutputs& outputs) {
+  std::vector<float> boxes(options.num_boxes() * options.num_coords());
+  DecodeBoxes(outputs.boxes.data(), outputs.anchors, options, boxes.data());
+  std::vector<float> scores(options.num_boxes());
+  std::vector<int> classes(options.num_boxes());
+  ScoreBoxes(outputs.scores.data(), options, ignore_classes, scores.data(),
+             classes.data());
+  DecodedDetections detections;
+  for (int i = 0; i < options.num_boxes(); ++i) {
+    if (options.has_min_score_thresh() &&
+        scores[i] < options.min_score_thresh()) {
+      continue;
+    }
+    detections.boxes.insert(detections.boxes.end(),
+                            boxes.begin() + i * options.num_coords(),
+                            boxes.begin() + (i + 1) * options.num_coords());
+    detections.scores.push_back(scores[i]);
+    detections.classes.push_back(classes[i]);
+  }
+  return detections;
+}
+
+void ExpectSameDetections(const DecodedDetections& expected,
+                          const DecodedDetections& actual, int num_coords) {
+  ASSERT_EQ(expected.size(), actual.size());
+  EXPECT_EQ(expected.classes, actual.classes);
+  for (int i = 0; i < expected.size(); ++i) {
+    EXPECT_NEAR(expected.scores[i], actual.scores[i], 1e-6f);
+    for (int c = 0; c < num_coords; ++c) {
+      const float value = expected.boxes[i * num_coords + c];
+      EXPECT_NEAR(value, actual.boxes[i * num_coords + c],
+                  1e-5f * std::max(1.0f, std::abs(value)))
+          << "box " << i << " coord " << c;
+    }
+  }
+}
+
+TEST(DetectionDecodingTest, ScoreFirstMatchesDecodeAll) {
+  const auto options = FaceDetectionOptions(896);
+  const RawOutputs outputs = MakeRawOutputs(options, 0.1f);
+
+  const DecodedDetections expected =
+      DecodeAllBoxes(options, IgnoreClasses(options), outputs);
+  ASSERT_GT(expected.size(), 0);
+  ASSERT_LT(expected.size(), options.num_boxes());
+
+  ScoreFirstDetectionDecoder decoder(options, outputs.anchors);
+  DecodedDetections actual;
+  decoder.Decode(outputs.boxes.data(), outputs.scores.data(), &actual);
+  ExpectSameDetections(expected, actual, options.num_coords());
+
+  // Scratch buffers are reused across frames.
+  decoder.Decode(outputs.boxes.data(), outputs.scores.data(), &actual);
+  ExpectSameDetections(expected, actual, options.num_coords());
+}
+
+TEST(DetectionDecodingTest, ScoreFirstMatchesDecodeAllWithClassesAndExp) {
+  auto options = FaceDetectionOptions(500);
+  options.set_num_classes(5);
+  options.set_num_keypoints(0);
+  options.set_num_coords(4);
+  options.set_reverse_output_order(false);
+  options.set_apply_exponential_on_box_size(true);
+  options.set_x_scale(10.0);
+  options.set_y_scale(10.0);
+  options.set_h_scale(5.0);
+  options.set_w_scale(5.0);
+  options.set_score_clipping_thresh(3.0);
+  options.add_ignore_classes(0);
+  options.add_ignore_classes(3);
+  const RawOutputs outputs = MakeRawOutputs(options, 0.05f);
+
+  const DecodedDetections expected =
+      DecodeAllBoxes(options, IgnoreClasses(options), outputs);
+  ASSERT_GT(expected.size(), 0);
+
+  ScoreFirstDetectionDecoder decoder(options, outputs.anchors);
+  DecodedDetections actual;
+  decoder.Decode(outputs.boxes.data(), outputs.scores.data(), &actual);
+  ExpectSameDetections(expected, actual, options.num_coords());
+  for (int class_id : actual.classes) {
+    EXPECT_THAT(class_id, testing::AnyOf(1, 2, 4));
+  }
+}
+
+TEST(DetectionDecodingTest, ScoreFirstWithoutThresholdKeepsAllBoxes) {
+  auto options = FaceDetectionOptions(100);
+  options.clear_min_score_thresh();
+  options.set_sigmoid_score(false);
+  const RawOutputs outputs = MakeRawOutputs(options, 0.5f);
+
+  const DecodedDetections expected =
+      DecodeAllBoxes(options, IgnoreClasses(options), outputs);
+  ASSERT_EQ(expected.size(), options.num_boxes());
+
+  ScoreFirstDetectionDecoder decoder(options, outputs.anchors);
+  DecodedDetections actual;
+  decoder.Decode(outputs.boxes.data(), outputs.scores.data(), &actual);
+  ExpectSameDetections(expected, actual, options.num_coords());
+}
+
+// Compares the default decode-all path with the score-first path on the
+// anchor counts of the short-range (896) and full-range (2944) face detection
+// models, with about 1% of the boxes above the threshold.
+
+void BM_DecodeAll(benchmark::State& state) {
+  const auto options = FaceDetectionOptions(state.range(0));
+  const RawOutputs outputs = MakeRawOutputs(options, 0.01f);
+  const std::set<int> ignore_classes = IgnoreClasses(options);
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(DecodeAllBoxes(options, ignore_classes, outputs));
+  }
+  state.SetItemsProcessed(state.iterations() * options.num_boxes());
+}
+BENCHMARK(BM_DecodeAll)->Arg(896)->Arg(2944);
+
+void BM_ScoreFirst(benchmark::State& state) {
+  const auto options = FaceDetectionOptions(state.range(0));
+  const RawOutputs outputs = MakeRawOutputs(options, 0.01f);
+  ScoreFirstDetectionDecoder decoder(options, outputs.anchors);
+  DecodedDetections detections;
+  for (auto _ : state) {
+    decoder.Decode(outputs.boxes.data(), outputs.scores.data(), &detections);
+    benchmark::DoNotOptimize(detections);
+  }
+  state.SetItemsProcessed(state.iterations() * options.num_boxes());
+}
+BENCHMARK(BM_ScoreFirst)->Arg(896)->Arg(2944);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,275 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/detection_non_max_suppression.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace mediapipe {
+
+namespace {
+
+// Upper bound on the number of grid cells along each axis.
+constexpr int kMaxGridDim = 32;
+
+}  // namespace
+
+DetectionNonMaxSuppression::DetectionNonMaxSuppression(
+    const TensorsToDetectionsCalculatorOptions& options)
+    : options_(options.non_max_suppression()),
+      num_coords_(options.num_coords()),
+      keypoint_coord_offset_(options.keypoint_coord_offset()),
+      num_keypoints_(options.num_keypoints()),
+      num_values_per_keypoint_(options.num_values_per_keypoint()),
+      has_min_score_thresh_(options.has_min_score_thresh()),
+      min_score_thresh_(options.min_score_thresh()),
+      use_grid_(options_.min_suppression_threshold() >= 0.0f) {}
+
+void DetectionNonMaxSuppression::Run(const float* boxes, const float* scores,
+                                     const int* classes, int num_boxes,
+                                     DecodedDetections* output) {
+  output->boxes.clear();
+  output->scores.clear();
+  output->classes.clear();
+
+  ymin_.resize(num_boxes);
+  xmin_.resize(num_boxes);
+  ymax_.resize(num_boxes);
+  xmax_.resize(num_boxes);
+  visit_stamp_.assign(num_boxes, 0);
+  stamp_ = 0;
+  order_.clear();
+  for (int i = 0; i < num_boxes; ++i) {
+    const float* box = boxes + i * num_coords_;
+    ymin_[i] = box[0];
+    xmin_[i] = box[1];
+    ymax_[i] = box[2];
+    xmax_[i] = box[3];
+    if (has_min_score_thresh_ && scores[i] < min_score_thresh_) continue;
+    if (!(xmax_[i] >= xmin_[i] && ymax_[i] >= ymin_[i])) continue;
+    order_.push_back(i);
+  }
+  if (order_.empty()) return;
+  std::stable_sort(order_.begin(), order_.end(),
+                   [scores](int a, int b) { return scores[a] > scores[b]; });
+  max_num_detections_ = options_.max_num_detections() > -1
+                            ? options_.max_num_detections()
+                            : static_cast<int>(order_.size());
+  if (max_num_detections_ == 0) return;
+
+  BuildGrid();
+  if (options_.algorithm() ==
+      TensorsToDetectionsCalculatorOptions::NonMaxSuppression::WEIGHTED) {
+    RunWeighted(boxes, scores, classes, output);
+  } else {
+    RunHard(boxes, scores, classes, output);
+  }
+}
+
+float DetectionNonMaxSuppression::Similarity(int i, int j) const {
+  // Mirrors OverlapSimilarity() in NonMaxSuppressionCalculator.
+  if (xmax_[j] < xmin_[i] || xmax_[i] < xmin_[j] || ymax_[j] < ymin_[i] ||
+      ymax_[i] < ymin_[j]) {
+    return 0.0f;
+  }
+  const float intersection_area =
+      (std::min(xmax_[i], xmax_[j]) - std::max(xmin_[i], xmin_[j])) *
+      (std::min(ymax_[i], ymax_[j]) - std::max(ymin_[i], ymin_[j]));
+  const float area_i = (xmax_[i] - xmin_[i]) * (ymax_[i] - ymin_[i]);
+  const float area_j = (xmax_[j] - xmin_[j]) * (ymax_[j] - ymin_[j]);
+  float normalization;
+  switch (options_.overlap_type()) {
+    case Options::MODIFIED_JACCARD:
+      normalization = area_j;
+      break;
+    case Options::INTERSECTION_OVER_UNION:
+      normalization = area_i + area_j - intersection_area;
+      break;
+    default:
+      // JACCARD, normalized by the bounding box of both boxes.
+      normalization =
+          (std::max(xmax_[i], xmax_[j]) - std::min(xmin_[i], xmin_[j])) *
+          (std::max(ymax_[i], ymax_[j]) - std::min(ymin_[i], ymin_[j]));
+      break;
+  }
+  return normalization > 0.0f ? intersection_area / normalization : 0.0f;
+}
+
+void DetectionNonMaxSuppression::BuildGrid() {
+  grid_members_.clear();
+  if (!use_grid_) return;
+
+  // Cells are about the mean box size, so that a box overlaps few cells and
+  // a cell holds few boxes.
+  float x0 = xmin_[order_[0]], x1 = xmax_[order_[0]];
+  float y0 = ymin_[order_[0]], y1 = ymax_[order_[0]];
+  float total_width = 0.0f, total_height = 0.0f;
+  for (int i : order_) {
+    x0 = std::min(x0, xmin_[i]);
+    x1 = std::max(x1, xmax_[i]);
+    y0 = std::min(y0, ymin_[i]);
+    y1 = std::max(y1, ymax_[i]);
+    total_width += xmax_[i] - xmin_[i];
+    total_height += ymax_[i] - ymin_[i];
+  }
+  grid_x0_ = x0;
+  grid_y0_ = y0;
+  cell_width_ = std::max(total_width / order_.size(), (x1 - x0) / kMaxGridDim);
+  cell_height_ =
+      std::max(total_height / order_.size(), (y1 - y0) / kMaxGridDim);
+  if (!(cell_width_ > 0.0f)) cell_width_ = 1.0f;
+  if (!(cell_height_ > 0.0f)) cell_height_ = 1.0f;
+  grid_cols_ = std::min(
+      kMaxGridDim, static_cast<int>((x1 - x0) / cell_width_) + 1);
+  grid_rows_ = std::min(
+      kMaxGridDim, static_cast<int>((y1 - y0) / cell_height_) + 1);
+  cells_.resize(grid_cols_ * grid_rows_);
+  for (auto& cell : cells_) cell.clear();
+}
+
+void DetectionNonMaxSuppression::AddToGrid(int i) {
+  grid_members_.push_back(i);
+  if (!use_grid_) return;
+  const int col0 = std::min(
+      grid_cols_ - 1, static_cast<int>((xmin_[i] - grid_x0_) / cell_width_));
+  const int col1 = std::min(
+      grid_cols_ - 1, static_cast<int>((xmax_[i] - grid_x0_) / cell_width_));
+  const int row0 = std::min(
+      grid_rows_ - 1, static_cast<int>((ymin_[i] - grid_y0_) / cell_height_));
+  const int row1 = std::min(
+      grid_rows_ - 1, static_cast<int>((ymax_[i] - grid_y0_) / cell_height_));
+  for (int row = row0; row <= row1; ++row) {
+    for (int col = col0; col <= col1; ++col) {
+      cells_[row * grid_cols_ + col].push_back(i);
+    }
+  }
+}
+
+template <typename Fn>
+void DetectionNonMaxSuppression::ForEachNeighbour(int i, Fn fn) {
+  if (!use_grid_) {
+    for (int j : grid_members_) fn(j);
+    return;
+  }
+  // Boxes with a positive intersection share at least one cell. Boxes that
+  // only touch have a similarity of 0 and cannot exceed the threshold.
+  ++stamp_;
+  const int col0 = std::max(
+      0, std::min(grid_cols_ - 1,
+                  static_cast<int>((xmin_[i] - grid_x0_) / cell_width_)));
+  const int col1 = std::max(
+      0, std::min(grid_cols_ - 1,
+                  static_cast<int>((xmax_[i] - grid_x0_) / cell_width_)));
+  const int row0 = std::max(
+      0, std::min(grid_rows_ - 1,
+                  static_cast<int>((ymin_[i] - grid_y0_) / cell_height_)));
+  const int row1 = std::max(
+      0, std::min(grid_rows_ - 1,
+                  static_cast<int>((ymax_[i] - grid_y0_) / cell_height_)));
+  for (int row = row0; row <= row1; ++row) {
+    for (int col = col0; col <= col1; ++col) {
+      for (int j : cells_[row * grid_cols_ + col]) {
+        if (visit_stamp_[j] == stamp_) continue;
+        visit_stamp_[j] = stamp_;
+        fn(j);
+      }
+    }
+  }
+}
+
+void DetectionNonMaxSuppression::RunHard(const float* boxes,
+                                         const float* scores,
+                                         const int* classes,
+                                         DecodedDetections* output) {
+  const float threshold = options_.min_suppression_threshold();
+  // The grid holds the retained boxes.
+  for (int i : order_) {
+    bool suppressed = false;
+    ForEachNeighbour(i, [&](int j) {
+      suppressed = suppressed || Similarity(j, i) > threshold;
+    });
+    if (suppressed) continue;
+    AddToGrid(i);
+    output->boxes.insert(output->boxes.end(), boxes + i * num_coords_,
+                         boxes + (i + 1) * num_coords_);
+    output->scores.push_back(scores[i]);
+    output->classes.push_back(classes[i]);
+    if (output->size() >= max_num_detections_) break;
+  }
+}
+
+void DetectionNonMaxSuppression::RunWeighted(const float* boxes,
+                                             const float* scores,
+                                             const int* classes,
+                                             DecodedDetections* output) {
+  const float threshold = options_.min_suppression_threshold();
+  // The grid holds the boxes not yet merged into an output box.
+  removed_.assign(ymin_.size(), false);
+  for (int i : order_) AddToGrid(i);
+  const auto by_score = [scores](int a, int b) {
+    return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+  };
+
+  for (int i : order_) {
+    if (removed_[i]) continue;
+    // This includes box i itself, unless the threshold is at least 1.
+    candidates_.clear();
+    ForEachNeighbour(i, [&](int j) {
+      if (!removed_[j] && Similarity(j, i) > threshold) {
+        candidates_.push_back(j);
+      }
+    });
+    std::sort(candidates_.begin(), candidates_.end(), by_score);
+
+    const int offset = output->boxes.size();
+    output->boxes.insert(output->boxes.end(), boxes + i * num_coords_,
+                         boxes + (i + 1) * num_coords_);
+    output->scores.push_back(scores[i]);
+    output->classes.push_back(classes[i]);
+    // Like NonMaxSuppressionCalculator, stop once a box absorbs nothing.
+    if (candidates_.empty()) break;
+
+    // Score-weighted average of the box corners and keypoints.
+    weighted_.assign(4 + num_keypoints_ * 2, 0.0f);
+    float total_score = 0.0f;
+    for (int j : candidates_) {
+      removed_[j] = true;
+      const float score = scores[j];
+      total_score += score;
+      weighted_[0] += ymin_[j] * score;
+      weighted_[1] += xmin_[j] * score;
+      weighted_[2] += ymax_[j] * score;
+      weighted_[3] += xmax_[j] * score;
+      for (int k = 0; k < num_keypoints_; ++k) {
+        const float* keypoint = boxes + j * num_coords_ +
+                                keypoint_coord_offset_ +
+                                k * num_values_per_keypoint_;
+        weighted_[4 + k * 2] += keypoint[0] * score;
+        weighted_[4 + k * 2 + 1] += keypoint[1] * score;
+      }
+    }
+    float* merged = output->boxes.data() + offset;
+    for (int c = 0; c < 4; ++c) merged[c] = weighted_[c] / total_score;
+    for (int k = 0; k < num_keypoints_; ++k) {
+      float* keypoint =
+          merged + keypoint_coord_offset_ + k * num_values_per_keypoint_;
+      keypoint[0] = weighted_[4 + k * 2] / total_score;
+      keypoint[1] = weighted_[4 + k * 2 + 1] / total_score;
+    }
+    if (output->size() >= max_num_detections_) break;
+  }
+}
+
+}  // namespace mediapipe
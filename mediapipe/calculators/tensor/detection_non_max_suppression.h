@@ -0,0 +1,100 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_NON_MAX_SUPPRESSION_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_NON_MAX_SUPPRESSION_H_
+
+#include <vector>
+
+#include "mediapipe/calculators/tensor/detection_decoding.h"
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+
+namespace mediapipe {
+
+// Non-maximum suppression on decoded box arrays (see detection_decoding.h),
+// configured by options.non_max_suppression(). It implements the same hard
+// and weighted algorithms as NonMaxSuppressionCalculator, but works on the raw
+// arrays instead of Detection protos, and looks up overlapping boxes in a
+// uniform grid rather than comparing every pair.
+//
+// Not thread-safe; reuses its scratch buffers across calls.
+class DetectionNonMaxSuppression {
+ public:
+  explicit DetectionNonMaxSuppression(
+      const TensorsToDetectionsCalculatorOptions& options);
+
+  // Suppresses non-maxima among the first "num_boxes" boxes and writes the
+  // retained (or, for WEIGHTED, merged) boxes to "output" by decreasing
+  // score. Boxes below options.min_score_thresh() or with a negative width or
+  // height are dropped first, as TensorsToDetectionsCalculator would.
+  void Run(const float* boxes, const float* scores, const int* classes,
+           int num_boxes, DecodedDetections* output);
+
+ private:
+  using Options = TensorsToDetectionsCalculatorOptions::NonMaxSuppression;
+
+  // Overlap similarity of boxes "i" and "j", normalized by the area of "j"
+  // for MODIFIED_JACCARD.
+  float Similarity(int i, int j) const;
+
+  void BuildGrid();
+  void AddToGrid(int i);
+  // Calls "fn" once for every box in the grid cells overlapped by box "i".
+  template <typename Fn>
+  void ForEachNeighbour(int i, Fn fn);
+
+  void RunHard(const float* boxes, const float* scores, const int* classes,
+               DecodedDetections* output);
+  void RunWeighted(const float* boxes, const float* scores,
+                   const int* classes, DecodedDetections* output);
+
+  const Options options_;
+  const int num_coords_;
+  const int keypoint_coord_offset_;
+  const int num_keypoints_;
+  const int num_values_per_keypoint_;
+  const bool has_min_score_thresh_;
+  const float min_score_thresh_;
+  int max_num_detections_ = 0;
+
+  // Per input box.
+  std::vector<float> ymin_;
+  std::vector<float> xmin_;
+  std::vector<float> ymax_;
+  std::vector<float> xmax_;
+  std::vector<int> visit_stamp_;
+  std::vector<bool> removed_;
+  int stamp_ = 0;
+  // Valid boxes by decreasing score.
+  std::vector<int> order_;
+
+  // With a negative threshold even disjoint boxes suppress each other, so
+  // every box is a neighbour and the grid is not used.
+  bool use_grid_ = true;
+  float grid_x0_ = 0.0f;
+  float grid_y0_ = 0.0f;
+  float cell_width_ = 1.0f;
+  float cell_height_ = 1.0f;
+  int grid_cols_ = 1;
+  int grid_rows_ = 1;
+  std::vector<std::vector<int>> cells_;
+  std::vector<int> grid_members_;
+
+  std::vector<int> candidates_;
+  std::vector<float> weighted_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_DETECTION_NON_MAX_SUPPRESSION_H_
@@ -0,0 +1,216 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/detection_non_max_suppression.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mediapipe/calculators/tensor/detection_decoding.h"
+#include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatNear;
+using ::testing::Pointwise;
+using NmsOptions = TensorsToDetectionsCalculatorOptions::NonMaxSuppression;
+
+// Boxes with one keypoint: [ymin, xmin, ymax, xmax, keypoint_x, keypoint_y].
+TensorsToDetectionsCalculatorOptions MakeOptions(
+    NmsOptions::Algorithm algorithm, float threshold) {
+  TensorsToDetectionsCalculatorOptions options;
+  options.set_num_coords(6);
+  options.set_keypoint_coord_offset(4);
+  options.set_num_keypoints(1);
+  auto* nms = options.mutable_non_max_suppression();
+  nms->set_algorithm(algorithm);
+  nms->set_min_suppression_threshold(threshold);
+  nms->set_overlap_type(NmsOptions::INTERSECTION_OVER_UNION);
+  return options;
+}
+
+struct Boxes {
+  std::vector<float> boxes;
+  std::vector<float> scores;
+  std::vector<int> classes;
+
+  void Add(float ymin, float xmin, float ymax, float xmax, float score) {
+    boxes.insert(boxes.end(), {ymin, xmin, ymax, xmax, (xmin + xmax) / 2,
+                               (ymin + ymax) / 2});
+    scores.push_back(score);
+    classes.push_back(scores.size() - 1);
+  }
+  int size() const { return scores.size(); }
+};
+
+DecodedDetections RunNms(const TensorsToDetectionsCalculatorOptions& options,
+                         const Boxes& input) {
+  DetectionNonMaxSuppression nms(options);
+  DecodedDetections output;
+  nms.Run(input.boxes.data(), input.scores.data(), input.classes.data(),
+          input.size(), &output);
+  return output;
+}
+
+TEST(DetectionNonMaxSuppressionTest, HardSuppressesOverlappingBoxes) {
+  Boxes input;
+  input.Add(0.1f, 0.1f, 0.3f, 0.3f, 0.7f);
+  input.Add(0.1f, 0.1f, 0.3f, 0.32f, 0.9f);    // Suppresses box 0.
+  input.Add(0.5f, 0.5f, 0.7f, 0.7f, 0.8f);     // Far away.
+  input.Add(0.2f, 0.2f, 0.1f, 0.3f, 0.95f);    // Negative height, dropped.
+  input.Add(0.25f, 0.25f, 0.45f, 0.45f, 0.6f);  // IoU ~0.08 with box 1.
+
+  const DecodedDetections output =
+      RunNms(MakeOptions(NmsOptions::DEFAULT, 0.3f), input);
+  EXPECT_THAT(output.classes, ElementsAre(1, 2, 4));
+  EXPECT_THAT(output.scores, ElementsAre(0.9f, 0.8f, 0.6f));
+  EXPECT_THAT(std::vector<float>(output.boxes.begin(), output.boxes.begin() + 6),
+              ElementsAre(0.1f, 0.1f, 0.3f, 0.32f, 0.21f, 0.2f));
+}
+
+TEST(DetectionNonMaxSuppressionTest, HardHonorsMaxNumDetections) {
+  Boxes input;
+  for (int i = 0; i < 5; ++i) {
+    input.Add(0.1f * i, 0.0f, 0.1f * i + 0.05f, 0.05f, 0.5f + 0.1f * i);
+  }
+  auto options = MakeOptions(NmsOptions::DEFAULT, 0.3f);
+  options.mutable_non_max_suppression()->set_max_num_detections(2);
+  EXPECT_THAT(RunNms(options, input).classes, ElementsAre(4, 3));
+}
+
+TEST(DetectionNonMaxSuppressionTest, WeightedMergesOverlappingBoxes) {
+  Boxes input;
+  input.Add(0.0f, 0.0f, 0.2f, 0.2f, 0.75f);
+  input.Add(0.0f, 0.02f, 0.2f, 0.22f, 0.25f);
+  input.Add(0.6f, 0.6f, 0.8f, 0.8f, 0.5f);
+
+  const DecodedDetections output =
+      RunNms(MakeOptions(NmsOptions::WEIGHTED, 0.3f), input);
+  EXPECT_THAT(output.classes, ElementsAre(0, 2));
+  EXPECT_THAT(output.scores, ElementsAre(0.75f, 0.5f));
+  EXPECT_THAT(output.boxes,
+              Pointwise(FloatNear(1e-6f), {0.0f, 0.005f, 0.2f, 0.205f, 0.105f,
+                                           0.1f, 0.6f, 0.6f, 0.8f, 0.8f, 0.7f,
+                                           0.7f}));
+}
+
+TEST(DetectionNonMaxSuppressionTest, NegativeThresholdSuppressesEverything) {
+  Boxes input;
+  input.Add(0.0f, 0.0f, 0.1f, 0.1f, 0.5f);
+  input.Add(0.8f, 0.8f, 0.9f, 0.9f, 0.6f);
+  EXPECT_THAT(RunNms(MakeOptions(NmsOptions::DEFAULT, -1.0f), input).classes,
+              ElementsAre(1));
+}
+
+// Random crowded scene: "num_boxes" boxes of varying sizes around a few
+// dozen objects.
+Boxes MakeCrowdedScene(int num_boxes) {
+  std::mt19937 rng(7);
+  std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+  std::normal_distribution<float> jitter(0.0f, 0.01f);
+  std::vector<std::pair<float, float>> objects(num_boxes / 20 + 1);
+  for (auto& object : objects) object = {unit(rng), unit(rng)};
+  Boxes boxes;
+  for (int i = 0; i < num_boxes; ++i) {
+    const auto& object = objects[i % objects.size()];
+    const float size = 0.02f + 0.06f * unit(rng);
+    const float y = object.first + jitter(rng);
+    const float x = object.second + jitter(rng);
+    boxes.Add(y - size, x - size, y + size, x + size, unit(rng));
+  }
+  return boxes;
+}
+
+// Quadratic hard NMS, as done by NonMaxSuppressionCalculator on protos.
+DecodedDetections PairwiseHardNms(
+    const TensorsToDetectionsCalculatorOptions& options, const Boxes& input) {
+  std::vector<int> order(input.size());
+  for (int i = 0; i < input.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return input.scores[a] > input.scores[b];
+  });
+  const float* b = input.boxes.data();
+  const int n = options.num_coords();
+  auto iou = [&](int i, int j) {
+    const float w = std::min(b[i * n + 3], b[j * n + 3]) -
+                    std::max(b[i * n + 1], b[j * n + 1]);
+    const float h = std::min(b[i * n + 2], b[j * n + 2]) -
+                    std::max(b[i * n + 0], b[j * n + 0]);
+    if (w < 0 || h < 0) return 0.0f;
+    const float area_i = (b[i * n + 3] - b[i * n + 1]) *
+                         (b[i * n + 2] - b[i * n + 0]);
+    const float area_j = (b[j * n + 3] - b[j * n + 1]) *
+                         (b[j * n + 2] - b[j * n + 0]);
+    return w * h / (area_i + area_j - w * h);
+  };
+  std::vector<int> retained;
+  DecodedDetections output;
+  for (int i : order) {
+    bool suppressed = false;
+    for (int j : retained) {
+      if (iou(j, i) > options.non_max_suppression().min_suppression_threshold())
+        suppressed = true;
+    }
+    if (suppressed) continue;
+    retained.push_back(i);
+    output.scores.push_back(input.scores[i]);
+    output.classes.push_back(input.classes[i]);
+  }
+  return output;
+}
+
+TEST(DetectionNonMaxSuppressionTest, GridMatchesPairwiseOnCrowdedScene) {
+  const auto options = MakeOptions(NmsOptions::DEFAULT, 0.3f);
+  const Boxes input = MakeCrowdedScene(2000);
+  const DecodedDetections expected = PairwiseHardNms(options, input);
+  const DecodedDetections actual = RunNms(options, input);
+  EXPECT_GT(expected.size(), 20);
+  EXPECT_EQ(expected.classes, actual.classes);
+}
+
+void BM_PairwiseNms(benchmark::State& state) {
+  const auto options = MakeOptions(NmsOptions::DEFAULT, 0.3f);
+  const Boxes input = MakeCrowdedScene(state.range(0));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(PairwiseHardNms(options, input));
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PairwiseNms)->Arg(500)->Arg(2000)->Arg(8000);
+
+void BM_GridNms(benchmark::State& state) {
+  const auto options = MakeOptions(state.range(1) ? NmsOptions::WEIGHTED
+                                                  : NmsOptions::DEFAULT,
+                                   0.3f);
+  const Boxes input = MakeCrowdedScene(state.range(0));
+  DetectionNonMaxSuppression nms(options);
+  DecodedDetections output;
+  for (auto _ : state) {
+    nms.Run(input.boxes.data(), input.scores.data(), input.classes.data(),
+            input.size(), &output);
+    benchmark::DoNotOptimize(output);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_GridNms)->ArgPair(500, 0)->ArgPair(2000, 0)->ArgPair(8000, 0)
+    ->ArgPair(2000, 1);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,82 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/float_tensor_view.h"
+
+#include <cstdint>
+#include <utility>
+
+#include "mediapipe/framework/port/status.h"
+
+namespace mediapipe {
+
+namespace {
+
+// A scale of zero marks a tensor that is not quantized, as TfLite reports it
+// for kTfLiteNoQuantization, and its values are converted as they are.
+template <typename T>
+std::vector<float> Dequantize(const T* data, int num_elements,
+                              const Tensor::QuantizationParameters& params) {
+  std::vector<float> values(num_elements);
+  if (params.scale == 0.0f) {
+    for (int i = 0; i < num_elements; ++i) {
+      values[i] = static_cast<float>(data[i]);
+    }
+    return values;
+  }
+  for (int i = 0; i < num_elements; ++i) {
+    values[i] = params.scale * (static_cast<int32_t>(data[i]) -
+                                params.zero_point);
+  }
+  return values;
+}
+
+}  // namespace
+
+absl::StatusOr<FloatTensorView> FloatTensorView::Create(const Tensor& tensor) {
+  const Tensor::ElementType element_type = tensor.element_type();
+  if (element_type != Tensor::ElementType::kFloat32 &&
+      element_type != Tensor::ElementType::kUInt8 &&
+      element_type != Tensor::ElementType::kInt8 &&
+      element_type != Tensor::ElementType::kInt32) {
+    return absl::InvalidArgumentError(
+        "Only float32, uint8, int8 and int32 tensors can be read as floats.");
+  }
+  const int num_elements = tensor.shape().num_elements();
+  const auto& params = tensor.quantization_parameters();
+  auto view = tensor.GetCpuReadView();
+  std::vector<float> values;
+  switch (element_type) {
+    case Tensor::ElementType::kUInt8:
+      values = Dequantize(view.buffer<uint8_t>(), num_elements, params);
+      break;
+    case Tensor::ElementType::kInt8:
+      values = Dequantize(view.buffer<int8_t>(), num_elements, params);
+      break;
+    case Tensor::ElementType::kInt32:
+      values = Dequantize(view.buffer<int32_t>(), num_elements, params);
+      break;
+    default:  // kFloat32 is read in place.
+      break;
+  }
+  return FloatTensorView(std::move(view), std::move(values));
+}
+
+FloatTensorView::FloatTensorView(Tensor::CpuReadView view,
+                                 std::vector<float> values)
+    : view_(std::move(view)), values_(std::move(values)) {
+  buffer_ = values_.empty() ? view_.buffer<float>() : values_.data();
+}
+
+}  // namespace mediapipe
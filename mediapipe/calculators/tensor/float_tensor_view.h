@@ -0,0 +1,54 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_CALCULATORS_TENSOR_FLOAT_TENSOR_VIEW_H_
+#define MEDIAPIPE_CALCULATORS_TENSOR_FLOAT_TENSOR_VIEW_H_
+
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// Read access to the values of a CPU tensor as floats, for calculators that
+// post-process model outputs. kFloat32 tensors are read in place. kUInt8, kInt8
+// and kInt32 tensors are dequantized with the tensor's quantization parameters
+// into a float copy. Those with a zero scale are not quantized, and their
+// values are only converted to float.
+//
+// Example:
+//   ASSIGN_OR_RETURN(auto view, FloatTensorView::Create(tensor));
+//   const float* values = view.buffer();
+class FloatTensorView {
+ public:
+  static absl::StatusOr<FloatTensorView> Create(const Tensor& tensor);
+
+  FloatTensorView(FloatTensorView&&) = default;
+
+  // Valid while the view is alive.
+  const float* buffer() const { return buffer_; }
+
+ private:
+  FloatTensorView(Tensor::CpuReadView view, std::vector<float> values);
+
+  // Keeps the tensor locked for reading while the view is alive.
+  Tensor::CpuReadView view_;
+  std::vector<float> values_;
+  const float* buffer_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_CALCULATORS_TENSOR_FLOAT_TENSOR_VIEW_H_
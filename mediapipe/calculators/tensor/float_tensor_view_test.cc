@@ -0,0 +1,131 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/calculators/tensor/float_tensor_view.h"
+
+#include <cstdint>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(FloatTensorViewTest, ReadsFloatTensorInPlace) {
+  Tensor tensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  const float* buffer;
+  {
+    auto view = tensor.GetCpuWriteView();
+    float* values = view.buffer<float>();
+    values[0] = 0.5f;
+    values[1] = -1.0f;
+    values[2] = 2.0f;
+    buffer = values;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer(), buffer);
+  EXPECT_EQ(view.buffer()[1], -1.0f);
+}
+
+TEST(FloatTensorViewTest, DequantizesUInt8Tensor) {
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{1, 3},
+                Tensor::QuantizationParameters(0.5f, 128));
+  {
+    auto view = tensor.GetCpuWriteView();
+    uint8_t* values = view.buffer<uint8_t>();
+    values[0] = 0;
+    values[1] = 128;
+    values[2] = 255;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer()[0], -64.0f);
+  EXPECT_EQ(view.buffer()[1], 0.0f);
+  EXPECT_EQ(view.buffer()[2], 63.5f);
+}
+
+TEST(FloatTensorViewTest, DequantizesInt8Tensor) {
+  Tensor tensor(Tensor::ElementType::kInt8, Tensor::Shape{1, 2},
+                Tensor::QuantizationParameters(0.25f, -2));
+  {
+    auto view = tensor.GetCpuWriteView();
+    int8_t* values = view.buffer<int8_t>();
+    values[0] = -128;
+    values[1] = 2;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer()[0], -31.5f);
+  EXPECT_EQ(view.buffer()[1], 1.0f);
+}
+
+TEST(FloatTensorViewTest, ConvertsInt32Tensor) {
+  Tensor tensor(Tensor::ElementType::kInt32, Tensor::Shape{2});
+  {
+    auto view = tensor.GetCpuWriteView();
+    view.buffer<int32_t>()[0] = 7;
+    view.buffer<int32_t>()[1] = -3;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer()[0], 7.0f);
+  EXPECT_EQ(view.buffer()[1], -3.0f);
+}
+
+// TfLite reports a zero scale for tensors that are not quantized.
+TEST(FloatTensorViewTest, ConvertsNonQuantizedInt32Tensor) {
+  Tensor tensor(Tensor::ElementType::kInt32, Tensor::Shape{3},
+                Tensor::QuantizationParameters(0.0f, 0));
+  {
+    auto view = tensor.GetCpuWriteView();
+    view.buffer<int32_t>()[0] = 5;
+    view.buffer<int32_t>()[1] = 0;
+    view.buffer<int32_t>()[2] = -2;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer()[0], 5.0f);
+  EXPECT_EQ(view.buffer()[1], 0.0f);
+  EXPECT_EQ(view.buffer()[2], -2.0f);
+}
+
+TEST(FloatTensorViewTest, ConvertsNonQuantizedUInt8Tensor) {
+  Tensor tensor(Tensor::ElementType::kUInt8, Tensor::Shape{2},
+                Tensor::QuantizationParameters(0.0f, 0));
+  {
+    auto view = tensor.GetCpuWriteView();
+    view.buffer<uint8_t>()[0] = 3;
+    view.buffer<uint8_t>()[1] = 255;
+  }
+  auto view_or = FloatTensorView::Create(tensor);
+  MP_ASSERT_OK(view_or);
+  const FloatTensorView& view = view_or.value();
+  EXPECT_EQ(view.buffer()[0], 3.0f);
+  EXPECT_EQ(view.buffer()[1], 255.0f);
+}
+
+TEST(FloatTensorViewTest, RejectsFloat16Tensor) {
+  Tensor tensor(Tensor::ElementType::kFloat16, Tensor::Shape{2});
+  EXPECT_FALSE(FloatTensorView::Create(tensor).ok());
+}
+
+}  // namespace
+}  // namespace mediapipe
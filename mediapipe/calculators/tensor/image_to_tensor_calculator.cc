@@ -26,6 +26,7 @@
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/ret_check.h"
@@ -82,6 +83,8 @@ using GpuBuffer = mediapipe::GpuBuffer;
 // Outputs:
 //   TENSORS - std::vector<Tensor>
 //     Vector containing a single Tensor populated with an extrated RGB image.
+//     The tensor is kFloat32, or kUInt8/kInt8 if an output_tensor_uint_range
+//     or output_tensor_int_range is configured (CPU images only).
 //   MATRIX - std::array<float, 16> @Optional
 //     An std::array<float, 16> representing a 4x4 row-major-order matrix which
 //     can be used to map a point on the output tensor to a point on the input
@@ -138,11 +141,34 @@ class ImageToTensorCalculator : public Node {
     const auto& options =
         cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
 
-    RET_CHECK(options.has_output_tensor_float_range())
+    RET_CHECK(options.has_output_tensor_float_range() ||
+              options.has_output_tensor_int_range() ||
+              options.has_output_tensor_uint_range())
         << "Output tensor range is required.";
-    RET_CHECK_LT(options.output_tensor_float_range().min(),
-                 options.output_tensor_float_range().max())
-        << "Valid output tensor range is required.";
+    if (options.has_output_tensor_float_range()) {
+      RET_CHECK_LT(options.output_tensor_float_range().min(),
+                   options.output_tensor_float_range().max())
+          << "Valid output tensor range is required.";
+    }
+    if (options.has_output_tensor_uint_range()) {
+      RET_CHECK_LT(options.output_tensor_uint_range().min(),
+                   options.output_tensor_uint_range().max())
+          << "Valid output tensor range is required.";
+      RET_CHECK_LE(options.output_tensor_uint_range().max(), 255)
+          << "The maximum of the output uint range must not exceed 255.";
+    }
+    if (options.has_output_tensor_int_range()) {
+      RET_CHECK_LT(options.output_tensor_int_range().min(),
+                   options.output_tensor_int_range().max())
+          << "Valid output tensor range is required.";
+      RET_CHECK_GE(options.output_tensor_int_range().min(), -128)
+          << "The minimum of the output int range must not be below -128.";
+      RET_CHECK_LE(options.output_tensor_int_range().max(), 127)
+          << "The maximum of the output int range must not exceed 127.";
+    }
+    RET_CHECK(options.has_output_tensor_float_range() ||
+              !kInGpu(cc).IsConnected())
+        << "Integer output tensors are supported for CPU images only.";
     RET_CHECK_GT(options.output_tensor_width(), 0)
         << "Valid output tensor width is required.";
     RET_CHECK_GT(options.output_tensor_height(), 0)
@@ -150,6 +176,7 @@ class ImageToTensorCalculator : public Node {
 
     RET_CHECK(kIn(cc).IsConnected() ^ kInGpu(cc).IsConnected())
         << "One and only one of IMAGE and IMAGE_GPU input is expected.";
+    cc->UseService(kTensorPoolService).Optional();
 
 #if MEDIAPIPE_DISABLE_GPU
     if (kInGpu(cc).IsConnected()) {
@@ -163,6 +190,8 @@ class ImageToTensorCalculator : public Node {
     MP_RETURN_IF_ERROR(mediapipe::GlCalculatorHelper::UpdateContract(cc));
 #endif  // MEDIAPIPE_METAL_ENABLED
 #endif  // MEDIAPIPE_DISABLE_GPU
+    // Each input image is converted independently of the previous ones.
+    cc->SetStateless(true);
 
     return absl::OkStatus();
   }
@@ -171,8 +200,20 @@ class ImageToTensorCalculator : public Node {
     options_ = cc->Options<mediapipe::ImageToTensorCalculatorOptions>();
     output_width_ = options_.output_tensor_width();
     output_height_ = options_.output_tensor_height();
-    range_min_ = options_.output_tensor_float_range().min();
-    range_max_ = options_.output_tensor_float_range().max();
+    if (options_.has_output_tensor_uint_range()) {
+      range_min_ =
+          static_cast<float>(options_.output_tensor_uint_range().min());
+      range_max_ =
+          static_cast<float>(options_.output_tensor_uint_range().max());
+      tensor_type_ = Tensor::ElementType::kUInt8;
+    } else if (options_.has_output_tensor_int_range()) {
+      range_min_ = static_cast<float>(options_.output_tensor_int_range().min());
+      range_max_ = static_cast<float>(options_.output_tensor_int_range().max());
+      tensor_type_ = Tensor::ElementType::kInt8;
+    } else {
+      range_min_ = options_.output_tensor_float_range().min();
+      range_max_ = options_.output_tensor_float_range().max();
+    }
 
     return absl::OkStatus();
   }
@@ -220,6 +261,11 @@ class ImageToTensorCalculator : public Node {
       kOutMatrix(cc).Send(std::move(matrix));
     }
 
+    if (image->UsesGpu() && tensor_type_ != Tensor::ElementType::kFloat32) {
+      return absl::UnimplementedError(
+          "Integer output tensors are supported for CPU images only.");
+    }
+
     // Lazy initialization of the GPU or CPU converter.
     MP_RETURN_IF_ERROR(InitConverterIfNecessary(cc, image->UsesGpu()));
 
@@ -301,7 +347,8 @@ class ImageToTensorCalculator : public Node {
     } else {
       if (!cpu_converter_) {
         ASSIGN_OR_RETURN(cpu_converter_,
-                         CreateOpenCvConverter(cc, GetBorderMode()));
+                         CreateOpenCvConverter(cc, GetBorderMode(),
+                                               tensor_type_));
       }
     }
     return absl::OkStatus();
@@ -314,6 +361,7 @@ class ImageToTensorCalculator : public Node {
   int output_height_ = 0;
   float range_min_ = 0.0f;
   float range_max_ = 1.0f;
+  Tensor::ElementType tensor_type_ = Tensor::ElementType::kFloat32;
 };
 
 MEDIAPIPE_REGISTER_NODE(ImageToTensorCalculator);
@@ -433,5 +433,77 @@ TEST(ImageToTensorCalculatorTest, NoOpExceptRangeBorderZero) {
           BorderMode::kZero, roi);
 }
 
+// Converts the full image into an integer tensor and compares it to the
+// expected image after mapping the tensor values back to [0, 255].
+void RunIntegerTensorTest(cv::Mat input, cv::Mat expected_result,
+                          Tensor::ElementType tensor_type) {
+  const bool is_uint8 = tensor_type == Tensor::ElementType::kUInt8;
+  auto graph_config = mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(
+      absl::Substitute(R"(
+        input_stream: "input_image"
+        node {
+          calculator: "ImageToTensorCalculator"
+          input_stream: "IMAGE:input_image"
+          output_stream: "TENSORS:tensor"
+          options {
+            [mediapipe.ImageToTensorCalculatorOptions.ext] {
+              output_tensor_width: 64
+              output_tensor_height: 128
+              keep_aspect_ratio: true
+              $0
+            }
+          }
+        }
+        )",
+                       is_uint8
+                           ? "output_tensor_uint_range { min: 0 max: 255 }"
+                           : "output_tensor_int_range { min: -128 max: 127 }"));
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor", &graph_config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(graph_config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  MP_ASSERT_OK(
+      graph.AddPacketToInputStream("input_image", MakeImagePacket(input)));
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_THAT(output_packets, testing::SizeIs(1));
+
+  const Tensor& tensor = output_packets[0].Get<std::vector<Tensor>>()[0];
+  EXPECT_EQ(tensor.element_type(), tensor_type);
+  EXPECT_EQ(tensor.bytes(), 128 * 64 * 3);
+  auto view = tensor.GetCpuReadView();
+  cv::Mat tensor_mat(128, 64, is_uint8 ? CV_8UC3 : CV_8SC3,
+                     const_cast<void*>(view.buffer<void>()));
+  cv::Mat result_rgb;
+  tensor_mat.convertTo(result_rgb, CV_8UC3, 1.0, is_uint8 ? 0.0 : 128.0);
+
+  cv::Mat diff;
+  cv::absdiff(result_rgb, expected_result, diff);
+  double max_val;
+  cv::minMaxLoc(diff, nullptr, &max_val);
+  EXPECT_LE(max_val, 5);
+
+  MP_ASSERT_OK(graph.CloseInputStream("input_image"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
+TEST(ImageToTensorCalculatorTest, NoOpExceptRangeUInt8) {
+  RunIntegerTensorTest(
+      GetRgba("/mediapipe/calculators/"
+              "tensor/testdata/image_to_tensor/input.jpg"),
+      GetRgb("/mediapipe/calculators/"
+             "tensor/testdata/image_to_tensor/noop_except_range.png"),
+      Tensor::ElementType::kUInt8);
+}
+
+TEST(ImageToTensorCalculatorTest, NoOpExceptRangeInt8) {
+  RunIntegerTensorTest(
+      GetRgba("/mediapipe/calculators/"
+              "tensor/testdata/image_to_tensor/input.jpg"),
+      GetRgb("/mediapipe/calculators/"
+             "tensor/testdata/image_to_tensor/noop_except_range.png"),
+      Tensor::ElementType::kInt8);
+}
+
 }  // namespace
 }  // namespace mediapipe
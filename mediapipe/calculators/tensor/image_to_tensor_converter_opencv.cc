@@ -24,9 +24,11 @@
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_opencv.h"
 #include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/opencv_core_inc.h"
 #include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/statusor.h"
 
 namespace mediapipe {
@@ -35,7 +37,9 @@ namespace {
 
 class OpenCvProcessor : public ImageToTensorConverter {
  public:
-  OpenCvProcessor(BorderMode border_mode) {
+  OpenCvProcessor(BorderMode border_mode, Tensor::ElementType tensor_type,
+                  TensorPool* tensor_pool)
+      : tensor_type_(tensor_type), tensor_pool_(tensor_pool) {
     switch (border_mode) {
       case BorderMode::kReplicate:
         border_mode_ = cv::BORDER_REPLICATE;
@@ -44,6 +48,17 @@ class OpenCvProcessor : public ImageToTensorConverter {
         border_mode_ = cv::BORDER_CONSTANT;
         break;
     }
+    switch (tensor_type_) {
+      case Tensor::ElementType::kUInt8:
+        mat_type_ = CV_8UC3;
+        break;
+      case Tensor::ElementType::kInt8:
+        mat_type_ = CV_8SC3;
+        break;
+      default:
+        mat_type_ = CV_32FC3;
+        break;
+    }
   }
 
   absl::StatusOr<Tensor> Convert(const mediapipe::Image& input,
@@ -59,12 +74,13 @@ class OpenCvProcessor : public ImageToTensorConverter {
     cv::Mat src = mediapipe::formats::MatView(&input);
 
     constexpr int kNumChannels = 3;
-    Tensor tensor(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{1, output_dims.height, output_dims.width, kNumChannels});
+    const Tensor::Shape shape{1, output_dims.height, output_dims.width,
+                              kNumChannels};
+    Tensor tensor = tensor_pool_ ? tensor_pool_->GetTensor(tensor_type_, shape)
+                                 : Tensor(tensor_type_, shape);
     auto buffer_view = tensor.GetCpuWriteView();
-    cv::Mat dst(output_dims.height, output_dims.width, CV_32FC3,
-                buffer_view.buffer<float>());
+    cv::Mat dst(output_dims.height, output_dims.width, mat_type_,
+                buffer_view.buffer<void>());
 
     const cv::RotatedRect rotated_rect(cv::Point2f(roi.center_x, roi.center_y),
                                        cv::Size2f(roi.width, roi.height),
@@ -102,22 +118,37 @@ class OpenCvProcessor : public ImageToTensorConverter {
         auto transform,
         GetValueRangeTransformation(kInputImageRangeMin, kInputImageRangeMax,
                                     range_min, range_max));
-    transformed.convertTo(dst, CV_32FC3, transform.scale, transform.offset);
+    // Integer destinations are rounded and saturated.
+    transformed.convertTo(dst, mat_type_, transform.scale, transform.offset);
     return tensor;
   }
 
  private:
   enum cv::BorderTypes border_mode_;
+  Tensor::ElementType tensor_type_;
+  int mat_type_;
+  // Not owned, may be null.
+  TensorPool* tensor_pool_;
 };
 
 }  // namespace
 
 absl::StatusOr<std::unique_ptr<ImageToTensorConverter>> CreateOpenCvConverter(
-    CalculatorContext* cc, BorderMode border_mode) {
+    CalculatorContext* cc, BorderMode border_mode,
+    Tensor::ElementType tensor_type) {
+  RET_CHECK(tensor_type == Tensor::ElementType::kFloat32 ||
+            tensor_type == Tensor::ElementType::kUInt8 ||
+            tensor_type == Tensor::ElementType::kInt8)
+      << "Tensor type is currently not supported by OpenCvProcessor.";
+  TensorPool* tensor_pool = nullptr;
+  if (cc->Service(kTensorPoolService).IsAvailable()) {
+    tensor_pool = &cc->Service(kTensorPoolService).GetObject();
+  }
   // Simply "return absl::make_unique<OpenCvProcessor>()" failed to build on
   // macOS with bazel.
   return std::unique_ptr<ImageToTensorConverter>(
-      absl::make_unique<OpenCvProcessor>(border_mode));
+      absl::make_unique<OpenCvProcessor>(border_mode, tensor_type,
+                                         tensor_pool));
 }
 
 }  // namespace mediapipe
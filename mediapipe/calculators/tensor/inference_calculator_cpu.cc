@@ -12,13 +12,18 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 #include <string>
 #include <vector>
 
+#include "absl/container/inlined_vector.h"
 #include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
 #include "mediapipe/calculators/tensor/inference_calculator.h"
+#include "mediapipe/framework/formats/tensor_pool.h"
 
 #if defined(MEDIAPIPE_ANDROID)
 #include "tensorflow/lite/delegates/nnapi/nnapi_delegate.h"
@@ -51,6 +56,43 @@ int GetXnnpackNumThreads(const mediapipe::InferenceCalculatorOptions& opts) {
 #endif  // !__EMSCRIPTEN__ || __EMSCRIPTEN_PTHREADS__
 }
 
+// Returns the Tensor element type matching the TfLite tensor type.
+absl::StatusOr<Tensor::ElementType> GetElementType(
+    const TfLiteTensor& tensor) {
+  switch (tensor.type) {
+    case kTfLiteFloat16:
+      return Tensor::ElementType::kFloat16;
+    case kTfLiteFloat32:
+      return Tensor::ElementType::kFloat32;
+    case kTfLiteUInt8:
+      return Tensor::ElementType::kUInt8;
+    case kTfLiteInt8:
+      return Tensor::ElementType::kInt8;
+    case kTfLiteInt32:
+      return Tensor::ElementType::kInt32;
+    default:
+      return absl::InvalidArgumentError(
+          absl::StrCat("Unsupported TfLite tensor type: ",
+                       TfLiteTypeGetName(tensor.type)));
+  }
+}
+
+// Gets a CPU Tensor from the pool with the type and quantization of the
+// TfLite tensor but with the given dimensions. Tensors that TfLite doesn't
+// quantize get the default parameters, rather than its zero scale.
+absl::StatusOr<Tensor> CreateTensorLike(TensorPool* tensor_pool,
+                                        const TfLiteTensor& tensor,
+                                        std::vector<int> dims) {
+  ASSIGN_OR_RETURN(Tensor::ElementType element_type, GetElementType(tensor));
+  Tensor::QuantizationParameters quantization_parameters;
+  if (tensor.quantization.type != kTfLiteNoQuantization) {
+    quantization_parameters = Tensor::QuantizationParameters{
+        tensor.params.scale, tensor.params.zero_point};
+  }
+  return tensor_pool->GetTensor(element_type, Tensor::Shape{std::move(dims)},
+                                quantization_parameters);
+}
+
 }  // namespace
 
 class InferenceCalculatorCpuImpl
@@ -65,11 +107,46 @@ class InferenceCalculatorCpuImpl
  private:
   absl::Status LoadModel(CalculatorContext* cc);
   absl::Status LoadDelegate(CalculatorContext* cc);
+  absl::Status InitZeroCopy();
+
+  // Copies the inputs into the interpreter, runs it and copies the outputs
+  // into pooled tensors.
+  absl::Status RunWithCopies(const std::vector<Tensor>& input_tensors,
+                             std::vector<Tensor>* output_tensors);
+  // Binds the input tensors and pooled output tensors as the interpreter's
+  // buffers and runs it.
+  absl::Status RunZeroCopy(const std::vector<Tensor>& input_tensors,
+                           std::vector<Tensor>* output_tensors);
+
+  // Queues the current input packet, if any, running the pending batch first
+  // if the packet, or any later one, would not fit into it.
+  absl::Status AddToBatch(CalculatorContext* cc);
+  // Runs the pending packets as one batch and sends one output packet per
+  // input timestamp.
+  absl::Status RunBatch(CalculatorContext* cc);
+  // Resizes the batch dimension of the interpreter's inputs.
+  absl::Status ResizeBatch(int batch_size);
 
   // TfLite requires us to keep the model alive as long as the interpreter is.
   Packet<TfLiteModelPtr> model_packet_;
   std::unique_ptr<tflite::Interpreter> interpreter_;
   TfLiteDelegatePtr delegate_;
+
+  // The graph's TensorPool, or own_tensor_pool_ if the graph has none.
+  TensorPool* tensor_pool_ = nullptr;
+  std::unique_ptr<TensorPool> own_tensor_pool_;
+
+  bool zero_copy_ = false;
+  // Buffers currently bound as custom allocations, in the order of the
+  // interpreter's inputs and outputs.
+  std::vector<void*> bound_input_buffers_;
+  std::vector<void*> bound_output_buffers_;
+
+  int max_batch_size_ = 1;
+  int64_t max_batch_timestamp_span_ = 0;
+  // Batch size the interpreter is currently allocated for.
+  int interpreter_batch_size_ = 1;
+  std::vector<Packet<std::vector<Tensor>>> pending_batch_;
 };
 
 absl::Status InferenceCalculatorCpuImpl::UpdateContract(
@@ -77,31 +154,84 @@ absl::Status InferenceCalculatorCpuImpl::UpdateContract(
   const auto& options = cc->Options<::mediapipe::InferenceCalculatorOptions>();
   RET_CHECK(!options.model_path().empty() ^ kSideInModel(cc).IsConnected())
       << "Either model as side packet or model path in options is required.";
+  cc->UseService(kTensorPoolService).Optional();
+  // Each instance owns its interpreter, so invocations can run concurrently
+  // on separate instances when max_in_flight > 1. With batching, the pending
+  // batch is state kept across timestamps: each instance would hold its own
+  // partial batch, and the batches flushed by the other instances in Close()
+  // would be dropped.
+  const bool batching = options.batching().max_batch_size() > 1;
+  RET_CHECK(!batching || cc->GetMaxInFlight() <= 1)
+      << "batching cannot be combined with max_in_flight > 1.";
+  cc->SetStateless(!batching);
+  // Input timestamp bounds can complete the time span of a pending batch when
+  // no further packets arrive.
+  cc->SetProcessTimestampBounds(batching);
 
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Open(CalculatorContext* cc) {
+  if (cc->Service(kTensorPoolService).IsAvailable()) {
+    tensor_pool_ = &cc->Service(kTensorPoolService).GetObject();
+  } else {
+    own_tensor_pool_ = absl::make_unique<TensorPool>();
+    tensor_pool_ = own_tensor_pool_.get();
+  }
   MP_RETURN_IF_ERROR(LoadModel(cc));
   MP_RETURN_IF_ERROR(LoadDelegate(cc));
+  const auto& options = cc->Options<mediapipe::InferenceCalculatorOptions>();
+  zero_copy_ = options.cpu_zero_copy();
+  if (zero_copy_) {
+    MP_RETURN_IF_ERROR(InitZeroCopy());
+  }
+  max_batch_size_ = std::max(options.batching().max_batch_size(), 1);
+  max_batch_timestamp_span_ = options.batching().max_timestamp_span();
+  if (max_batch_size_ > 1) {
+    RET_CHECK(!zero_copy_) << "batching cannot be combined with cpu_zero_copy.";
+    for (int tensor_index : interpreter_->inputs()) {
+      const TfLiteIntArray* dims = interpreter_->tensor(tensor_index)->dims;
+      RET_CHECK(dims->size > 0 && dims->data[0] == 1)
+          << "batching requires model inputs with a batch dimension of 1.";
+    }
+    pending_batch_.reserve(max_batch_size_);
+  }
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
+  if (max_batch_size_ > 1) {
+    return AddToBatch(cc);
+  }
   if (kInTensors(cc).IsEmpty()) {
     return absl::OkStatus();
   }
   const auto& input_tensors = *kInTensors(cc);
   RET_CHECK(!input_tensors.empty());
   auto output_tensors = absl::make_unique<std::vector<Tensor>>();
+  if (zero_copy_) {
+    MP_RETURN_IF_ERROR(RunZeroCopy(input_tensors, output_tensors.get()));
+  } else {
+    MP_RETURN_IF_ERROR(RunWithCopies(input_tensors, output_tensors.get()));
+  }
+  kOutTensors(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
 
+absl::Status InferenceCalculatorCpuImpl::RunWithCopies(
+    const std::vector<Tensor>& input_tensors,
+    std::vector<Tensor>* output_tensors) {
   // Read CPU input into tensors.
   for (int i = 0; i < input_tensors.size(); ++i) {
     const Tensor* input_tensor = &input_tensors[i];
+    TfLiteTensor* local_tensor = interpreter_->input_tensor(i);
+    ASSIGN_OR_RETURN(Tensor::ElementType element_type,
+                     GetElementType(*local_tensor));
+    RET_CHECK(input_tensor->element_type() == element_type)
+        << "Input tensor " << i << " does not match the model's input type.";
+    RET_CHECK_EQ(input_tensor->bytes(), local_tensor->bytes);
     auto input_tensor_view = input_tensor->GetCpuReadView();
-    auto input_tensor_buffer = input_tensor_view.buffer<float>();
-    float* local_tensor_buffer = interpreter_->typed_input_tensor<float>(i);
-    std::memcpy(local_tensor_buffer, input_tensor_buffer,
+    std::memcpy(local_tensor->data.raw, input_tensor_view.buffer<char>(),
                 input_tensor->bytes());
   }
 
@@ -113,21 +243,209 @@ absl::Status InferenceCalculatorCpuImpl::Process(CalculatorContext* cc) {
   output_tensors->reserve(tensor_indexes.size());
   for (int i = 0; i < tensor_indexes.size(); ++i) {
     TfLiteTensor* tensor = interpreter_->tensor(tensor_indexes[i]);
-    output_tensors->emplace_back(
-        Tensor::ElementType::kFloat32,
-        Tensor::Shape{std::vector<int>{
-            tensor->dims->data, tensor->dims->data + tensor->dims->size}});
+    ASSIGN_OR_RETURN(
+        Tensor output_tensor,
+        CreateTensorLike(tensor_pool_, *tensor,
+                         {tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size}));
+    output_tensors->push_back(std::move(output_tensor));
     auto cpu_view = output_tensors->back().GetCpuWriteView();
-    std::memcpy(cpu_view.buffer<float>(), tensor->data.f,
+    std::memcpy(cpu_view.buffer<char>(), tensor->data.raw,
                 output_tensors->back().bytes());
   }
-  kOutTensors(cc).Send(std::move(output_tensors));
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::RunZeroCopy(
+    const std::vector<Tensor>& input_tensors,
+    std::vector<Tensor>* output_tensors) {
+  const auto& input_indexes = interpreter_->inputs();
+  const auto& output_indexes = interpreter_->outputs();
+  RET_CHECK_EQ(input_tensors.size(), input_indexes.size());
+
+  // The views are held until inference is done, so that the bound buffers
+  // cannot be accessed by anyone else in the meantime.
+  absl::InlinedVector<Tensor::CpuReadView, 4> input_views;
+  bool buffers_changed = false;
+  for (int i = 0; i < input_tensors.size(); ++i) {
+    const Tensor& input_tensor = input_tensors[i];
+    const TfLiteTensor* tensor = interpreter_->tensor(input_indexes[i]);
+    ASSIGN_OR_RETURN(Tensor::ElementType element_type,
+                     GetElementType(*tensor));
+    RET_CHECK(input_tensor.element_type() == element_type)
+        << "Input tensor " << i << " does not match the model's input type.";
+    RET_CHECK_EQ(input_tensor.bytes(), tensor->bytes);
+    input_views.push_back(input_tensor.GetCpuReadView());
+    // The interpreter only reads its input tensors.
+    void* buffer = const_cast<void*>(input_views.back().buffer<void>());
+    if (buffer == bound_input_buffers_[i]) continue;
+    RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                     input_indexes[i], {buffer, input_tensor.bytes()}),
+                 kTfLiteOk);
+    bound_input_buffers_[i] = buffer;
+    buffers_changed = true;
+  }
+
+  // Reserve first: the write views lock the tensors in place.
+  output_tensors->reserve(output_indexes.size());
+  absl::InlinedVector<Tensor::CpuWriteView, 4> output_views;
+  for (int i = 0; i < output_indexes.size(); ++i) {
+    const TfLiteTensor* tensor = interpreter_->tensor(output_indexes[i]);
+    ASSIGN_OR_RETURN(
+        Tensor output_tensor,
+        CreateTensorLike(tensor_pool_, *tensor,
+                         {tensor->dims->data,
+                          tensor->dims->data + tensor->dims->size}));
+    output_tensors->push_back(std::move(output_tensor));
+    output_views.push_back(output_tensors->back().GetCpuWriteView());
+    void* buffer = output_views.back().buffer<void>();
+    if (buffer == bound_output_buffers_[i]) continue;
+    RET_CHECK_EQ(interpreter_->SetCustomAllocationForTensor(
+                     output_indexes[i],
+                     {buffer, output_tensors->back().bytes()}),
+                 kTfLiteOk);
+    bound_output_buffers_[i] = buffer;
+    buffers_changed = true;
+  }
+
+  // TfLite requires AllocateTensors() after changing custom allocations, and
+  // that re-prepares every node of the graph. The pool hands back the same
+  // buffers once the previous outputs are released, so in steady state this
+  // only happens when a downstream calculator still holds on to a tensor.
+  if (buffers_changed) {
+    RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  }
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::AddToBatch(CalculatorContext* cc) {
+  const bool has_packet = !kInTensors(cc).IsEmpty();
+  if (!has_packet && !cc->InputTimestamp().IsRangeValue()) {
+    return absl::OkStatus();
+  }
+  // Without a packet, the input timestamp is the latest settled one, so the
+  // next packet cannot come before the following timestamp.
+  const Timestamp next_packet_timestamp =
+      has_packet ? cc->InputTimestamp()
+                 : cc->InputTimestamp().NextAllowedInStream();
+  if (!pending_batch_.empty() && max_batch_timestamp_span_ > 0 &&
+      next_packet_timestamp.Value() -
+              pending_batch_.front().timestamp().Value() >
+          max_batch_timestamp_span_) {
+    MP_RETURN_IF_ERROR(RunBatch(cc));
+  }
+  if (has_packet) {
+    RET_CHECK(!kInTensors(cc)->empty());
+    pending_batch_.push_back(kInTensors(cc));
+    if (pending_batch_.size() >= max_batch_size_) {
+      return RunBatch(cc);
+    }
+  }
+  if (pending_batch_.empty()) {
+    kOutTensors(cc).SetNextTimestampBound(next_packet_timestamp);
+  } else {
+    // No output can be produced before the oldest pending packet, which lets
+    // downstream calculators settle the timestamps in between.
+    kOutTensors(cc).SetNextTimestampBound(pending_batch_.front().timestamp());
+  }
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::ResizeBatch(int batch_size) {
+  if (batch_size == interpreter_batch_size_) {
+    return absl::OkStatus();
+  }
+  for (int tensor_index : interpreter_->inputs()) {
+    const TfLiteIntArray* dims = interpreter_->tensor(tensor_index)->dims;
+    std::vector<int> new_dims(dims->data, dims->data + dims->size);
+    new_dims[0] = batch_size;
+    RET_CHECK_EQ(interpreter_->ResizeInputTensor(tensor_index, new_dims),
+                 kTfLiteOk);
+  }
+  RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
+  interpreter_batch_size_ = batch_size;
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::RunBatch(CalculatorContext* cc) {
+  const int batch_size = pending_batch_.size();
+  if (batch_size == 0) {
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(ResizeBatch(batch_size));
+
+  // Stack the input tensors along the batch dimension.
+  const auto& input_indexes = interpreter_->inputs();
+  for (int b = 0; b < batch_size; ++b) {
+    const auto& input_tensors = pending_batch_[b].Get();
+    RET_CHECK_EQ(input_tensors.size(), input_indexes.size());
+    for (int i = 0; i < input_tensors.size(); ++i) {
+      const TfLiteTensor* tensor = interpreter_->tensor(input_indexes[i]);
+      ASSIGN_OR_RETURN(Tensor::ElementType element_type,
+                       GetElementType(*tensor));
+      RET_CHECK(input_tensors[i].element_type() == element_type);
+      const size_t frame_bytes = tensor->bytes / batch_size;
+      RET_CHECK_EQ(input_tensors[i].bytes(), frame_bytes);
+      auto input_tensor_view = input_tensors[i].GetCpuReadView();
+      std::memcpy(tensor->data.raw + b * frame_bytes,
+                  input_tensor_view.buffer<char>(), frame_bytes);
+    }
+  }
+
+  // Run inference.
+  RET_CHECK_EQ(interpreter_->Invoke(), kTfLiteOk);
+
+  // Split the outputs back into one packet per input timestamp.
+  const auto& output_indexes = interpreter_->outputs();
+  std::vector<std::unique_ptr<std::vector<Tensor>>> outputs(batch_size);
+  for (auto& output_tensors : outputs) {
+    output_tensors = absl::make_unique<std::vector<Tensor>>();
+    output_tensors->reserve(output_indexes.size());
+  }
+  for (int tensor_index : output_indexes) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+    RET_CHECK(tensor->dims->size > 0 && tensor->dims->data[0] == batch_size)
+        << "batching requires model outputs with a batch dimension.";
+    std::vector<int> frame_dims(tensor->dims->data,
+                                tensor->dims->data + tensor->dims->size);
+    frame_dims[0] = 1;
+    const size_t frame_bytes = tensor->bytes / batch_size;
+    for (int b = 0; b < batch_size; ++b) {
+      ASSIGN_OR_RETURN(Tensor output_tensor,
+                       CreateTensorLike(tensor_pool_, *tensor, frame_dims));
+      outputs[b]->push_back(std::move(output_tensor));
+      auto cpu_view = outputs[b]->back().GetCpuWriteView();
+      std::memcpy(cpu_view.buffer<char>(), tensor->data.raw + b * frame_bytes,
+                  frame_bytes);
+    }
+  }
+  for (int b = 0; b < batch_size; ++b) {
+    kOutTensors(cc).Send(std::move(outputs[b]),
+                         pending_batch_[b].timestamp());
+  }
+  pending_batch_.clear();
+  return absl::OkStatus();
+}
+
+absl::Status InferenceCalculatorCpuImpl::InitZeroCopy() {
+  for (int tensor_index : interpreter_->outputs()) {
+    const TfLiteTensor* tensor = interpreter_->tensor(tensor_index);
+    MP_RETURN_IF_ERROR(GetElementType(*tensor).status());
+    RET_CHECK(tensor->type != kTfLiteFloat16)
+        << "cpu_zero_copy does not support float16 outputs.";
+  }
+  bound_input_buffers_.assign(interpreter_->inputs().size(), nullptr);
+  bound_output_buffers_.assign(interpreter_->outputs().size(), nullptr);
   return absl::OkStatus();
 }
 
 absl::Status InferenceCalculatorCpuImpl::Close(CalculatorContext* cc) {
+  MP_RETURN_IF_ERROR(RunBatch(cc));
   interpreter_ = nullptr;
   delegate_ = nullptr;
+  tensor_pool_ = nullptr;
+  own_tensor_pool_ = nullptr;
   return absl::OkStatus();
 }
 
@@ -149,9 +467,6 @@ absl::Status InferenceCalculatorCpuImpl::LoadModel(CalculatorContext* cc) {
 #endif  // __EMSCRIPTEN__
 
   RET_CHECK_EQ(interpreter_->AllocateTensors(), kTfLiteOk);
-  // TODO: Support quantized tensors.
-  CHECK(interpreter_->tensor(interpreter_->inputs()[0])->quantization.type !=
-        kTfLiteAffineQuantization);
 
   return absl::OkStatus();
 }
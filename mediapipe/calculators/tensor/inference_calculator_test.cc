@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -118,6 +119,234 @@ TEST(InferenceCalculatorTest, SmokeTest) {
       {{"$delegate", "delegate { xnnpack { num_threads: 10 } }"}}));
 }
 
+// Runs the add model on batches of packets from consecutive timestamps and
+// checks that every output is sent at its input's timestamp, including the
+// partial batch flushed when the input stream is closed.
+TEST(InferenceCalculatorTest, BatchesAcrossTimestamps) {
+  const int kNumPackets = 5;
+  const int kNumElements = 8 * 8 * 3;
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+              batching { max_batch_size: 2 }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  for (int i = 0; i < kNumPackets; ++i) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32,
+                            Tensor::Shape{1, 8, 8, 3});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      std::fill_n(view.buffer<float>(), kNumElements, i + 1);
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  // The last packet waits for a second one to complete its batch.
+  EXPECT_EQ(kNumPackets - 1, output_packets.size());
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(kNumPackets, output_packets.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets[i].Timestamp());
+    const auto& result_vec = output_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    EXPECT_EQ(result_vec[0].shape().dims, std::vector<int>({1, 8, 8, 3}));
+    auto view = result_vec[0].GetCpuReadView();
+    const float* result_buffer = view.buffer<float>();
+    for (int j = 0; j < kNumElements; ++j) {
+      ASSERT_EQ(3 * (i + 1), result_buffer[j]);
+    }
+  }
+}
+
+// Runs the add model on replicas of the calculator, which the node has
+// without batching, and checks that the outputs keep the input order.
+TEST(InferenceCalculatorTest, RunsOnReplicas) {
+  const int kNumPackets = 8;
+  const int kNumElements = 8 * 8 * 3;
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          max_in_flight: 2
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < kNumPackets; ++i) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32,
+                            Tensor::Shape{1, 8, 8, 3});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      std::fill_n(view.buffer<float>(), kNumElements, i + 1);
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("tensor_in"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  ASSERT_EQ(kNumPackets, output_packets.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets[i].Timestamp());
+    const auto& result_vec = output_packets[i].Get<std::vector<Tensor>>();
+    auto view = result_vec[0].GetCpuReadView();
+    EXPECT_EQ(3 * (i + 1), view.buffer<float>()[0]);
+  }
+}
+
+// Replicas of a batching calculator would each hold their own partial batch,
+// so batching is rejected on nodes with max_in_flight > 1.
+TEST(InferenceCalculatorTest, RejectsBatchingOnReplicas) {
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:tensor_in"
+          output_stream: "TENSORS:tensor_out"
+          max_in_flight: 2
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+              batching { max_batch_size: 2 }
+            }
+          }
+        }
+      )");
+  CalculatorGraph graph;
+  absl::Status status = graph.Initialize(graph_config);
+  EXPECT_FALSE(status.ok());
+  EXPECT_THAT(status.message(),
+              testing::HasSubstr("batching cannot be combined with "
+                                 "max_in_flight > 1"));
+}
+
+// Runs the add model with batching behind a gate that stops passing packets,
+// so that the stream stalls in the middle of a batch. The gate keeps
+// advancing the timestamp bound, which completes the batch's timestamp span
+// and flushes it before the input stream is closed.
+TEST(InferenceCalculatorTest, FlushesBatchOnStalledStream) {
+  const int kNumElements = 8 * 8 * 3;
+  CalculatorGraphConfig graph_config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"(
+        input_stream: "tensor_in"
+        input_stream: "allow"
+        node {
+          calculator: "GateCalculator"
+          input_stream: "tensor_in"
+          input_stream: "ALLOW:allow"
+          output_stream: "gated_tensor"
+        }
+        node {
+          calculator: "InferenceCalculator"
+          input_stream: "TENSORS:gated_tensor"
+          output_stream: "TENSORS:tensor_out"
+          options {
+            [mediapipe.InferenceCalculatorOptions.ext] {
+              model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+              delegate { tflite {} }
+              batching { max_batch_size: 4 max_timestamp_span: 2 }
+            }
+          }
+        }
+      )");
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("tensor_out", &graph_config, &output_packets);
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  auto add_packet = [&graph](int timestamp, bool allow) {
+    auto input_vec = absl::make_unique<std::vector<Tensor>>();
+    input_vec->emplace_back(Tensor::ElementType::kFloat32,
+                            Tensor::Shape{1, 8, 8, 3});
+    {
+      auto view = input_vec->back().GetCpuWriteView();
+      std::fill_n(view.buffer<float>(), kNumElements, timestamp + 1);
+    }
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "tensor_in", Adopt(input_vec.release()).At(Timestamp(timestamp))));
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "allow", MakePacket<bool>(allow).At(Timestamp(timestamp))));
+  };
+  add_packet(0, true);
+  add_packet(1, true);
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  // The batch can still take a packet at timestamp 2.
+  EXPECT_TRUE(output_packets.empty());
+
+  add_packet(2, false);
+  MP_ASSERT_OK(graph.WaitUntilIdle());
+  ASSERT_EQ(2, output_packets.size());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(Timestamp(i), output_packets[i].Timestamp());
+    const auto& result_vec = output_packets[i].Get<std::vector<Tensor>>();
+    ASSERT_EQ(1, result_vec.size());
+    auto view = result_vec[0].GetCpuReadView();
+    const float* result_buffer = view.buffer<float>();
+    for (int j = 0; j < kNumElements; ++j) {
+      ASSERT_EQ(3 * (i + 1), result_buffer[j]);
+    }
+  }
+
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_EQ(2, output_packets.size());
+}
+
+TEST(InferenceCalculatorTest, SmokeTest_CpuZeroCopy) {
+  std::string graph_proto = R"(
+    input_stream: "tensor_in"
+    node {
+      calculator: "InferenceCalculator"
+      input_stream: "TENSORS:tensor_in"
+      output_stream: "TENSORS:tensor_out"
+      options {
+        [mediapipe.InferenceCalculatorOptions.ext] {
+          model_path: "mediapipe/calculators/tensor/testdata/add.bin"
+          cpu_zero_copy: true
+          $delegate
+        }
+      }
+    }
+  )";
+  DoSmokeTest(absl::StrReplaceAll(graph_proto,
+                                  {{"$delegate", "delegate { tflite {} }"}}));
+  DoSmokeTest(absl::StrReplaceAll(graph_proto,
+                                  {{"$delegate", "delegate { xnnpack {} }"}}));
+}
+
 TEST(InferenceCalculatorTest, SmokeTest_ModelAsInputSidePacket) {
   std::string graph_proto = R"(
     input_stream: "tensor_in"
@@ -19,6 +19,7 @@
 #include "absl/container/node_hash_map.h"
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/float_tensor_view.h"
 #include "mediapipe/calculators/tensor/tensors_to_classification_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -42,6 +43,7 @@ namespace api2 {
 // Input:
 //  TENSORS - Vector of Tensors of type kFloat32 containing one
 //            tensor, the size of which must be (1, * num_classes).
+//            Quantized (kUInt8/kInt8) tensors are dequantized on CPU.
 // Output:
 //  CLASSIFICATIONS - Result MediaPipe ClassificationList. The score and index
 //                    fields of each classification are set, while the label
@@ -117,8 +119,8 @@ absl::Status TensorsToClassificationCalculator::Process(CalculatorContext* cc) {
   if (label_map_loaded_) {
     RET_CHECK_EQ(num_classes, label_map_.size());
   }
-  auto view = input_tensors[0].GetCpuReadView();
-  auto raw_scores = view.buffer<float>();
+  ASSIGN_OR_RETURN(auto view, FloatTensorView::Create(input_tensors[0]));
+  auto raw_scores = view.buffer();
 
   auto classification_list = absl::make_unique<ClassificationList>();
   if (options_.binary_classification()) {
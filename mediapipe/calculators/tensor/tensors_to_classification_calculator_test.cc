@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <cstdint>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -84,6 +85,42 @@ TEST_F(TensorsToClassificationCalculatorTest, CorrectOutput) {
   }
 }
 
+TEST_F(TensorsToClassificationCalculatorTest, CorrectOutputWithUInt8Scores) {
+  mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
+    calculator: "TensorsToClassificationCalculator"
+    input_stream: "TENSORS:tensors"
+    output_stream: "CLASSIFICATIONS:classifications"
+    options {
+      [mediapipe.TensorsToClassificationCalculatorOptions.ext] {}
+    }
+  )pb"));
+
+  // Scores 0, 0.5 and 1 quantized with scale 1/128 and zero point 64.
+  auto tensors = absl::make_unique<std::vector<Tensor>>();
+  tensors->emplace_back(Tensor::ElementType::kUInt8, Tensor::Shape{1, 3},
+                        Tensor::QuantizationParameters(1.0f / 128, 64));
+  {
+    auto view = tensors->back().GetCpuWriteView();
+    uint8_t* tensor_buffer = view.buffer<uint8_t>();
+    tensor_buffer[0] = 64;
+    tensor_buffer[1] = 128;
+    tensor_buffer[2] = 192;
+  }
+  runner.MutableInputs()->Tag("TENSORS").packets.push_back(
+      mediapipe::Adopt(tensors.release()).At(mediapipe::Timestamp(0)));
+  MP_ASSERT_OK(runner.Run());
+
+  const auto& output_packets_ = runner.Outputs().Tag("CLASSIFICATIONS").packets;
+  ASSERT_EQ(1, output_packets_.size());
+  const auto& classification_list =
+      output_packets_[0].Get<ClassificationList>();
+  ASSERT_EQ(3, classification_list.classification_size());
+  for (int i = 0; i < classification_list.classification_size(); ++i) {
+    EXPECT_EQ(i, classification_list.classification(i).index());
+    EXPECT_FLOAT_EQ(i * 0.5, classification_list.classification(i).score());
+  }
+}
+
 TEST_F(TensorsToClassificationCalculatorTest, CorrectOutputWithLabelMapPath) {
   mediapipe::CalculatorRunner runner(ParseTextProtoOrDie<Node>(R"pb(
     calculator: "TensorsToClassificationCalculator"
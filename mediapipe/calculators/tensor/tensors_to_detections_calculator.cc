@@ -17,6 +17,9 @@
 
 #include "absl/strings/str_format.h"
 #include "absl/types/span.h"
+#include "mediapipe/calculators/tensor/detection_decoding.h"
+#include "mediapipe/calculators/tensor/detection_non_max_suppression.h"
+#include "mediapipe/calculators/tensor/float_tensor_view.h"
 #include "mediapipe/calculators/tensor/tensors_to_detections_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -97,7 +100,8 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
 // Detections.
 //
 // Input:
-//  TENSORS - Vector of Tensors of type kFloat32. The vector of tensors can have
+//  TENSORS - Vector of Tensors of type kFloat32 (quantized kUInt8/kInt8/kInt32
+//            tensors are dequantized on CPU). The vector of tensors can have
 //            2 or 3 tensors. First tensor is the predicted raw boxes/keypoints.
 //            The size of the values must be (num_boxes * num_predicted_values).
 //            Second tensor is the score tensor. The size of the valuse must be
@@ -106,7 +110,9 @@ void ConvertAnchorsToRawValues(const std::vector<Anchor>& anchors,
 //            detection model. The size of anchor tensor must be (num_boxes *
 //            4).
 // Output:
-//  DETECTIONS - Result MediaPipe detections.
+//  DETECTIONS - Result MediaPipe detections. If non_max_suppression is set in
+//               the options, only the detections retained by non-maximum
+//               suppression, so no NonMaxSuppressionCalculator is needed.
 //
 // Usage example:
 // node {
@@ -148,12 +154,10 @@ class TensorsToDetectionsCalculator : public Node {
 
   absl::Status LoadOptions(CalculatorContext* cc);
   absl::Status GpuInit(CalculatorContext* cc);
-  absl::Status DecodeBoxes(const float* raw_boxes,
-                           const std::vector<Anchor>& anchors,
-                           std::vector<float>* boxes);
   absl::Status ConvertToDetections(const float* detection_boxes,
                                    const float* detection_scores,
                                    const int* detection_classes,
+                                   int num_boxes,
                                    std::vector<Detection>* output_detections);
   Detection ConvertToDetection(float box_ymin, float box_xmin, float box_ymax,
                                float box_xmax, float score, int class_id,
@@ -166,6 +170,12 @@ class TensorsToDetectionsCalculator : public Node {
 
   ::mediapipe::TensorsToDetectionsCalculatorOptions options_;
   std::vector<Anchor> anchors_;
+  // Set once the anchors are known if options_.score_first_decoding().
+  std::unique_ptr<ScoreFirstDetectionDecoder> score_first_decoder_;
+  DecodedDetections decoded_detections_;
+  // Set if options_.has_non_max_suppression().
+  std::unique_ptr<DetectionNonMaxSuppression> non_max_suppression_;
+  DecodedDetections retained_detections_;
 
 #ifndef MEDIAPIPE_DISABLE_GL_COMPUTE
   mediapipe::GlCalculatorHelper gpu_helper_;
@@ -195,6 +205,8 @@ absl::Status TensorsToDetectionsCalculator::UpdateContract(
     MP_RETURN_IF_ERROR([MPPMetalHelper updateContract:cc]);
 #endif  // !defined(MEDIAPIPE_DISABLE_GL_COMPUTE)
   }
+  // Detections only depend on the current input tensors.
+  cc->SetStateless(true);
 
   return absl::OkStatus();
 }
@@ -261,10 +273,12 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(raw_score_tensor->shape().dims[0], 1);
     RET_CHECK_EQ(raw_score_tensor->shape().dims[1], num_boxes_);
     RET_CHECK_EQ(raw_score_tensor->shape().dims[2], num_classes_);
-    auto raw_box_view = raw_box_tensor->GetCpuReadView();
-    auto raw_boxes = raw_box_view.buffer<float>();
-    auto raw_scores_view = raw_score_tensor->GetCpuReadView();
-    auto raw_scores = raw_scores_view.buffer<float>();
+    ASSIGN_OR_RETURN(auto raw_box_view,
+                     FloatTensorView::Create(*raw_box_tensor));
+    auto raw_boxes = raw_box_view.buffer();
+    ASSIGN_OR_RETURN(auto raw_scores_view,
+                     FloatTensorView::Create(*raw_score_tensor));
+    auto raw_scores = raw_scores_view.buffer();
 
     // TODO: Support other options to load anchors.
     if (!anchors_init_) {
@@ -273,8 +287,9 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
         RET_CHECK_EQ(anchor_tensor->shape().dims.size(), 2);
         RET_CHECK_EQ(anchor_tensor->shape().dims[0], num_boxes_);
         RET_CHECK_EQ(anchor_tensor->shape().dims[1], kNumCoordsPerBox);
-        auto anchor_view = anchor_tensor->GetCpuReadView();
-        auto raw_anchors = anchor_view.buffer<float>();
+        ASSIGN_OR_RETURN(auto anchor_view,
+                         FloatTensorView::Create(*anchor_tensor));
+        auto raw_anchors = anchor_view.buffer();
         ConvertRawValuesToAnchors(raw_anchors, num_boxes_, &anchors_);
       } else if (!kInAnchors(cc).IsEmpty()) {
         anchors_ = *kInAnchors(cc);
@@ -283,44 +298,34 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
       }
       anchors_init_ = true;
     }
+
+    if (options_.score_first_decoding()) {
+      if (!score_first_decoder_) {
+        RET_CHECK_GE(anchors_.size(), num_boxes_);
+        score_first_decoder_ =
+            absl::make_unique<ScoreFirstDetectionDecoder>(options_, anchors_);
+      }
+      score_first_decoder_->Decode(raw_boxes, raw_scores,
+                                   &decoded_detections_);
+      return ConvertToDetections(decoded_detections_.boxes.data(),
+                                 decoded_detections_.scores.data(),
+                                 decoded_detections_.classes.data(),
+                                 decoded_detections_.size(),
+                                 output_detections);
+    }
+
     std::vector<float> boxes(num_boxes_ * num_coords_);
-    MP_RETURN_IF_ERROR(DecodeBoxes(raw_boxes, anchors_, &boxes));
+    DecodeBoxes(raw_boxes, anchors_, options_, boxes.data());
 
+    // Filter classes by scores.
     std::vector<float> detection_scores(num_boxes_);
     std::vector<int> detection_classes(num_boxes_);
+    ScoreBoxes(raw_scores, options_, ignore_classes_, detection_scores.data(),
+               detection_classes.data());
 
-    // Filter classes by scores.
-    for (int i = 0; i < num_boxes_; ++i) {
-      int class_id = -1;
-      float max_score = -std::numeric_limits<float>::max();
-      // Find the top score for box i.
-      for (int score_idx = 0; score_idx < num_classes_; ++score_idx) {
-        if (ignore_classes_.find(score_idx) == ignore_classes_.end()) {
-          auto score = raw_scores[i * num_classes_ + score_idx];
-          if (options_.sigmoid_score()) {
-            if (options_.has_score_clipping_thresh()) {
-              score = score < -options_.score_clipping_thresh()
-                          ? -options_.score_clipping_thresh()
-                          : score;
-              score = score > options_.score_clipping_thresh()
-                          ? options_.score_clipping_thresh()
-                          : score;
-            }
-            score = 1.0f / (1.0f + std::exp(-score));
-          }
-          if (max_score < score) {
-            max_score = score;
-            class_id = score_idx;
-          }
-        }
-      }
-      detection_scores[i] = max_score;
-      detection_classes[i] = class_id;
-    }
-
-    MP_RETURN_IF_ERROR(
-        ConvertToDetections(boxes.data(), detection_scores.data(),
-                            detection_classes.data(), output_detections));
+    MP_RETURN_IF_ERROR(ConvertToDetections(
+        boxes.data(), detection_scores.data(), detection_classes.data(),
+        num_boxes_, output_detections));
   } else {
     // Postprocessing on CPU with postprocessing op (e.g. anchor decoding and
     // non-maximum suppression) within the model.
@@ -346,25 +351,29 @@ absl::Status TensorsToDetectionsCalculator::ProcessCPU(
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[0], 1);
     RET_CHECK_EQ(detection_scores_tensor->shape().dims[1], max_detections);
 
-    auto num_boxes_view = num_boxes_tensor->GetCpuReadView();
-    auto num_boxes = num_boxes_view.buffer<float>();
+    ASSIGN_OR_RETURN(auto num_boxes_view,
+                     FloatTensorView::Create(*num_boxes_tensor));
+    auto num_boxes = num_boxes_view.buffer();
     num_boxes_ = num_boxes[0];
 
-    auto detection_boxes_view = detection_boxes_tensor->GetCpuReadView();
-    auto detection_boxes = detection_boxes_view.buffer<float>();
+    ASSIGN_OR_RETURN(auto detection_boxes_view,
+                     FloatTensorView::Create(*detection_boxes_tensor));
+    auto detection_boxes = detection_boxes_view.buffer();
 
-    auto detection_scores_view = detection_scores_tensor->GetCpuReadView();
-    auto detection_scores = detection_scores_view.buffer<float>();
+    ASSIGN_OR_RETURN(auto detection_scores_view,
+                     FloatTensorView::Create(*detection_scores_tensor));
+    auto detection_scores = detection_scores_view.buffer();
 
-    auto detection_classes_view = detection_classes_tensor->GetCpuReadView();
-    auto detection_classes_ptr = detection_classes_view.buffer<float>();
+    ASSIGN_OR_RETURN(auto detection_classes_view,
+                     FloatTensorView::Create(*detection_classes_tensor));
+    auto detection_classes_ptr = detection_classes_view.buffer();
     std::vector<int> detection_classes(num_boxes_);
     for (int i = 0; i < num_boxes_; ++i) {
       detection_classes[i] = static_cast<int>(detection_classes_ptr[i]);
     }
     MP_RETURN_IF_ERROR(ConvertToDetections(detection_boxes, detection_scores,
                                            detection_classes.data(),
-                                           output_detections));
+                                           num_boxes_, output_detections));
   }
   return absl::OkStatus();
 }
@@ -437,7 +446,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 #elif MEDIAPIPE_METAL_ENABLED
   id<MTLDevice> device = gpu_helper_.mtlDevice;
@@ -518,7 +527,7 @@ absl::Status TensorsToDetectionsCalculator::ProcessGPU(
   auto decoded_boxes_view = decoded_boxes_buffer_->GetCpuReadView();
   auto boxes = decoded_boxes_view.buffer<float>();
   MP_RETURN_IF_ERROR(ConvertToDetections(boxes, detection_scores.data(),
-                                         detection_classes.data(),
+                                         detection_classes.data(), num_boxes_,
                                          output_detections));
 
 #else
@@ -570,68 +579,9 @@ absl::Status TensorsToDetectionsCalculator::LoadOptions(CalculatorContext* cc) {
     ignore_classes_.insert(options_.ignore_classes(i));
   }
 
-  return absl::OkStatus();
-}
-
-absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
-    const float* raw_boxes, const std::vector<Anchor>& anchors,
-    std::vector<float>* boxes) {
-  for (int i = 0; i < num_boxes_; ++i) {
-    const int box_offset = i * num_coords_ + options_.box_coord_offset();
-
-    float y_center = raw_boxes[box_offset];
-    float x_center = raw_boxes[box_offset + 1];
-    float h = raw_boxes[box_offset + 2];
-    float w = raw_boxes[box_offset + 3];
-    if (options_.reverse_output_order()) {
-      x_center = raw_boxes[box_offset];
-      y_center = raw_boxes[box_offset + 1];
-      w = raw_boxes[box_offset + 2];
-      h = raw_boxes[box_offset + 3];
-    }
-
-    x_center =
-        x_center / options_.x_scale() * anchors[i].w() + anchors[i].x_center();
-    y_center =
-        y_center / options_.y_scale() * anchors[i].h() + anchors[i].y_center();
-
-    if (options_.apply_exponential_on_box_size()) {
-      h = std::exp(h / options_.h_scale()) * anchors[i].h();
-      w = std::exp(w / options_.w_scale()) * anchors[i].w();
-    } else {
-      h = h / options_.h_scale() * anchors[i].h();
-      w = w / options_.w_scale() * anchors[i].w();
-    }
-
-    const float ymin = y_center - h / 2.f;
-    const float xmin = x_center - w / 2.f;
-    const float ymax = y_center + h / 2.f;
-    const float xmax = x_center + w / 2.f;
-
-    (*boxes)[i * num_coords_ + 0] = ymin;
-    (*boxes)[i * num_coords_ + 1] = xmin;
-    (*boxes)[i * num_coords_ + 2] = ymax;
-    (*boxes)[i * num_coords_ + 3] = xmax;
-
-    if (options_.num_keypoints()) {
-      for (int k = 0; k < options_.num_keypoints(); ++k) {
-        const int offset = i * num_coords_ + options_.keypoint_coord_offset() +
-                           k * options_.num_values_per_keypoint();
-
-        float keypoint_y = raw_boxes[offset];
-        float keypoint_x = raw_boxes[offset + 1];
-        if (options_.reverse_output_order()) {
-          keypoint_x = raw_boxes[offset];
-          keypoint_y = raw_boxes[offset + 1];
-        }
-
-        (*boxes)[offset] = keypoint_x / options_.x_scale() * anchors[i].w() +
-                           anchors[i].x_center();
-        (*boxes)[offset + 1] =
-            keypoint_y / options_.y_scale() * anchors[i].h() +
-            anchors[i].y_center();
-      }
-    }
+  if (options_.has_non_max_suppression()) {
+    non_max_suppression_ =
+        absl::make_unique<DetectionNonMaxSuppression>(options_);
   }
 
   return absl::OkStatus();
@@ -639,8 +589,18 @@ absl::Status TensorsToDetectionsCalculator::DecodeBoxes(
 
 absl::Status TensorsToDetectionsCalculator::ConvertToDetections(
     const float* detection_boxes, const float* detection_scores,
-    const int* detection_classes, std::vector<Detection>* output_detections) {
-  for (int i = 0; i < num_boxes_; ++i) {
+    const int* detection_classes, int num_boxes,
+    std::vector<Detection>* output_detections) {
+  if (non_max_suppression_) {
+    non_max_suppression_->Run(detection_boxes, detection_scores,
+                              detection_classes, num_boxes,
+                              &retained_detections_);
+    detection_boxes = retained_detections_.boxes.data();
+    detection_scores = retained_detections_.scores.data();
+    detection_classes = retained_detections_.classes.data();
+    num_boxes = retained_detections_.size();
+  }
+  for (int i = 0; i < num_boxes; ++i) {
     if (options_.has_min_score_thresh() &&
         detection_scores[i] < options_.min_score_thresh()) {
       continue;
@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "mediapipe/calculators/tensor/float_tensor_view.h"
 #include "mediapipe/calculators/tensor/tensors_to_landmarks_calculator.pb.h"
 #include "mediapipe/framework/api2/node.h"
 #include "mediapipe/framework/calculator_framework.h"
@@ -49,6 +50,7 @@ float ApplyActivation(
 // Input:
 //  TENSORS - Vector of Tensors of type kFloat32. Only the first tensor will be
 //  used. The size of the values must be (num_dimension x num_landmarks).
+//  Quantized (kUInt8/kInt8) tensors are dequantized on CPU.
 //
 //  FLIP_HORIZONTALLY (optional): Whether to flip landmarks horizontally or
 //  not. Overrides corresponding side packet and/or field in the calculator
@@ -143,8 +145,8 @@ absl::Status TensorsToLandmarksCalculator::Process(CalculatorContext* cc) {
   const int num_dimensions = num_values / num_landmarks_;
   CHECK_GT(num_dimensions, 0);
 
-  auto view = input_tensors[0].GetCpuReadView();
-  auto raw_landmarks = view.buffer<float>();
+  ASSIGN_OR_RETURN(auto view, FloatTensorView::Create(input_tensors[0]));
+  auto raw_landmarks = view.buffer();
 
   LandmarkList output_landmarks;
 
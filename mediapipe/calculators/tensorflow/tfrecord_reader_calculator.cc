@@ -15,13 +15,20 @@
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/memory/memory.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
 #include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/io/record_reader.h"
 #include "tensorflow/core/platform/env.h"
@@ -31,14 +38,109 @@ namespace mediapipe {
 
 const char kTFRecordPath[] = "TFRECORD_PATH";
 const char kRecordIndex[] = "RECORD_INDEX";
+const char kNumRecords[] = "NUM_RECORDS";
 const char kExampleTag[] = "EXAMPLE";
 const char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
 
-// Reads a tensorflow example/sequence example from a tfrecord file.
-// If the "RECORD_INDEX" input side packet is provided, the calculator is going
-// to fetch the example/sequence example of the tfrecord file at the target
-// record index. Otherwise, the reader always reads the first example/sequence
-// example of the tfrecord file.
+namespace {
+
+// The start offsets of the records of one version of a tfrecord file, found
+// by scanning the file as far as needed so far.
+class RecordOffsets {
+ public:
+  // Sets "offset" to the start of record "index" of "file", scanning "file"
+  // from the last known record onwards if needed. Fails if "file" has fewer
+  // records.
+  absl::Status Find(tensorflow::RandomAccessFile* file, int index,
+                    tensorflow::uint64* offset) ABSL_LOCKS_EXCLUDED(mutex_);
+
+ private:
+  absl::Mutex mutex_;
+  // offsets_[i] is where record i starts. The last entry may be the end of
+  // the file.
+  std::vector<tensorflow::uint64> offsets_ ABSL_GUARDED_BY(mutex_) = {0};
+  bool reached_end_ ABSL_GUARDED_BY(mutex_) = false;
+};
+
+absl::Status RecordOffsets::Find(tensorflow::RandomAccessFile* file, int index,
+                                 tensorflow::uint64* offset) {
+  RET_CHECK_GE(index, 0);
+  absl::MutexLock lock(&mutex_);
+  if (index >= static_cast<int>(offsets_.size()) && !reached_end_) {
+    tensorflow::io::RecordReader reader(file,
+                                        tensorflow::io::RecordReaderOptions());
+    tensorflow::uint64 next_offset = offsets_.back();
+    tensorflow::tstring record;
+    while (index >= static_cast<int>(offsets_.size())) {
+      auto tf_status = reader.ReadRecord(&next_offset, &record);
+      if (tensorflow::errors::IsOutOfRange(tf_status)) {
+        reached_end_ = true;
+        break;
+      }
+      RET_CHECK(tf_status.ok())
+          << "Failed to read tfrecord: " << tf_status.ToString();
+      offsets_.push_back(next_offset);
+    }
+  }
+  RET_CHECK_LT(index, static_cast<int>(offsets_.size()))
+      << "Record index " << index << " is past the end of the tfrecord file.";
+  *offset = offsets_[index];
+  return absl::OkStatus();
+}
+
+// Process-wide cache of the RecordOffsets of each tfrecord path, so that
+// graphs reading different records of the same file only scan it once. An
+// entry is replaced when the length or modification time of its file changes.
+class RecordOffsetsCache {
+ public:
+  static RecordOffsetsCache* Get() {
+    static RecordOffsetsCache* cache = new RecordOffsetsCache();
+    return cache;
+  }
+
+  absl::StatusOr<std::shared_ptr<RecordOffsets>> Lookup(
+      const std::string& path) ABSL_LOCKS_EXCLUDED(mutex_) {
+    tensorflow::FileStatistics stats;
+    auto tf_status = tensorflow::Env::Default()->Stat(path, &stats);
+    RET_CHECK(tf_status.ok())
+        << "Failed to stat tfrecord file: " << tf_status.ToString();
+    absl::MutexLock lock(&mutex_);
+    Entry& entry = entries_[path];
+    if (!entry.offsets || entry.length != stats.length ||
+        entry.mtime_nsec != stats.mtime_nsec) {
+      entry.offsets = std::make_shared<RecordOffsets>();
+      entry.length = stats.length;
+      entry.mtime_nsec = stats.mtime_nsec;
+    }
+    return entry.offsets;
+  }
+
+ private:
+  struct Entry {
+    std::shared_ptr<RecordOffsets> offsets;
+    int64 length = -1;
+    int64 mtime_nsec = -1;
+  };
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
+// Reads tensorflow examples/sequence examples from a tfrecord file.
+//
+// If the EXAMPLE or SEQUENCE_EXAMPLE output is a side packet, the calculator
+// outputs the record at the "RECORD_INDEX" input side packet, or the first
+// record if it is not provided.
+//
+// If the output is a stream instead, the calculator emits "NUM_RECORDS"
+// records, or all remaining ones if not provided, starting at "RECORD_INDEX".
+// Each record is output at a timestamp equal to its index in the file.
+//
+// The start offsets of records are cached per file path for the lifetime of
+// the process, so opening record N of a file does not re-read the records
+// before it once any reader has passed them.
 //
 // Example config:
 // node {
@@ -47,12 +149,35 @@ const char kSequenceExampleTag[] = "SEQUENCE_EXAMPLE";
 //   input_side_packet: "RECORD_INDEX:record_index"
 //   output_side_packet: "SEQUENCE_EXAMPLE:sequence_example"
 // }
+//
+// Example config for streaming records 100 to 149:
+// node {
+//   calculator: "TFRecordReaderCalculator"
+//   input_side_packet: "TFRECORD_PATH:tfrecord_path"
+//   input_side_packet: "RECORD_INDEX:first_record_index"
+//   input_side_packet: "NUM_RECORDS:num_records"
+//   output_stream: "SEQUENCE_EXAMPLE:sequence_examples"
+// }
 class TFRecordReaderCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc);
 
   absl::Status Open(CalculatorContext* cc) override;
   absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  // Parses "record" into an Example or SequenceExample packet, depending on
+  // the output tag.
+  Packet ParseRecord(const tensorflow::tstring& record) const;
+
+  bool output_examples_ = false;
+  std::unique_ptr<tensorflow::RandomAccessFile> file_;
+  // Only used when streaming.
+  std::unique_ptr<tensorflow::io::RecordReader> reader_;
+  tensorflow::uint64 offset_ = 0;
+  int next_index_ = 0;
+  // Index past the last record to emit, or -1 to read until the end.
+  int end_index_ = -1;
 };
 
 absl::Status TFRecordReaderCalculator::GetContract(CalculatorContract* cc) {
@@ -61,65 +186,110 @@ absl::Status TFRecordReaderCalculator::GetContract(CalculatorContract* cc) {
     cc->InputSidePackets().Tag(kRecordIndex).Set<int>();
   }
 
-  RET_CHECK(cc->OutputSidePackets().HasTag(kExampleTag) ||
-            cc->OutputSidePackets().HasTag(kSequenceExampleTag))
+  const bool has_side_output =
+      cc->OutputSidePackets().HasTag(kExampleTag) ||
+      cc->OutputSidePackets().HasTag(kSequenceExampleTag);
+  const bool has_stream_output = cc->Outputs().HasTag(kExampleTag) ||
+                                 cc->Outputs().HasTag(kSequenceExampleTag);
+  RET_CHECK(has_side_output != has_stream_output)
       << "TFRecordReaderCalculator must output either Tensorflow example or "
-         "sequence example.";
-  if (cc->OutputSidePackets().HasTag(kExampleTag)) {
-    cc->OutputSidePackets().Tag(kExampleTag).Set<tensorflow::Example>();
+         "sequence example, as a side packet or as a stream.";
+  if (has_side_output) {
+    if (cc->OutputSidePackets().HasTag(kExampleTag)) {
+      cc->OutputSidePackets().Tag(kExampleTag).Set<tensorflow::Example>();
+    } else {
+      cc->OutputSidePackets()
+          .Tag(kSequenceExampleTag)
+          .Set<tensorflow::SequenceExample>();
+    }
   } else {
-    cc->OutputSidePackets()
-        .Tag(kSequenceExampleTag)
-        .Set<tensorflow::SequenceExample>();
+    if (cc->InputSidePackets().HasTag(kNumRecords)) {
+      cc->InputSidePackets().Tag(kNumRecords).Set<int>();
+    }
+    if (cc->Outputs().HasTag(kExampleTag)) {
+      cc->Outputs().Tag(kExampleTag).Set<tensorflow::Example>();
+    } else {
+      cc->Outputs().Tag(kSequenceExampleTag).Set<tensorflow::SequenceExample>();
+    }
   }
   return absl::OkStatus();
 }
 
 absl::Status TFRecordReaderCalculator::Open(CalculatorContext* cc) {
-  std::unique_ptr<tensorflow::RandomAccessFile> file;
-  auto tf_status = tensorflow::Env::Default()->NewRandomAccessFile(
-      cc->InputSidePackets().Tag(kTFRecordPath).Get<std::string>(), &file);
+  const std::string& path =
+      cc->InputSidePackets().Tag(kTFRecordPath).Get<std::string>();
+  auto tf_status =
+      tensorflow::Env::Default()->NewRandomAccessFile(path, &file_);
   RET_CHECK(tf_status.ok())
       << "Failed to open tfrecord file: " << tf_status.ToString();
-  tensorflow::io::RecordReader reader(file.get(),
-                                      tensorflow::io::RecordReaderOptions());
-  tensorflow::uint64 offset = 0;
-  tensorflow::tstring example_str;
   const int target_idx =
       cc->InputSidePackets().HasTag(kRecordIndex)
           ? cc->InputSidePackets().Tag(kRecordIndex).Get<int>()
           : 0;
-  int current_idx = 0;
-  while (current_idx <= target_idx) {
-    tf_status = reader.ReadRecord(&offset, &example_str);
-    RET_CHECK(tf_status.ok())
-        << "Failed to read tfrecord: " << tf_status.ToString();
-    if (current_idx == target_idx) {
-      if (cc->OutputSidePackets().HasTag(kExampleTag)) {
-        tensorflow::Example tf_example;
-        tf_example.ParseFromArray(example_str.data(), example_str.size());
-        cc->OutputSidePackets()
-            .Tag(kExampleTag)
-            .Set(MakePacket<tensorflow::Example>(std::move(tf_example)));
-      } else {
-        tensorflow::SequenceExample tf_sequence_example;
-        tf_sequence_example.ParseFromString(example_str);
-        cc->OutputSidePackets()
-            .Tag(kSequenceExampleTag)
-            .Set(MakePacket<tensorflow::SequenceExample>(
-                std::move(tf_sequence_example)));
-      }
+  ASSIGN_OR_RETURN(std::shared_ptr<RecordOffsets> record_offsets,
+                   RecordOffsetsCache::Get()->Lookup(path));
+  MP_RETURN_IF_ERROR(record_offsets->Find(file_.get(), target_idx, &offset_));
+  output_examples_ = cc->OutputSidePackets().HasTag(kExampleTag) ||
+                     cc->Outputs().HasTag(kExampleTag);
+
+  if (cc->Outputs().NumEntries() > 0) {
+    reader_ = absl::make_unique<tensorflow::io::RecordReader>(
+        file_.get(), tensorflow::io::RecordReaderOptions());
+    next_index_ = target_idx;
+    if (cc->InputSidePackets().HasTag(kNumRecords)) {
+      const int num_records =
+          cc->InputSidePackets().Tag(kNumRecords).Get<int>();
+      RET_CHECK_GE(num_records, 0);
+      end_index_ = target_idx + num_records;
     }
-    ++current_idx;
+    return absl::OkStatus();
   }
 
+  tensorflow::io::RecordReader reader(file_.get(),
+                                      tensorflow::io::RecordReaderOptions());
+  tensorflow::tstring example_str;
+  tf_status = reader.ReadRecord(&offset_, &example_str);
+  RET_CHECK(tf_status.ok())
+      << "Failed to read tfrecord: " << tf_status.ToString();
+  cc->OutputSidePackets()
+      .Tag(output_examples_ ? kExampleTag : kSequenceExampleTag)
+      .Set(ParseRecord(example_str));
+  file_.reset();
+
   return absl::OkStatus();
 }
 
 absl::Status TFRecordReaderCalculator::Process(CalculatorContext* cc) {
+  if (!reader_ || next_index_ == end_index_) {
+    return tool::StatusStop();
+  }
+  tensorflow::tstring example_str;
+  auto tf_status = reader_->ReadRecord(&offset_, &example_str);
+  if (end_index_ < 0 && tensorflow::errors::IsOutOfRange(tf_status)) {
+    return tool::StatusStop();
+  }
+  RET_CHECK(tf_status.ok())
+      << "Failed to read tfrecord: " << tf_status.ToString();
+  cc->Outputs()
+      .Tag(output_examples_ ? kExampleTag : kSequenceExampleTag)
+      .AddPacket(ParseRecord(example_str).At(Timestamp(next_index_)));
+  ++next_index_;
   return absl::OkStatus();
 }
 
+Packet TFRecordReaderCalculator::ParseRecord(
+    const tensorflow::tstring& record) const {
+  if (output_examples_) {
+    tensorflow::Example tf_example;
+    tf_example.ParseFromArray(record.data(), record.size());
+    return MakePacket<tensorflow::Example>(std::move(tf_example));
+  }
+  tensorflow::SequenceExample tf_sequence_example;
+  tf_sequence_example.ParseFromArray(record.data(), record.size());
+  return MakePacket<tensorflow::SequenceExample>(
+      std::move(tf_sequence_example));
+}
+
 REGISTER_CALCULATOR(TFRecordReaderCalculator);
 
 }  // namespace mediapipe
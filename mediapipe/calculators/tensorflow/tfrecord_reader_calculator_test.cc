@@ -0,0 +1,176 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "tensorflow/core/example/example.pb.h"
+#include "tensorflow/core/lib/io/record_writer.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/file_system.h"
+
+namespace mediapipe {
+namespace {
+
+namespace tf = ::tensorflow;
+
+constexpr int kNumRecords = 10;
+
+// Returns the id stored in a sequence example written by WriteRecords().
+int64 RecordId(const tf::SequenceExample& sequence) {
+  return sequence.context().feature().at("id").int64_list().value(0);
+}
+
+// Writes kNumRecords sequence examples with increasing ids, and of varying
+// sizes, to a new tfrecord file and returns its path.
+std::string WriteRecords(const std::string& name) {
+  const std::string path = absl::StrCat(std::getenv("TEST_TMPDIR"), "/", name);
+  std::unique_ptr<tf::WritableFile> file;
+  TF_CHECK_OK(tf::Env::Default()->NewWritableFile(path, &file));
+  tf::io::RecordWriter writer(file.get());
+  for (int i = 0; i < kNumRecords; ++i) {
+    tf::SequenceExample sequence;
+    auto& features = *sequence.mutable_context()->mutable_feature();
+    features["id"].mutable_int64_list()->add_value(i);
+    features["padding"].mutable_bytes_list()->add_value(
+        std::string(i * 7, 'x'));
+    TF_CHECK_OK(writer.WriteRecord(sequence.SerializeAsString()));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+  return path;
+}
+
+CalculatorGraphConfig::Node ReaderConfig(bool streaming) {
+  CalculatorGraphConfig::Node config;
+  config.set_calculator("TFRecordReaderCalculator");
+  config.add_input_side_packet("TFRECORD_PATH:path");
+  config.add_input_side_packet("RECORD_INDEX:index");
+  if (streaming) {
+    config.add_output_stream("SEQUENCE_EXAMPLE:sequences");
+  } else {
+    config.add_output_side_packet("SEQUENCE_EXAMPLE:sequence");
+  }
+  return config;
+}
+
+TEST(TFRecordReaderCalculatorTest, ReadsRecordAtIndex) {
+  const std::string path = WriteRecords("read_at_index.tfrecord");
+  // Out of order, so that later reads use the cached offsets.
+  for (int index : {6, 2, 9, 0, 6}) {
+    CalculatorRunner runner(ReaderConfig(/*streaming=*/false));
+    runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+        MakePacket<std::string>(path);
+    runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(index);
+    MP_ASSERT_OK(runner.Run());
+    EXPECT_EQ(RecordId(runner.OutputSidePackets()
+                           .Tag("SEQUENCE_EXAMPLE")
+                           .Get<tf::SequenceExample>()),
+              index);
+  }
+}
+
+TEST(TFRecordReaderCalculatorTest, FailsPastLastRecord) {
+  const std::string path = WriteRecords("past_last_record.tfrecord");
+  for (int index : {kNumRecords, kNumRecords + 5}) {
+    CalculatorRunner runner(ReaderConfig(/*streaming=*/false));
+    runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+        MakePacket<std::string>(path);
+    runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(index);
+    EXPECT_FALSE(runner.Run().ok());
+  }
+}
+
+TEST(TFRecordReaderCalculatorTest, StreamsRecordRange) {
+  const std::string path = WriteRecords("stream_range.tfrecord");
+  auto config = ReaderConfig(/*streaming=*/true);
+  config.add_input_side_packet("NUM_RECORDS:num_records");
+  CalculatorRunner runner(config);
+  runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+      MakePacket<std::string>(path);
+  runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(3);
+  runner.MutableSidePackets()->Tag("NUM_RECORDS") = MakePacket<int>(4);
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& packets =
+      runner.Outputs().Tag("SEQUENCE_EXAMPLE").packets;
+  ASSERT_EQ(packets.size(), 4);
+  for (int i = 0; i < packets.size(); ++i) {
+    EXPECT_EQ(packets[i].Timestamp(), Timestamp(3 + i));
+    EXPECT_EQ(RecordId(packets[i].Get<tf::SequenceExample>()), 3 + i);
+  }
+}
+
+TEST(TFRecordReaderCalculatorTest, StreamsUntilEndOfFile) {
+  const std::string path = WriteRecords("stream_to_end.tfrecord");
+  CalculatorRunner runner(ReaderConfig(/*streaming=*/true));
+  runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+      MakePacket<std::string>(path);
+  runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(7);
+  MP_ASSERT_OK(runner.Run());
+
+  const std::vector<Packet>& packets =
+      runner.Outputs().Tag("SEQUENCE_EXAMPLE").packets;
+  ASSERT_EQ(packets.size(), kNumRecords - 7);
+  EXPECT_EQ(RecordId(packets.back().Get<tf::SequenceExample>()),
+            kNumRecords - 1);
+}
+
+TEST(TFRecordReaderCalculatorTest, RescansRewrittenFile) {
+  const std::string path = WriteRecords("rewritten.tfrecord");
+  {
+    CalculatorRunner runner(ReaderConfig(/*streaming=*/false));
+    runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+        MakePacket<std::string>(path);
+    runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(5);
+    MP_ASSERT_OK(runner.Run());
+  }
+
+  // Replace the file with a shorter one holding different records.
+  std::unique_ptr<tf::WritableFile> file;
+  TF_CHECK_OK(tf::Env::Default()->NewWritableFile(path, &file));
+  tf::io::RecordWriter writer(file.get());
+  for (int i = 0; i < 3; ++i) {
+    tf::SequenceExample sequence;
+    (*sequence.mutable_context()->mutable_feature())["id"]
+        .mutable_int64_list()
+        ->add_value(100 + i);
+    TF_CHECK_OK(writer.WriteRecord(sequence.SerializeAsString()));
+  }
+  TF_CHECK_OK(writer.Close());
+  TF_CHECK_OK(file->Close());
+
+  CalculatorRunner runner(ReaderConfig(/*streaming=*/false));
+  runner.MutableSidePackets()->Tag("TFRECORD_PATH") =
+      MakePacket<std::string>(path);
+  runner.MutableSidePackets()->Tag("RECORD_INDEX") = MakePacket<int>(2);
+  MP_ASSERT_OK(runner.Run());
+  EXPECT_EQ(RecordId(runner.OutputSidePackets()
+                         .Tag("SEQUENCE_EXAMPLE")
+                         .Get<tf::SequenceExample>()),
+            102);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -15,8 +15,10 @@
 #include <cmath>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/port/ret_check.h"
 
 namespace mediapipe {
@@ -24,8 +26,25 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kLandmarksSoaTag[] = "LANDMARKS_SOA";
 constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 
+// Removes the letterbox from `landmarks` in place. The loop only reads and
+// writes contiguous arrays, so it is vectorized.
+void RemoveLetterbox(float left, float top, float left_and_right,
+                     float top_and_bottom, NormalizedLandmarkSoa* landmarks) {
+  const float width = 1.0f - left_and_right;
+  const float height = 1.0f - top_and_bottom;
+  float* x = landmarks->x().data();
+  float* y = landmarks->y().data();
+  float* z = landmarks->z().data();
+  for (int i = 0; i < landmarks->size(); ++i) {
+    x[i] = (x[i] - left) / width;
+    y[i] = (y[i] - top) / height;
+    z[i] = z[i] / width;  // Scale Z coordinate as X.
+  }
+}
+
 }  // namespace
 
 // Adjusts landmark locations on a letterboxed image to the corresponding
@@ -42,10 +61,16 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 //   padding from the 4 sides ([left, top, right, bottom]) of the letterboxed
 //   image, normalized to [0.f, 1.f] by the letterboxed image dimensions.
 //
+//   LANDMARKS_SOA: May be used instead of LANDMARKS, with NormalizedLandmarkSoa
+//   landmarks.
+//
 // Output:
 //   LANDMARKS: An NormalizedLandmarkList proto representing landmarks with
 //   their locations adjusted to the letterbox-removed (non-padded) image.
 //
+//   LANDMARKS_SOA: Used with LANDMARKS_SOA inputs, the NormalizedLandmarkSoa
+//   landmarks adjusted to the letterbox-removed image.
+//
 // Usage example:
 // node {
 //   calculator: "LandmarkLetterboxRemovalCalculator"
@@ -65,24 +90,36 @@ constexpr char kLetterboxPaddingTag[] = "LETTERBOX_PADDING";
 class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kLandmarksTag) ||
+               cc->Inputs().HasTag(kLandmarksSoaTag)) &&
               cc->Inputs().HasTag(kLetterboxPaddingTag))
         << "Missing one or more input streams.";
 
     RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksTag),
                  cc->Outputs().NumEntries(kLandmarksTag))
         << "Same number of input and output landmarks is required.";
+    RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksSoaTag),
+                 cc->Outputs().NumEntries(kLandmarksSoaTag))
+        << "Same number of input and output landmarks is required.";
 
     for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
          id != cc->Inputs().EndId(kLandmarksTag); ++id) {
       cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksSoaTag);
+         id != cc->Inputs().EndId(kLandmarksSoaTag); ++id) {
+      cc->Inputs().Get(id).Set<NormalizedLandmarkSoa>();
+    }
     cc->Inputs().Tag(kLetterboxPaddingTag).Set<std::array<float, 4>>();
 
     for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
          id != cc->Outputs().EndId(kLandmarksTag); ++id) {
       cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksSoaTag);
+         id != cc->Outputs().EndId(kLandmarksSoaTag); ++id) {
+      cc->Outputs().Get(id).Set<NormalizedLandmarkSoa>();
+    }
 
     return absl::OkStatus();
   }
@@ -134,6 +171,23 @@ class LandmarkLetterboxRemovalCalculator : public CalculatorBase {
           MakePacket<NormalizedLandmarkList>(output_landmarks)
               .At(cc->InputTimestamp()));
     }
+
+    input_id = cc->Inputs().BeginId(kLandmarksSoaTag);
+    output_id = cc->Outputs().BeginId(kLandmarksSoaTag);
+    for (; input_id != cc->Inputs().EndId(kLandmarksSoaTag);
+         ++input_id, ++output_id) {
+      const auto& input_packet = cc->Inputs().Get(input_id);
+      if (input_packet.IsEmpty()) {
+        continue;
+      }
+
+      auto output_landmarks = absl::make_unique<NormalizedLandmarkSoa>(
+          input_packet.Get<NormalizedLandmarkSoa>());
+      RemoveLetterbox(left, top, left_and_right, top_and_bottom,
+                      output_landmarks.get());
+      cc->Outputs().Get(output_id).Add(output_landmarks.release(),
+                                       cc->InputTimestamp());
+    }
     return absl::OkStatus();
   }
 };
@@ -15,6 +15,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_runner.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -109,4 +110,51 @@ TEST(LandmarkLetterboxRemovalCalculatorTest, PaddingTopBottom) {
   EXPECT_THAT(output_landmarks.landmark(2).y(), testing::FloatNear(1.0f, 1e-5));
 }
 
+TEST(LandmarkLetterboxRemovalCalculatorTest, SoaMatchesProto) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(R"pb(
+    calculator: "LandmarkLetterboxRemovalCalculator"
+    input_stream: "LANDMARKS:landmarks"
+    input_stream: "LANDMARKS_SOA:landmarks_soa"
+    input_stream: "LETTERBOX_PADDING:letterbox_padding"
+    output_stream: "LANDMARKS:adjusted_landmarks"
+    output_stream: "LANDMARKS_SOA:adjusted_landmarks_soa"
+  )pb"));
+
+  NormalizedLandmarkList landmarks;
+  for (int i = 0; i < 21; ++i) {
+    NormalizedLandmark* landmark = landmarks.add_landmark();
+    *landmark = CreateLandmark(0.05f * i, 1.0f - 0.04f * i);
+    landmark->set_z(0.01f * i);
+    landmark->set_visibility(0.5f);
+  }
+  runner.MutableInputs()->Tag("LANDMARKS").packets.push_back(
+      MakePacket<NormalizedLandmarkList>(landmarks).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("LANDMARKS_SOA").packets.push_back(
+      MakePacket<NormalizedLandmarkSoa>(
+          NormalizedLandmarkSoa::FromProto(landmarks))
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Tag("LETTERBOX_PADDING").packets.push_back(
+      MakePacket<std::array<float, 4>>(
+          std::array<float, 4>{0.1f, 0.2f, 0.15f, 0.05f})
+          .At(Timestamp(0)));
+
+  MP_ASSERT_OK(runner.Run()) << "Calculator execution failed.";
+  const auto& output = runner.Outputs().Tag("LANDMARKS").packets;
+  const auto& output_soa = runner.Outputs().Tag("LANDMARKS_SOA").packets;
+  ASSERT_EQ(1, output.size());
+  ASSERT_EQ(1, output_soa.size());
+  const auto& expected = output[0].Get<NormalizedLandmarkList>();
+  const auto& actual = output_soa[0].Get<NormalizedLandmarkSoa>();
+  ASSERT_EQ(actual.size(), expected.landmark_size());
+  for (int i = 0; i < actual.size(); ++i) {
+    EXPECT_THAT(actual.x()[i],
+                testing::FloatNear(expected.landmark(i).x(), 1e-6));
+    EXPECT_THAT(actual.y()[i],
+                testing::FloatNear(expected.landmark(i).y(), 1e-6));
+    EXPECT_THAT(actual.z()[i],
+                testing::FloatNear(expected.landmark(i).z(), 1e-6));
+    EXPECT_EQ(actual.visibility()[i], expected.landmark(i).visibility());
+  }
+}
+
 }  // namespace mediapipe
@@ -15,9 +15,11 @@
 #include <cmath>
 #include <vector>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/calculators/util/landmark_projection_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/formats/rect.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 
@@ -26,8 +28,33 @@ namespace mediapipe {
 namespace {
 
 constexpr char kLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kLandmarksSoaTag[] = "NORM_LANDMARKS_SOA";
 constexpr char kRectTag[] = "NORM_RECT";
 
+// Projects `landmarks` in place. The loop only reads and writes contiguous
+// arrays, so it is vectorized.
+void ProjectLandmarks(const NormalizedRect& rect, float angle,
+                      NormalizedLandmarkSoa* landmarks) {
+  const float cos_angle = std::cos(angle);
+  const float sin_angle = std::sin(angle);
+  const float width = rect.width();
+  const float height = rect.height();
+  const float x_center = rect.x_center();
+  const float y_center = rect.y_center();
+  float* x = landmarks->x().data();
+  float* y = landmarks->y().data();
+  float* z = landmarks->z().data();
+  for (int i = 0; i < landmarks->size(); ++i) {
+    const float centered_x = x[i] - 0.5f;
+    const float centered_y = y[i] - 0.5f;
+    const float new_x = cos_angle * centered_x - sin_angle * centered_y;
+    const float new_y = sin_angle * centered_x + cos_angle * centered_y;
+    x[i] = new_x * width + x_center;
+    y[i] = new_y * height + y_center;
+    z[i] = z[i] * width;  // Scale Z coordinate as X.
+  }
+}
+
 }  // namespace
 
 // Projects normalized landmarks in a rectangle to its original coordinates. The
@@ -37,10 +64,14 @@ constexpr char kRectTag[] = "NORM_RECT";
 //                   in a normalized rectangle.
 //   NORM_RECT: An NormalizedRect representing a normalized rectangle in image
 //              coordinates.
+//   NORM_LANDMARKS_SOA: May be used instead of NORM_LANDMARKS, with
+//                       NormalizedLandmarkSoa landmarks.
 //
 // Output:
 //   NORM_LANDMARKS: A NormalizedLandmarkList representing landmarks
 //                   with their locations adjusted to the image.
+//   NORM_LANDMARKS_SOA: Used with NORM_LANDMARKS_SOA inputs, the
+//                       NormalizedLandmarkSoa landmarks adjusted to the image.
 //
 // Usage example:
 // node {
@@ -61,24 +92,36 @@ constexpr char kRectTag[] = "NORM_RECT";
 class LandmarkProjectionCalculator : public CalculatorBase {
  public:
   static absl::Status GetContract(CalculatorContract* cc) {
-    RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) &&
+    RET_CHECK((cc->Inputs().HasTag(kLandmarksTag) ||
+               cc->Inputs().HasTag(kLandmarksSoaTag)) &&
               cc->Inputs().HasTag(kRectTag))
         << "Missing one or more input streams.";
 
     RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksTag),
                  cc->Outputs().NumEntries(kLandmarksTag))
         << "Same number of input and output landmarks is required.";
+    RET_CHECK_EQ(cc->Inputs().NumEntries(kLandmarksSoaTag),
+                 cc->Outputs().NumEntries(kLandmarksSoaTag))
+        << "Same number of input and output landmarks is required.";
 
     for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksTag);
          id != cc->Inputs().EndId(kLandmarksTag); ++id) {
       cc->Inputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Inputs().BeginId(kLandmarksSoaTag);
+         id != cc->Inputs().EndId(kLandmarksSoaTag); ++id) {
+      cc->Inputs().Get(id).Set<NormalizedLandmarkSoa>();
+    }
     cc->Inputs().Tag(kRectTag).Set<NormalizedRect>();
 
     for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksTag);
          id != cc->Outputs().EndId(kLandmarksTag); ++id) {
       cc->Outputs().Get(id).Set<NormalizedLandmarkList>();
     }
+    for (CollectionItemId id = cc->Outputs().BeginId(kLandmarksSoaTag);
+         id != cc->Outputs().EndId(kLandmarksSoaTag); ++id) {
+      cc->Outputs().Get(id).Set<NormalizedLandmarkSoa>();
+    }
 
     return absl::OkStatus();
   }
@@ -136,6 +179,23 @@ class LandmarkProjectionCalculator : public CalculatorBase {
           MakePacket<NormalizedLandmarkList>(output_landmarks)
               .At(cc->InputTimestamp()));
     }
+
+    const float angle = options.ignore_rotation() ? 0 : input_rect.rotation();
+    input_id = cc->Inputs().BeginId(kLandmarksSoaTag);
+    output_id = cc->Outputs().BeginId(kLandmarksSoaTag);
+    for (; input_id != cc->Inputs().EndId(kLandmarksSoaTag);
+         ++input_id, ++output_id) {
+      const auto& input_packet = cc->Inputs().Get(input_id);
+      if (input_packet.IsEmpty()) {
+        continue;
+      }
+
+      auto output_landmarks = absl::make_unique<NormalizedLandmarkSoa>(
+          input_packet.Get<NormalizedLandmarkSoa>());
+      ProjectLandmarks(input_rect, angle, output_landmarks.get());
+      cc->Outputs().Get(output_id).Add(output_landmarks.release(),
+                                       cc->InputTimestamp());
+    }
     return absl::OkStatus();
   }
 };
@@ -0,0 +1,151 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <cmath>
+#include <string>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
+#include "mediapipe/framework/formats/rect.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::FloatNear;
+
+// The output landmarks of both representations of one calculator run.
+struct ProjectedLandmarks {
+  NormalizedLandmarkList proto;
+  NormalizedLandmarkSoa soa;
+};
+
+// Projects `landmarks` into `rect`, through both the NORM_LANDMARKS and the
+// NORM_LANDMARKS_SOA streams of one calculator.
+ProjectedLandmarks Project(const NormalizedLandmarkList& landmarks,
+                           const NormalizedRect& rect, bool ignore_rotation) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+                         calculator: "LandmarkProjectionCalculator"
+                         input_stream: "NORM_LANDMARKS:landmarks"
+                         input_stream: "NORM_LANDMARKS_SOA:landmarks_soa"
+                         input_stream: "NORM_RECT:rect"
+                         output_stream: "NORM_LANDMARKS:projected"
+                         output_stream: "NORM_LANDMARKS_SOA:projected_soa"
+                         options {
+                           [mediapipe.LandmarkProjectionCalculatorOptions.ext] {
+                             ignore_rotation: $0
+                           }
+                         }
+                       )pb",
+                       ignore_rotation ? "true" : "false")));
+  runner.MutableInputs()->Tag("NORM_LANDMARKS").packets.push_back(
+      MakePacket<NormalizedLandmarkList>(landmarks).At(Timestamp(0)));
+  runner.MutableInputs()->Tag("NORM_LANDMARKS_SOA").packets.push_back(
+      MakePacket<NormalizedLandmarkSoa>(
+          NormalizedLandmarkSoa::FromProto(landmarks))
+          .At(Timestamp(0)));
+  runner.MutableInputs()->Tag("NORM_RECT").packets.push_back(
+      MakePacket<NormalizedRect>(rect).At(Timestamp(0)));
+  MP_EXPECT_OK(runner.Run());
+
+  ProjectedLandmarks projected;
+  const auto& output = runner.Outputs().Tag("NORM_LANDMARKS").packets;
+  const auto& output_soa = runner.Outputs().Tag("NORM_LANDMARKS_SOA").packets;
+  EXPECT_EQ(output.size(), 1);
+  EXPECT_EQ(output_soa.size(), 1);
+  if (output.size() == 1 && output_soa.size() == 1) {
+    projected.proto = output[0].Get<NormalizedLandmarkList>();
+    projected.soa = output_soa[0].Get<NormalizedLandmarkSoa>();
+  }
+  return projected;
+}
+
+// Expects the SoA landmarks to match the proto landmarks, including which of
+// them have visibility and presence set.
+void ExpectSoaMatchesProto(const ProjectedLandmarks& projected) {
+  ASSERT_EQ(projected.soa.size(), projected.proto.landmark_size());
+  for (int i = 0; i < projected.soa.size(); ++i) {
+    const NormalizedLandmark& expected = projected.proto.landmark(i);
+    const auto actual = projected.soa.landmark(i);
+    EXPECT_THAT(actual.x(), FloatNear(expected.x(), 1e-6)) << i;
+    EXPECT_THAT(actual.y(), FloatNear(expected.y(), 1e-6)) << i;
+    EXPECT_THAT(actual.z(), FloatNear(expected.z(), 1e-6)) << i;
+    EXPECT_EQ(actual.has_visibility(), expected.has_visibility()) << i;
+    EXPECT_EQ(actual.visibility(), expected.visibility()) << i;
+    EXPECT_EQ(actual.has_presence(), expected.has_presence()) << i;
+    EXPECT_EQ(actual.presence(), expected.presence()) << i;
+  }
+}
+
+NormalizedLandmarkList TestLandmarks() {
+  NormalizedLandmarkList landmarks;
+  for (int i = 0; i < 21; ++i) {
+    NormalizedLandmark* landmark = landmarks.add_landmark();
+    landmark->set_x(0.05f * i);
+    landmark->set_y(1.0f - 0.04f * i);
+    landmark->set_z(0.01f * i - 0.1f);
+    if (i % 2 == 0) landmark->set_visibility(0.5f);
+    if (i % 3 == 0) landmark->set_presence(0.25f);
+  }
+  return landmarks;
+}
+
+NormalizedRect TestRect() {
+  return ParseTextProtoOrDie<NormalizedRect>(R"pb(
+    x_center: 0.4 y_center: 0.6 width: 0.5 height: 0.3 rotation: 0.7
+  )pb");
+}
+
+TEST(LandmarkProjectionCalculatorTest, SoaMatchesProtoWithRotation) {
+  ExpectSoaMatchesProto(Project(TestLandmarks(), TestRect(),
+                                /*ignore_rotation=*/false));
+}
+
+TEST(LandmarkProjectionCalculatorTest, SoaMatchesProtoIgnoringRotation) {
+  ExpectSoaMatchesProto(Project(TestLandmarks(), TestRect(),
+                                /*ignore_rotation=*/true));
+}
+
+TEST(LandmarkProjectionCalculatorTest, RotatesAboutRectCenter) {
+  const auto landmarks = ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+    landmark { x: 1.0 y: 0.5 z: 0.2 }
+  )pb");
+  NormalizedRect rect = ParseTextProtoOrDie<NormalizedRect>(R"pb(
+    x_center: 0.5 y_center: 0.5 width: 1.0 height: 1.0
+  )pb");
+  rect.set_rotation(M_PI / 2);
+
+  ProjectedLandmarks rotated = Project(landmarks, rect, false);
+  ExpectSoaMatchesProto(rotated);
+  ASSERT_EQ(rotated.soa.size(), 1);
+  EXPECT_THAT(rotated.soa.x()[0], FloatNear(0.5f, 1e-6));
+  EXPECT_THAT(rotated.soa.y()[0], FloatNear(1.0f, 1e-6));
+  EXPECT_THAT(rotated.soa.z()[0], FloatNear(0.2f, 1e-6));
+
+  ProjectedLandmarks unrotated = Project(landmarks, rect, true);
+  ExpectSoaMatchesProto(unrotated);
+  ASSERT_EQ(unrotated.soa.size(), 1);
+  EXPECT_THAT(unrotated.soa.x()[0], FloatNear(1.0f, 1e-6));
+  EXPECT_THAT(unrotated.soa.y()[0], FloatNear(0.5f, 1e-6));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -12,16 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <memory>
 
 #include "absl/algorithm/container.h"
+#include "absl/types/span.h"
 #include "mediapipe/calculators/util/landmarks_smoothing_calculator.pb.h"
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/framework/timestamp.h"
-#include "mediapipe/util/filtering/one_euro_filter.h"
-#include "mediapipe/util/filtering/relative_velocity_filter.h"
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
 
 namespace mediapipe {
 
@@ -32,41 +35,56 @@ constexpr char kLandmarksTag[] = "LANDMARKS";
 constexpr char kImageSizeTag[] = "IMAGE_SIZE";
 constexpr char kNormalizedFilteredLandmarksTag[] = "NORM_FILTERED_LANDMARKS";
 constexpr char kFilteredLandmarksTag[] = "FILTERED_LANDMARKS";
+constexpr char kNormalizedLandmarksSoaTag[] = "NORM_LANDMARKS_SOA";
+constexpr char kLandmarksSoaTag[] = "LANDMARKS_SOA";
+constexpr char kNormalizedFilteredLandmarksSoaTag[] =
+    "NORM_FILTERED_LANDMARKS_SOA";
+constexpr char kFilteredLandmarksSoaTag[] = "FILTERED_LANDMARKS_SOA";
 
-using mediapipe::OneEuroFilter;
-using mediapipe::RelativeVelocityFilter;
+using mediapipe::OneEuroFilterBank;
+using mediapipe::RelativeVelocityFilterBank;
 
 void NormalizedLandmarksToLandmarks(
-    const NormalizedLandmarkList& norm_landmarks, const int image_width,
-    const int image_height, LandmarkList* landmarks) {
-  for (int i = 0; i < norm_landmarks.landmark_size(); ++i) {
-    const auto& norm_landmark = norm_landmarks.landmark(i);
-
-    auto* landmark = landmarks->add_landmark();
-    landmark->set_x(norm_landmark.x() * image_width);
-    landmark->set_y(norm_landmark.y() * image_height);
+    const NormalizedLandmarkSoa& norm_landmarks, const int image_width,
+    const int image_height, LandmarkSoa* landmarks) {
+  const int n = norm_landmarks.size();
+  landmarks->Resize(n);
+  const float* norm_x = norm_landmarks.x().data();
+  const float* norm_y = norm_landmarks.y().data();
+  const float* norm_z = norm_landmarks.z().data();
+  float* x = landmarks->x().data();
+  float* y = landmarks->y().data();
+  float* z = landmarks->z().data();
+  for (int i = 0; i < n; ++i) {
+    x[i] = norm_x[i] * image_width;
+    y[i] = norm_y[i] * image_height;
     // Scale Z the same way as X (using image width).
-    landmark->set_z(norm_landmark.z() * image_width);
-    landmark->set_visibility(norm_landmark.visibility());
-    landmark->set_presence(norm_landmark.presence());
+    z[i] = norm_z[i] * image_width;
   }
+  absl::c_copy(norm_landmarks.visibility(), landmarks->visibility().begin());
+  absl::c_copy(norm_landmarks.presence(), landmarks->presence().begin());
 }
 
-void LandmarksToNormalizedLandmarks(const LandmarkList& landmarks,
+void LandmarksToNormalizedLandmarks(const LandmarkSoa& landmarks,
                                     const int image_width,
                                     const int image_height,
-                                    NormalizedLandmarkList* norm_landmarks) {
-  for (int i = 0; i < landmarks.landmark_size(); ++i) {
-    const auto& landmark = landmarks.landmark(i);
-
-    auto* norm_landmark = norm_landmarks->add_landmark();
-    norm_landmark->set_x(landmark.x() / image_width);
-    norm_landmark->set_y(landmark.y() / image_height);
+                                    NormalizedLandmarkSoa* norm_landmarks) {
+  const int n = landmarks.size();
+  norm_landmarks->Resize(n);
+  const float* x = landmarks.x().data();
+  const float* y = landmarks.y().data();
+  const float* z = landmarks.z().data();
+  float* norm_x = norm_landmarks->x().data();
+  float* norm_y = norm_landmarks->y().data();
+  float* norm_z = norm_landmarks->z().data();
+  for (int i = 0; i < n; ++i) {
+    norm_x[i] = x[i] / image_width;
+    norm_y[i] = y[i] / image_height;
     // Scale Z the same way as X (using image width).
-    norm_landmark->set_z(landmark.z() / image_width);
-    norm_landmark->set_visibility(landmark.visibility());
-    norm_landmark->set_presence(landmark.presence());
+    norm_z[i] = z[i] / image_width;
   }
+  absl::c_copy(landmarks.visibility(), norm_landmarks->visibility().begin());
+  absl::c_copy(landmarks.presence(), norm_landmarks->presence().begin());
 }
 
 // Estimate object scale to use its inverse value as velocity scale for
@@ -75,18 +93,22 @@ void LandmarksToNormalizedLandmarks(const LandmarkList& landmarks,
 // landmarks will be returned as is.
 // Object scale is calculated as average between bounding box width and height
 // with sides parallel to axis.
-float GetObjectScale(const LandmarkList& landmarks) {
-  const auto& lm_minmax_x = absl::c_minmax_element(
-      landmarks.landmark(),
-      [](const auto& a, const auto& b) { return a.x() < b.x(); });
-  const float x_min = lm_minmax_x.first->x();
-  const float x_max = lm_minmax_x.second->x();
-
-  const auto& lm_minmax_y = absl::c_minmax_element(
-      landmarks.landmark(),
-      [](const auto& a, const auto& b) { return a.y() < b.y(); });
-  const float y_min = lm_minmax_y.first->y();
-  const float y_max = lm_minmax_y.second->y();
+float GetObjectScale(const LandmarkSoa& landmarks) {
+  if (landmarks.empty()) {
+    return 0.0f;
+  }
+  const absl::Span<const float> x = landmarks.x();
+  const absl::Span<const float> y = landmarks.y();
+  float x_min = x[0];
+  float x_max = x[0];
+  float y_min = y[0];
+  float y_max = y[0];
+  for (int i = 1; i < landmarks.size(); ++i) {
+    x_min = std::min(x_min, x[i]);
+    x_max = std::max(x_max, x[i]);
+    y_min = std::min(y_min, y[i]);
+    y_max = std::max(y_max, y[i]);
+  }
 
   const float object_width = x_max - x_min;
   const float object_height = y_max - y_min;
@@ -101,17 +123,17 @@ class LandmarksFilter {
 
   virtual absl::Status Reset() { return absl::OkStatus(); }
 
-  virtual absl::Status Apply(const LandmarkList& in_landmarks,
+  virtual absl::Status Apply(const LandmarkSoa& in_landmarks,
                              const absl::Duration& timestamp,
-                             LandmarkList* out_landmarks) = 0;
+                             LandmarkSoa* out_landmarks) = 0;
 };
 
 // Returns landmarks as is without smoothing.
 class NoFilter : public LandmarksFilter {
  public:
-  absl::Status Apply(const LandmarkList& in_landmarks,
+  absl::Status Apply(const LandmarkSoa& in_landmarks,
                      const absl::Duration& timestamp,
-                     LandmarkList* out_landmarks) override {
+                     LandmarkSoa* out_landmarks) override {
     *out_landmarks = in_landmarks;
     return absl::OkStatus();
   }
@@ -128,15 +150,15 @@ class VelocityFilter : public LandmarksFilter {
         disable_value_scaling_(disable_value_scaling) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    x_filters_.reset();
+    y_filters_.reset();
+    z_filters_.reset();
     return absl::OkStatus();
   }
 
-  absl::Status Apply(const LandmarkList& in_landmarks,
+  absl::Status Apply(const LandmarkSoa& in_landmarks,
                      const absl::Duration& timestamp,
-                     LandmarkList* out_landmarks) override {
+                     LandmarkSoa* out_landmarks) override {
     // Get value scale as inverse value of the object scale.
     // If value is too small smoothing will be disabled and landmarks will be
     // returned as is.
@@ -151,21 +173,14 @@ class VelocityFilter : public LandmarksFilter {
     }
 
     // Initialize filters once.
-    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
-
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
-
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(
-          x_filters_[i].Apply(timestamp, value_scale, in_landmark.x()));
-      out_landmark->set_y(
-          y_filters_[i].Apply(timestamp, value_scale, in_landmark.y()));
-      out_landmark->set_z(
-          z_filters_[i].Apply(timestamp, value_scale, in_landmark.z()));
-    }
+    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.size()));
+
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // one axis of all landmarks at a time.
+    *out_landmarks = in_landmarks;
+    x_filters_->Apply(timestamp, value_scale, out_landmarks->x());
+    y_filters_->Apply(timestamp, value_scale, out_landmarks->y());
+    z_filters_->Apply(timestamp, value_scale, out_landmarks->z());
 
     return absl::OkStatus();
   }
@@ -174,19 +189,19 @@ class VelocityFilter : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (x_filters_) {
+      RET_CHECK_EQ(x_filters_->num_values(), n_landmarks);
+      RET_CHECK_EQ(y_filters_->num_values(), n_landmarks);
+      RET_CHECK_EQ(z_filters_->num_values(), n_landmarks);
       return absl::OkStatus();
     }
 
-    x_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    y_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
-    z_filters_.resize(n_landmarks,
-                      RelativeVelocityFilter(window_size_, velocity_scale_));
+    x_filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        n_landmarks, window_size_, velocity_scale_);
+    y_filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        n_landmarks, window_size_, velocity_scale_);
+    z_filters_ = absl::make_unique<RelativeVelocityFilterBank>(
+        n_landmarks, window_size_, velocity_scale_);
 
     return absl::OkStatus();
   }
@@ -196,9 +211,9 @@ class VelocityFilter : public LandmarksFilter {
   float min_allowed_object_scale_;
   bool disable_value_scaling_;
 
-  std::vector<RelativeVelocityFilter> x_filters_;
-  std::vector<RelativeVelocityFilter> y_filters_;
-  std::vector<RelativeVelocityFilter> z_filters_;
+  std::unique_ptr<RelativeVelocityFilterBank> x_filters_;
+  std::unique_ptr<RelativeVelocityFilterBank> y_filters_;
+  std::unique_ptr<RelativeVelocityFilterBank> z_filters_;
 };
 
 // Please check OneEuroFilter documentation for details.
@@ -212,28 +227,24 @@ class OneEuroFilterImpl : public LandmarksFilter {
         derivate_cutoff_(derivate_cutoff) {}
 
   absl::Status Reset() override {
-    x_filters_.clear();
-    y_filters_.clear();
-    z_filters_.clear();
+    x_filters_.reset();
+    y_filters_.reset();
+    z_filters_.reset();
     return absl::OkStatus();
   }
 
-  absl::Status Apply(const LandmarkList& in_landmarks,
+  absl::Status Apply(const LandmarkSoa& in_landmarks,
                      const absl::Duration& timestamp,
-                     LandmarkList* out_landmarks) override {
+                     LandmarkSoa* out_landmarks) override {
     // Initialize filters once.
-    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.landmark_size()));
-
-    // Filter landmarks. Every axis of every landmark is filtered separately.
-    for (int i = 0; i < in_landmarks.landmark_size(); ++i) {
-      const auto& in_landmark = in_landmarks.landmark(i);
+    MP_RETURN_IF_ERROR(InitializeFiltersIfEmpty(in_landmarks.size()));
 
-      auto* out_landmark = out_landmarks->add_landmark();
-      *out_landmark = in_landmark;
-      out_landmark->set_x(x_filters_[i].Apply(timestamp, in_landmark.x()));
-      out_landmark->set_y(y_filters_[i].Apply(timestamp, in_landmark.y()));
-      out_landmark->set_z(z_filters_[i].Apply(timestamp, in_landmark.z()));
-    }
+    // Filter landmarks. Every axis of every landmark is filtered separately,
+    // one axis of all landmarks at a time.
+    *out_landmarks = in_landmarks;
+    x_filters_->Apply(timestamp, out_landmarks->x());
+    y_filters_->Apply(timestamp, out_landmarks->y());
+    z_filters_->Apply(timestamp, out_landmarks->z());
 
     return absl::OkStatus();
   }
@@ -242,21 +253,19 @@ class OneEuroFilterImpl : public LandmarksFilter {
   // Initializes filters for the first time or after Reset. If initialized then
   // check the size.
   absl::Status InitializeFiltersIfEmpty(const int n_landmarks) {
-    if (!x_filters_.empty()) {
-      RET_CHECK_EQ(x_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(y_filters_.size(), n_landmarks);
-      RET_CHECK_EQ(z_filters_.size(), n_landmarks);
+    if (x_filters_) {
+      RET_CHECK_EQ(x_filters_->num_values(), n_landmarks);
+      RET_CHECK_EQ(y_filters_->num_values(), n_landmarks);
+      RET_CHECK_EQ(z_filters_->num_values(), n_landmarks);
       return absl::OkStatus();
     }
 
-    for (int i = 0; i < n_landmarks; ++i) {
-      x_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      y_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-      z_filters_.push_back(
-          OneEuroFilter(frequency_, min_cutoff_, beta_, derivate_cutoff_));
-    }
+    x_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
+    y_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
+    z_filters_ = absl::make_unique<OneEuroFilterBank>(
+        n_landmarks, frequency_, min_cutoff_, beta_, derivate_cutoff_);
 
     return absl::OkStatus();
   }
@@ -266,9 +275,9 @@ class OneEuroFilterImpl : public LandmarksFilter {
   double beta_;
   double derivate_cutoff_;
 
-  std::vector<OneEuroFilter> x_filters_;
-  std::vector<OneEuroFilter> y_filters_;
-  std::vector<OneEuroFilter> z_filters_;
+  std::unique_ptr<OneEuroFilterBank> x_filters_;
+  std::unique_ptr<OneEuroFilterBank> y_filters_;
+  std::unique_ptr<OneEuroFilterBank> z_filters_;
 };
 
 }  // namespace
@@ -281,8 +290,17 @@ class OneEuroFilterImpl : public LandmarksFilter {
 //     Required to perform all computations in absolute coordinates to avoid any
 //     influence of normalized values.
 //
+//   LANDMARKS: A LandmarkList of landmarks you want to smooth, instead of
+//     NORM_LANDMARKS and IMAGE_SIZE.
+//   NORM_LANDMARKS_SOA, LANDMARKS_SOA: The same as NORM_LANDMARKS and LANDMARKS
+//     with NormalizedLandmarkSoa and LandmarkSoa landmarks, which are filtered
+//     without conversion to and from protos.
+//
 // Outputs:
 //   NORM_FILTERED_LANDMARKS: A NormalizedLandmarkList of smoothed landmarks.
+//   FILTERED_LANDMARKS: A LandmarkList of smoothed landmarks.
+//   NORM_FILTERED_LANDMARKS_SOA, FILTERED_LANDMARKS_SOA: The smoothed
+//     NormalizedLandmarkSoa and LandmarkSoa landmarks.
 //
 // Example config:
 //   node {
@@ -307,6 +325,12 @@ class LandmarksSmoothingCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  private:
+  // Filters normalized landmarks in absolute coordinates, using IMAGE_SIZE.
+  absl::Status FilterNormalizedLandmarks(
+      CalculatorContext* cc, const NormalizedLandmarkSoa& in_norm_landmarks,
+      const absl::Duration& timestamp,
+      NormalizedLandmarkSoa* out_norm_landmarks);
+
   std::unique_ptr<LandmarksFilter> landmarks_filter_;
 };
 REGISTER_CALCULATOR(LandmarksSmoothingCalculator);
@@ -318,6 +342,15 @@ absl::Status LandmarksSmoothingCalculator::GetContract(CalculatorContract* cc) {
     cc->Outputs()
         .Tag(kNormalizedFilteredLandmarksTag)
         .Set<NormalizedLandmarkList>();
+  } else if (cc->Inputs().HasTag(kNormalizedLandmarksSoaTag)) {
+    cc->Inputs().Tag(kNormalizedLandmarksSoaTag).Set<NormalizedLandmarkSoa>();
+    cc->Inputs().Tag(kImageSizeTag).Set<std::pair<int, int>>();
+    cc->Outputs()
+        .Tag(kNormalizedFilteredLandmarksSoaTag)
+        .Set<NormalizedLandmarkSoa>();
+  } else if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    cc->Inputs().Tag(kLandmarksSoaTag).Set<LandmarkSoa>();
+    cc->Outputs().Tag(kFilteredLandmarksSoaTag).Set<LandmarkSoa>();
   } else {
     cc->Inputs().Tag(kLandmarksTag).Set<LandmarkList>();
     cc->Outputs().Tag(kFilteredLandmarksTag).Set<LandmarkList>();
@@ -356,48 +389,74 @@ absl::Status LandmarksSmoothingCalculator::Open(CalculatorContext* cc) {
 absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
   // Check that landmarks are not empty and reset the filter if so.
   // Don't emit an empty packet for this timestamp.
-  if ((cc->Inputs().HasTag(kNormalizedLandmarksTag) &&
-       cc->Inputs().Tag(kNormalizedLandmarksTag).IsEmpty()) ||
-      (cc->Inputs().HasTag(kLandmarksTag) &&
-       cc->Inputs().Tag(kLandmarksTag).IsEmpty())) {
-    MP_RETURN_IF_ERROR(landmarks_filter_->Reset());
-    return absl::OkStatus();
+  for (const char* tag : {kNormalizedLandmarksTag, kLandmarksTag,
+                          kNormalizedLandmarksSoaTag, kLandmarksSoaTag}) {
+    if (cc->Inputs().HasTag(tag) && cc->Inputs().Tag(tag).IsEmpty()) {
+      MP_RETURN_IF_ERROR(landmarks_filter_->Reset());
+      return absl::OkStatus();
+    }
   }
 
   const auto& timestamp =
       absl::Microseconds(cc->InputTimestamp().Microseconds());
 
   if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
-    const auto& in_norm_landmarks =
+    const auto& in_norm_landmarks_proto =
         cc->Inputs().Tag(kNormalizedLandmarksTag).Get<NormalizedLandmarkList>();
+    auto in_norm_landmarks =
+        NormalizedLandmarkSoa::FromProto(in_norm_landmarks_proto);
+    // Filtered normalized landmarks always have visibility and presence.
+    in_norm_landmarks.set_has_visibility(true);
+    in_norm_landmarks.set_has_presence(true);
+
+    NormalizedLandmarkSoa out_norm_landmarks;
+    MP_RETURN_IF_ERROR(FilterNormalizedLandmarks(
+        cc, in_norm_landmarks, timestamp, &out_norm_landmarks));
+
+    auto out_norm_landmarks_proto = absl::make_unique<NormalizedLandmarkList>();
+    out_norm_landmarks.ToProto(out_norm_landmarks_proto.get());
+    cc->Outputs()
+        .Tag(kNormalizedFilteredLandmarksTag)
+        .Add(out_norm_landmarks_proto.release(), cc->InputTimestamp());
+  } else if (cc->Inputs().HasTag(kNormalizedLandmarksSoaTag)) {
+    const auto& in_norm_landmarks = cc->Inputs()
+                                        .Tag(kNormalizedLandmarksSoaTag)
+                                        .Get<NormalizedLandmarkSoa>();
 
-    int image_width;
-    int image_height;
-    std::tie(image_width, image_height) =
-        cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
-
-    auto in_landmarks = absl::make_unique<LandmarkList>();
-    NormalizedLandmarksToLandmarks(in_norm_landmarks, image_width, image_height,
-                                   in_landmarks.get());
+    auto out_norm_landmarks = absl::make_unique<NormalizedLandmarkSoa>();
+    MP_RETURN_IF_ERROR(FilterNormalizedLandmarks(
+        cc, in_norm_landmarks, timestamp, out_norm_landmarks.get()));
 
-    auto out_landmarks = absl::make_unique<LandmarkList>();
-    MP_RETURN_IF_ERROR(landmarks_filter_->Apply(*in_landmarks, timestamp,
-                                                out_landmarks.get()));
+    cc->Outputs()
+        .Tag(kNormalizedFilteredLandmarksSoaTag)
+        .Add(out_norm_landmarks.release(), cc->InputTimestamp());
+  } else if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    const auto& in_landmarks =
+        cc->Inputs().Tag(kLandmarksSoaTag).Get<LandmarkSoa>();
 
-    auto out_norm_landmarks = absl::make_unique<NormalizedLandmarkList>();
-    LandmarksToNormalizedLandmarks(*out_landmarks, image_width, image_height,
-                                   out_norm_landmarks.get());
+    auto out_landmarks = absl::make_unique<LandmarkSoa>();
+    MP_RETURN_IF_ERROR(
+        landmarks_filter_->Apply(in_landmarks, timestamp, out_landmarks.get()));
 
     cc->Outputs()
-        .Tag(kNormalizedFilteredLandmarksTag)
-        .Add(out_norm_landmarks.release(), cc->InputTimestamp());
+        .Tag(kFilteredLandmarksSoaTag)
+        .Add(out_landmarks.release(), cc->InputTimestamp());
   } else {
     const auto& in_landmarks =
         cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>();
 
-    auto out_landmarks = absl::make_unique<LandmarkList>();
-    MP_RETURN_IF_ERROR(
-        landmarks_filter_->Apply(in_landmarks, timestamp, out_landmarks.get()));
+    LandmarkSoa out_landmarks_soa;
+    MP_RETURN_IF_ERROR(landmarks_filter_->Apply(
+        LandmarkSoa::FromProto(in_landmarks), timestamp, &out_landmarks_soa));
+
+    // Only the coordinates are filtered, other fields are kept as they are.
+    auto out_landmarks = absl::make_unique<LandmarkList>(in_landmarks);
+    for (int i = 0; i < out_landmarks->landmark_size(); ++i) {
+      auto* out_landmark = out_landmarks->mutable_landmark(i);
+      out_landmark->set_x(out_landmarks_soa.x()[i]);
+      out_landmark->set_y(out_landmarks_soa.y()[i]);
+      out_landmark->set_z(out_landmarks_soa.z()[i]);
+    }
 
     cc->Outputs()
         .Tag(kFilteredLandmarksTag)
@@ -407,4 +466,26 @@ absl::Status LandmarksSmoothingCalculator::Process(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+absl::Status LandmarksSmoothingCalculator::FilterNormalizedLandmarks(
+    CalculatorContext* cc, const NormalizedLandmarkSoa& in_norm_landmarks,
+    const absl::Duration& timestamp,
+    NormalizedLandmarkSoa* out_norm_landmarks) {
+  int image_width;
+  int image_height;
+  std::tie(image_width, image_height) =
+      cc->Inputs().Tag(kImageSizeTag).Get<std::pair<int, int>>();
+
+  LandmarkSoa in_landmarks;
+  NormalizedLandmarksToLandmarks(in_norm_landmarks, image_width, image_height,
+                                 &in_landmarks);
+
+  LandmarkSoa out_landmarks;
+  MP_RETURN_IF_ERROR(
+      landmarks_filter_->Apply(in_landmarks, timestamp, &out_landmarks));
+
+  LandmarksToNormalizedLandmarks(out_landmarks, image_width, image_height,
+                                 out_norm_landmarks);
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
@@ -0,0 +1,213 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kNumFrames = 12;
+// No landmarks arrive for this frame, which resets the filter.
+constexpr int kEmptyFrame = 6;
+constexpr int kImageWidth = 640;
+constexpr int kImageHeight = 480;
+
+constexpr char kVelocityFilter[] = R"pb(
+  velocity_filter { window_size: 5 velocity_scale: 10 }
+)pb";
+constexpr char kOneEuroFilter[] = R"pb(
+  one_euro_filter { min_cutoff: 1 beta: 0.001 }
+)pb";
+
+// The one-euro filter ignores landmarks at time zero, so the frames start
+// one frame period later.
+Timestamp FrameTimestamp(int frame) { return Timestamp((frame + 1) * 33333); }
+
+// Returns jittering landmarks that move to the right over the frames. Only
+// some of them have visibility and presence set.
+NormalizedLandmarkList FrameLandmarks(int frame) {
+  NormalizedLandmarkList landmarks;
+  for (int i = 0; i < 21; ++i) {
+    NormalizedLandmark* landmark = landmarks.add_landmark();
+    const float jitter = 0.01f * std::sin(3.0f * frame + i);
+    landmark->set_x(0.2f + 0.02f * frame + 0.03f * i + jitter);
+    landmark->set_y(0.8f - 0.025f * i - jitter);
+    landmark->set_z(0.01f * i + jitter);
+    if (i % 2 == 0) landmark->set_visibility(0.1f * (i % 10));
+    if (i % 3 == 0) landmark->set_presence(0.9f);
+  }
+  return landmarks;
+}
+
+// Runs a LandmarksSmoothingCalculator with the given filter options on
+// normalized landmarks through the `input_tag` and `output_tag` streams.
+std::vector<Packet> RunSmoothing(const std::string& filter,
+                                 const std::string& input_tag,
+                                 const std::string& output_tag, bool soa) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+                         calculator: "LandmarksSmoothingCalculator"
+                         input_stream: "$0:landmarks"
+                         input_stream: "IMAGE_SIZE:image_size"
+                         output_stream: "$1:filtered_landmarks"
+                         options {
+                           [mediapipe.LandmarksSmoothingCalculatorOptions.ext] {
+                             $2
+                           }
+                         }
+                       )pb",
+                       input_tag, output_tag, filter)));
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    runner.MutableInputs()->Tag("IMAGE_SIZE").packets.push_back(
+        MakePacket<std::pair<int, int>>(kImageWidth, kImageHeight)
+            .At(FrameTimestamp(frame)));
+    if (frame == kEmptyFrame) continue;
+    const NormalizedLandmarkList landmarks = FrameLandmarks(frame);
+    runner.MutableInputs()->Tag(input_tag).packets.push_back(
+        (soa ? MakePacket<NormalizedLandmarkSoa>(
+                   NormalizedLandmarkSoa::FromProto(landmarks))
+             : MakePacket<NormalizedLandmarkList>(landmarks))
+            .At(FrameTimestamp(frame)));
+  }
+  MP_EXPECT_OK(runner.Run());
+  return runner.Outputs().Tag(output_tag).packets;
+}
+
+// Expects the SoA path to filter the coordinates exactly as the proto path,
+// and the filter to restart from the input after the empty frame.
+void ExpectSoaMatchesProto(const std::string& filter) {
+  const std::vector<Packet> expected = RunSmoothing(
+      filter, "NORM_LANDMARKS", "NORM_FILTERED_LANDMARKS", /*soa=*/false);
+  const std::vector<Packet> actual =
+      RunSmoothing(filter, "NORM_LANDMARKS_SOA", "NORM_FILTERED_LANDMARKS_SOA",
+                   /*soa=*/true);
+  // There is no output for the empty frame.
+  ASSERT_EQ(expected.size(), kNumFrames - 1);
+  ASSERT_EQ(actual.size(), kNumFrames - 1);
+  for (int i = 0; i < actual.size(); ++i) {
+    const int frame = i < kEmptyFrame ? i : i + 1;
+    ASSERT_EQ(actual[i].Timestamp(), FrameTimestamp(frame));
+    ASSERT_EQ(expected[i].Timestamp(), FrameTimestamp(frame));
+    const auto& expected_landmarks =
+        expected[i].Get<NormalizedLandmarkList>();
+    const auto& actual_landmarks = actual[i].Get<NormalizedLandmarkSoa>();
+    const NormalizedLandmarkList input = FrameLandmarks(frame);
+    ASSERT_EQ(actual_landmarks.size(), expected_landmarks.landmark_size());
+    float max_change = 0.0f;
+    for (int j = 0; j < actual_landmarks.size(); ++j) {
+      const auto landmark = actual_landmarks.landmark(j);
+      EXPECT_EQ(landmark.x(), expected_landmarks.landmark(j).x());
+      EXPECT_EQ(landmark.y(), expected_landmarks.landmark(j).y());
+      EXPECT_EQ(landmark.z(), expected_landmarks.landmark(j).z());
+      // The SoA path keeps the visibility and presence of each landmark.
+      EXPECT_EQ(landmark.has_visibility(), input.landmark(j).has_visibility());
+      EXPECT_EQ(landmark.visibility(), input.landmark(j).visibility());
+      EXPECT_EQ(landmark.has_presence(), input.landmark(j).has_presence());
+      EXPECT_EQ(landmark.presence(), input.landmark(j).presence());
+      max_change =
+          std::max(max_change, std::abs(landmark.x() - input.landmark(j).x()));
+    }
+    // The first landmarks after a reset are passed through as they are, up
+    // to the rounding of their conversion to image coordinates and back.
+    if (frame == 0 || frame == kEmptyFrame + 1) {
+      EXPECT_LT(max_change, 1e-6) << "frame " << frame;
+    } else {
+      EXPECT_GT(max_change, 1e-4) << "frame " << frame;
+    }
+  }
+}
+
+TEST(LandmarksSmoothingCalculatorTest, SoaMatchesProtoWithVelocityFilter) {
+  ExpectSoaMatchesProto(kVelocityFilter);
+}
+
+TEST(LandmarksSmoothingCalculatorTest, SoaMatchesProtoWithOneEuroFilter) {
+  ExpectSoaMatchesProto(kOneEuroFilter);
+}
+
+// Runs a LandmarksSmoothingCalculator with the given filter options on the
+// landmarks in image coordinates, through the LANDMARKS or the LANDMARKS_SOA
+// stream.
+std::vector<Packet> RunLandmarksSmoothing(const std::string& filter,
+                                          bool soa) {
+  const std::string input_tag = soa ? "LANDMARKS_SOA" : "LANDMARKS";
+  const std::string output_tag =
+      soa ? "FILTERED_LANDMARKS_SOA" : "FILTERED_LANDMARKS";
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+                         calculator: "LandmarksSmoothingCalculator"
+                         input_stream: "$0:landmarks"
+                         output_stream: "$1:filtered_landmarks"
+                         options {
+                           [mediapipe.LandmarksSmoothingCalculatorOptions.ext] {
+                             $2
+                           }
+                         }
+                       )pb",
+                       input_tag, output_tag, filter)));
+  for (int frame = 0; frame < kNumFrames; ++frame) {
+    const NormalizedLandmarkList norm_landmarks = FrameLandmarks(frame);
+    LandmarkList landmarks;
+    for (const auto& norm_landmark : norm_landmarks.landmark()) {
+      Landmark* landmark = landmarks.add_landmark();
+      landmark->set_x(norm_landmark.x() * kImageWidth);
+      landmark->set_y(norm_landmark.y() * kImageHeight);
+      landmark->set_z(norm_landmark.z() * kImageWidth);
+    }
+    runner.MutableInputs()->Tag(input_tag).packets.push_back(
+        (soa ? MakePacket<LandmarkSoa>(LandmarkSoa::FromProto(landmarks))
+             : MakePacket<LandmarkList>(landmarks))
+            .At(FrameTimestamp(frame)));
+  }
+  MP_EXPECT_OK(runner.Run());
+  return runner.Outputs().Tag(output_tag).packets;
+}
+
+TEST(LandmarksSmoothingCalculatorTest, LandmarksSoaMatchesProto) {
+  for (const std::string filter : {kVelocityFilter, kOneEuroFilter}) {
+    const std::vector<Packet> expected =
+        RunLandmarksSmoothing(filter, /*soa=*/false);
+    const std::vector<Packet> actual =
+        RunLandmarksSmoothing(filter, /*soa=*/true);
+    ASSERT_EQ(expected.size(), kNumFrames);
+    ASSERT_EQ(actual.size(), kNumFrames);
+    for (int frame = 0; frame < kNumFrames; ++frame) {
+      const auto& expected_landmarks = expected[frame].Get<LandmarkList>();
+      const auto& actual_landmarks = actual[frame].Get<LandmarkSoa>();
+      ASSERT_EQ(actual_landmarks.size(), expected_landmarks.landmark_size());
+      for (int j = 0; j < actual_landmarks.size(); ++j) {
+        EXPECT_EQ(actual_landmarks.x()[j], expected_landmarks.landmark(j).x());
+        EXPECT_EQ(actual_landmarks.y()[j], expected_landmarks.landmark(j).y());
+        EXPECT_EQ(actual_landmarks.z()[j], expected_landmarks.landmark(j).z());
+      }
+    }
+  }
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,162 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <memory>
+#include <string>
+
+#include "absl/memory/memory.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
+#include "mediapipe/framework/port/ret_check.h"
+
+namespace mediapipe {
+
+namespace {
+
+constexpr char kLandmarksTag[] = "LANDMARKS";
+constexpr char kNormalizedLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kLandmarksSoaTag[] = "LANDMARKS_SOA";
+constexpr char kNormalizedLandmarksSoaTag[] = "NORM_LANDMARKS_SOA";
+
+}  // namespace
+
+// A calculator to convert landmark lists between their proto and structure of
+// arrays (LandmarkSoa, NormalizedLandmarkSoa) representations, at the
+// boundaries of a graph section whose calculators process SoA landmarks.
+//
+// Exactly one input stream should be provided, and the output stream of the
+// other representation of the same landmark type.
+//
+// Visibility and presence stay set or unset per landmark, so converting a list
+// to SoA and back gives the same protos.
+//
+// Inputs:
+//   LANDMARKS (optional): A LandmarkList to convert to LANDMARKS_SOA.
+//   NORM_LANDMARKS (optional): A NormalizedLandmarkList to convert to
+//     NORM_LANDMARKS_SOA.
+//   LANDMARKS_SOA (optional): A LandmarkSoa to convert to LANDMARKS.
+//   NORM_LANDMARKS_SOA (optional): A NormalizedLandmarkSoa to convert to
+//     NORM_LANDMARKS.
+//
+// Outputs:
+//   LANDMARKS, NORM_LANDMARKS, LANDMARKS_SOA, NORM_LANDMARKS_SOA (optional):
+//     The converted landmarks.
+//
+// Example config:
+//   node {
+//     calculator: "LandmarksSoaConverterCalculator"
+//     input_stream: "NORM_LANDMARKS:hand_landmarks"
+//     output_stream: "NORM_LANDMARKS_SOA:hand_landmarks_soa"
+//   }
+//
+class LandmarksSoaConverterCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Open(CalculatorContext* cc) override;
+  absl::Status Process(CalculatorContext* cc) override;
+
+ private:
+  template <class LandmarkListType>
+  static absl::Status ToSoa(CalculatorContext* cc, const std::string& in_tag,
+                            const std::string& out_tag);
+  template <class LandmarkListType>
+  static absl::Status FromSoa(CalculatorContext* cc, const std::string& in_tag,
+                              const std::string& out_tag);
+};
+REGISTER_CALCULATOR(LandmarksSoaConverterCalculator);
+
+absl::Status LandmarksSoaConverterCalculator::GetContract(
+    CalculatorContract* cc) {
+  RET_CHECK_EQ(cc->Inputs().NumEntries(), 1)
+      << "Exactly one landmarks stream to convert should be provided";
+  RET_CHECK_EQ(cc->Outputs().NumEntries(), 1)
+      << "Exactly one converted landmarks stream should be provided";
+
+  if (cc->Inputs().HasTag(kLandmarksTag)) {
+    RET_CHECK(cc->Outputs().HasTag(kLandmarksSoaTag))
+        << "LANDMARKS are converted to LANDMARKS_SOA";
+    cc->Inputs().Tag(kLandmarksTag).Set<LandmarkList>();
+    cc->Outputs().Tag(kLandmarksSoaTag).Set<LandmarkSoa>();
+  } else if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
+    RET_CHECK(cc->Outputs().HasTag(kNormalizedLandmarksSoaTag))
+        << "NORM_LANDMARKS are converted to NORM_LANDMARKS_SOA";
+    cc->Inputs().Tag(kNormalizedLandmarksTag).Set<NormalizedLandmarkList>();
+    cc->Outputs().Tag(kNormalizedLandmarksSoaTag).Set<NormalizedLandmarkSoa>();
+  } else if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    RET_CHECK(cc->Outputs().HasTag(kLandmarksTag))
+        << "LANDMARKS_SOA are converted to LANDMARKS";
+    cc->Inputs().Tag(kLandmarksSoaTag).Set<LandmarkSoa>();
+    cc->Outputs().Tag(kLandmarksTag).Set<LandmarkList>();
+  } else {
+    RET_CHECK(cc->Inputs().HasTag(kNormalizedLandmarksSoaTag) &&
+              cc->Outputs().HasTag(kNormalizedLandmarksTag))
+        << "NORM_LANDMARKS_SOA are converted to NORM_LANDMARKS";
+    cc->Inputs().Tag(kNormalizedLandmarksSoaTag).Set<NormalizedLandmarkSoa>();
+    cc->Outputs().Tag(kNormalizedLandmarksTag).Set<NormalizedLandmarkList>();
+  }
+
+  return absl::OkStatus();
+}
+
+absl::Status LandmarksSoaConverterCalculator::Open(CalculatorContext* cc) {
+  cc->SetOffset(TimestampDiff(0));
+  return absl::OkStatus();
+}
+
+absl::Status LandmarksSoaConverterCalculator::Process(CalculatorContext* cc) {
+  if (cc->Inputs().HasTag(kLandmarksTag)) {
+    return ToSoa<LandmarkList>(cc, kLandmarksTag, kLandmarksSoaTag);
+  } else if (cc->Inputs().HasTag(kNormalizedLandmarksTag)) {
+    return ToSoa<NormalizedLandmarkList>(cc, kNormalizedLandmarksTag,
+                                         kNormalizedLandmarksSoaTag);
+  } else if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    return FromSoa<LandmarkList>(cc, kLandmarksSoaTag, kLandmarksTag);
+  } else {
+    return FromSoa<NormalizedLandmarkList>(cc, kNormalizedLandmarksSoaTag,
+                                           kNormalizedLandmarksTag);
+  }
+}
+
+template <class LandmarkListType>
+absl::Status LandmarksSoaConverterCalculator::ToSoa(
+    CalculatorContext* cc, const std::string& in_tag,
+    const std::string& out_tag) {
+  if (cc->Inputs().Tag(in_tag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  using SoaType = BasicLandmarkSoa<LandmarkListType>;
+  auto landmarks = absl::make_unique<SoaType>(
+      SoaType::FromProto(cc->Inputs().Tag(in_tag).Get<LandmarkListType>()));
+  cc->Outputs().Tag(out_tag).Add(landmarks.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+template <class LandmarkListType>
+absl::Status LandmarksSoaConverterCalculator::FromSoa(
+    CalculatorContext* cc, const std::string& in_tag,
+    const std::string& out_tag) {
+  if (cc->Inputs().Tag(in_tag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+
+  using SoaType = BasicLandmarkSoa<LandmarkListType>;
+  auto landmarks = absl::make_unique<LandmarkListType>();
+  cc->Inputs().Tag(in_tag).Get<SoaType>().ToProto(landmarks.get());
+  cc->Outputs().Tag(out_tag).Add(landmarks.release(), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,86 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+// Runs a LandmarksSoaConverterCalculator from `in_tag` to `out_tag` on one
+// packet and returns its output.
+Packet Convert(const std::string& in_tag, const std::string& out_tag,
+               const Packet& input) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+                         calculator: "LandmarksSoaConverterCalculator"
+                         input_stream: "$0:input"
+                         output_stream: "$1:output"
+                       )pb",
+                       in_tag, out_tag)));
+  runner.MutableInputs()->Tag(in_tag).packets.push_back(
+      input.At(Timestamp(0)));
+  MP_EXPECT_OK(runner.Run());
+  const auto& outputs = runner.Outputs().Tag(out_tag).packets;
+  EXPECT_EQ(outputs.size(), 1);
+  return outputs.empty() ? Packet() : outputs[0];
+}
+
+TEST(LandmarksSoaConverterCalculatorTest, RoundTripsNormalizedLandmarks) {
+  // Visibility and presence are each set on some landmarks only.
+  const auto landmarks = ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+    landmark { x: 0.1 y: 0.2 z: 0.3 visibility: 0.9 presence: 0.8 }
+    landmark { x: 0.4 y: 0.5 z: 0.6 visibility: 0.7 }
+    landmark { x: 0.7 y: 0.8 z: 0.9 presence: 0.6 }
+    landmark { x: 1.0 y: 1.1 z: 1.2 }
+  )pb");
+
+  const Packet soa =
+      Convert("NORM_LANDMARKS", "NORM_LANDMARKS_SOA",
+              MakePacket<NormalizedLandmarkList>(landmarks));
+  const auto& soa_landmarks = soa.Get<NormalizedLandmarkSoa>();
+  ASSERT_EQ(soa_landmarks.size(), 4);
+  EXPECT_TRUE(soa_landmarks.landmark(1).has_visibility());
+  EXPECT_FALSE(soa_landmarks.landmark(1).has_presence());
+  EXPECT_FALSE(soa_landmarks.landmark(3).has_visibility());
+
+  const Packet round_trip =
+      Convert("NORM_LANDMARKS_SOA", "NORM_LANDMARKS", soa);
+  EXPECT_THAT(round_trip.Get<NormalizedLandmarkList>(), EqualsProto(landmarks));
+}
+
+TEST(LandmarksSoaConverterCalculatorTest, RoundTripsLandmarks) {
+  const auto landmarks = ParseTextProtoOrDie<LandmarkList>(R"pb(
+    landmark { x: 10 y: 20 z: -3 }
+    landmark { x: 40 y: 50 z: 6 visibility: 0.5 }
+  )pb");
+
+  const Packet soa = Convert("LANDMARKS", "LANDMARKS_SOA",
+                             MakePacket<LandmarkList>(landmarks));
+  const Packet round_trip = Convert("LANDMARKS_SOA", "LANDMARKS", soa);
+  EXPECT_THAT(round_trip.Get<LandmarkList>(), EqualsProto(landmarks));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -20,6 +20,7 @@
 #include "mediapipe/framework/calculator_framework.h"
 #include "mediapipe/framework/calculator_options.pb.h"
 #include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
 #include "mediapipe/framework/formats/location_data.pb.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/color.pb.h"
@@ -30,6 +31,8 @@ namespace {
 
 constexpr char kLandmarksTag[] = "LANDMARKS";
 constexpr char kNormLandmarksTag[] = "NORM_LANDMARKS";
+constexpr char kLandmarksSoaTag[] = "LANDMARKS_SOA";
+constexpr char kNormLandmarksSoaTag[] = "NORM_LANDMARKS_SOA";
 constexpr char kRenderScaleTag[] = "RENDER_SCALE";
 constexpr char kRenderDataTag[] = "RENDER_DATA";
 constexpr char kLandmarkLabel[] = "KEYPOINT";
@@ -224,11 +227,13 @@ RenderAnnotation* AddPointRenderData(const Color& landmark_color,
 
 absl::Status LandmarksToRenderDataCalculator::GetContract(
     CalculatorContract* cc) {
-  RET_CHECK(cc->Inputs().HasTag(kLandmarksTag) ||
-            cc->Inputs().HasTag(kNormLandmarksTag))
+  const int num_landmark_inputs = cc->Inputs().HasTag(kLandmarksTag) +
+                                  cc->Inputs().HasTag(kNormLandmarksTag) +
+                                  cc->Inputs().HasTag(kLandmarksSoaTag) +
+                                  cc->Inputs().HasTag(kNormLandmarksSoaTag);
+  RET_CHECK(num_landmark_inputs > 0)
       << "None of the input streams are provided.";
-  RET_CHECK(!(cc->Inputs().HasTag(kLandmarksTag) &&
-              cc->Inputs().HasTag(kNormLandmarksTag)))
+  RET_CHECK(num_landmark_inputs == 1)
       << "Can only one type of landmark can be taken. Either absolute or "
          "normalized landmarks.";
 
@@ -238,6 +243,12 @@ absl::Status LandmarksToRenderDataCalculator::GetContract(
   if (cc->Inputs().HasTag(kNormLandmarksTag)) {
     cc->Inputs().Tag(kNormLandmarksTag).Set<NormalizedLandmarkList>();
   }
+  if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    cc->Inputs().Tag(kLandmarksSoaTag).Set<LandmarkSoa>();
+  }
+  if (cc->Inputs().HasTag(kNormLandmarksSoaTag)) {
+    cc->Inputs().Tag(kNormLandmarksSoaTag).Set<NormalizedLandmarkSoa>();
+  }
   if (cc->Inputs().HasTag(kRenderScaleTag)) {
     cc->Inputs().Tag(kRenderScaleTag).Set<float>();
   }
@@ -271,11 +282,17 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
       cc->Inputs().Tag(kNormLandmarksTag).IsEmpty()) {
     return absl::OkStatus();
   }
+  if (cc->Inputs().HasTag(kLandmarksSoaTag) &&
+      cc->Inputs().Tag(kLandmarksSoaTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
+  if (cc->Inputs().HasTag(kNormLandmarksSoaTag) &&
+      cc->Inputs().Tag(kNormLandmarksSoaTag).IsEmpty()) {
+    return absl::OkStatus();
+  }
 
   auto render_data = absl::make_unique<RenderData>();
-  bool visualize_depth = options_.visualize_landmark_depth();
-  float z_min = 0.f;
-  float z_max = 0.f;
+  const bool visualize_depth = options_.visualize_landmark_depth();
 
   const Color min_depth_line_color = options_.has_min_depth_line_color()
                                          ? options_.min_depth_line_color()
@@ -294,94 +311,29 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
   }
 
   if (cc->Inputs().HasTag(kLandmarksTag)) {
-    const LandmarkList& landmarks =
-        cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>();
-    if (visualize_depth) {
-      GetMinMaxZ<LandmarkList, Landmark>(landmarks, &z_min, &z_max);
-    }
-    // Only change rendering if there are actually z values other than 0.
-    visualize_depth &= ((z_max - z_min) > 1e-3);
-    if (visualize_depth) {
-      AddConnectionsWithDepth<LandmarkList, Landmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), thickness, /*normalized=*/false, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
-    } else {
-      AddConnections<LandmarkList, Landmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/false, render_data.get());
-    }
-    for (int i = 0; i < landmarks.landmark_size(); ++i) {
-      const Landmark& landmark = landmarks.landmark(i);
-
-      if (!IsLandmarkVisibileAndPresent<Landmark>(
-              landmark, options_.utilize_visibility(),
-              options_.visibility_threshold(), options_.utilize_presence(),
-              options_.presence_threshold())) {
-        continue;
-      }
-
-      auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
-      if (visualize_depth) {
-        SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
-                               options_.min_depth_circle_thickness(),
-                               options_.max_depth_circle_thickness());
-      }
-      auto* landmark_data = landmark_data_render->mutable_point();
-      landmark_data->set_normalized(false);
-      landmark_data->set_x(landmark.x());
-      landmark_data->set_y(landmark.y());
-    }
+    AddLandmarksToRenderData<LandmarkList, Landmark>(
+        cc->Inputs().Tag(kLandmarksTag).Get<LandmarkList>(),
+        /*normalized=*/false, thickness, visualize_depth, min_depth_line_color,
+        max_depth_line_color, render_data.get());
   }
-
   if (cc->Inputs().HasTag(kNormLandmarksTag)) {
-    const NormalizedLandmarkList& landmarks =
-        cc->Inputs().Tag(kNormLandmarksTag).Get<NormalizedLandmarkList>();
-    if (visualize_depth) {
-      GetMinMaxZ<NormalizedLandmarkList, NormalizedLandmark>(landmarks, &z_min,
-                                                             &z_max);
-    }
-    // Only change rendering if there are actually z values other than 0.
-    visualize_depth &= ((z_max - z_min) > 1e-3);
-    if (visualize_depth) {
-      AddConnectionsWithDepth<NormalizedLandmarkList, NormalizedLandmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), thickness, /*normalized=*/true, z_min,
-          z_max, min_depth_line_color, max_depth_line_color, render_data.get());
-    } else {
-      AddConnections<NormalizedLandmarkList, NormalizedLandmark>(
-          landmarks, landmark_connections_, options_.utilize_visibility(),
-          options_.visibility_threshold(), options_.utilize_presence(),
-          options_.presence_threshold(), options_.connection_color(), thickness,
-          /*normalized=*/true, render_data.get());
-    }
-    for (int i = 0; i < landmarks.landmark_size(); ++i) {
-      const NormalizedLandmark& landmark = landmarks.landmark(i);
-
-      if (!IsLandmarkVisibileAndPresent<NormalizedLandmark>(
-              landmark, options_.utilize_visibility(),
-              options_.visibility_threshold(), options_.utilize_presence(),
-              options_.presence_threshold())) {
-        continue;
-      }
-
-      auto* landmark_data_render = AddPointRenderData(
-          options_.landmark_color(), thickness, render_data.get());
-      if (visualize_depth) {
-        SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
-                               options_.min_depth_circle_thickness(),
-                               options_.max_depth_circle_thickness());
-      }
-      auto* landmark_data = landmark_data_render->mutable_point();
-      landmark_data->set_normalized(true);
-      landmark_data->set_x(landmark.x());
-      landmark_data->set_y(landmark.y());
-    }
+    AddLandmarksToRenderData<NormalizedLandmarkList, NormalizedLandmark>(
+        cc->Inputs().Tag(kNormLandmarksTag).Get<NormalizedLandmarkList>(),
+        /*normalized=*/true, thickness, visualize_depth, min_depth_line_color,
+        max_depth_line_color, render_data.get());
+  }
+  if (cc->Inputs().HasTag(kLandmarksSoaTag)) {
+    AddLandmarksToRenderData<LandmarkSoa, LandmarkSoa::LandmarkView>(
+        cc->Inputs().Tag(kLandmarksSoaTag).Get<LandmarkSoa>(),
+        /*normalized=*/false, thickness, visualize_depth, min_depth_line_color,
+        max_depth_line_color, render_data.get());
+  }
+  if (cc->Inputs().HasTag(kNormLandmarksSoaTag)) {
+    AddLandmarksToRenderData<NormalizedLandmarkSoa,
+                             NormalizedLandmarkSoa::LandmarkView>(
+        cc->Inputs().Tag(kNormLandmarksSoaTag).Get<NormalizedLandmarkSoa>(),
+        /*normalized=*/true, thickness, visualize_depth, min_depth_line_color,
+        max_depth_line_color, render_data.get());
   }
 
   cc->Outputs()
@@ -390,5 +342,54 @@ absl::Status LandmarksToRenderDataCalculator::Process(CalculatorContext* cc) {
   return absl::OkStatus();
 }
 
+template <class LandmarkListType, class LandmarkType>
+void LandmarksToRenderDataCalculator::AddLandmarksToRenderData(
+    const LandmarkListType& landmarks, bool normalized, float thickness,
+    bool visualize_depth, const Color& min_depth_line_color,
+    const Color& max_depth_line_color, RenderData* render_data) {
+  float z_min = 0.f;
+  float z_max = 0.f;
+  if (visualize_depth) {
+    GetMinMaxZ<LandmarkListType, LandmarkType>(landmarks, &z_min, &z_max);
+  }
+  // Only change rendering if there are actually z values other than 0.
+  visualize_depth &= ((z_max - z_min) > 1e-3);
+  if (visualize_depth) {
+    AddConnectionsWithDepth<LandmarkListType, LandmarkType>(
+        landmarks, landmark_connections_, options_.utilize_visibility(),
+        options_.visibility_threshold(), options_.utilize_presence(),
+        options_.presence_threshold(), thickness, normalized, z_min, z_max,
+        min_depth_line_color, max_depth_line_color, render_data);
+  } else {
+    AddConnections<LandmarkListType, LandmarkType>(
+        landmarks, landmark_connections_, options_.utilize_visibility(),
+        options_.visibility_threshold(), options_.utilize_presence(),
+        options_.presence_threshold(), options_.connection_color(), thickness,
+        normalized, render_data);
+  }
+  for (int i = 0; i < landmarks.landmark_size(); ++i) {
+    const LandmarkType& landmark = landmarks.landmark(i);
+
+    if (!IsLandmarkVisibileAndPresent<LandmarkType>(
+            landmark, options_.utilize_visibility(),
+            options_.visibility_threshold(), options_.utilize_presence(),
+            options_.presence_threshold())) {
+      continue;
+    }
+
+    auto* landmark_data_render =
+        AddPointRenderData(options_.landmark_color(), thickness, render_data);
+    if (visualize_depth) {
+      SetColorSizeValueFromZ(landmark.z(), z_min, z_max, landmark_data_render,
+                             options_.min_depth_circle_thickness(),
+                             options_.max_depth_circle_thickness());
+    }
+    auto* landmark_data = landmark_data_render->mutable_point();
+    landmark_data->set_normalized(normalized);
+    landmark_data->set_x(landmark.x());
+    landmark_data->set_y(landmark.y());
+  }
+}
+
 REGISTER_CALCULATOR(LandmarksToRenderDataCalculator);
 }  // namespace mediapipe
@@ -29,7 +29,9 @@ namespace mediapipe {
 
 // A calculator that converts Landmark proto to RenderData proto for
 // visualization. The input should be LandmarkList proto. It is also possible
-// to specify the connections between landmarks.
+// to specify the connections between landmarks. LANDMARKS_SOA and
+// NORM_LANDMARKS_SOA inputs take LandmarkSoa and NormalizedLandmarkSoa lists
+// instead of LANDMARKS and NORM_LANDMARKS.
 //
 // Example config:
 // node {
@@ -61,6 +63,16 @@ class LandmarksToRenderDataCalculator : public CalculatorBase {
   absl::Status Process(CalculatorContext* cc) override;
 
  protected:
+  // Adds the landmarks and their connections to `render_data`.
+  template <class LandmarkListType, class LandmarkType>
+  void AddLandmarksToRenderData(const LandmarkListType& landmarks,
+                                bool normalized, float thickness,
+                                bool visualize_depth,
+                                const Color& min_depth_line_color,
+                                const Color& max_depth_line_color,
+                                RenderData* render_data);
+
+
   ::mediapipe::LandmarksToRenderDataCalculatorOptions options_;
   std::vector<int> landmark_connections_;
 };
@@ -0,0 +1,111 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "absl/strings/substitute.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_runner.h"
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/formats/landmark_soa.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/util/render_data.pb.h"
+
+namespace mediapipe {
+namespace {
+
+// Hides landmarks with a visibility or presence below 0.5, and draws depth.
+constexpr char kOptions[] = R"pb(
+  landmark_connections: [ 0, 1, 1, 2, 2, 3, 3, 4 ]
+  landmark_color { r: 255 g: 0 b: 0 }
+  connection_color { r: 0 g: 255 b: 0 }
+  thickness: 2.0
+  utilize_visibility: true
+  visibility_threshold: 0.5
+  utilize_presence: true
+  presence_threshold: 0.5
+)pb";
+
+// Landmark 1 is hidden by its visibility and landmark 3 by its presence.
+// Landmarks 2 and 4 have no visibility, and landmarks 0 and 2 no presence,
+// so those are drawn.
+constexpr char kLandmarks[] = R"pb(
+  landmark { x: 0.1 y: 0.2 z: -0.1 visibility: 0.9 }
+  landmark { x: 0.3 y: 0.4 z: 0.0 visibility: 0.2 presence: 0.9 }
+  landmark { x: 0.5 y: 0.6 z: 0.1 }
+  landmark { x: 0.7 y: 0.8 z: 0.2 visibility: 0.9 presence: 0.1 }
+  landmark { x: 0.9 y: 1.0 z: 0.3 presence: 0.8 }
+)pb";
+
+// Runs a LandmarksToRenderDataCalculator on `landmarks` through the `tag`
+// stream.
+RenderData RenderLandmarks(const std::string& tag, const Packet& landmarks) {
+  CalculatorRunner runner(ParseTextProtoOrDie<CalculatorGraphConfig::Node>(
+      absl::Substitute(R"pb(
+                         calculator: "LandmarksToRenderDataCalculator"
+                         input_stream: "$0:landmarks"
+                         output_stream: "RENDER_DATA:render_data"
+                         options {
+                           [mediapipe.LandmarksToRenderDataCalculatorOptions
+                                .ext] { $1 }
+                         }
+                       )pb",
+                       tag, kOptions)));
+  runner.MutableInputs()->Tag(tag).packets.push_back(
+      landmarks.At(Timestamp(0)));
+  MP_EXPECT_OK(runner.Run());
+  const auto& outputs = runner.Outputs().Tag("RENDER_DATA").packets;
+  EXPECT_EQ(outputs.size(), 1);
+  return outputs.empty() ? RenderData() : outputs[0].Get<RenderData>();
+}
+
+int CountPoints(const RenderData& render_data) {
+  int num_points = 0;
+  for (const auto& annotation : render_data.render_annotations()) {
+    if (annotation.data_case() == RenderAnnotation::kPoint) ++num_points;
+  }
+  return num_points;
+}
+
+TEST(LandmarksToRenderDataCalculatorTest, NormalizedSoaMatchesProto) {
+  const auto landmarks =
+      ParseTextProtoOrDie<NormalizedLandmarkList>(kLandmarks);
+  const RenderData expected = RenderLandmarks(
+      "NORM_LANDMARKS", MakePacket<NormalizedLandmarkList>(landmarks));
+  EXPECT_EQ(CountPoints(expected), 3);
+
+  const RenderData actual = RenderLandmarks(
+      "NORM_LANDMARKS_SOA", MakePacket<NormalizedLandmarkSoa>(
+                                NormalizedLandmarkSoa::FromProto(landmarks)));
+  EXPECT_THAT(actual, EqualsProto(expected));
+}
+
+TEST(LandmarksToRenderDataCalculatorTest, SoaMatchesProto) {
+  const auto landmarks = ParseTextProtoOrDie<LandmarkList>(kLandmarks);
+  const RenderData expected =
+      RenderLandmarks("LANDMARKS", MakePacket<LandmarkList>(landmarks));
+  EXPECT_EQ(CountPoints(expected), 3);
+
+  const RenderData actual = RenderLandmarks(
+      "LANDMARKS_SOA",
+      MakePacket<LandmarkSoa>(LandmarkSoa::FromProto(landmarks)));
+  EXPECT_THAT(actual, EqualsProto(expected));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -132,6 +132,12 @@ absl::Status BoxDetectorCalculator::GetContract(CalculatorContract* cc) {
     RET_CHECK(cc->Inputs().HasTag("FEATURES"))
         << "FEATURES and DESCRIPTORS need to be specified together.";
     cc->Inputs().Tag("DESCRIPTORS").Set<std::vector<float>>();
+    RET_CHECK_NE(cc->Options<BoxDetectorCalculatorOptions>()
+                     .detector_options()
+                     .index_type(),
+                 BoxDetectorOptions::HAMMING_LSH)
+        << "DESCRIPTORS are float descriptors, which the HAMMING_LSH index "
+           "does not support.";
   }
 
   if (cc->Inputs().HasTag("IMAGE_SIZE")) {
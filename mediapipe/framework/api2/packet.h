@@ -23,6 +23,7 @@ namespace api2 {
 
 using Timestamp = mediapipe::Timestamp;
 using HolderBase = mediapipe::packet_internal::HolderBase;
+using HolderPtr = mediapipe::packet_internal::HolderPtr;
 
 template <typename T>
 class Packet;
@@ -63,8 +64,8 @@ class PacketBase {
   operator mediapipe::Packet() && { return ToOldPacket(std::move(*this)); }
 
   // Note: Consume is included for compatibility with the old Packet; however,
-  // it relies on shared_ptr.unique(), which is deprecated and is not guaranteed
-  // to give exact results.
+  // it relies on HolderPtr::unique(), which is not guaranteed to give exact
+  // results if other threads are copying the packet.
   template <typename T>
   absl::StatusOr<std::unique_ptr<T>> Consume() {
     // Using the implementation in the old Packet for now.
@@ -77,10 +78,10 @@ class PacketBase {
   }
 
  protected:
-  explicit PacketBase(std::shared_ptr<HolderBase> payload)
+  explicit PacketBase(HolderPtr payload)
       : payload_(std::move(payload)) {}
 
-  std::shared_ptr<HolderBase> payload_;
+  HolderPtr payload_;
   Timestamp timestamp_;
 
   template <typename T>
@@ -191,7 +192,7 @@ class Packet<internal::Generic> : public PacketBase {
   Packet<internal::Generic> At(Timestamp timestamp) &&;
 
  protected:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : PacketBase(std::move(payload)) {}
 
   friend PacketBase;
@@ -222,14 +223,14 @@ class Packet : public Packet<internal::Generic> {
   }
 
   // Note: Consume is included for compatibility with the old Packet; however,
-  // it relies on shared_ptr.unique(), which is deprecated and is not guaranteed
-  // to give exact results.
+  // it relies on HolderPtr::unique(), which is not guaranteed to give exact
+  // results if other threads are copying the packet.
   absl::StatusOr<std::unique_ptr<T>> Consume() {
     return PacketBase::Consume<T>();
   }
 
  private:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : Packet<internal::Generic>(std::move(payload)) {}
 
   friend PacketBase;
@@ -352,8 +353,8 @@ class Packet<OneOf<T...>> : public PacketBase {
   }
 
   // Note: Consume is included for compatibility with the old Packet; however,
-  // it relies on shared_ptr.unique(), which is deprecated and is not guaranteed
-  // to give exact results.
+  // it relies on HolderPtr::unique(), which is not guaranteed to give exact
+  // results if other threads are copying the packet.
   template <class U, class = AllowedType<U>>
   absl::StatusOr<std::unique_ptr<U>> Consume() {
     return PacketBase::Consume<U>();
@@ -376,7 +377,7 @@ class Packet<OneOf<T...>> : public PacketBase {
   }
 
  protected:
-  explicit Packet(std::shared_ptr<HolderBase> payload)
+  explicit Packet(HolderPtr payload)
       : PacketBase(std::move(payload)) {}
 
   friend PacketBase;
@@ -447,18 +448,18 @@ inline Packet<internal::Generic> Packet<internal::Generic>::At(
 
 template <typename T, typename... Args>
 Packet<T> MakePacket(Args&&... args) {
-  return Packet<T>(std::make_shared<packet_internal::Holder<T>>(
-      new T(std::forward<Args>(args)...)));
+  return Packet<T>(HolderPtr(
+      new packet_internal::Holder<T>(new T(std::forward<Args>(args)...))));
 }
 
 template <typename T>
 Packet<T> PacketAdopting(const T* ptr) {
-  return Packet<T>(std::make_shared<packet_internal::Holder<T>>(ptr));
+  return Packet<T>(HolderPtr(new packet_internal::Holder<T>(ptr)));
 }
 
 template <typename T>
 Packet<T> PacketAdopting(std::unique_ptr<T> ptr) {
-  return Packet<T>(std::make_shared<packet_internal::Holder<T>>(ptr.release()));
+  return Packet<T>(HolderPtr(new packet_internal::Holder<T>(ptr.release())));
 }
 
 }  // namespace api2
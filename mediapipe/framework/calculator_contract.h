@@ -15,6 +15,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTRACT_H_
 #define MEDIAPIPE_FRAMEWORK_CALCULATOR_CONTRACT_H_
 
+#include <algorithm>
 #include <map>
 #include <memory>
 #include <string>
@@ -58,6 +59,11 @@ class CalculatorContract {
   // Returns the name given to this node.
   const std::string& GetNodeName() { return node_name_; }
 
+  // Returns the max_in_flight given to this node, or 1 if it is unset.
+  int GetMaxInFlight() const {
+    return node_config_ ? std::max(node_config_->max_in_flight(), 1) : 1;
+  }
+
   // Returns the options given to this calculator.  Template argument T must
   // be the type of the protobuf extension message or the protobuf::Any
   // message containing the options.
@@ -130,6 +136,15 @@ class CalculatorContract {
   void SetTimestampOffset(TimestampDiff offset) { timestamp_offset_ = offset; }
   TimestampDiff GetTimestampOffset() const { return timestamp_offset_; }
 
+  // Declares that Process() keeps no state from one input timestamp to the
+  // next: its outputs depend only on the inputs at the timestamp and on what
+  // Open() computed from the options and input side packets. A node of such a
+  // calculator with max_in_flight > 1 runs its concurrent Process() calls on
+  // separate instances of the calculator, each opened in the same way, and
+  // its outputs are still propagated in input timestamp order.
+  void SetStateless(bool stateless) { stateless_ = stateless; }
+  bool IsStateless() const { return stateless_; }
+
   class GraphServiceRequest {
    public:
     // APIs that should be used by calculators.
@@ -175,6 +190,7 @@ class CalculatorContract {
   std::map<std::string, GraphServiceRequest> service_requests_;
   bool process_timestamps_ = false;
   TimestampDiff timestamp_offset_ = TimestampDiff::Unset();
+  bool stateless_ = false;
 };
 
 }  // namespace mediapipe
@@ -75,6 +75,8 @@ namespace {
 // threshold.
 constexpr int kMaxNumAccumulatedErrors = 1000;
 constexpr char kApplicationThreadExecutorType[] = "ApplicationThreadExecutor";
+// The default interval between GraphMetrics snapshots.
+constexpr int64 kDefaultMetricsIntervalUsec = 1000000;
 
 }  // namespace
 
@@ -129,6 +131,10 @@ CalculatorGraph::CalculatorGraph(const CalculatorGraphConfig& config)
 // they only need to be fully visible here, where their destructor is
 // instantiated.
 CalculatorGraph::~CalculatorGraph() {
+  // Stop periodic metrics output before the graph is destroyed.
+  if (metrics_publisher_) {
+    metrics_publisher_->Stop();
+  }
   // Stop periodic profiler output to ublock Executor destructors.
   absl::Status status = profiler()->Stop();
   if (!status.ok()) {
@@ -265,6 +271,27 @@ absl::Status CalculatorGraph::InitializeCalculatorNodes() {
 
 absl::Status CalculatorGraph::InitializeProfiler() {
   profiler_->Initialize(*validated_graph_);
+  // Adds the metrics exporters requested by the ProfilerConfig, such as the
+  // PrometheusExporter for metrics_port, among those linked in.
+  const ProfilerConfig& profiler_config =
+      validated_graph_->Config().profiler_config();
+  if ((profiler_config.metrics_port() != 0 ||
+       !profiler_config.metrics_unix_socket_path().empty()) &&
+      !MetricsExporterRegistry::IsRegistered("PrometheusExporter")) {
+    return absl::FailedPreconditionError(
+        "ProfilerConfig.metrics_port and metrics_unix_socket_path require "
+        "the PrometheusExporter, which is linked in by "
+        "//mediapipe/framework/profiler:prometheus_exporter.");
+  }
+  for (const std::string& name :
+       MetricsExporterRegistry::GetRegisteredNames()) {
+    ASSIGN_OR_RETURN(
+        std::shared_ptr<MetricsExporter> exporter,
+        MetricsExporterRegistry::CreateByName(name, profiler_config));
+    if (exporter) {
+      MP_RETURN_IF_ERROR(AddMetricsExporter(std::move(exporter)));
+    }
+  }
   return absl::OkStatus();
 }
 
@@ -325,6 +352,14 @@ absl::Status CalculatorGraph::InitializeExecutors() {
                                                  use_application_thread));
   }
 
+  for (const ExecutorConfig& executor_config :
+       validated_graph_->Config().executor()) {
+    if (executor_config.max_nodes_per_task() > 1) {
+      MP_RETURN_IF_ERROR(scheduler_.SetMaxNodesPerTask(
+          executor_config.name(), executor_config.max_nodes_per_task()));
+    }
+  }
+
   return absl::OkStatus();
 }
 
@@ -411,7 +446,8 @@ absl::Status CalculatorGraph::Initialize(
 
 absl::Status CalculatorGraph::ObserveOutputStream(
     const std::string& stream_name,
-    std::function<absl::Status(const Packet&)> packet_callback) {
+    std::function<absl::Status(const Packet&)> packet_callback,
+    bool observe_timestamp_bounds) {
   RET_CHECK(initialized_).SetNoLogging()
       << "CalculatorGraph is not initialized.";
   // TODO Allow output observers to be attached by graph level
@@ -425,7 +461,7 @@ absl::Status CalculatorGraph::ObserveOutputStream(
   auto observer = absl::make_unique<internal::OutputStreamObserver>();
   MP_RETURN_IF_ERROR(observer->Initialize(
       stream_name, &any_packet_type_, std::move(packet_callback),
-      &output_stream_managers_[output_stream_index]));
+      &output_stream_managers_[output_stream_index], observe_timestamp_bounds));
   graph_output_streams_.push_back(std::move(observer));
   return absl::OkStatus();
 }
@@ -504,6 +540,18 @@ absl::Status CalculatorGraph::StartRun(
       << "CalculatorGraph is not initialized.";
   MP_RETURN_IF_ERROR(PrepareForRun(extra_side_packets, stream_headers));
   MP_RETURN_IF_ERROR(profiler_->Start(executors_[""].get()));
+  if (!metrics_exporters_.empty()) {
+    if (!metrics_publisher_) {
+      int64 interval_usec =
+          validated_graph_->Config().profiler_config().metrics_interval_usec();
+      metrics_publisher_ = absl::make_unique<MetricsPublisher>(
+          absl::Microseconds(interval_usec > 0 ? interval_usec
+                                               : kDefaultMetricsIntervalUsec),
+          [this](GraphMetrics* metrics) { GetMetrics(metrics).IgnoreError(); },
+          metrics_exporters_);
+    }
+    metrics_publisher_->Start();
+  }
   scheduler_.Start();
   return absl::OkStatus();
 }
@@ -584,6 +632,23 @@ absl::StatusOr<std::map<std::string, Packet>> CalculatorGraph::PrepareGpu(
 }
 #endif  // !MEDIAPIPE_DISABLE_GPU
 
+absl::Status CalculatorGraph::PrepareServices() {
+  for (const auto& node_type_info : validated_graph_->CalculatorInfos()) {
+    const auto& requests = node_type_info.Contract().ServiceRequests();
+    for (const auto& key_request : requests) {
+      const GraphServiceBase& service = key_request.second.Service();
+      if (!service.default_factory ||
+          ContainsKey(service_manager_.ServicePackets(), service.key)) {
+        continue;
+      }
+      // The object is kept across runs, e.g. so that pools stay warm.
+      MP_RETURN_IF_ERROR(service_manager_.SetServicePacket(
+          service, service.default_factory()));
+    }
+  }
+  return absl::OkStatus();
+}
+
 absl::Status CalculatorGraph::PrepareForRun(
     const std::map<std::string, Packet>& extra_side_packets,
     const std::map<std::string, Packet>& stream_headers) {
@@ -604,6 +669,7 @@ absl::Status CalculatorGraph::PrepareForRun(
 #if !MEDIAPIPE_DISABLE_GPU
   ASSIGN_OR_RETURN(additional_side_packets, PrepareGpu(extra_side_packets));
 #endif  // !MEDIAPIPE_DISABLE_GPU
+  MP_RETURN_IF_ERROR(PrepareServices());
 
   const std::map<std::string, Packet>* input_side_packets;
   if (!additional_side_packets.empty()) {
@@ -782,21 +848,20 @@ absl::Status CalculatorGraph::WaitForObservedOutput() {
 
 absl::Status CalculatorGraph::AddPacketToInputStream(
     const std::string& stream_name, const Packet& packet) {
-  return AddPacketToInputStreamInternal(stream_name, packet);
+  ASSIGN_OR_RETURN(GraphInputStreamHandle stream,
+                   GetInputStreamHandle(stream_name));
+  return AddPacketToInputStreamInternal(stream, packet);
 }
 
 absl::Status CalculatorGraph::AddPacketToInputStream(
     const std::string& stream_name, Packet&& packet) {
-  return AddPacketToInputStreamInternal(stream_name, std::move(packet));
+  ASSIGN_OR_RETURN(GraphInputStreamHandle stream,
+                   GetInputStreamHandle(stream_name));
+  return AddPacketToInputStreamInternal(stream, std::move(packet));
 }
 
-// We avoid having two copies of this code for AddPacketToInputStream(
-// const Packet&) and AddPacketToInputStream(Packet &&) by having this
-// internal-only templated version.  T&& is a forwarding reference here, so
-// std::forward will deduce the correct type as we pass along packet.
-template <typename T>
-absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
-    const std::string& stream_name, T&& packet) {
+absl::StatusOr<CalculatorGraph::GraphInputStreamHandle>
+CalculatorGraph::GetInputStreamHandle(const std::string& stream_name) {
   std::unique_ptr<GraphInputStream>* stream =
       mediapipe::FindOrNull(graph_input_streams_, stream_name);
   RET_CHECK(stream).SetNoLogging() << absl::Substitute(
@@ -805,46 +870,53 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
       stream_name);
   int node_id = mediapipe::FindOrDie(graph_input_stream_node_ids_, stream_name);
   CHECK_GE(node_id, validated_graph_->CalculatorInfos().size());
-  {
-    absl::MutexLock lock(&full_input_streams_mutex_);
-    if (full_input_streams_.empty()) {
-      return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
-             << "CalculatorGraph::AddPacketToInputStream() is called before "
-                "StartRun()";
-    }
-    if (graph_input_stream_add_mode_ ==
-        GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
-      // Return with StatusUnavailable if this stream is being throttled.
-      if (!full_input_streams_[node_id].empty()) {
-        return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
-               << "Graph is throttled.";
-      }
-    } else if (graph_input_stream_add_mode_ ==
-               GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
-      // Wait until this stream is not being throttled.
-      // TODO: instead of checking has_error_, we could just check
-      // if the graph is done. That could also be indicated by returning an
-      // error from WaitUntilGraphInputStreamUnthrottled.
-      while (!has_error_ && !full_input_streams_[node_id].empty()) {
-        // TODO: allow waiting for a specific stream?
-        scheduler_.WaitUntilGraphInputStreamUnthrottled(
-            &full_input_streams_mutex_);
-      }
-      if (has_error_) {
-        absl::Status error_status;
-        GetCombinedErrors("Graph has errors: ", &error_status);
-        return error_status;
-      }
-    }
+  return GraphInputStreamHandle(stream->get(), node_id);
+}
+
+absl::Status CalculatorGraph::AddPacketToInputStream(
+    const GraphInputStreamHandle& stream, const Packet& packet) {
+  return AddPacketToInputStreamInternal(stream, packet);
+}
+
+absl::Status CalculatorGraph::AddPacketToInputStream(
+    const GraphInputStreamHandle& stream, Packet&& packet) {
+  return AddPacketToInputStreamInternal(stream, std::move(packet));
+}
+
+absl::Status CalculatorGraph::AddPacketsToInputStream(
+    const GraphInputStreamHandle& stream, std::vector<Packet>&& packets) {
+  RET_CHECK(stream.IsValid());
+  if (packets.empty()) {
+    return absl::OkStatus();
   }
+  MP_RETURN_IF_ERROR(WaitToAddPacketsToInputStream(stream.node_id_));
+
+  const std::string* stream_id = &stream.stream_->GetManager()->Name();
+  for (Packet& packet : packets) {
+    profiler_->LogEvent(TraceEvent(TraceEvent::PROCESS)
+                            .set_is_finish(true)
+                            .set_input_ts(packet.Timestamp())
+                            .set_stream_id(stream_id)
+                            .set_packet_ts(packet.Timestamp())
+                            .set_packet_data_id(&packet));
+    stream.stream_->AddPacket(std::move(packet));
+  }
+  packets.clear();
+  return FinishAddingPacketsToInputStream(stream.stream_);
+}
+
+// We avoid having two copies of this code for AddPacketToInputStream(
+// const Packet&) and AddPacketToInputStream(Packet &&) by having this
+// internal-only templated version.  T&& is a forwarding reference here, so
+// std::forward will deduce the correct type as we pass along packet.
+template <typename T>
+absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
+    const GraphInputStreamHandle& stream, T&& packet) {
+  RET_CHECK(stream.IsValid());
+  MP_RETURN_IF_ERROR(WaitToAddPacketsToInputStream(stream.node_id_));
 
   // Adding profiling info for a new packet entering the graph.
-  const std::string* stream_id = &(*stream)->GetManager()->Name();
+  const std::string* stream_id = &stream.stream_->GetManager()->Name();
   profiler_->LogEvent(TraceEvent(TraceEvent::PROCESS)
                           .set_is_finish(true)
                           .set_input_ts(packet.Timestamp())
@@ -856,15 +928,59 @@ absl::Status CalculatorGraph::AddPacketToInputStreamInternal(
   // should not be called by multiple threads concurrently. Note that this could
   // potentially lead to the max queue size being exceeded by one packet at most
   // because we don't have the lock over the input stream.
-  (*stream)->AddPacket(std::forward<T>(packet));
+  stream.stream_->AddPacket(std::forward<T>(packet));
+  return FinishAddingPacketsToInputStream(stream.stream_);
+}
+
+absl::Status CalculatorGraph::WaitToAddPacketsToInputStream(int node_id) {
+  absl::MutexLock lock(&full_input_streams_mutex_);
+  if (full_input_streams_.empty()) {
+    return mediapipe::FailedPreconditionErrorBuilder(MEDIAPIPE_LOC)
+           << "CalculatorGraph::AddPacketToInputStream() is called before "
+              "StartRun()";
+  }
+  if (graph_input_stream_add_mode_ ==
+      GraphInputStreamAddMode::ADD_IF_NOT_FULL) {
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
+    }
+    // Return with StatusUnavailable if this stream is being throttled.
+    if (!full_input_streams_[node_id].empty()) {
+      return mediapipe::UnavailableErrorBuilder(MEDIAPIPE_LOC)
+             << "Graph is throttled.";
+    }
+  } else if (graph_input_stream_add_mode_ ==
+             GraphInputStreamAddMode::WAIT_TILL_NOT_FULL) {
+    // Wait until this stream is not being throttled.
+    // TODO: instead of checking has_error_, we could just check
+    // if the graph is done. That could also be indicated by returning an
+    // error from WaitUntilGraphInputStreamUnthrottled.
+    while (!has_error_ && !full_input_streams_[node_id].empty()) {
+      // TODO: allow waiting for a specific stream?
+      scheduler_.WaitUntilGraphInputStreamUnthrottled(
+          &full_input_streams_mutex_);
+    }
+    if (has_error_) {
+      absl::Status error_status;
+      GetCombinedErrors("Graph has errors: ", &error_status);
+      return error_status;
+    }
+  }
+  return absl::OkStatus();
+}
+
+absl::Status CalculatorGraph::FinishAddingPacketsToInputStream(
+    GraphInputStream* stream) {
   if (has_error_) {
     absl::Status error_status;
     GetCombinedErrors("Graph has errors: ", &error_status);
     return error_status;
   }
-  (*stream)->PropagateUpdatesToMirrors();
+  stream->PropagateUpdatesToMirrors();
 
-  VLOG(2) << "Packet added directly to: " << stream_name;
+  VLOG(2) << "Packets added directly to: " << stream->GetManager()->Name();
   // Note: one reason why we need to call the scheduler here is that we have
   // re-throttled the graph input streams, and we may need to unthrottle them
   // again if the graph is still idle. Unthrottling basically only lets in one
@@ -1045,6 +1161,9 @@ void CalculatorGraph::UpdateThrottledNodes(InputStreamManager* stream,
     // in this function and is guarded by full_input_streams_mutex_.
     bool stream_is_full = stream->IsFull();
     if (*stream_was_full != stream_is_full) {
+      if (stream_is_full) {
+        ++throttle_count_;
+      }
       for (int node_id : *upstream_nodes) {
         VLOG(2) << "Stream \"" << stream->Name() << "\" is "
                 << (stream_is_full ? "throttling" : "no longer throttling")
@@ -1222,6 +1341,9 @@ bool CalculatorGraph::IsReservedExecutorName(const std::string& name) {
 absl::Status CalculatorGraph::FinishRun() {
   // Check for any errors that may have occurred.
   absl::Status status = absl::OkStatus();
+  if (metrics_publisher_) {
+    metrics_publisher_->Stop();
+  }
   MP_RETURN_IF_ERROR(profiler_->Stop());
   GetCombinedErrors(&status);
   CleanupAfterRun(&status);
@@ -1300,4 +1422,49 @@ absl::Status CalculatorGraph::GetCalculatorProfiles(
   return profiler_->GetCalculatorProfiles(profiles);
 }
 
+absl::Status CalculatorGraph::GetMetrics(GraphMetrics* metrics) {
+  RET_CHECK(initialized_) << "CalculatorGraph is not initialized.";
+  metrics->Clear();
+  std::vector<CalculatorProfile> profiles;
+  profiler_->CollectCalculatorProfiles(&profiles);
+  for (CalculatorProfile& profile : profiles) {
+    *metrics->add_calculator_profiles() = std::move(profile);
+  }
+  const auto& input_stream_infos = validated_graph_->InputStreamInfos();
+  for (int index = 0; index < input_stream_infos.size(); ++index) {
+    const EdgeInfo& edge_info = input_stream_infos[index];
+    if (edge_info.parent_node.type != NodeTypeInfo::NodeType::CALCULATOR) {
+      continue;
+    }
+    const InputStreamManager& stream = input_stream_managers_[index];
+    GraphMetrics::InputStreamMetrics* stream_metrics =
+        metrics->add_input_stream();
+    stream_metrics->set_calculator_name(
+        (*nodes_)[edge_info.parent_node.index].GetCalculatorState().NodeName());
+    stream_metrics->set_stream_name(stream.Name());
+    stream_metrics->set_queue_size(stream.QueueSize());
+    stream_metrics->set_max_queue_size(stream.MaxQueueSize());
+  }
+  {
+    absl::MutexLock lock(&full_input_streams_mutex_);
+    metrics->set_throttle_count(throttle_count_);
+    int throttled_node_count = 0;
+    for (const auto& full_streams : full_input_streams_) {
+      throttled_node_count += full_streams.empty() ? 0 : 1;
+    }
+    metrics->set_throttled_node_count(throttled_node_count);
+  }
+  scheduler_.GetExecutorMetrics(metrics);
+  return absl::OkStatus();
+}
+
+absl::Status CalculatorGraph::AddMetricsExporter(
+    std::shared_ptr<MetricsExporter> exporter) {
+  RET_CHECK(!metrics_publisher_)
+      << "AddMetricsExporter must be called before StartRun.";
+  RET_CHECK(exporter);
+  metrics_exporters_.push_back(std::move(exporter));
+  return absl::OkStatus();
+}
+
 }  // namespace mediapipe
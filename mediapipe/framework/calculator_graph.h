@@ -51,6 +51,7 @@
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/profiler/metrics_exporter.h"
 #include "mediapipe/framework/scheduler.h"
 #include "mediapipe/framework/thread_pool_executor.pb.h"
 
@@ -96,6 +97,9 @@ typedef absl::StatusOr<OutputStreamPoller> StatusOrPoller;
 //   MP_RETURN_IF_ERROR(graph->CloseAllInputStreams());
 //   MP_RETURN_IF_ERROR(graph->WaitUntilDone());
 class CalculatorGraph {
+ private:
+  class GraphInputStream;
+
  public:
   // Defines possible modes for adding a packet to a graph input stream.
   // WAIT_TILL_NOT_FULL can be used to control the memory usage of a graph by
@@ -114,6 +118,25 @@ class CalculatorGraph {
     ADD_IF_NOT_FULL
   };
 
+  // A graph input stream resolved by name once, by GetInputStreamHandle(), so
+  // that adding packets to it skips the lookup by name. A handle can be used
+  // in every run of the graph that created it.
+  class GraphInputStreamHandle {
+   public:
+    GraphInputStreamHandle() = default;
+
+    bool IsValid() const { return stream_ != nullptr; }
+
+   private:
+    GraphInputStreamHandle(GraphInputStream* stream, int node_id)
+        : stream_(stream), node_id_(node_id) {}
+
+    GraphInputStream* stream_ = nullptr;
+    int node_id_ = -1;
+
+    friend class CalculatorGraph;
+  };
+
   // Creates an uninitialized graph.
   CalculatorGraph();
   CalculatorGraph(const CalculatorGraph&) = delete;
@@ -154,10 +177,14 @@ class CalculatorGraph {
   // Observes the named output stream. packet_callback will be invoked on every
   // packet emitted by the output stream. Can only be called before Run() or
   // StartRun().
+  // If observe_timestamp_bounds is true, packet_callback is also invoked with
+  // an empty packet when the timestamp bound of the stream advances without a
+  // packet. The empty packet is at the last timestamp settled by the bound.
   // TODO: Rename to AddOutputStreamCallback.
   absl::Status ObserveOutputStream(
       const std::string& stream_name,
-      std::function<absl::Status(const Packet&)> packet_callback);
+      std::function<absl::Status(const Packet&)> packet_callback,
+      bool observe_timestamp_bounds = false);
 
   // Adds an OutputStreamPoller for a stream. This provides a synchronous,
   // polling API for accessing a stream's output. Should only be called before
@@ -254,6 +281,28 @@ class CalculatorGraph {
   absl::Status AddPacketToInputStream(const std::string& stream_name,
                                       Packet&& packet);
 
+  // Returns a handle to the graph input stream named |stream_name|, for the
+  // overloads of AddPacketToInputStream below. Can be called once the graph
+  // is initialized.
+  absl::StatusOr<GraphInputStreamHandle> GetInputStreamHandle(
+      const std::string& stream_name);
+
+  // Same as the versions taking a stream name.
+  absl::Status AddPacketToInputStream(const GraphInputStreamHandle& stream,
+                                      const Packet& packet);
+  absl::Status AddPacketToInputStream(const GraphInputStreamHandle& stream,
+                                      Packet&& packet);
+
+  // Adds |packets|, in increasing timestamp order, to a graph input stream.
+  // The graph input stream add mode is applied once for the whole batch, and
+  // the packets are propagated to the consumers of the stream together, which
+  // is cheaper than adding them one at a time. The batch may exceed the max
+  // queue size of the stream. The packets are moved out of |packets| only if
+  // they are added; in particular, with ADD_IF_NOT_FULL and a full queue this
+  // returns StatusUnavailable and |packets| is left unchanged.
+  absl::Status AddPacketsToInputStream(const GraphInputStreamHandle& stream,
+                                       std::vector<Packet>&& packets);
+
   // Sets the queue size of a graph input stream, overriding the graph default.
   absl::Status SetInputStreamMaxQueueSize(const std::string& stream_name,
                                           int max_queue_size);
@@ -290,6 +339,17 @@ class CalculatorGraph {
   ABSL_DEPRECATED("Use profiler()->GetCalculatorProfiles() instead")
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const;
 
+  // Collects a snapshot of the calculator profiles, the input stream queue
+  // sizes, source throttling, and the load on each executor. The calculator
+  // profiles are collected without acquiring the profiler mutex. May be called
+  // at any time after the graph has been initialized.
+  absl::Status GetMetrics(GraphMetrics* metrics);
+
+  // Adds an exporter that receives GraphMetrics periodically while the graph
+  // runs, every ProfilerConfig::metrics_interval_usec, and once more as each
+  // run finishes. Must be called before the first call to StartRun().
+  absl::Status AddMetricsExporter(std::shared_ptr<MetricsExporter> exporter);
+
   // Set the type of counter used in this graph.
   void SetCounterFactory(CounterFactory* factory) {
     counter_factory_.reset(factory);
@@ -450,8 +510,16 @@ class CalculatorGraph {
   // AddPacketToInputStream(Packet&& packet) or
   // AddPacketToInputStream(const Packet& packet).
   template <typename T>
-  absl::Status AddPacketToInputStreamInternal(const std::string& stream_name,
-                                              T&& packet);
+  absl::Status AddPacketToInputStreamInternal(
+      const GraphInputStreamHandle& stream, T&& packet);
+
+  // Blocks or fails according to graph_input_stream_add_mode_ until packets
+  // can be added to the graph input stream feeding |node_id|.
+  absl::Status WaitToAddPacketsToInputStream(int node_id)
+      ABSL_LOCKS_EXCLUDED(full_input_streams_mutex_);
+
+  // Propagates the packets added to |stream| and lets the scheduler know.
+  absl::Status FinishAddingPacketsToInputStream(GraphInputStream* stream);
 
   // Sets the executor that will run the nodes assigned to the executor
   // named |name|.  If |name| is empty, this sets the default executor.
@@ -489,6 +557,11 @@ class CalculatorGraph {
   // Iterates through all nodes and schedules any that can be opened.
   void ScheduleAllOpenableNodes();
 
+  // Helper for PrepareForRun. Creates the default object of every service
+  // that a node requests, allows default initialization, and has not been
+  // provided by the application.
+  absl::Status PrepareServices();
+
   // Does the bulk of the work for StartRun but does not start the scheduler.
   absl::Status PrepareForRun(
       const std::map<std::string, Packet>& extra_side_packets,
@@ -579,6 +652,9 @@ class CalculatorGraph {
   std::vector<absl::flat_hash_set<InputStreamManager*>> full_input_streams_
       ABSL_GUARDED_BY(full_input_streams_mutex_);
 
+  // The number of times an input stream became full and throttled sources.
+  int64 throttle_count_ ABSL_GUARDED_BY(full_input_streams_mutex_) = 0;
+
   // Maps stream names to graph input stream objects.
   absl::flat_hash_map<std::string, std::unique_ptr<GraphInputStream>>
       graph_input_streams_;
@@ -638,6 +714,13 @@ class CalculatorGraph {
   std::shared_ptr<ProfilingContext> profiler_;
 
   internal::Scheduler scheduler_;
+
+  // The exporters that receive GraphMetrics while the graph runs.
+  std::vector<std::shared_ptr<MetricsExporter>> metrics_exporters_;
+
+  // Publishes GraphMetrics to metrics_exporters_ during each graph run.
+  // It is declared last so that it stops before the graph is destroyed.
+  std::unique_ptr<MetricsPublisher> metrics_publisher_;
 };
 
 }  // namespace mediapipe
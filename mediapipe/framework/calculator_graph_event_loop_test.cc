@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <algorithm>
 #include <map>
 #include <string>
 #include <vector>
@@ -540,6 +541,100 @@ TEST_F(CalculatorGraphEventLoopTest, WaitToAddPacketToInputStream) {
   ASSERT_EQ(kNumInputPackets, output_packets_.size());
 }
 
+// Adds packets through a GraphInputStreamHandle, one at a time and in batches,
+// and drains them from an OutputStreamPoller in batches.
+TEST_F(CalculatorGraphEventLoopTest, AddPacketsToInputStreamHandle) {
+  CalculatorGraphConfig graph_config;
+  ASSERT_TRUE(proto_ns::TextFormat::ParseFromString(
+      R"(
+          node {
+            calculator: "PassThroughCalculator"
+            input_stream: "input_numbers"
+            output_stream: "output_numbers"
+          }
+          input_stream: "input_numbers"
+          output_stream: "output_numbers"
+          max_queue_size: 10
+      )",
+      &graph_config));
+
+  CalculatorGraph graph(graph_config);
+  EXPECT_FALSE(graph.GetInputStreamHandle("output_numbers").ok());
+  auto stream_or = graph.GetInputStreamHandle("input_numbers");
+  MP_ASSERT_OK(stream_or);
+  const CalculatorGraph::GraphInputStreamHandle stream = stream_or.value();
+  auto poller_or = graph.AddOutputStreamPoller("output_numbers");
+  MP_ASSERT_OK(poller_or);
+  OutputStreamPoller poller = std::move(poller_or).value();
+  MP_ASSERT_OK(graph.StartRun({}));
+
+  constexpr int kNumInputPackets = 35;
+  constexpr int kBatchSize = 8;
+  MP_ASSERT_OK(graph.AddPacketToInputStream(
+      stream, MakePacket<int>(0).At(Timestamp(0))));
+  for (int i = 1; i < kNumInputPackets; i += kBatchSize) {
+    std::vector<Packet> batch;
+    for (int j = i; j < std::min(i + kBatchSize, kNumInputPackets); ++j) {
+      batch.push_back(MakePacket<int>(j).At(Timestamp(j)));
+    }
+    MP_ASSERT_OK(graph.AddPacketsToInputStream(stream, std::move(batch)));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("input_numbers"));
+
+  std::vector<Packet> output_packets;
+  while (poller.NextBatch(&output_packets, kBatchSize)) {
+  }
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(output_packets.size(), kNumInputPackets);
+  for (int i = 0; i < kNumInputPackets; ++i) {
+    EXPECT_EQ(output_packets[i].Timestamp(), Timestamp(i));
+    EXPECT_EQ(output_packets[i].Get<int>(), i);
+  }
+}
+
+// A throttled batch is rejected as a whole and left to the caller.
+TEST_F(CalculatorGraphEventLoopTest, TryToAddPacketsToInputStreamHandle) {
+  CalculatorGraphConfig graph_config;
+  ASSERT_TRUE(proto_ns::TextFormat::ParseFromString(
+      R"(
+          node {
+            calculator: "BlockingPassThroughCalculator"
+            input_stream: "input_numbers"
+            output_stream: "output_numbers"
+            input_side_packet: "blocking_mutex"
+          }
+          input_stream: "input_numbers"
+          max_queue_size: 1
+      )",
+      &graph_config));
+
+  absl::Mutex* mutex = new absl::Mutex();
+  Packet mutex_side_packet = AdoptAsUniquePtr(mutex);
+
+  CalculatorGraph graph(graph_config);
+  graph.SetGraphInputStreamAddMode(
+      CalculatorGraph::GraphInputStreamAddMode::ADD_IF_NOT_FULL);
+  auto stream_or = graph.GetInputStreamHandle("input_numbers");
+  MP_ASSERT_OK(stream_or);
+  MP_ASSERT_OK(graph.StartRun({{"blocking_mutex", mutex_side_packet}}));
+
+  // Lock the mutex so that the BlockingPassThroughCalculator cannot read any
+  // of these packets.
+  mutex->Lock();
+  absl::Status status = absl::OkStatus();
+  std::vector<Packet> batch;
+  for (int i = 0; i < 10 && status.ok(); ++i) {
+    batch = {MakePacket<int>(2 * i).At(Timestamp(2 * i)),
+             MakePacket<int>(2 * i + 1).At(Timestamp(2 * i + 1))};
+    status = graph.AddPacketsToInputStream(stream_or.value(), std::move(batch));
+  }
+  mutex->Unlock();
+  EXPECT_EQ(status.code(), absl::StatusCode::kUnavailable);
+  EXPECT_EQ(batch.size(), 2);
+  MP_ASSERT_OK(graph.CloseInputStream("input_numbers"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+}
+
 // Captures log messages during testing.
 class TextMessageLogSink : public LogSink {
  public:
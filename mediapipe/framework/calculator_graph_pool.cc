@@ -0,0 +1,252 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph_pool.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+#include "mediapipe/framework/tool/validate_name.h"
+#include "mediapipe/framework/validated_graph_config.h"
+
+namespace mediapipe {
+
+namespace {
+
+// Returns the stream names of "tag_index_names", e.g. the graph input streams.
+absl::StatusOr<std::vector<std::string>> StreamNames(
+    const proto_ns::RepeatedPtrField<ProtoString>& tag_index_names) {
+  std::vector<std::string> names;
+  for (const auto& tag_index_name : tag_index_names) {
+    std::string tag;
+    int index;
+    std::string name;
+    MP_RETURN_IF_ERROR(
+        tool::ParseTagIndexName(tag_index_name, &tag, &index, &name));
+    names.push_back(std::move(name));
+  }
+  return names;
+}
+
+}  // namespace
+
+// static
+absl::StatusOr<std::unique_ptr<CalculatorGraphPool>>
+CalculatorGraphPool::Create(const CalculatorGraphConfig& config,
+                            int num_graphs,
+                            const std::map<std::string, Packet>& side_packets) {
+  RET_CHECK_GT(num_graphs, 0);
+
+  // Validates the config once, to decide how the graphs are restarted.
+  ValidatedGraphConfig validated_config;
+  MP_RETURN_IF_ERROR(validated_config.Initialize(config));
+  bool has_source_nodes = false;
+  bool all_stateless = true;
+  for (const NodeTypeInfo& node : validated_config.CalculatorInfos()) {
+    has_source_nodes |= node.Contract().Inputs().NumEntries() == 0;
+    all_stateless &= node.Contract().IsStateless();
+  }
+  const bool warm_restart = !validated_config.CalculatorInfos().empty() &&
+                            all_stateless && !has_source_nodes;
+
+  auto pool = absl::WrapUnique(
+      new CalculatorGraphPool(side_packets, warm_restart, has_source_nodes));
+  ASSIGN_OR_RETURN(pool->input_stream_names_,
+                   StreamNames(validated_config.Config().input_stream()));
+  ASSIGN_OR_RETURN(pool->output_stream_names_,
+                   StreamNames(validated_config.Config().output_stream()));
+  pool->restart_pool_ =
+      absl::make_unique<ThreadPool>("graph_pool_restart", num_graphs);
+  pool->restart_pool_->StartWorkers();
+  for (int i = 0; i < num_graphs; ++i) {
+    pool->graphs_.push_back(absl::make_unique<PooledGraph>());
+    PooledGraph* pooled_graph = pool->graphs_.back().get();
+    {
+      absl::MutexLock lock(&pool->mutex_);
+      pool->idle_graphs_.push_back(pooled_graph);
+    }
+    MP_RETURN_IF_ERROR(pool->InitializeGraph(config, pooled_graph));
+    MP_RETURN_IF_ERROR(pooled_graph->start_status);
+  }
+  return pool;
+}
+
+CalculatorGraphPool::CalculatorGraphPool(
+    const std::map<std::string, Packet>& side_packets, bool warm_restart,
+    bool has_source_nodes)
+    : side_packets_(side_packets),
+      warm_restart_(warm_restart),
+      has_source_nodes_(has_source_nodes) {}
+
+CalculatorGraphPool::~CalculatorGraphPool() {
+  {
+    absl::MutexLock lock(&mutex_);
+    mutex_.Await(absl::Condition(this, &CalculatorGraphPool::AllGraphsIdle));
+  }
+  for (auto& pooled_graph : graphs_) {
+    if (!pooled_graph->running) continue;
+    absl::Status status = pooled_graph->graph.CloseAllPacketSources();
+    status.Update(pooled_graph->graph.WaitUntilDone());
+    LOG_IF(WARNING, !status.ok())
+        << "Closing a pooled graph failed: " << status;
+  }
+}
+
+absl::Status CalculatorGraphPool::InitializeGraph(
+    const CalculatorGraphConfig& config, PooledGraph* pooled_graph) {
+  CalculatorGraph& graph = pooled_graph->graph;
+  MP_RETURN_IF_ERROR(graph.Initialize(config));
+  for (const std::string& name : input_stream_names_) {
+    ASSIGN_OR_RETURN(CalculatorGraph::GraphInputStreamHandle stream,
+                     graph.GetInputStreamHandle(name));
+    pooled_graph->input_streams.push_back(stream);
+  }
+  for (const std::string& name : output_stream_names_) {
+    MP_RETURN_IF_ERROR(graph.ObserveOutputStream(
+        name,
+        [this, pooled_graph, name](const Packet& packet) {
+          absl::MutexLock lock(&pooled_graph->outputs_mutex);
+          if (warm_restart_ &&
+              packet.Timestamp() >= pooled_graph->request_timestamp) {
+            pooled_graph->settled_outputs.insert(name);
+          }
+          if (!packet.IsEmpty() &&
+              (!warm_restart_ ||
+               packet.Timestamp() == pooled_graph->request_timestamp)) {
+            pooled_graph->outputs[name] = packet;
+          }
+          return absl::OkStatus();
+        },
+        /*observe_timestamp_bounds=*/warm_restart_));
+  }
+  return StartGraph(pooled_graph);
+}
+
+absl::Status CalculatorGraphPool::StartGraph(PooledGraph* pooled_graph) {
+  CalculatorGraph& graph = pooled_graph->graph;
+  absl::Status status = graph.StartRun(side_packets_);
+  pooled_graph->running = status.ok();
+  pooled_graph->next_timestamp = 0;
+  if (status.ok() && !has_source_nodes_) {
+    // The calculators are opened by the scheduler. Waits for them, so that the
+    // request that takes the graph does not.
+    status = graph.WaitUntilIdle();
+  }
+  pooled_graph->start_status = status;
+  return status;
+}
+
+absl::StatusOr<std::map<std::string, Packet>> CalculatorGraphPool::Process(
+    const std::map<std::string, Packet>& inputs) {
+  bool has_all_inputs = inputs.size() == input_stream_names_.size();
+  for (const std::string& name : input_stream_names_) {
+    has_all_inputs = has_all_inputs && inputs.count(name) > 0;
+  }
+  if (!has_all_inputs) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("A request needs a packet for each of the graph input "
+                     "streams, and no others: ",
+                     absl::StrJoin(input_stream_names_, ", ")));
+  }
+
+  PooledGraph* pooled_graph = AcquireGraph();
+  absl::Status status = pooled_graph->start_status;
+  if (status.ok()) {
+    status = ProcessOnGraph(inputs, pooled_graph);
+  }
+  std::map<std::string, Packet> outputs;
+  {
+    absl::MutexLock lock(&pooled_graph->outputs_mutex);
+    outputs.swap(pooled_graph->outputs);
+  }
+  if (warm_restart_ && status.ok()) {
+    ReleaseGraph(pooled_graph);
+  } else {
+    restart_pool_->Schedule(
+        [this, pooled_graph]() { RestartGraph(pooled_graph); });
+  }
+  MP_RETURN_IF_ERROR(status);
+  return outputs;
+}
+
+absl::Status CalculatorGraphPool::ProcessOnGraph(
+    const std::map<std::string, Packet>& inputs, PooledGraph* pooled_graph) {
+  const Timestamp timestamp(pooled_graph->next_timestamp++);
+  {
+    absl::MutexLock lock(&pooled_graph->outputs_mutex);
+    pooled_graph->request_timestamp = timestamp;
+    pooled_graph->outputs.clear();
+    pooled_graph->settled_outputs.clear();
+  }
+  CalculatorGraph& graph = pooled_graph->graph;
+  for (size_t i = 0; i < input_stream_names_.size(); ++i) {
+    MP_RETURN_IF_ERROR(graph.AddPacketToInputStream(
+        pooled_graph->input_streams[i],
+        inputs.at(input_stream_names_[i]).At(timestamp)));
+  }
+  if (warm_restart_) {
+    MP_RETURN_IF_ERROR(graph.WaitUntilIdle());
+    absl::MutexLock lock(&pooled_graph->outputs_mutex);
+    for (const std::string& name : output_stream_names_) {
+      if (pooled_graph->settled_outputs.count(name) == 0) {
+        return absl::FailedPreconditionError(absl::StrCat(
+            "The graph became idle before the graph output stream \"", name,
+            "\" was done with the request. A calculator of the graph may keep "
+            "packets across timestamps despite declaring that it is "
+            "stateless."));
+      }
+    }
+    return absl::OkStatus();
+  }
+  MP_RETURN_IF_ERROR(graph.CloseAllPacketSources());
+  absl::Status status = graph.WaitUntilDone();
+  pooled_graph->running = false;
+  return status;
+}
+
+CalculatorGraphPool::PooledGraph* CalculatorGraphPool::AcquireGraph() {
+  absl::MutexLock lock(&mutex_);
+  mutex_.Await(absl::Condition(this, &CalculatorGraphPool::HasIdleGraph));
+  // The most recently used graph is taken first, since its memory is the most
+  // likely to be still cached.
+  PooledGraph* pooled_graph = idle_graphs_.back();
+  idle_graphs_.pop_back();
+  return pooled_graph;
+}
+
+void CalculatorGraphPool::ReleaseGraph(PooledGraph* pooled_graph) {
+  absl::MutexLock lock(&mutex_);
+  idle_graphs_.push_back(pooled_graph);
+}
+
+void CalculatorGraphPool::RestartGraph(PooledGraph* pooled_graph) {
+  CalculatorGraph& graph = pooled_graph->graph;
+  if (pooled_graph->running) {
+    // The run failed while it was kept going. It is ended before the next one
+    // is started.
+    graph.CloseAllPacketSources().IgnoreError();
+    graph.WaitUntilDone().IgnoreError();
+    pooled_graph->running = false;
+  }
+  absl::Status status = StartGraph(pooled_graph);
+  LOG_IF(ERROR, !status.ok()) << "Restarting a pooled graph failed: " << status;
+  ReleaseGraph(pooled_graph);
+}
+
+}  // namespace mediapipe
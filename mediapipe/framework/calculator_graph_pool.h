@@ -0,0 +1,173 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_graph.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/port/threadpool.h"
+#include "mediapipe/framework/timestamp.h"
+
+namespace mediapipe {
+
+// A pool of running CalculatorGraphs of the same config, to serve independent
+// requests, e.g. still images, with a graph per request but without the
+// latency of setting up a graph for each request.
+//
+// The graphs are initialized and started when the pool is created, so their
+// calculators are opened, and their models loaded, before the first request.
+// Process() takes an idle graph, sends the request packets to the graph input
+// streams at the next timestamp of that graph, and returns the last packet of
+// each graph output stream. Concurrent Process() calls run on different graphs
+// and wait for one to become idle when all are busy.
+//
+// How a graph is made ready for the next request depends on its calculators:
+// * Warm restart: if every calculator declares that it is stateless, see
+//   CalculatorContract::SetStateless(), and no node is a source node, the
+//   graph run is kept going from one request to the next. Each request is a
+//   new timestamp of the same run, which is complete once the graph is idle,
+//   and no calculator is closed and reopened between requests. A request
+//   fails if the graph becomes idle while a graph output stream has neither
+//   output a packet at the request timestamp nor advanced its timestamp bound
+//   past it, e.g. because a calculator holds the request's packets back, and
+//   the graph is then restarted.
+// * Otherwise, each request is a whole graph run: Process() closes the graph
+//   input streams and waits until the run is done, so the outputs of the
+//   calculators' Close() are included. The pool then starts the next run of
+//   the graph, and so reopens its calculators, in the background, before the
+//   graph can be taken by another request.
+//
+// A graph whose run fails is restarted in the background as well.
+//
+// Example:
+//   ASSIGN_OR_RETURN(std::unique_ptr<CalculatorGraphPool> pool,
+//                    CalculatorGraphPool::Create(config, /*num_graphs=*/4));
+//   ASSIGN_OR_RETURN(auto outputs,
+//                    pool->Process({{"image", MakePacket<ImageFrame>(...)}}));
+//   const auto& detections =
+//       outputs["detections"].Get<std::vector<Detection>>();
+class CalculatorGraphPool {
+ public:
+  // Creates a pool of "num_graphs" graphs of "config", and starts them with
+  // the input side packets "side_packets", which are used for every run.
+  static absl::StatusOr<std::unique_ptr<CalculatorGraphPool>> Create(
+      const CalculatorGraphConfig& config, int num_graphs,
+      const std::map<std::string, Packet>& side_packets = {});
+
+  CalculatorGraphPool(const CalculatorGraphPool&) = delete;
+  CalculatorGraphPool& operator=(const CalculatorGraphPool&) = delete;
+
+  // Waits for the running requests and background restarts, then closes the
+  // graphs.
+  ~CalculatorGraphPool();
+
+  // Sends "inputs", a packet for every graph input stream by stream name, to
+  // an idle graph, and returns the last packet of each graph output stream
+  // that has output a packet for the request, by stream name. The timestamps
+  // of the input packets are replaced by the request timestamp. With warm
+  // restart, only output packets at the request timestamp are returned.
+  absl::StatusOr<std::map<std::string, Packet>> Process(
+      const std::map<std::string, Packet>& inputs);
+
+  // Returns true if the graph runs are kept going from one request to the
+  // next. See the class comment.
+  bool WarmRestart() const { return warm_restart_; }
+
+  int NumGraphs() const { return graphs_.size(); }
+
+ private:
+  // A graph of the pool, with the graph input and output streams.
+  struct PooledGraph {
+    CalculatorGraph graph;
+    std::vector<CalculatorGraph::GraphInputStreamHandle> input_streams;
+    // The status of the last start of a run of the graph, and whether the run
+    // is still going.
+    absl::Status start_status;
+    bool running = false;
+    // The timestamp of the next request in the current run.
+    int64 next_timestamp = 0;
+
+    absl::Mutex outputs_mutex;
+    // The timestamp of the current request, the last packets output for it,
+    // by graph output stream, and the graph output streams that are done with
+    // it, i.e. that have output a packet or advanced their timestamp bound
+    // past it.
+    Timestamp request_timestamp ABSL_GUARDED_BY(outputs_mutex);
+    std::map<std::string, Packet> outputs ABSL_GUARDED_BY(outputs_mutex);
+    std::set<std::string> settled_outputs ABSL_GUARDED_BY(outputs_mutex);
+  };
+
+  CalculatorGraphPool(const std::map<std::string, Packet>& side_packets,
+                      bool warm_restart, bool has_source_nodes);
+
+  // Initializes and starts a graph.
+  absl::Status InitializeGraph(const CalculatorGraphConfig& config,
+                               PooledGraph* pooled_graph);
+
+  // Starts the next run of a graph, and waits until its calculators are open,
+  // unless the graph has source nodes, which keep it busy.
+  absl::Status StartGraph(PooledGraph* pooled_graph);
+
+  // Sends the request to the graph, and waits until the graph is done with it.
+  absl::Status ProcessOnGraph(const std::map<std::string, Packet>& inputs,
+                              PooledGraph* pooled_graph);
+
+  // Waits until a graph is idle and takes it.
+  PooledGraph* AcquireGraph() ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Makes a graph taken by AcquireGraph() available again.
+  void ReleaseGraph(PooledGraph* pooled_graph) ABSL_LOCKS_EXCLUDED(mutex_);
+
+  // Ends the current run of the graph, if any, and starts the next one, then
+  // releases the graph.
+  void RestartGraph(PooledGraph* pooled_graph);
+
+  bool HasIdleGraph() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return !idle_graphs_.empty();
+  }
+  bool AllGraphsIdle() const ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_) {
+    return idle_graphs_.size() == graphs_.size();
+  }
+
+  const std::map<std::string, Packet> side_packets_;
+  const bool warm_restart_;
+  const bool has_source_nodes_;
+  std::vector<std::string> input_stream_names_;
+  std::vector<std::string> output_stream_names_;
+  std::vector<std::unique_ptr<PooledGraph>> graphs_;
+
+  mutable absl::Mutex mutex_;
+  std::vector<PooledGraph*> idle_graphs_ ABSL_GUARDED_BY(mutex_);
+
+  // Runs RestartGraph() in the background. Destroyed first, so that it waits
+  // for the scheduled restarts before the graphs are destroyed.
+  std::unique_ptr<ThreadPool> restart_pool_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_CALCULATOR_GRAPH_POOL_H_
@@ -0,0 +1,287 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/calculator_graph_pool.h"
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/port/threadpool.h"
+
+namespace mediapipe {
+namespace {
+
+// Adds one to its input, and fails on negative inputs. Counts how many times
+// the calculators of this type are opened and closed.
+class AddOneCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    ++num_opened_;
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    const int value = cc->Inputs().Index(0).Get<int>();
+    RET_CHECK_GE(value, 0);
+    cc->Outputs().Index(0).AddPacket(
+        MakePacket<int>(value + 1).At(cc->InputTimestamp()));
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    ++num_closed_;
+    return absl::OkStatus();
+  }
+
+  static std::atomic<int> num_opened_;
+  static std::atomic<int> num_closed_;
+};
+std::atomic<int> AddOneCalculator::num_opened_(0);
+std::atomic<int> AddOneCalculator::num_closed_(0);
+
+REGISTER_CALCULATOR(AddOneCalculator);
+
+// An AddOneCalculator that declares that it is stateless.
+class StatelessAddOneCalculator : public AddOneCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    MP_RETURN_IF_ERROR(AddOneCalculator::GetContract(cc));
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_CALCULATOR(StatelessAddOneCalculator);
+
+// Passes even values through, and drops odd ones. Sets the timestamp offset,
+// so that the timestamp bound of its output advances past dropped values.
+class StatelessEvenFilterCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetTimestampOffset(0);
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (cc->Inputs().Index(0).Get<int>() % 2 == 0) {
+      cc->Outputs().Index(0).AddPacket(cc->Inputs().Index(0).Value());
+    }
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_CALCULATOR(StatelessEvenFilterCalculator);
+
+// Outputs each input packet when the next one arrives, and the last one in
+// Close(), although it declares that it is stateless.
+class HoldingCalculator : public AddOneCalculator {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    MP_RETURN_IF_ERROR(AddOneCalculator::GetContract(cc));
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    if (!held_.IsEmpty()) {
+      cc->Outputs().Index(0).AddPacket(held_);
+    }
+    held_ = cc->Inputs().Index(0).Value();
+    return absl::OkStatus();
+  }
+
+  absl::Status Close(CalculatorContext* cc) override {
+    if (!held_.IsEmpty()) {
+      cc->Outputs().Index(0).AddPacket(held_);
+    }
+    return AddOneCalculator::Close(cc);
+  }
+
+ private:
+  Packet held_;
+};
+
+REGISTER_CALCULATOR(HoldingCalculator);
+
+// Returns a graph in which "calculator" adds one to the graph input stream.
+CalculatorGraphConfig AddOneConfig(const std::string& calculator) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        output_stream: "out"
+        node { input_stream: "in" output_stream: "out" }
+      )pb");
+  config.mutable_node(0)->set_calculator(calculator);
+  return config;
+}
+
+// Sends "value" to the pool and returns the output.
+int ProcessValue(CalculatorGraphPool* pool, int value) {
+  auto outputs = pool->Process({{"in", MakePacket<int>(value)}});
+  CHECK(outputs.ok()) << outputs.status();
+  CHECK_EQ(outputs->count("out"), 1);
+  return outputs->at("out").Get<int>();
+}
+
+class CalculatorGraphPoolTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    AddOneCalculator::num_opened_ = 0;
+    AddOneCalculator::num_closed_ = 0;
+  }
+};
+
+TEST_F(CalculatorGraphPoolTest, WarmRestartKeepsCalculatorsOpen) {
+  auto pool_or =
+      CalculatorGraphPool::Create(AddOneConfig("StatelessAddOneCalculator"),
+                                  /*num_graphs=*/2);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  EXPECT_TRUE(pool->WarmRestart());
+  EXPECT_EQ(pool->NumGraphs(), 2);
+  EXPECT_EQ(AddOneCalculator::num_opened_, 2);
+
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(ProcessValue(pool.get(), i), i + 1);
+  }
+  EXPECT_EQ(AddOneCalculator::num_opened_, 2);
+  EXPECT_EQ(AddOneCalculator::num_closed_, 0);
+
+  pool.reset();
+  EXPECT_EQ(AddOneCalculator::num_closed_, 2);
+}
+
+TEST_F(CalculatorGraphPoolTest, ColdRestartReopensCalculators) {
+  auto pool_or = CalculatorGraphPool::Create(AddOneConfig("AddOneCalculator"),
+                                             /*num_graphs=*/1);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  EXPECT_FALSE(pool->WarmRestart());
+
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(ProcessValue(pool.get(), i), i + 1);
+  }
+
+  // Every request ran a whole graph run, and the run after the last request
+  // is closed with the pool.
+  pool.reset();
+  EXPECT_EQ(AddOneCalculator::num_opened_, 6);
+  EXPECT_EQ(AddOneCalculator::num_closed_, 6);
+}
+
+TEST_F(CalculatorGraphPoolTest, RejectsMissingInputs) {
+  auto pool_or =
+      CalculatorGraphPool::Create(AddOneConfig("StatelessAddOneCalculator"),
+                                  /*num_graphs=*/1);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  EXPECT_EQ(pool->Process({}).status().code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(pool->Process({{"in", MakePacket<int>(1)},
+                           {"other", MakePacket<int>(2)}})
+                .status()
+                .code(),
+            absl::StatusCode::kInvalidArgument);
+  EXPECT_EQ(ProcessValue(pool.get(), 1), 2);
+}
+
+TEST_F(CalculatorGraphPoolTest, RestartsGraphAfterFailedRequest) {
+  auto pool_or =
+      CalculatorGraphPool::Create(AddOneConfig("StatelessAddOneCalculator"),
+                                  /*num_graphs=*/1);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  EXPECT_EQ(ProcessValue(pool.get(), 1), 2);
+  EXPECT_FALSE(pool->Process({{"in", MakePacket<int>(-1)}}).ok());
+  EXPECT_EQ(ProcessValue(pool.get(), 2), 3);
+  EXPECT_EQ(AddOneCalculator::num_opened_, 2);
+}
+
+// With warm restart, a request succeeds without an output packet once the
+// timestamp bound of the output stream has passed the request.
+TEST_F(CalculatorGraphPoolTest, WarmRestartAcceptsSettledEmptyOutput) {
+  auto pool_or = CalculatorGraphPool::Create(
+      AddOneConfig("StatelessEvenFilterCalculator"), /*num_graphs=*/1);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  ASSERT_TRUE(pool->WarmRestart());
+  for (int i = 0; i < 4; ++i) {
+    auto outputs = pool->Process({{"in", MakePacket<int>(i)}});
+    MP_ASSERT_OK(outputs);
+    if (i % 2 == 0) {
+      ASSERT_EQ(outputs->count("out"), 1);
+      EXPECT_EQ(outputs->at("out").Get<int>(), i);
+    } else {
+      EXPECT_EQ(outputs->count("out"), 0);
+    }
+  }
+}
+
+// With warm restart, a request fails if a calculator holds its packets back
+// past the time the graph becomes idle, and the graph is restarted.
+TEST_F(CalculatorGraphPoolTest, WarmRestartRejectsHeldBackOutput) {
+  auto pool_or = CalculatorGraphPool::Create(AddOneConfig("HoldingCalculator"),
+                                             /*num_graphs=*/1);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  ASSERT_TRUE(pool->WarmRestart());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(pool->Process({{"in", MakePacket<int>(i)}}).status().code(),
+              absl::StatusCode::kFailedPrecondition);
+  }
+  pool.reset();
+  EXPECT_EQ(AddOneCalculator::num_opened_, 4);
+  EXPECT_EQ(AddOneCalculator::num_closed_, 4);
+}
+
+TEST_F(CalculatorGraphPoolTest, ServesConcurrentRequests) {
+  constexpr int kNumRequests = 100;
+  auto pool_or =
+      CalculatorGraphPool::Create(AddOneConfig("StatelessAddOneCalculator"),
+                                  /*num_graphs=*/3);
+  MP_ASSERT_OK(pool_or);
+  std::unique_ptr<CalculatorGraphPool> pool = std::move(pool_or).value();
+  std::atomic<int> num_correct(0);
+  {
+    ThreadPool clients("clients", 8);
+    clients.StartWorkers();
+    for (int i = 0; i < kNumRequests; ++i) {
+      clients.Schedule([&pool, &num_correct, i]() {
+        if (ProcessValue(pool.get(), i) == i + 1) ++num_correct;
+      });
+    }
+  }
+  EXPECT_EQ(num_correct, kNumRequests);
+  EXPECT_EQ(AddOneCalculator::num_opened_, 3);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -1580,6 +1580,143 @@ TEST(CalculatorGraph, RunsCorrectlyWithMultipleExecutors) {
   RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
 }
 
+TEST(CalculatorGraph, RunsCorrectlyWithWorkStealingExecutor) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig proto = GetConfig();
+  ExecutorConfig* executor = proto.add_executor();
+  ThreadPoolExecutorOptions* extension =
+      executor->mutable_options()->MutableExtension(
+          ThreadPoolExecutorOptions::ext);
+  extension->set_num_threads(4);
+  extension->set_queue_type(ThreadPoolExecutorOptions::WORK_STEALING);
+  RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
+}
+
+TEST(CalculatorGraph, RunsCorrectlyWithBatchedNodeTasks) {
+  CalculatorGraph graph;
+  CalculatorGraphConfig proto = GetConfig();
+  ExecutorConfig* executor = proto.add_executor();
+  executor->set_max_nodes_per_task(4);
+  executor->mutable_options()
+      ->MutableExtension(ThreadPoolExecutorOptions::ext)
+      ->set_num_threads(2);
+  RunComprehensiveTest(&graph, proto, /*define_node_5=*/true);
+}
+
+// A chain of cheap nodes run in batches delivers every packet in order.
+TEST(CalculatorGraph, BatchedNodeTasksPreserveOrder) {
+  CalculatorGraphConfig config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: 'in'
+        executor {
+          max_nodes_per_task: 8
+          options {
+            [mediapipe.ThreadPoolExecutorOptions.ext] { num_threads: 2 }
+          }
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'in'
+          output_stream: 'a'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'a'
+          output_stream: 'b'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'b'
+          output_stream: 'c'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'c'
+          output_stream: 'd'
+        }
+        node {
+          calculator: 'PassThroughCalculator'
+          input_stream: 'd'
+          output_stream: 'out'
+        }
+      )pb");
+  std::vector<Packet> out_packets;
+  tool::AddVectorSink("out", &config, &out_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.StartRun({}));
+  constexpr int kNumPackets = 200;
+  for (int i = 0; i < kNumPackets; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  ASSERT_EQ(kNumPackets, out_packets.size());
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(i, out_packets[i].Get<int>());
+    EXPECT_EQ(Timestamp(i), out_packets[i].Timestamp());
+  }
+}
+
+// Runs tasks on the current thread like CurrentThreadExecutor, and counts the
+// tasks that the scheduler queue adds.
+class CountingExecutor : public CurrentThreadExecutor {
+ public:
+  void AddTask(TaskQueue* task_queue) override {
+    ++num_tasks_;
+    CurrentThreadExecutor::AddTask(task_queue);
+  }
+
+  int num_tasks() const { return num_tasks_; }
+
+ private:
+  int num_tasks_ = 0;
+};
+
+// A task keeps running the nodes of a chain as they become ready, so a packet
+// passes through the chain with one executor task per max_nodes_per_task
+// nodes.
+TEST(CalculatorGraph, BatchedNodeTasksRunNewlyReadyNodes) {
+  constexpr int kNumNodes = 8;
+  constexpr int kNumPackets = 3;
+  for (int max_nodes_per_task : {1, 3, 4, 8}) {
+    CalculatorGraphConfig config;
+    config.add_input_stream("s0");
+    config.add_executor()->set_max_nodes_per_task(max_nodes_per_task);
+    for (int i = 0; i < kNumNodes; ++i) {
+      CalculatorGraphConfig::Node* node = config.add_node();
+      node->set_calculator("PassThroughCalculator");
+      node->add_input_stream(absl::StrCat("s", i));
+      node->add_output_stream(absl::StrCat("s", i + 1));
+    }
+    auto executor = std::make_shared<CountingExecutor>();
+    CalculatorGraph graph;
+    MP_ASSERT_OK(graph.SetExecutor("", executor));
+    MP_ASSERT_OK(graph.Initialize(config));
+    std::vector<Packet> out_packets;
+    MP_ASSERT_OK(graph.ObserveOutputStream(
+        absl::StrCat("s", kNumNodes), [&out_packets](const Packet& packet) {
+          out_packets.push_back(packet);
+          return absl::OkStatus();
+        }));
+    MP_ASSERT_OK(graph.StartRun({}));
+    for (int i = 0; i < kNumPackets; ++i) {
+      const int num_tasks_before = executor->num_tasks();
+      // CurrentThreadExecutor runs the graph until it is idle.
+      MP_ASSERT_OK(graph.AddPacketToInputStream(
+          "s0", MakePacket<int>(i).At(Timestamp(i))));
+      EXPECT_EQ(executor->num_tasks() - num_tasks_before,
+                (kNumNodes + max_nodes_per_task - 1) / max_nodes_per_task)
+          << "max_nodes_per_task: " << max_nodes_per_task;
+      ASSERT_EQ(out_packets.size(), i + 1);
+      EXPECT_EQ(out_packets.back().Get<int>(), i);
+    }
+    MP_ASSERT_OK(graph.CloseAllInputStreams());
+    MP_ASSERT_OK(graph.WaitUntilDone());
+  }
+}
+
 // Packet generator for an arbitrary unit64 packet.
 class Uint64PacketGenerator : public PacketGenerator {
  public:
@@ -0,0 +1,157 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures how many packets per second the framework moves through chains and
+// fan-outs of PassThroughCalculators, i.e. the per-packet cost of the output
+// streams, input stream handlers and input stream queues, and of scheduling.
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/status_matchers.h"
+#include "mediapipe/framework/tool/sink.h"
+
+namespace mediapipe {
+namespace {
+
+// The number of packets the source sends in each graph run.
+constexpr int kPacketsPerRun = 1000;
+
+// Returns a graph with a CountingSourceCalculator, which sends MAX_COUNT
+// batches of BATCH_SIZE packets to the stream "source".
+CalculatorGraphConfig SourceConfig() {
+  CalculatorGraphConfig config;
+  CalculatorGraphConfig::Node* source = config.add_node();
+  source->set_calculator("CountingSourceCalculator");
+  source->add_output_stream("source");
+  source->add_input_side_packet("MAX_COUNT:max_count");
+  source->add_input_side_packet("BATCH_SIZE:batch_size");
+  return config;
+}
+
+// Returns a graph in which the source packets go through a chain of "depth"
+// PassThroughCalculators. The last stream is "chain_<depth>".
+CalculatorGraphConfig ChainConfig(int depth) {
+  CalculatorGraphConfig config = SourceConfig();
+  std::string input = "source";
+  for (int i = 1; i <= depth; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream(input);
+    input = absl::StrCat("chain_", i);
+    node->add_output_stream(input);
+  }
+  return config;
+}
+
+// Returns a graph in which the source packets go to "width"
+// PassThroughCalculators. Their streams are "fan_out_1" to "fan_out_<width>".
+CalculatorGraphConfig FanOutConfig(int width) {
+  CalculatorGraphConfig config = SourceConfig();
+  for (int i = 1; i <= width; ++i) {
+    CalculatorGraphConfig::Node* node = config.add_node();
+    node->set_calculator("PassThroughCalculator");
+    node->add_input_stream("source");
+    node->add_output_stream(absl::StrCat("fan_out_", i));
+  }
+  return config;
+}
+
+std::map<std::string, Packet> SourceSidePackets(int batch_size) {
+  return {{"max_count", MakePacket<int>(kPacketsPerRun / batch_size)},
+          {"batch_size", MakePacket<int>(batch_size)}};
+}
+
+TEST(CalculatorGraphThroughputTest, ChainDeliversAllPackets) {
+  CalculatorGraphConfig config = ChainConfig(4);
+  std::vector<Packet> output_packets;
+  tool::AddVectorSink("chain_4", &config, &output_packets);
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  for (int run = 0; run < 2; ++run) {
+    output_packets.clear();
+    MP_ASSERT_OK(graph.Run(SourceSidePackets(/*batch_size=*/10)));
+    ASSERT_EQ(output_packets.size(), kPacketsPerRun);
+    for (int i = 0; i < kPacketsPerRun; ++i) {
+      EXPECT_EQ(output_packets[i].Get<int>(), i);
+      EXPECT_EQ(output_packets[i].Timestamp(), Timestamp(i));
+    }
+  }
+}
+
+TEST(CalculatorGraphThroughputTest, FanOutDeliversAllPackets) {
+  CalculatorGraphConfig config = FanOutConfig(3);
+  std::vector<Packet> output_packets[3];
+  for (int i = 0; i < 3; ++i) {
+    tool::AddVectorSink(absl::StrCat("fan_out_", i + 1), &config,
+                        &output_packets[i]);
+  }
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  MP_ASSERT_OK(graph.Run(SourceSidePackets(/*batch_size=*/1)));
+  for (int i = 0; i < 3; ++i) {
+    ASSERT_EQ(output_packets[i].size(), kPacketsPerRun);
+    EXPECT_EQ(output_packets[i].back().Get<int>(), kPacketsPerRun - 1);
+  }
+}
+
+// Runs the graph once per iteration, and reports the packets received by the
+// "num_consumers" PassThroughCalculators per second.
+void RunGraphBenchmark(benchmark::State& state,
+                       const CalculatorGraphConfig& config, int num_consumers,
+                       int batch_size) {
+  CalculatorGraph graph;
+  CHECK(graph.Initialize(config).ok());
+  const std::map<std::string, Packet> side_packets =
+      SourceSidePackets(batch_size);
+  for (auto _ : state) {
+    CHECK(graph.Run(side_packets).ok());
+  }
+  state.SetItemsProcessed(state.iterations() * kPacketsPerRun *
+                          num_consumers);
+}
+
+// Arguments: the chain depth, and the source batch size.
+void BM_Chain(benchmark::State& state) {
+  RunGraphBenchmark(state, ChainConfig(state.range(0)), state.range(0),
+                    state.range(1));
+}
+BENCHMARK(BM_Chain)
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Args({16, 1})
+    ->Args({4, 10})
+    ->UseRealTime();
+
+// Arguments: the fan-out width, and the source batch size.
+void BM_FanOut(benchmark::State& state) {
+  RunGraphBenchmark(state, FanOutConfig(state.range(0)), state.range(0),
+                    state.range(1));
+}
+BENCHMARK(BM_FanOut)
+    ->Args({1, 1})
+    ->Args({4, 1})
+    ->Args({16, 1})
+    ->Args({4, 10})
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
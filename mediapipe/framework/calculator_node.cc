@@ -201,6 +201,15 @@ absl::Status CalculatorNode::Initialize(
   input_stream_handler_->SetProcessTimestampBounds(
       contract.GetProcessTimestampBounds());
 
+  if (max_in_flight_ > 1 && contract.IsStateless() &&
+      node_type_info.InputStreamTypes().NumEntries() > 0) {
+    // Only calculator_ may set the output side packets in Open().
+    RET_CHECK_EQ(node_type_info.OutputSidePacketTypes().NumEntries(), 0)
+        << "Stateless calculator node \"" << name_
+        << "\" can't have output side packets with max_in_flight > 1.";
+    num_calculator_instances_ = max_in_flight_;
+  }
+
   return InitializeInputStreams(input_stream_managers, output_stream_managers);
 }
 
@@ -427,6 +436,19 @@ absl::Status CalculatorNode::PrepareForRun(
           validated_graph_->Package(), calculator_state_->CalculatorType()));
   calculator_ = calculator_factory->CreateCalculator(
       calculator_context_manager_.GetDefaultCalculatorContext());
+  calculator_replicas_.clear();
+  for (int i = 1; i < num_calculator_instances_; ++i) {
+    calculator_replicas_.push_back(calculator_factory->CreateCalculator(
+        calculator_context_manager_.GetDefaultCalculatorContext()));
+  }
+  {
+    absl::MutexLock lock(&idle_calculators_mutex_);
+    idle_calculators_.clear();
+    idle_calculators_.push_back(calculator_.get());
+    for (auto& replica : calculator_replicas_) {
+      idle_calculators_.push_back(replica.get());
+    }
+  }
 
   needs_to_close_ = false;
 
@@ -498,7 +520,18 @@ absl::Status CalculatorNode::OpenNode() {
   } else {
     MEDIAPIPE_PROFILING(OPEN, default_context);
     LegacyCalculatorSupport::Scoped<CalculatorContext> s(default_context);
-    result = calculator_->Open(default_context);
+    // The replicas are opened first, and whatever they output is dropped, so
+    // that only the outputs of calculator_->Open() are propagated.
+    for (auto& replica : calculator_replicas_) {
+      result = replica->Open(default_context);
+      output_stream_handler_->PrepareOutputs(Timestamp::Unstarted(), outputs);
+      if (!result.ok()) {
+        break;
+      }
+    }
+    if (result.ok()) {
+      result = calculator_->Open(default_context);
+    }
   }
 
   calculator_context_manager_.PopInputTimestampFromContext(default_context);
@@ -600,7 +633,18 @@ absl::Status CalculatorNode::CloseNode(const absl::Status& graph_status,
   } else {
     MEDIAPIPE_PROFILING(CLOSE, default_context);
     LegacyCalculatorSupport::Scoped<CalculatorContext> s(default_context);
-    result = calculator_->Close(default_context);
+    // As in OpenNode(), only the outputs of calculator_->Close() are kept.
+    for (auto& replica : calculator_replicas_) {
+      absl::Status replica_result = replica->Close(default_context);
+      output_stream_handler_->PrepareOutputs(Timestamp::Done(), outputs);
+      if (result.ok()) {
+        result = replica_result;
+      }
+    }
+    absl::Status calculator_result = calculator_->Close(default_context);
+    if (result.ok()) {
+      result = calculator_result;
+    }
   }
   needs_to_close_ = false;
 
@@ -636,6 +680,11 @@ void CalculatorNode::CleanupAfterRun(const absl::Status& graph_status) {
         Timestamp::Done());
     CloseNode(graph_status, /*graph_run_ended=*/true).IgnoreError();
   }
+  {
+    absl::MutexLock lock(&idle_calculators_mutex_);
+    idle_calculators_.clear();
+  }
+  calculator_replicas_.clear();
   calculator_ = nullptr;
   // All pending output packets are automatically dropped when calculator
   // context manager destroys all calculator context objects.
@@ -867,7 +916,9 @@ absl::Status CalculatorNode::ProcessNode(
           MEDIAPIPE_PROFILING(PROCESS, calculator_context);
           LegacyCalculatorSupport::Scoped<CalculatorContext> s(
               calculator_context);
-          result = calculator_->Process(calculator_context);
+          CalculatorBase* calculator = AcquireCalculator();
+          result = calculator->Process(calculator_context);
+          ReleaseCalculator(calculator);
         }
 
         VLOG(2) << "Called Calculator::Process() for node: " << DebugName()
@@ -910,6 +961,26 @@ absl::Status CalculatorNode::ProcessNode(
   }
 }
 
+CalculatorBase* CalculatorNode::AcquireCalculator() {
+  if (calculator_replicas_.empty()) {
+    return calculator_.get();
+  }
+  absl::MutexLock lock(&idle_calculators_mutex_);
+  // There are as many instances as invocations allowed in flight.
+  CHECK(!idle_calculators_.empty()) << DebugName();
+  CalculatorBase* calculator = idle_calculators_.back();
+  idle_calculators_.pop_back();
+  return calculator;
+}
+
+void CalculatorNode::ReleaseCalculator(CalculatorBase* calculator) {
+  if (calculator_replicas_.empty()) {
+    return;
+  }
+  absl::MutexLock lock(&idle_calculators_mutex_);
+  idle_calculators_.push_back(calculator);
+}
+
 void CalculatorNode::SetQueueSizeCallbacks(
     InputStreamManager::QueueSizeCallback becomes_full_callback,
     InputStreamManager::QueueSizeCallback becomes_not_full_callback) {
@@ -26,6 +26,7 @@
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
@@ -282,8 +283,27 @@ class CalculatorNode {
   // Returns true if all outputs will be identical to the previous graph run.
   bool OutputsAreConstant(CalculatorContext* cc);
 
+  // Returns a calculator instance that isn't running Process(), and gives it
+  // back once Process() returns. Only a stateless calculator run in parallel
+  // has more than one instance.
+  CalculatorBase* AcquireCalculator()
+      ABSL_LOCKS_EXCLUDED(idle_calculators_mutex_);
+  void ReleaseCalculator(CalculatorBase* calculator)
+      ABSL_LOCKS_EXCLUDED(idle_calculators_mutex_);
+
   // The calculator.
   std::unique_ptr<CalculatorBase> calculator_;
+  // For a stateless calculator with max_in_flight_ > 1, the additional
+  // calculator instances that parallel invocations run on. They are opened and
+  // closed along with calculator_, but their Open() and Close() outputs are
+  // discarded.
+  std::vector<std::unique_ptr<CalculatorBase>> calculator_replicas_;
+  // The number of calculator instances to create, including calculator_.
+  int num_calculator_instances_ = 1;
+  absl::Mutex idle_calculators_mutex_;
+  // The calculator instances that no invocation is running on.
+  std::vector<CalculatorBase*> idle_calculators_
+      ABSL_GUARDED_BY(idle_calculators_mutex_);
   // Keeps data which a Calculator subclass needs access to.
   std::unique_ptr<CalculatorState> calculator_state_;
 
@@ -19,6 +19,7 @@
 //
 // TODO: Add more tests to verify the correctness of parallel execution.
 
+#include <atomic>
 #include <memory>
 #include <random>
 #include <string>
@@ -77,6 +78,73 @@ class SlowPlusOneCalculator : public CalculatorBase {
 
 REGISTER_CALCULATOR(SlowPlusOneCalculator);
 
+// Adds one to its input after a random delay, and fails if two invocations of
+// Process() overlap on the same instance. Declared stateless, so that a node
+// with max_in_flight > 1 runs one instance per invocation in flight.
+class StatelessSlowPlusOneCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Open(CalculatorContext* cc) override {
+    ++num_opened_;
+    // Every instance sets the header, as calculators normally do in Open().
+    cc->Outputs().Index(0).SetHeader(MakePacket<int>(num_opened_));
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    RET_CHECK(!in_process_) << "Concurrent Process() calls on one instance.";
+    in_process_ = true;
+    const int in_flight = ++num_in_flight_;
+    int max_in_flight = max_in_flight_.load();
+    while (in_flight > max_in_flight &&
+           !max_in_flight_.compare_exchange_weak(max_in_flight, in_flight)) {
+    }
+    std::mt19937 random(cc->InputTimestamp().Value());
+    std::uniform_int_distribution<> uniform_dist(1, 30);
+    BusySleep(absl::Milliseconds(uniform_dist(random)));
+    cc->Outputs().Index(0).Add(new int(cc->Inputs().Index(0).Get<int>() + 1),
+                               cc->InputTimestamp());
+    --num_in_flight_;
+    in_process_ = false;
+    return absl::OkStatus();
+  }
+
+  static std::atomic<int> num_opened_;
+  static std::atomic<int> num_in_flight_;
+  static std::atomic<int> max_in_flight_;
+
+ private:
+  bool in_process_ = false;
+};
+std::atomic<int> StatelessSlowPlusOneCalculator::num_opened_(0);
+std::atomic<int> StatelessSlowPlusOneCalculator::num_in_flight_(0);
+std::atomic<int> StatelessSlowPlusOneCalculator::max_in_flight_(0);
+
+REGISTER_CALCULATOR(StatelessSlowPlusOneCalculator);
+
+class StatelessSidePacketCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc) {
+    cc->Inputs().Index(0).Set<int>();
+    cc->Outputs().Index(0).Set<int>();
+    cc->OutputSidePackets().Index(0).Set<int>();
+    cc->SetStateless(true);
+    return absl::OkStatus();
+  }
+
+  absl::Status Process(CalculatorContext* cc) override {
+    return absl::OkStatus();
+  }
+};
+
+REGISTER_CALCULATOR(StatelessSidePacketCalculator);
+
 class ParallelExecutionTest : public testing::Test {
  public:
   void AddThreadSafeVectorSink(const Packet& packet) {
@@ -153,5 +221,71 @@ TEST_F(ParallelExecutionTest, SlowPlusOneCalculatorsTest) {
   }
 }
 
+TEST_F(ParallelExecutionTest, StatelessCalculatorRunsOnSeparateInstances) {
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "StatelessSlowPlusOneCalculator"
+          input_stream: "input"
+          output_stream: "output"
+          max_in_flight: 4
+        }
+        node {
+          calculator: "CallbackCalculator"
+          input_stream: "output"
+          input_side_packet: "CALLBACK:callback"
+        }
+        num_threads: 4
+      )pb");
+  StatelessSlowPlusOneCalculator::num_opened_ = 0;
+  StatelessSlowPlusOneCalculator::max_in_flight_ = 0;
+
+  CalculatorGraph graph(graph_config);
+  MP_ASSERT_OK(graph.StartRun(
+      {{"callback", MakePacket<std::function<void(const Packet&)>>(std::bind(
+                        &ParallelExecutionTest::AddThreadSafeVectorSink, this,
+                        std::placeholders::_1))}}));
+  const int kTotalNums = 40;
+  for (int i = 0; i < kTotalNums; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "input", Adopt(new int(i)).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseInputStream("input"));
+  MP_ASSERT_OK(graph.WaitUntilDone());
+
+  EXPECT_EQ(StatelessSlowPlusOneCalculator::num_opened_, 4);
+  EXPECT_GT(StatelessSlowPlusOneCalculator::max_in_flight_, 1);
+  EXPECT_LE(StatelessSlowPlusOneCalculator::max_in_flight_, 4);
+  absl::ReaderMutexLock lock(&output_packets_mutex_);
+  ASSERT_EQ(kTotalNums, output_packets_.size());
+  for (int i = 0; i < kTotalNums; ++i) {
+    EXPECT_EQ(i + 1, output_packets_[i].Get<int>());
+    EXPECT_EQ(Timestamp(i), output_packets_[i].Timestamp());
+  }
+}
+
+TEST(ParallelExecutionConfigTest, StatelessCalculatorWithOutputSidePacket) {
+  CalculatorGraphConfig graph_config =
+      mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "input"
+        node {
+          calculator: "StatelessSidePacketCalculator"
+          input_stream: "input"
+          output_stream: "output"
+          output_side_packet: "side_output"
+          max_in_flight: 2
+        }
+      )pb");
+  CalculatorGraph graph;
+  absl::Status status = graph.Initialize(graph_config);
+  EXPECT_THAT(status.message(),
+              testing::HasSubstr("can't have output side packets"));
+
+  graph_config.mutable_node(0)->set_max_in_flight(1);
+  CalculatorGraph sequential_graph;
+  MP_EXPECT_OK(sequential_graph.Initialize(graph_config));
+}
+
 }  // namespace
 }  // namespace mediapipe
@@ -0,0 +1,159 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
+
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+
+namespace mediapipe {
+
+namespace {
+
+// Identifies the pool and worker slot of the current thread, if it is a
+// WorkStealingThreadPool worker.
+struct CurrentWorker {
+  const WorkStealingThreadPool* pool = nullptr;
+  int index = -1;
+};
+
+thread_local CurrentWorker current_worker;
+
+// Number of failed rounds over all queues before a worker goes to sleep.
+constexpr int kSpinRounds = 64;
+
+}  // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(int num_threads)
+    : threads_(std::make_unique<ThreadPool>(num_threads)) {}
+
+WorkStealingThreadPool::WorkStealingThreadPool(const std::string& name_prefix,
+                                               int num_threads)
+    : threads_(std::make_unique<ThreadPool>(name_prefix, num_threads)) {}
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    const ThreadOptions& thread_options, const std::string& name_prefix,
+    int num_threads)
+    : threads_(std::make_unique<ThreadPool>(thread_options, name_prefix,
+                                            num_threads)) {}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    absl::MutexLock lock(&sleep_mutex_);
+    stopped_.store(true);
+    sleep_condition_.SignalAll();
+  }
+  // The worker loops exit once all pending tasks have run. Destroying
+  // threads_ joins them, so it must happen before the queues go away.
+  threads_.reset();
+
+  // Only reached with tasks left if StartWorkers() was never called.
+  for (auto& worker : workers_) {
+    while (Task* task = worker->tasks.Pop()) delete task;
+  }
+  absl::MutexLock lock(&injection_mutex_);
+  for (Task* task : injected_) delete task;
+  injected_.clear();
+}
+
+void WorkStealingThreadPool::StartWorkers() {
+  const int num_workers = threads_->num_threads();
+  workers_.reserve(num_workers);
+  for (int i = 0; i < num_workers; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+  threads_->StartWorkers();
+  for (int i = 0; i < num_workers; ++i) {
+    threads_->Schedule([this, i] { RunWorker(i); });
+  }
+}
+
+void WorkStealingThreadPool::Schedule(std::function<void()> callback) {
+  Task* task = new Task(std::move(callback));
+  if (current_worker.pool != this ||
+      !workers_[current_worker.index]->tasks.Push(task)) {
+    absl::MutexLock lock(&injection_mutex_);
+    injected_.push_back(task);
+    num_injected_.fetch_add(1, std::memory_order_release);
+  }
+  NotifyTaskAdded();
+}
+
+void WorkStealingThreadPool::NotifyTaskAdded() {
+  // Pairs with the increment of num_sleeping_ in WaitForWork(): either the
+  // sleeper observes the new task, or we observe the sleeper and wake it.
+  num_pending_.fetch_add(1, std::memory_order_seq_cst);
+  if (num_sleeping_.load(std::memory_order_seq_cst) > 0) {
+    absl::MutexLock lock(&sleep_mutex_);
+    sleep_condition_.Signal();
+  }
+}
+
+void WorkStealingThreadPool::RunWorker(int index) {
+  current_worker.pool = this;
+  current_worker.index = index;
+  int idle_rounds = 0;
+  while (true) {
+    if (Task* task = FindTask(index)) {
+      num_pending_.fetch_sub(1, std::memory_order_relaxed);
+      (*task)();
+      delete task;
+      idle_rounds = 0;
+      continue;
+    }
+    if (++idle_rounds < kSpinRounds) {
+      std::this_thread::yield();
+      continue;
+    }
+    idle_rounds = 0;
+    if (!WaitForWork()) break;
+  }
+  current_worker.pool = nullptr;
+  current_worker.index = -1;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::FindTask(int index) {
+  if (Task* task = workers_[index]->tasks.Pop()) return task;
+  if (Task* task = PopInjected()) return task;
+  const int num_workers = workers_.size();
+  for (int i = 1; i < num_workers; ++i) {
+    if (Task* task = workers_[(index + i) % num_workers]->tasks.Steal()) {
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::PopInjected() {
+  if (num_injected_.load(std::memory_order_acquire) == 0) return nullptr;
+  absl::MutexLock lock(&injection_mutex_);
+  if (injected_.empty()) return nullptr;
+  Task* task = injected_.front();
+  injected_.pop_front();
+  num_injected_.fetch_sub(1, std::memory_order_relaxed);
+  return task;
+}
+
+bool WorkStealingThreadPool::WaitForWork() {
+  absl::MutexLock lock(&sleep_mutex_);
+  num_sleeping_.fetch_add(1, std::memory_order_seq_cst);
+  while (num_pending_.load(std::memory_order_seq_cst) == 0 &&
+         !stopped_.load()) {
+    sleep_condition_.Wait(&sleep_mutex_);
+  }
+  num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+  return num_pending_.load(std::memory_order_seq_cst) > 0 || !stopped_.load();
+}
+
+}  // namespace mediapipe
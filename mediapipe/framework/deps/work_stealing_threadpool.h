@@ -0,0 +1,215 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
+#define MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/deps/thread_options.h"
+#include "mediapipe/framework/deps/threadpool.h"
+
+namespace mediapipe {
+
+namespace internal {
+
+// A bounded single-owner work-stealing deque (Chase-Lev). Only the owning
+// worker thread may call Push() and Pop(); any thread may call Steal().
+// Push() and Pop() operate on the bottom end (LIFO), Steal() takes from the
+// top end (FIFO), so the owner keeps working on cache-hot tasks while thieves
+// take the oldest ones.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  // "capacity" must be a power of two.
+  explicit WorkStealingDeque(int64_t capacity)
+      : mask_(capacity - 1), buffer_(new std::atomic<T*>[capacity]) {
+    for (int64_t i = 0; i < capacity; ++i) {
+      buffer_[i].store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  // Owner only. Returns false if the deque is full.
+  bool Push(T* item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    if (b - t > mask_) return false;
+    buffer_[b & mask_].store(item, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+    return true;
+  }
+
+  // Owner only. Returns nullptr if the deque is empty.
+  T* Pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    T* item = nullptr;
+    if (t <= b) {
+      item = buffer_[b & mask_].load(std::memory_order_relaxed);
+      if (t == b) {
+        // Last item: race against thieves for it.
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+          item = nullptr;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Any thread. Returns nullptr if the deque is empty or if the steal lost a
+  // race with another thief or the owner.
+  T* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) return nullptr;
+    T* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+  // Approximate number of items; exact only when called by the owner with no
+  // concurrent thieves.
+  int64_t Size() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b > t ? b - t : 0;
+  }
+
+ private:
+  // Keep the indices on separate cache lines, since top_ is written by
+  // thieves and bottom_ by the owner.
+  alignas(64) std::atomic<int64_t> top_{0};
+  alignas(64) std::atomic<int64_t> bottom_{0};
+  const int64_t mask_;
+  std::unique_ptr<std::atomic<T*>[]> buffer_;
+};
+
+}  // namespace internal
+
+// A thread pool in which every worker owns a lock-free deque of tasks.
+//
+// Tasks scheduled from one of the pool's own worker threads are pushed onto
+// that worker's deque, so a task and the follow-up tasks it schedules tend to
+// run on the same core. Tasks scheduled from other threads go to a shared
+// injection queue. Idle workers first drain their own deque, then the
+// injection queue, and finally steal from the other workers' deques. The only
+// lock on the hot path is the injection queue lock, taken by external
+// submitters and by workers that have run out of local work.
+//
+// The interface mirrors ThreadPool, so the two can be used interchangeably:
+//
+// {
+//   WorkStealingThreadPool pool("testpool", num_workers);
+//   pool.StartWorkers();
+//   for (int i = 0; i < N; ++i) {
+//     pool.Schedule([i]() { DoWork(i); });
+//   }
+// }
+//
+// Unlike ThreadPool, tasks are not run in FIFO order even with one thread.
+class WorkStealingThreadPool {
+ public:
+  explicit WorkStealingThreadPool(int num_threads);
+  WorkStealingThreadPool(const std::string& name_prefix, int num_threads);
+  WorkStealingThreadPool(const ThreadOptions& thread_options,
+                         const std::string& name_prefix, int num_threads);
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+  // Waits for closures (if any) to complete. May be called without
+  // having called StartWorkers().
+  ~WorkStealingThreadPool();
+
+  // REQUIRES: StartWorkers has not been called
+  // Actually start the worker threads.
+  void StartWorkers();
+
+  // REQUIRES: StartWorkers has been called
+  // Add specified callback to the pool. If called from one of this pool's
+  // worker threads, the callback is queued on that worker's local deque.
+  void Schedule(std::function<void()> callback);
+
+  // Provided for debugging and testing only.
+  int num_threads() const { return threads_->num_threads(); }
+
+  // Standard thread options.  Use this accessor to get them.
+  const ThreadOptions& thread_options() const {
+    return threads_->thread_options();
+  }
+
+ private:
+  using Task = std::function<void()>;
+
+  // Capacity of each worker's local deque. Tasks that do not fit overflow to
+  // the injection queue.
+  static constexpr int64_t kLocalQueueCapacity = 1024;
+
+  struct Worker {
+    Worker() : tasks(kLocalQueueCapacity) {}
+    internal::WorkStealingDeque<Task> tasks;
+  };
+
+  // The body of worker "index"; runs until the pool is stopped and drained.
+  void RunWorker(int index);
+  // Returns the next task for worker "index", or nullptr if none was found.
+  Task* FindTask(int index);
+  Task* PopInjected();
+  // Blocks worker until there may be a task to run. Returns false if the
+  // pool is stopped and no work remains.
+  bool WaitForWork();
+  // Accounts for a newly queued task and wakes a sleeping worker if needed.
+  void NotifyTaskAdded();
+
+  // Hosts the long-running worker loops. Reusing ThreadPool keeps thread
+  // naming, priority and affinity handling in one place.
+  std::unique_ptr<ThreadPool> threads_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+
+  // Tasks scheduled but not yet taken by a worker.
+  std::atomic<int64_t> num_pending_{0};
+  std::atomic<int> num_sleeping_{0};
+  std::atomic<bool> stopped_{false};
+
+  absl::Mutex injection_mutex_;
+  std::deque<Task*> injected_ ABSL_GUARDED_BY(injection_mutex_);
+  // Mirrors injected_.size() so that idle workers can skip the lock.
+  std::atomic<int64_t> num_injected_{0};
+
+  absl::Mutex sleep_mutex_;
+  absl::CondVar sleep_condition_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_DEPS_WORK_STEALING_THREADPOOL_H_
@@ -0,0 +1,217 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
+
+#include <atomic>
+#include <functional>
+
+#include "absl/synchronization/blocking_counter.h"
+#include "absl/synchronization/notification.h"
+#include "mediapipe/framework/deps/threadpool.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+TEST(WorkStealingDequeTest, OwnerPopsInLifoOrderAndThiefStealsInFifoOrder) {
+  internal::WorkStealingDeque<int> deque(4);
+  int values[4] = {0, 1, 2, 3};
+  for (int& value : values) {
+    ASSERT_TRUE(deque.Push(&value));
+  }
+  int extra = 4;
+  EXPECT_FALSE(deque.Push(&extra));
+  EXPECT_EQ(4, deque.Size());
+
+  EXPECT_EQ(&values[3], deque.Pop());
+  EXPECT_EQ(&values[0], deque.Steal());
+  EXPECT_EQ(&values[2], deque.Pop());
+  EXPECT_EQ(&values[1], deque.Steal());
+  EXPECT_EQ(nullptr, deque.Pop());
+  EXPECT_EQ(nullptr, deque.Steal());
+  EXPECT_EQ(0, deque.Size());
+
+  // Indices keep growing past the capacity; the buffer wraps around.
+  for (int round = 0; round < 3; ++round) {
+    for (int& value : values) {
+      ASSERT_TRUE(deque.Push(&value));
+    }
+    for (int i = 3; i >= 0; --i) {
+      EXPECT_EQ(&values[i], deque.Pop());
+    }
+  }
+}
+
+TEST(WorkStealingThreadPoolTest, DestroyWithoutStart) {
+  WorkStealingThreadPool thread_pool("testpool", 10);
+}
+
+TEST(WorkStealingThreadPoolTest, EmptyThread) {
+  WorkStealingThreadPool thread_pool("testpool", 0);
+  ASSERT_EQ(1, thread_pool.num_threads());
+  thread_pool.StartWorkers();
+}
+
+TEST(WorkStealingThreadPoolTest, CreateWithThreadOptions) {
+  ThreadOptions thread_options = ThreadOptions().set_nice_priority_level(-10);
+  WorkStealingThreadPool thread_pool(thread_options, "testpool", 10);
+  ASSERT_EQ(10, thread_pool.num_threads());
+  ASSERT_EQ(-10, thread_pool.thread_options().nice_priority_level());
+  thread_pool.StartWorkers();
+}
+
+TEST(WorkStealingThreadPoolTest, SingleThread) {
+  std::atomic<int> n(100);
+  {
+    WorkStealingThreadPool thread_pool("testpool", 1);
+    thread_pool.StartWorkers();
+    for (int i = 0; i < 100; ++i) {
+      thread_pool.Schedule([&n]() { --n; });
+    }
+  }
+  EXPECT_EQ(0, n);
+}
+
+TEST(WorkStealingThreadPoolTest, MultiThreads) {
+  std::atomic<int> n(1000);
+  {
+    WorkStealingThreadPool thread_pool("testpool", 10);
+    thread_pool.StartWorkers();
+    for (int i = 0; i < 1000; ++i) {
+      thread_pool.Schedule([&n]() { --n; });
+    }
+  }
+  EXPECT_EQ(0, n);
+}
+
+// Tasks scheduled from worker threads go to the local deques, overflow into
+// the injection queue when a deque is full, and are stolen by idle workers.
+TEST(WorkStealingThreadPoolTest, ScheduleFromWorkers) {
+  constexpr int kNumRoots = 8;
+  constexpr int kChildrenPerRoot = 5000;
+  std::atomic<int> n(kNumRoots * kChildrenPerRoot);
+  absl::BlockingCounter roots_done(kNumRoots);
+  {
+    WorkStealingThreadPool thread_pool("testpool", 4);
+    thread_pool.StartWorkers();
+    for (int i = 0; i < kNumRoots; ++i) {
+      thread_pool.Schedule([&]() {
+        for (int j = 0; j < kChildrenPerRoot; ++j) {
+          thread_pool.Schedule([&n]() { --n; });
+        }
+        roots_done.DecrementCount();
+      });
+    }
+    roots_done.Wait();
+  }
+  EXPECT_EQ(0, n);
+}
+
+TEST(WorkStealingThreadPoolTest, WakesUpAfterIdle) {
+  WorkStealingThreadPool thread_pool("testpool", 4);
+  thread_pool.StartWorkers();
+  for (int round = 0; round < 50; ++round) {
+    absl::Notification done;
+    thread_pool.Schedule([&done]() { done.Notify(); });
+    done.WaitForNotification();
+  }
+}
+
+// Scaling benchmarks comparing ThreadPool and WorkStealingThreadPool. The
+// argument is the number of worker threads.
+
+constexpr int kNumBenchmarkTasks = 10000;
+
+// Spins for a little while to simulate a cheap calculator.
+void SmallWork() {
+  int x = 0;
+  for (int i = 0; i < 100; ++i) benchmark::DoNotOptimize(x += i);
+}
+
+// All tasks are scheduled from outside the pool, like graph input packets.
+template <typename Pool>
+void BM_ScheduleExternal(benchmark::State& state) {
+  Pool pool("bm", state.range(0));
+  pool.StartWorkers();
+  for (auto _ : state) {
+    absl::BlockingCounter done(kNumBenchmarkTasks);
+    for (int i = 0; i < kNumBenchmarkTasks; ++i) {
+      pool.Schedule([&done]() {
+        SmallWork();
+        done.DecrementCount();
+      });
+    }
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * kNumBenchmarkTasks);
+}
+
+// Every task schedules its successors from the worker thread, like the
+// scheduler queueing downstream nodes after a node finishes.
+template <typename Pool>
+void BM_ScheduleFanOut(benchmark::State& state) {
+  constexpr int kFanOut = 4;
+  constexpr int kDepth = 6;  // 1 + 4 + ... + 4^6 = 5461 tasks.
+  int num_tasks = 0;
+  for (int d = 0, level = 1; d <= kDepth; ++d, level *= kFanOut) {
+    num_tasks += level;
+  }
+  Pool pool("bm", state.range(0));
+  pool.StartWorkers();
+  for (auto _ : state) {
+    absl::BlockingCounter done(num_tasks);
+    std::function<void(int)> run = [&](int depth) {
+      SmallWork();
+      if (depth < kDepth) {
+        for (int i = 0; i < kFanOut; ++i) {
+          pool.Schedule([&run, depth]() { run(depth + 1); });
+        }
+      }
+      done.DecrementCount();
+    };
+    pool.Schedule([&run]() { run(0); });
+    done.Wait();
+  }
+  state.SetItemsProcessed(state.iterations() * num_tasks);
+}
+
+BENCHMARK_TEMPLATE(BM_ScheduleExternal, ThreadPool)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ScheduleExternal, WorkStealingThreadPool)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ScheduleFanOut, ThreadPool)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(BM_ScheduleFanOut, WorkStealingThreadPool)
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(64)
+    ->UseRealTime();
+
+}  // namespace
+}  // namespace mediapipe
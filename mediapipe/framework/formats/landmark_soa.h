@@ -0,0 +1,224 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_SOA_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_SOA_H_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+
+namespace mediapipe {
+
+// A list of landmarks stored as a structure of arrays: the x, y, z,
+// visibility and presence values of all landmarks are each stored in one
+// contiguous array, and all five arrays share a single allocation.
+//
+// Landmark calculators process LandmarkSoa and NormalizedLandmarkSoa packets
+// with plain loops over these arrays, which the compiler vectorizes, and
+// without allocating a proto message per landmark. Use FromProto and ToProto,
+// or LandmarksSoaConverterCalculator, to convert at the boundaries of a graph
+// section that uses them.
+//
+// As in the protos, visibility and presence are set or unset per landmark: an
+// unset value is stored as NaN in the visibility() and presence() arrays, so
+// writing a value to them sets it for that landmark.
+//
+// landmark(i) and landmark_size() return read-only views with the accessors of
+// the proto messages, so that code templated on the landmark list proto type
+// also accepts these lists, without copying the landmarks.
+template <typename LandmarkListProto>
+class BasicLandmarkSoa {
+ public:
+  using ProtoType = LandmarkListProto;
+
+  // Read-only view of one landmark of the list, with the accessors of the
+  // landmark proto message.
+  class LandmarkView {
+   public:
+    LandmarkView(const BasicLandmarkSoa* list, int index)
+        : list_(list), index_(index) {}
+
+    float x() const { return list_->Field(kX)[index_]; }
+    float y() const { return list_->Field(kY)[index_]; }
+    float z() const { return list_->Field(kZ)[index_]; }
+    float visibility() const { return ValueOrZero(kVisibility); }
+    float presence() const { return ValueOrZero(kPresence); }
+    bool has_x() const { return true; }
+    bool has_y() const { return true; }
+    bool has_z() const { return true; }
+    bool has_visibility() const {
+      return !std::isnan(list_->Field(kVisibility)[index_]);
+    }
+    bool has_presence() const {
+      return !std::isnan(list_->Field(kPresence)[index_]);
+    }
+
+   private:
+    // Unset values read as zero, as in the proto messages.
+    float ValueOrZero(int field) const {
+      const float value = list_->Field(field)[index_];
+      return std::isnan(value) ? 0.0f : value;
+    }
+
+    const BasicLandmarkSoa* list_;
+    int index_;
+  };
+
+  BasicLandmarkSoa() = default;
+  explicit BasicLandmarkSoa(int size) { Resize(size); }
+
+  // Returns the landmarks of `list`, keeping which of them have visibility and
+  // presence set.
+  static BasicLandmarkSoa FromProto(const LandmarkListProto& list) {
+    BasicLandmarkSoa soa(list.landmark_size());
+    float* x = soa.Field(kX);
+    float* y = soa.Field(kY);
+    float* z = soa.Field(kZ);
+    float* visibility = soa.Field(kVisibility);
+    float* presence = soa.Field(kPresence);
+    for (int i = 0; i < soa.size_; ++i) {
+      const auto& landmark = list.landmark(i);
+      x[i] = landmark.x();
+      y[i] = landmark.y();
+      z[i] = landmark.z();
+      visibility[i] =
+          landmark.has_visibility() ? landmark.visibility() : kUnset;
+      presence[i] = landmark.has_presence() ? landmark.presence() : kUnset;
+    }
+    return soa;
+  }
+
+  // Replaces the landmarks of `list` with these landmarks.
+  void ToProto(LandmarkListProto* list) const {
+    list->Clear();
+    list->mutable_landmark()->Reserve(size_);
+    const float* x = Field(kX);
+    const float* y = Field(kY);
+    const float* z = Field(kZ);
+    const float* visibility = Field(kVisibility);
+    const float* presence = Field(kPresence);
+    for (int i = 0; i < size_; ++i) {
+      auto* landmark = list->add_landmark();
+      landmark->set_x(x[i]);
+      landmark->set_y(y[i]);
+      landmark->set_z(z[i]);
+      if (!std::isnan(visibility[i])) landmark->set_visibility(visibility[i]);
+      if (!std::isnan(presence[i])) landmark->set_presence(presence[i]);
+    }
+  }
+
+  LandmarkListProto ToProto() const {
+    LandmarkListProto list;
+    ToProto(&list);
+    return list;
+  }
+
+  int size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  // Proto style access to the landmarks.
+  int landmark_size() const { return size_; }
+  LandmarkView landmark(int index) const { return LandmarkView(this, index); }
+
+  // Resizes the list to `size` landmarks. Values of the first landmarks are
+  // kept. Added landmarks have zero coordinates, and no visibility or
+  // presence.
+  void Resize(int size) {
+    if (size == size_) return;
+    std::vector<float> data(kNumFields * size, 0.0f);
+    const int num_kept = std::min(size, size_);
+    for (int field = 0; field < kNumFields; ++field) {
+      float* values = data.data() + field * size;
+      std::copy_n(Field(field), num_kept, values);
+      if (field == kVisibility || field == kPresence) {
+        std::fill(values + num_kept, values + size, kUnset);
+      }
+    }
+    data_.swap(data);
+    size_ = size;
+  }
+
+  // Copies the landmarks [begin, end) of `source` to this list, starting at
+  // landmark `offset`. This list must be large enough.
+  void CopyFrom(const BasicLandmarkSoa& source, int begin, int end,
+                int offset) {
+    for (int field = 0; field < kNumFields; ++field) {
+      std::copy(source.Field(field) + begin, source.Field(field) + end,
+                Field(field) + offset);
+    }
+  }
+
+  absl::Span<float> x() { return Values(kX); }
+  absl::Span<const float> x() const { return Values(kX); }
+  absl::Span<float> y() { return Values(kY); }
+  absl::Span<const float> y() const { return Values(kY); }
+  absl::Span<float> z() { return Values(kZ); }
+  absl::Span<const float> z() const { return Values(kZ); }
+  absl::Span<float> visibility() { return Values(kVisibility); }
+  absl::Span<const float> visibility() const { return Values(kVisibility); }
+  absl::Span<float> presence() { return Values(kPresence); }
+  absl::Span<const float> presence() const { return Values(kPresence); }
+
+  // Whether any landmark has visibility or presence set.
+  bool has_visibility() const { return AnySet(kVisibility); }
+  bool has_presence() const { return AnySet(kPresence); }
+  // Sets visibility or presence for all landmarks, to zero where it was
+  // unset, or unsets it for all landmarks.
+  void set_has_visibility(bool value) { SetAll(kVisibility, value); }
+  void set_has_presence(bool value) { SetAll(kPresence, value); }
+
+ private:
+  enum FieldIndex { kX = 0, kY, kZ, kVisibility, kPresence, kNumFields };
+
+  // Marks an unset visibility or presence value.
+  static constexpr float kUnset = std::numeric_limits<float>::quiet_NaN();
+
+  float* Field(int field) { return data_.data() + field * size_; }
+  const float* Field(int field) const { return data_.data() + field * size_; }
+  absl::Span<float> Values(int field) {
+    return absl::MakeSpan(Field(field), size_);
+  }
+  absl::Span<const float> Values(int field) const {
+    return absl::MakeConstSpan(Field(field), size_);
+  }
+  bool AnySet(int field) const {
+    return std::any_of(Field(field), Field(field) + size_,
+                       [](float value) { return !std::isnan(value); });
+  }
+  void SetAll(int field, bool set) {
+    for (float& value : Values(field)) {
+      if (!set) {
+        value = kUnset;
+      } else if (std::isnan(value)) {
+        value = 0.0f;
+      }
+    }
+  }
+
+  // The kNumFields arrays of size_ values, one after the other.
+  std::vector<float> data_;
+  int size_ = 0;
+};
+
+using LandmarkSoa = BasicLandmarkSoa<LandmarkList>;
+using NormalizedLandmarkSoa = BasicLandmarkSoa<NormalizedLandmarkList>;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_LANDMARK_SOA_H_
@@ -0,0 +1,119 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/landmark_soa.h"
+
+#include "mediapipe/framework/deps/message_matchers.h"
+#include "mediapipe/framework/formats/landmark.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::FloatEq;
+using ::testing::IsNan;
+
+TEST(LandmarkSoaTest, ConvertsFromAndToProto) {
+  auto list = ParseTextProtoOrDie<NormalizedLandmarkList>(R"pb(
+    landmark { x: 0.1 y: 0.2 z: 0.3 visibility: 0.4 }
+    landmark { x: 0.5 y: 0.6 z: 0.7 visibility: 0.8 }
+  )pb");
+  auto soa = NormalizedLandmarkSoa::FromProto(list);
+  ASSERT_EQ(soa.size(), 2);
+  EXPECT_THAT(soa.x(), ElementsAre(0.1f, 0.5f));
+  EXPECT_THAT(soa.y(), ElementsAre(0.2f, 0.6f));
+  EXPECT_THAT(soa.z(), ElementsAre(0.3f, 0.7f));
+  EXPECT_THAT(soa.visibility(), ElementsAre(0.4f, 0.8f));
+  EXPECT_TRUE(soa.has_visibility());
+  EXPECT_FALSE(soa.has_presence());
+  EXPECT_THAT(soa.ToProto(), EqualsProto(list));
+}
+
+TEST(LandmarkSoaTest, KeepsUnsetFieldsPerLandmark) {
+  auto list = ParseTextProtoOrDie<LandmarkList>(R"pb(
+    landmark { x: 1 y: 2 z: 3 visibility: 0.5 }
+    landmark { x: 4 y: 5 z: 6 presence: 0.25 }
+    landmark { x: 7 y: 8 z: 9 }
+  )pb");
+  auto soa = LandmarkSoa::FromProto(list);
+  EXPECT_TRUE(soa.has_visibility());
+  EXPECT_TRUE(soa.has_presence());
+  EXPECT_TRUE(soa.landmark(0).has_visibility());
+  EXPECT_FALSE(soa.landmark(0).has_presence());
+  EXPECT_FALSE(soa.landmark(1).has_visibility());
+  EXPECT_TRUE(soa.landmark(1).has_presence());
+  EXPECT_FALSE(soa.landmark(2).has_visibility());
+  EXPECT_FALSE(soa.landmark(2).has_presence());
+  // Unset values read as zero through the views, as in the protos.
+  EXPECT_EQ(soa.landmark(1).visibility(), 0.0f);
+  EXPECT_THAT(soa.visibility(), ElementsAre(FloatEq(0.5f), IsNan(), IsNan()));
+  EXPECT_THAT(soa.ToProto(), EqualsProto(list));
+
+  soa.set_has_visibility(true);
+  EXPECT_THAT(soa.visibility(), ElementsAre(0.5f, 0.0f, 0.0f));
+  soa.set_has_presence(false);
+  EXPECT_FALSE(soa.has_presence());
+  EXPECT_FALSE(soa.landmark(1).has_presence());
+}
+
+TEST(LandmarkSoaTest, ViewsLandmarks) {
+  LandmarkSoa soa(3);
+  soa.x()[1] = 1.0f;
+  soa.y()[1] = 2.0f;
+  soa.z()[1] = 3.0f;
+  soa.presence()[1] = 0.5f;
+  soa.set_has_presence(true);
+  ASSERT_EQ(soa.landmark_size(), 3);
+  const auto landmark = soa.landmark(1);
+  EXPECT_EQ(landmark.x(), 1.0f);
+  EXPECT_EQ(landmark.y(), 2.0f);
+  EXPECT_EQ(landmark.z(), 3.0f);
+  EXPECT_FALSE(landmark.has_visibility());
+  EXPECT_TRUE(landmark.has_presence());
+  EXPECT_EQ(landmark.presence(), 0.5f);
+}
+
+TEST(LandmarkSoaTest, ResizesAndCopiesRanges) {
+  LandmarkSoa source(4);
+  for (int i = 0; i < 4; ++i) {
+    source.x()[i] = i;
+    source.visibility()[i] = 10 + i;
+  }
+  source.set_has_visibility(true);
+
+  LandmarkSoa soa;
+  soa.Resize(3);
+  soa.CopyFrom(source, 2, 4, 0);
+  soa.CopyFrom(source, 0, 1, 2);
+  EXPECT_THAT(soa.x(), ElementsAre(2.0f, 3.0f, 0.0f));
+  EXPECT_THAT(soa.visibility(), ElementsAre(12.0f, 13.0f, 10.0f));
+  EXPECT_TRUE(soa.has_visibility());
+  EXPECT_FALSE(soa.has_presence());
+
+  // Added landmarks have no visibility.
+  soa.Resize(4);
+  EXPECT_THAT(soa.x(), ElementsAre(2.0f, 3.0f, 0.0f, 0.0f));
+  EXPECT_THAT(soa.visibility(), ElementsAre(FloatEq(12.0f), FloatEq(13.0f),
+                                            FloatEq(10.0f), IsNan()));
+  EXPECT_FALSE(soa.landmark(3).has_visibility());
+  soa.Resize(1);
+  EXPECT_THAT(soa.x(), ElementsAre(2.0f));
+  EXPECT_THAT(soa.visibility(), ElementsAre(12.0f));
+}
+
+}  // namespace
+}  // namespace mediapipe
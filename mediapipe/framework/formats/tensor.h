@@ -16,6 +16,8 @@
 #define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_H_
 
 #include <algorithm>
+#include <cstdint>
+#include <functional>
 #include <initializer_list>
 #include <tuple>
 #include <type_traits>
@@ -76,7 +78,7 @@ class Tensor {
 
  public:
   // No resources are allocated here.
-  enum class ElementType { kNone, kFloat16, kFloat32 };
+  enum class ElementType { kNone, kFloat16, kFloat32, kUInt8, kInt8, kInt32 };
   struct Shape {
     Shape() = default;
     Shape(std::initializer_list<int> dimensions) : dims(dimensions) {}
@@ -88,8 +90,32 @@ class Tensor {
     }
     std::vector<int> dims;
   };
+  // Quantization parameters corresponding to the zero_point and scale value
+  // made available by TfLite quantized (uint8/int8) tensors. A quantized value
+  // q represents the real value scale * (q - zero_point).
+  struct QuantizationParameters {
+    QuantizationParameters() : scale(1.0f), zero_point(0) {}
+    QuantizationParameters(float scale, int zero_point)
+        : scale(scale), zero_point(zero_point) {}
+    float scale;
+    int zero_point;
+  };
 
   Tensor(ElementType element_type, const Shape& shape);
+  Tensor(ElementType element_type, const Shape& shape,
+         const QuantizationParameters& quantization_parameters);
+  // Creates a tensor that uses the caller-provided "cpu_buffer" as its CPU
+  // storage instead of allocating one. The buffer must hold at least bytes()
+  // bytes, be aligned to kCpuBufferAlignment and stay valid until "release" is
+  // invoked with it when the tensor is destroyed. This lets the memory be
+  // recycled, e.g. by a pool (see TensorPool). Not supported with Metal.
+  Tensor(ElementType element_type, const Shape& shape, void* cpu_buffer,
+         std::function<void(void*)> release,
+         const QuantizationParameters& quantization_parameters = {});
+
+  // Alignment of the CPU buffers allocated by Tensor. It matches the alignment
+  // TfLite requires for custom tensor allocations.
+  static constexpr int kCpuBufferAlignment = 64;
 
   // Non-copyable.
   Tensor(const Tensor&) = delete;
@@ -207,6 +233,9 @@ class Tensor {
 
   const Shape& shape() const { return shape_; }
   ElementType element_type() const { return element_type_; }
+  const QuantizationParameters& quantization_parameters() const {
+    return quantization_parameters_;
+  }
   int element_size() const {
     switch (element_type_) {
       case ElementType::kNone:
@@ -215,6 +244,12 @@ class Tensor {
         return 2;
       case ElementType::kFloat32:
         return sizeof(float);
+      case ElementType::kUInt8:
+        return 1;
+      case ElementType::kInt8:
+        return 1;
+      case ElementType::kInt32:
+        return sizeof(int32_t);
     }
   }
   int bytes() const { return shape_.num_elements() * element_size(); }
@@ -236,6 +271,7 @@ class Tensor {
 
   ElementType element_type_;
   Shape shape_;
+  QuantizationParameters quantization_parameters_;
 
   // The flags describe the current source of truth resource type.
   enum {
@@ -252,6 +288,8 @@ class Tensor {
   mutable absl::Mutex view_mutex_;
 
   mutable void* cpu_buffer_ = nullptr;
+  // Set if cpu_buffer_ is owned by the caller, see the constructor.
+  std::function<void(void*)> cpu_buffer_release_;
   void AllocateCpuBuffer() const;
 #if MEDIAPIPE_METAL_ENABLED
   mutable id<MTLCommandBuffer> command_buffer_;
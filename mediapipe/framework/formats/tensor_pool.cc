@@ -0,0 +1,131 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/aligned_malloc_and_free.h"
+
+namespace mediapipe {
+
+const GraphService<TensorPool> kTensorPoolService(
+    "kTensorPoolService",
+    GraphService<TensorPool>::kAllowDefaultInitialization);
+
+namespace {
+
+// The maximum number of simple pools. When the limit is reached, the oldest
+// one is dropped.
+constexpr int kMaxPoolCount = 20;
+
+}  // namespace
+
+namespace internal {
+
+TensorBufferPool::~TensorBufferPool() {
+  for (void* buffer : available_) aligned_free(buffer);
+}
+
+void* TensorBufferPool::TryGetBuffer() {
+  absl::MutexLock lock(&mutex_);
+  if (available_.empty()) return nullptr;
+  void* buffer = available_.back();
+  available_.pop_back();
+  ++in_use_count_;
+  return buffer;
+}
+
+void* TensorBufferPool::AllocateBuffer() {
+  {
+    absl::MutexLock lock(&mutex_);
+    ++in_use_count_;
+  }
+  return aligned_malloc(buffer_bytes_, Tensor::kCpuBufferAlignment);
+}
+
+std::function<void(void*)> TensorBufferPool::GetReleaser() {
+  std::weak_ptr<TensorBufferPool> weak_pool(shared_from_this());
+  return [weak_pool](void* buffer) {
+    auto pool = weak_pool.lock();
+    if (pool) {
+      pool->Return(buffer);
+    } else {
+      aligned_free(buffer);
+    }
+  };
+}
+
+std::pair<int, int> TensorBufferPool::GetInUseAndAvailableCounts() {
+  absl::MutexLock lock(&mutex_);
+  return {in_use_count_, available_.size()};
+}
+
+void TensorBufferPool::Return(void* buffer) {
+  {
+    absl::MutexLock lock(&mutex_);
+    --in_use_count_;
+    if (available_.size() < keep_count_) {
+      available_.push_back(buffer);
+      return;
+    }
+  }
+  // Surplus buffers are released without holding the lock.
+  aligned_free(buffer);
+}
+
+}  // namespace internal
+
+Tensor TensorPool::GetTensor(
+    Tensor::ElementType element_type, const Tensor::Shape& shape,
+    const Tensor::QuantizationParameters& quantization_parameters) {
+  Tensor tensor(element_type, shape, quantization_parameters);
+#if MEDIAPIPE_METAL_ENABLED
+  // Tensor::AllocateMtlBuffer() cannot wrap external CPU storage, so the
+  // tensor keeps its own buffer.
+  ++miss_count_;
+  return tensor;
+#else
+  const size_t bytes = tensor.bytes();
+  if (bytes == 0) return tensor;
+
+  auto pool = GetSimplePool({element_type, shape.dims}, bytes);
+  void* buffer = pool->TryGetBuffer();
+  if (buffer) {
+    ++hit_count_;
+  } else {
+    ++miss_count_;
+    buffer = pool->AllocateBuffer();
+  }
+  return Tensor(element_type, shape, buffer, pool->GetReleaser(),
+                quantization_parameters);
+#endif  // MEDIAPIPE_METAL_ENABLED
+}
+
+std::shared_ptr<internal::TensorBufferPool> TensorPool::GetSimplePool(
+    Spec spec, size_t bytes) {
+  absl::MutexLock lock(&mutex_);
+  auto pool_it = pools_.find(spec);
+  if (pool_it != pools_.end()) return pool_it->second;
+
+  if (pools_.size() >= kMaxPoolCount) {
+    pools_.erase(specs_.front());  // Front has the oldest spec.
+    specs_.pop_front();
+  }
+  auto pool = internal::TensorBufferPool::Create(bytes, keep_count_);
+  specs_.push_back(spec);
+  pools_.emplace(std::move(spec), pool);
+  return pool;
+}
+
+}  // namespace mediapipe
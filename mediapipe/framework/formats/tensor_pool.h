@@ -0,0 +1,132 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+#define MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/graph_service.h"
+
+namespace mediapipe {
+
+namespace internal {
+
+// Recycles CPU buffers of a single size. Buffers hold a weak reference to the
+// pool, so they can outlive it.
+class TensorBufferPool
+    : public std::enable_shared_from_this<TensorBufferPool> {
+ public:
+  static std::shared_ptr<TensorBufferPool> Create(size_t buffer_bytes,
+                                                  int keep_count) {
+    return std::shared_ptr<TensorBufferPool>(
+        new TensorBufferPool(buffer_bytes, keep_count));
+  }
+  ~TensorBufferPool();
+
+  // Returns a recycled buffer, or nullptr if none is available.
+  void* TryGetBuffer();
+  // Allocates a new buffer that will be returned to this pool.
+  void* AllocateBuffer();
+  // Returns a function that gives a buffer back to this pool, or frees it if
+  // the pool is gone.
+  std::function<void(void*)> GetReleaser();
+
+  // This method is meant for testing.
+  std::pair<int, int> GetInUseAndAvailableCounts();
+
+ private:
+  TensorBufferPool(size_t buffer_bytes, int keep_count)
+      : buffer_bytes_(buffer_bytes), keep_count_(keep_count) {}
+
+  void Return(void* buffer);
+
+  const size_t buffer_bytes_;
+  const int keep_count_;
+
+  absl::Mutex mutex_;
+  int in_use_count_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::vector<void*> available_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace internal
+
+// Lets calculators allocate CPU tensors of various element types and shapes,
+// reusing the buffers of tensors that have been released, i.e. once the last
+// packet holding such a tensor is destroyed. Similar to ImageMultiPool, it
+// keeps one simple pool per (element type, shape) and drops the oldest one when
+// too many shapes are in use.
+//
+// A graph-wide instance is available to calculators through
+// kTensorPoolService. The service allows default initialization, so the graph
+// creates the pool when a node requests the service and the application has
+// not provided one.
+//
+// Pooled buffers are external CPU storage, which Metal buffers cannot wrap.
+// When MEDIAPIPE_METAL_ENABLED is set, the pool therefore recycles nothing and
+// every tensor owns its buffer.
+class TensorPool {
+ public:
+  // Number of released buffers kept for reuse per element type and shape.
+  static constexpr int kDefaultKeepCount = 4;
+
+  explicit TensorPool(int keep_count = kDefaultKeepCount)
+      : keep_count_(keep_count) {}
+  TensorPool(const TensorPool&) = delete;
+  TensorPool& operator=(const TensorPool&) = delete;
+
+  // Obtains a CPU tensor. Its buffer may either be reused or created anew.
+  // The contents of a reused buffer are unspecified. With Metal, the buffer is
+  // always created anew.
+  Tensor GetTensor(Tensor::ElementType element_type, const Tensor::Shape& shape,
+                   const Tensor::QuantizationParameters&
+                       quantization_parameters = {});
+
+  // Number of GetTensor() calls served with a recycled buffer.
+  int64_t hit_count() const { return hit_count_.load(); }
+  // Number of GetTensor() calls that had to allocate a new buffer.
+  int64_t miss_count() const { return miss_count_.load(); }
+
+ private:
+  using Spec = std::pair<Tensor::ElementType, std::vector<int>>;
+
+  std::shared_ptr<internal::TensorBufferPool> GetSimplePool(Spec spec,
+                                                            size_t bytes);
+
+  const int keep_count_;
+  std::atomic<int64_t> hit_count_{0};
+  std::atomic<int64_t> miss_count_{0};
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<Spec, std::shared_ptr<internal::TensorBufferPool>> pools_
+      ABSL_GUARDED_BY(mutex_);
+  // Specs in the order they were added; the front one is evicted first.
+  std::deque<Spec> specs_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Graph-wide TensorPool shared by the tensor calculators.
+extern const GraphService<TensorPool> kTensorPoolService;
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_FORMATS_TENSOR_POOL_H_
@@ -0,0 +1,127 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/formats/tensor_pool.h"
+
+#include <memory>
+#include <vector>
+
+#include "mediapipe/framework/formats/tensor.h"
+#include "mediapipe/framework/port.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kKeepCount = 2;
+
+const void* GetCpuBuffer(const Tensor& tensor) {
+  return tensor.GetCpuWriteView().buffer<void>();
+}
+
+#if !MEDIAPIPE_METAL_ENABLED
+TEST(TensorPoolTest, ReusesReleasedBuffers) {
+  TensorPool pool(kKeepCount);
+  const void* buffer;
+  {
+    Tensor tensor = pool.GetTensor(Tensor::ElementType::kFloat32,
+                                   Tensor::Shape{1, 16, 16, 3});
+    buffer = GetCpuBuffer(tensor);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(buffer) %
+                  Tensor::kCpuBufferAlignment,
+              0);
+  }
+  EXPECT_EQ(pool.hit_count(), 0);
+  EXPECT_EQ(pool.miss_count(), 1);
+
+  Tensor tensor = pool.GetTensor(Tensor::ElementType::kFloat32,
+                                 Tensor::Shape{1, 16, 16, 3});
+  EXPECT_EQ(GetCpuBuffer(tensor), buffer);
+  EXPECT_EQ(pool.hit_count(), 1);
+  EXPECT_EQ(pool.miss_count(), 1);
+}
+
+TEST(TensorPoolTest, KeysByTypeAndShape) {
+  TensorPool pool(kKeepCount);
+  {
+    Tensor tensor =
+        pool.GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{4, 8});
+  }
+  // Same byte size, different type or shape.
+  Tensor t1 = pool.GetTensor(Tensor::ElementType::kInt32, Tensor::Shape{4, 8});
+  Tensor t2 =
+      pool.GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{8, 4});
+  EXPECT_EQ(pool.hit_count(), 0);
+  EXPECT_EQ(pool.miss_count(), 3);
+  Tensor t3 =
+      pool.GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{4, 8});
+  EXPECT_EQ(pool.hit_count(), 1);
+}
+
+TEST(TensorPoolTest, KeepsAtMostKeepCountBuffers) {
+  TensorPool pool(kKeepCount);
+  {
+    std::vector<Tensor> tensors;
+    for (int i = 0; i <= kKeepCount; ++i) {
+      tensors.push_back(
+          pool.GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{1, 32}));
+    }
+  }
+  std::vector<Tensor> tensors;
+  for (int i = 0; i <= kKeepCount; ++i) {
+    tensors.push_back(
+        pool.GetTensor(Tensor::ElementType::kUInt8, Tensor::Shape{1, 32}));
+  }
+  EXPECT_EQ(pool.hit_count(), kKeepCount);
+  EXPECT_EQ(pool.miss_count(), kKeepCount + 2);
+}
+
+#else
+
+// With Metal, every tensor owns its buffer, so that it can be used by the GPU.
+TEST(TensorPoolTest, DoesNotReuseBuffersWithMetal) {
+  TensorPool pool(kKeepCount);
+  for (int i = 0; i < 2; ++i) {
+    Tensor tensor = pool.GetTensor(Tensor::ElementType::kFloat32,
+                                   Tensor::Shape{1, 16, 16, 3});
+  }
+  EXPECT_EQ(pool.hit_count(), 0);
+  EXPECT_EQ(pool.miss_count(), 2);
+}
+
+#endif  // !MEDIAPIPE_METAL_ENABLED
+
+TEST(TensorPoolTest, PreservesQuantizationParameters) {
+  TensorPool pool;
+  Tensor tensor =
+      pool.GetTensor(Tensor::ElementType::kInt8, Tensor::Shape{1, 4},
+                     Tensor::QuantizationParameters(0.5f, -3));
+  EXPECT_EQ(tensor.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(tensor.quantization_parameters().zero_point, -3);
+}
+
+TEST(TensorPoolTest, TensorsOutlivePool) {
+  auto pool = std::make_unique<TensorPool>();
+  Tensor tensor =
+      pool->GetTensor(Tensor::ElementType::kFloat32, Tensor::Shape{1, 8});
+  {
+    auto view = tensor.GetCpuWriteView();
+    view.buffer<float>()[7] = 1.0f;
+  }
+  pool.reset();
+  EXPECT_EQ(tensor.GetCpuReadView().buffer<float>()[7], 1.0f);
+}
+
+}  // namespace
+}  // namespace mediapipe
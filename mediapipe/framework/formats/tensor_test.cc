@@ -1,5 +1,7 @@
 #include "mediapipe/framework/formats/tensor.h"
 
+#include <cstdint>
+
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
 #if !MEDIAPIPE_DISABLE_GPU
@@ -23,6 +25,27 @@ TEST(General, TestDataTypes) {
 
   Tensor t2(Tensor::ElementType::kFloat16, Tensor::Shape{4, 3, 2, 3});
   EXPECT_EQ(t2.bytes(), t2.shape().num_elements() * 2);
+
+  Tensor t_uint8(Tensor::ElementType::kUInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t_uint8.bytes(), t_uint8.shape().num_elements() * sizeof(uint8_t));
+
+  Tensor t_int8(Tensor::ElementType::kInt8, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t_int8.bytes(), t_int8.shape().num_elements() * sizeof(int8_t));
+
+  Tensor t_int32(Tensor::ElementType::kInt32, Tensor::Shape{4, 3, 2, 3});
+  EXPECT_EQ(t_int32.bytes(), t_int32.shape().num_elements() * sizeof(int32_t));
+}
+
+TEST(General, TestQuantizationParameters) {
+  Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{1, 2});
+  EXPECT_EQ(t1.quantization_parameters().scale, 1.0f);
+  EXPECT_EQ(t1.quantization_parameters().zero_point, 0);
+
+  Tensor t2(Tensor::ElementType::kUInt8, Tensor::Shape{1, 2},
+            Tensor::QuantizationParameters(0.5f, 128));
+  Tensor t3(std::move(t2));
+  EXPECT_EQ(t3.quantization_parameters().scale, 0.5f);
+  EXPECT_EQ(t3.quantization_parameters().zero_point, 128);
 }
 
 TEST(Cpu, TestMemoryAllocation) {
@@ -54,6 +77,29 @@ TEST(Cpu, TestViewMove) {
   EXPECT_EQ(v1.buffer<float>(), nullptr);  // NOLINT
 }
 
+TEST(Cpu, TestBufferAlignment) {
+  Tensor t(Tensor::ElementType::kFloat32, Tensor::Shape{1, 3});
+  auto view = t.GetCpuWriteView();
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(view.buffer<float>()) %
+                Tensor::kCpuBufferAlignment,
+            0);
+}
+
+TEST(Cpu, TestExternalStorage) {
+  alignas(Tensor::kCpuBufferAlignment) float storage[2 * 3];
+  void* released = nullptr;
+  {
+    Tensor t1(Tensor::ElementType::kFloat32, Tensor::Shape{2, 3}, storage,
+              [&released](void* buffer) { released = buffer; });
+    EXPECT_EQ(t1.GetCpuWriteView().buffer<float>(), storage);
+    // Moving transfers the ownership of the release function.
+    Tensor t2(std::move(t1));
+    EXPECT_EQ(released, nullptr);
+    EXPECT_EQ(t2.GetCpuReadView().buffer<float>(), storage);
+  }
+  EXPECT_EQ(released, storage);
+}
+
 }  // namespace mediapipe
 
 int main(int argc, char** argv) {
@@ -52,19 +52,36 @@ void GraphOutputStream::PrepareForRun(
 absl::Status OutputStreamObserver::Initialize(
     const std::string& stream_name, const PacketType* packet_type,
     std::function<absl::Status(const Packet&)> packet_callback,
-    OutputStreamManager* output_stream_manager) {
+    OutputStreamManager* output_stream_manager, bool observe_timestamp_bounds) {
   RET_CHECK(output_stream_manager);
 
   packet_callback_ = std::move(packet_callback);
+  observe_timestamp_bounds_ = observe_timestamp_bounds;
   return GraphOutputStream::Initialize(stream_name, packet_type,
                                        output_stream_manager);
 }
 
+void OutputStreamObserver::PrepareForRun(
+    std::function<void()> notification_callback,
+    std::function<void(absl::Status)> error_callback) {
+  GraphOutputStream::PrepareForRun(std::move(notification_callback),
+                                   std::move(error_callback));
+  last_processed_ts_ = Timestamp::Unstarted();
+}
+
 absl::Status OutputStreamObserver::Notify() {
   while (true) {
     bool empty;
     Timestamp min_timestamp = input_stream_->MinTimestampOrBound(&empty);
     if (empty) {
+      if (observe_timestamp_bounds_ && min_timestamp < Timestamp::Done()) {
+        // Reports the timestamps settled by the bound with an empty packet.
+        const Timestamp settled = min_timestamp.PreviousAllowedInStream();
+        if (settled > last_processed_ts_) {
+          last_processed_ts_ = settled;
+          MP_RETURN_IF_ERROR(packet_callback_(Packet().At(settled)));
+        }
+      }
       break;
     }
     int num_packets_dropped = 0;
@@ -74,6 +91,7 @@ absl::Status OutputStreamObserver::Notify() {
     RET_CHECK_EQ(num_packets_dropped, 0).SetNoLogging()
         << absl::Substitute("Dropped $0 packet(s) on input stream \"$1\".",
                             num_packets_dropped, input_stream_->Name());
+    last_processed_ts_ = packet.Timestamp();
     MP_RETURN_IF_ERROR(packet_callback_(packet));
   }
   return absl::OkStatus();
@@ -130,8 +148,7 @@ void OutputStreamPollerImpl::NotifyError() {
   mutex_.Unlock();
 }
 
-bool OutputStreamPollerImpl::Next(Packet* packet) {
-  CHECK(packet);
+Timestamp OutputStreamPollerImpl::WaitForNextPacket() {
   bool empty_queue = true;
   Timestamp min_timestamp = Timestamp::Unset();
   mutex_.Lock();
@@ -145,10 +162,15 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
     }
   }
   if (graph_has_error_ && empty_queue) {
-    mutex_.Unlock();
-    return false;
+    min_timestamp = Timestamp::Done();
   }
   mutex_.Unlock();
+  return min_timestamp;
+}
+
+bool OutputStreamPollerImpl::Next(Packet* packet) {
+  CHECK(packet);
+  Timestamp min_timestamp = WaitForNextPacket();
   if (min_timestamp == Timestamp::Done()) {
     return false;
   }
@@ -162,5 +184,17 @@ bool OutputStreamPollerImpl::Next(Packet* packet) {
   return true;
 }
 
+bool OutputStreamPollerImpl::NextBatch(std::vector<Packet>* packets,
+                                       int max_packets) {
+  CHECK(packets);
+  CHECK(max_packets == -1 || max_packets > 0);
+  if (WaitForNextPacket() == Timestamp::Done()) {
+    return false;
+  }
+  bool stream_is_done = false;
+  return input_stream_->PopQueueHeadPackets(max_packets, packets,
+                                            &stream_is_done) > 0;
+}
+
 }  // namespace internal
 }  // namespace mediapipe
@@ -109,10 +109,17 @@ class OutputStreamObserver : public GraphOutputStream {
  public:
   virtual ~OutputStreamObserver() {}
 
+  // If observe_timestamp_bounds is true, packet_callback is also invoked with
+  // an empty packet at the last settled timestamp when the timestamp bound of
+  // the observed output stream advances without a packet.
   absl::Status Initialize(
       const std::string& stream_name, const PacketType* packet_type,
       std::function<absl::Status(const Packet&)> packet_callback,
-      OutputStreamManager* output_stream_manager);
+      OutputStreamManager* output_stream_manager,
+      bool observe_timestamp_bounds = false);
+
+  void PrepareForRun(std::function<void()> notification_callback,
+                     std::function<void(absl::Status)> error_callback) override;
 
   // Notifies the observer of new packets emitted by the observed
   // output stream.
@@ -124,6 +131,9 @@ class OutputStreamObserver : public GraphOutputStream {
  private:
   // Invoked on every packet emitted by the observed output stream.
   std::function<absl::Status(const Packet&)> packet_callback_;
+  bool observe_timestamp_bounds_ = false;
+  // The last timestamp passed to packet_callback_ in the current run.
+  Timestamp last_processed_ts_ = Timestamp::Unstarted();
 };
 
 // OutputStreamPollerImpl that returns packets to the caller via
@@ -159,7 +169,18 @@ class OutputStreamPollerImpl : public GraphOutputStream {
   // done).  Returns true if successful.
   ABSL_MUST_USE_RESULT bool Next(Packet* packet);
 
+  // Blocks like Next(), then moves up to "max_packets" queued packets, or all
+  // of them if "max_packets" is -1, into "packets". Returns true if any packet
+  // was appended.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets);
+
  private:
+  // Blocks until a packet is queued, the stream is done, or the graph has an
+  // error. Returns the timestamp of the first queued packet, or
+  // Timestamp::Done() if there is no packet left to return.
+  Timestamp WaitForNextPacket();
+
   absl::Mutex mutex_;
   absl::CondVar handler_condvar_ ABSL_GUARDED_BY(mutex_);
   bool graph_has_error_ ABSL_GUARDED_BY(mutex_);
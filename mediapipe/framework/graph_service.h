@@ -17,6 +17,8 @@
 
 #include <memory>
 
+#include "mediapipe/framework/packet.h"
+
 namespace mediapipe {
 
 // The GraphService API can be used to define extensions to a graph's execution
@@ -28,9 +30,17 @@ namespace mediapipe {
 // if you want to use it. In most cases, you should use a side packet instead.
 
 struct GraphServiceBase {
-  constexpr GraphServiceBase(const char* key) : key(key) {}
+  // Creates the service object that a graph uses when a calculator requests
+  // the service and the application has not provided one.
+  using DefaultFactory = Packet (*)();
+
+  constexpr GraphServiceBase(const char* key,
+                             DefaultFactory default_factory = nullptr)
+      : key(key), default_factory(default_factory) {}
 
   const char* key;
+  // Null if the application must provide the service object.
+  DefaultFactory default_factory;
 };
 
 template <typename T>
@@ -38,7 +48,24 @@ struct GraphService : public GraphServiceBase {
   using type = T;
   using packet_type = std::shared_ptr<T>;
 
+  // Whether a graph may create a default-constructed T for calculators that
+  // request the service when the application has not provided one.
+  enum DefaultInitSupport {
+    kDisallowDefaultInitialization,
+    kAllowDefaultInitialization,
+  };
+
   constexpr GraphService(const char* key) : GraphServiceBase(key) {}
+  // Only instantiated when used, since it requires T to be complete.
+  constexpr GraphService(const char* key, DefaultInitSupport default_init)
+      : GraphServiceBase(key, default_init == kAllowDefaultInitialization
+                                  ? &CreateDefaultObject
+                                  : nullptr) {}
+
+ private:
+  static Packet CreateDefaultObject() {
+    return MakePacket<packet_type>(std::make_shared<T>());
+  }
 };
 
 template <typename T>
@@ -150,5 +150,68 @@ TEST_F(GraphServiceTest, OptionalIsAvailable) {
   EXPECT_EQ(PacketValues<int>(output_packets_), (std::vector<int>{108}));
 }
 
+class DefaultInitServiceTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    CalculatorGraphConfig config =
+        mediapipe::ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+          input_stream: "in"
+          node {
+            calculator: "DefaultInitServiceCalculator"
+            input_stream: "in"
+            output_stream: "out"
+          }
+        )pb");
+    MP_ASSERT_OK(graph_.Initialize(config));
+    MP_ASSERT_OK(
+        graph_.ObserveOutputStream("out", [this](const Packet& packet) {
+          output_packets_.push_back(packet);
+          return absl::OkStatus();
+        }));
+  }
+
+  // Runs the graph on one packet.
+  void RunGraph() {
+    MP_ASSERT_OK(graph_.StartRun({}));
+    MP_ASSERT_OK(graph_.AddPacketToInputStream(
+        "in", MakePacket<int>(0).At(Timestamp(0))));
+    MP_ASSERT_OK(graph_.CloseAllInputStreams());
+    MP_ASSERT_OK(graph_.WaitUntilDone());
+  }
+
+  CalculatorGraph graph_;
+  std::vector<Packet> output_packets_;
+};
+
+TEST_F(DefaultInitServiceTest, CreatesDefaultObject) {
+  EXPECT_EQ(graph_.GetServiceObject(kDefaultInitService), nullptr);
+  RunGraph();
+  auto service_object = graph_.GetServiceObject(kDefaultInitService);
+  ASSERT_NE(service_object, nullptr);
+  EXPECT_EQ(1, (*service_object)["count"]);
+
+  // The object is kept for the next run.
+  RunGraph();
+  EXPECT_EQ(graph_.GetServiceObject(kDefaultInitService), service_object);
+  EXPECT_EQ(PacketValues<int>(output_packets_), (std::vector<int>{1, 2}));
+}
+
+TEST_F(DefaultInitServiceTest, UsesProvidedObject) {
+  auto service_object =
+      std::make_shared<TestServiceObject>(TestServiceObject{{"count", 10}});
+  MP_EXPECT_OK(graph_.SetServiceObject(kDefaultInitService, service_object));
+  RunGraph();
+  EXPECT_EQ(graph_.GetServiceObject(kDefaultInitService), service_object);
+  EXPECT_EQ(PacketValues<int>(output_packets_), (std::vector<int>{11}));
+}
+
+TEST_F(DefaultInitServiceTest, DefaultFactory) {
+  EXPECT_EQ(kTestService.default_factory, nullptr);
+  ASSERT_NE(kDefaultInitService.default_factory, nullptr);
+  Packet packet = kDefaultInitService.default_factory();
+  MP_ASSERT_OK(packet.ValidateAsType<std::shared_ptr<TestServiceObject>>());
+  EXPECT_NE(packet.Get<std::shared_ptr<TestServiceObject>>(), nullptr);
+}
+
 }  // namespace
 }  // namespace mediapipe
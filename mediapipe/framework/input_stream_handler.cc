@@ -256,7 +256,7 @@ void LogQueuedPackets(CalculatorContext* context, InputStreamManager* stream,
 }
 
 void InputStreamHandler::AddPackets(CollectionItemId id,
-                                    const std::list<Packet>& packets) {
+                                    const PacketQueue& packets) {
   LogQueuedPackets(GetCalculatorContext(calculator_context_manager_),
                    input_stream_managers_.Get(id), packets.back());
   bool notify = false;
@@ -271,7 +271,7 @@ void InputStreamHandler::AddPackets(CollectionItemId id,
 }
 
 void InputStreamHandler::MovePackets(CollectionItemId id,
-                                     std::list<Packet>* packets) {
+                                     PacketQueue* packets) {
   LogQueuedPackets(GetCalculatorContext(calculator_context_manager_),
                    input_stream_managers_.Get(id), packets->back());
   bool notify = false;
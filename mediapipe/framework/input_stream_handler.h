@@ -33,6 +33,7 @@
 #include "mediapipe/framework/input_stream_shard.h"
 #include "mediapipe/framework/mediapipe_options.pb.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_queue.h"
 #include "mediapipe/framework/packet_set.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port/status.h"
@@ -132,11 +133,10 @@ class InputStreamHandler {
       InputStreamManager::QueueSizeCallback becomes_not_full_callback);
 
   // Add packets into a particular stream.
-  virtual void AddPackets(CollectionItemId id,
-                          const std::list<Packet>& packets);
+  virtual void AddPackets(CollectionItemId id, const PacketQueue& packets);
 
   // Moves packets into a particular stream.
-  virtual void MovePackets(CollectionItemId id, std::list<Packet>* packets);
+  virtual void MovePackets(CollectionItemId id, PacketQueue* packets);
 
   // Sets next timestamp bound in a particular stream.
   void SetNextTimestampBound(CollectionItemId id, Timestamp bound);
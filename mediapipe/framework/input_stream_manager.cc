@@ -14,6 +14,7 @@
 
 #include "mediapipe/framework/input_stream_manager.h"
 
+#include <algorithm>
 #include <type_traits>
 #include <utility>
 
@@ -80,20 +81,40 @@ absl::Status InputStreamManager::SetHeader(const Packet& header) {
   return absl::OkStatus();
 }
 
-absl::Status InputStreamManager::AddPackets(const std::list<Packet>& container,
+absl::Status InputStreamManager::AddPackets(const PacketQueue& container,
                                             bool* notify) {
-  return AddOrMovePacketsInternal<const std::list<Packet>&>(container, notify);
+  return AddOrMovePacketsInternal<const PacketQueue&>(container, notify);
 }
 
-absl::Status InputStreamManager::MovePackets(std::list<Packet>* container,
+absl::Status InputStreamManager::MovePackets(PacketQueue* container,
                                              bool* notify) {
-  return AddOrMovePacketsInternal<std::list<Packet>&>(*container, notify);
+  return AddOrMovePacketsInternal<PacketQueue&>(*container, notify);
 }
 
 template <typename Container>
 absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
                                                           bool* notify) {
+  constexpr bool kMove =
+      !std::is_const<typename std::remove_reference<Container>::type>::value;
   *notify = false;
+  // The packet types do not depend on the stream state, so they are checked
+  // before the stream is locked. As if the packets were checked one by one,
+  // only the packets before a mismatch are added.
+  absl::Status type_result;
+  size_t num_typed_packets = container.size();
+  for (size_t i = 0; i < container.size(); ++i) {
+    absl::Status result = packet_type_->Validate(container[i]);
+    if (!result.ok()) {
+      type_result = tool::AddStatusPrefix(
+          absl::StrCat(
+              "Packet type mismatch on a calculator receiving from stream \"",
+              name_, "\": "),
+          result);
+      num_typed_packets = i;
+      break;
+    }
+  }
+
   bool queue_became_non_empty = false;
   bool queue_became_full = false;
   {
@@ -107,22 +128,16 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
     // Check if the queue becomes non-empty.
     queue_became_non_empty = queue_.empty() && !container.empty();
-    for (auto& packet : container) {
-      absl::Status result = packet_type_->Validate(packet);
-      if (!result.ok()) {
-        return tool::AddStatusPrefix(
-            absl::StrCat(
-                "Packet type mismatch on a calculator receiving from stream \"",
-                name_, "\": "),
-            result);
-      }
-
-      const Timestamp timestamp = packet.Timestamp();
+    absl::Status result;
+    size_t num_valid_packets = 0;
+    for (; num_valid_packets < num_typed_packets; ++num_valid_packets) {
+      const Timestamp timestamp = container[num_valid_packets].Timestamp();
       if (!timestamp.IsAllowedInStream()) {
-        return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-               << "In stream \"" << name_
-               << "\", timestamp not specified or set to illegal value: "
-               << timestamp.DebugString();
+        result = mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+                 << "In stream \"" << name_
+                 << "\", timestamp not specified or set to illegal value: "
+                 << timestamp.DebugString();
+        break;
       }
       if (enable_timestamps_) {
         // Check that PostStream(), if used, is the only timestamp used.  This
@@ -130,38 +145,56 @@ absl::Status InputStreamManager::AddOrMovePacketsInternal(Container container,
         // Timestamp::PreStream().NextAllowedInStream() is
         // Timestamp::OneOverPostStream().
         if (timestamp == Timestamp::PostStream() && num_packets_added_ > 0) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "In stream \"" << name_
-                 << "\", a packet at Timestamp::PostStream() must be the only "
-                    "Packet in an InputStream.";
+          result = mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+                   << "In stream \"" << name_
+                   << "\", a packet at Timestamp::PostStream() must be the "
+                      "only Packet in an InputStream.";
+          break;
         }
         if (timestamp < next_timestamp_bound_) {
-          return mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
-                 << "Packet timestamp mismatch on a calculator receiving from "
-                    "stream \""
-                 << name_ << "\". Current minimum expected timestamp is "
-                 << next_timestamp_bound_.DebugString() << " but received "
-                 << timestamp.DebugString()
-                 << ". Are you using a custom InputStreamHandler? Note that "
-                    "some InputStreamHandlers allow timestamps that are not "
-                    "strictly monotonically increasing. See for example the "
-                    "ImmediateInputStreamHandler class comment.";
+          result =
+              mediapipe::InvalidArgumentErrorBuilder(MEDIAPIPE_LOC)
+              << "Packet timestamp mismatch on a calculator receiving from "
+                 "stream \""
+              << name_ << "\". Current minimum expected timestamp is "
+              << next_timestamp_bound_.DebugString() << " but received "
+              << timestamp.DebugString()
+              << ". Are you using a custom InputStreamHandler? Note that "
+                 "some InputStreamHandlers allow timestamps that are not "
+                 "strictly monotonically increasing. See for example the "
+                 "ImmediateInputStreamHandler class comment.";
+          break;
         }
       }
       next_timestamp_bound_ = timestamp.NextAllowedInStream();
-
-      // If the caller is MovePackets(), packet's underlying holder should be
-      // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
       ++num_packets_added_;
       VLOG(3) << "Input stream:" << name_
-              << " has added packet at time: " << packet.Timestamp();
-      if (std::is_const<
-              typename std::remove_reference<Container>::type>::value) {
-        queue_.emplace_back(packet);
+              << " has added packet at time: " << timestamp;
+    }
+    if (result.ok()) {
+      result = type_result;
+    }
+
+    // If the caller is MovePackets(), packet's underlying holder should be
+    // transferred into queue_. Otherwise, queue_ keeps a copy of the packet.
+    if constexpr (kMove) {
+      if (queue_.empty() && num_valid_packets == container.size()) {
+        // Take over the whole ring, and hand the empty one to the producer.
+        queue_.swap(container);
       } else {
-        queue_.emplace_back(std::move(packet));
+        for (size_t i = 0; i < num_valid_packets; ++i) {
+          queue_.push_back(std::move(container[i]));
+        }
       }
+    } else {
+      for (size_t i = 0; i < num_valid_packets; ++i) {
+        queue_.push_back(container[i]);
+      }
+    }
+    if (!result.ok()) {
+      return result;
     }
+
     queue_became_full = (!was_queue_full && max_queue_size_ != -1 &&
                          queue_.size() >= max_queue_size_);
     if (queue_.size() > 1) {
@@ -329,6 +362,47 @@ Packet InputStreamManager::PopQueueHead(bool* stream_is_done) {
   return packet;
 }
 
+int InputStreamManager::PopQueueHeadPackets(int max_packets,
+                                            std::vector<Packet>* packets,
+                                            bool* stream_is_done) {
+  CHECK(packets);
+  *stream_is_done = false;
+  bool queue_became_non_full = false;
+  int num_popped = 0;
+  {
+    absl::MutexLock stream_lock(&stream_mutex_);
+
+    // Check if queue is full.
+    bool was_queue_full =
+        (max_queue_size_ != -1 && queue_.size() >= max_queue_size_);
+
+    while (!queue_.empty() && (max_packets == -1 || num_popped < max_packets)) {
+      packets->push_back(std::move(queue_.front()));
+      queue_.pop_front();
+      ++num_popped;
+    }
+    if (enable_timestamps_ && num_popped > 0) {
+      // Same bookkeeping as PopPacketAtTimestamp() at the last timestamp.
+      const Timestamp timestamp = packets->back().Timestamp();
+      CHECK_LE(last_select_timestamp_, timestamp);
+      last_select_timestamp_ = timestamp;
+      if (next_timestamp_bound_ <= timestamp) {
+        next_timestamp_bound_ = timestamp.NextAllowedInStream();
+      }
+    }
+
+    VLOG(3) << "Input stream removed " << num_popped << " packets:" << name_
+            << " Size:" << queue_.size();
+    queue_became_non_full = (was_queue_full && queue_.size() < max_queue_size_);
+    *stream_is_done = IsDone();
+  }
+  if (queue_became_non_full) {
+    VLOG(3) << "Queue became non-full: " << Name();
+    becomes_not_full_callback_(this, &last_reported_stream_full_);
+  }
+  return num_popped;
+}
+
 int InputStreamManager::QueueSize() const {
   absl::MutexLock lock(&stream_mutex_);
   return static_cast<int>(queue_.size());
@@ -369,7 +443,8 @@ Timestamp InputStreamManager::GetMinTimestampAmongNLatest(int n) const {
   if (queue_.empty()) {
     return Timestamp::Unset();
   }
-  return (queue_.cend() - std::min((size_t)n, queue_.size()))->Timestamp();
+  return queue_[queue_.size() - std::min((size_t)n, queue_.size())]
+      .Timestamp();
 }
 
 void InputStreamManager::ErasePacketsEarlierThan(Timestamp timestamp) {
@@ -15,14 +15,14 @@
 #ifndef MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 #define MEDIAPIPE_FRAMEWORK_INPUT_STREAM_MANAGER_H_
 
-#include <deque>
 #include <functional>
-#include <list>
 #include <string>
+#include <vector>
 
 #include "absl/base/thread_annotations.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_queue.h"
 #include "mediapipe/framework/packet_type.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -87,12 +87,17 @@ class InputStreamManager {
   //   Timestamp::PostStream(), the packet must be the only packet in the
   //   stream.
   // Violation of any of these conditions causes an error status.
-  absl::Status AddPackets(const std::list<Packet>& container, bool* notify);
+  absl::Status AddPackets(const PacketQueue& container, bool* notify);
 
   // Move a list of timestamped packets. Sets "notify" to true if the queue
   // becomes non-empty. Does nothing if the input stream is closed. After the
   // move, all packets in the container must be empty.
-  absl::Status MovePackets(std::list<Packet>* container, bool* notify);
+  //
+  // If the queue is empty, which is the common case for a stream whose only
+  // producer keeps up with its consumer, the queue and the container exchange
+  // their rings instead of moving the packets one by one. The container then
+  // holds the drained ring of this stream, ready to be refilled.
+  absl::Status MovePackets(PacketQueue* container, bool* notify);
 
   // Closes the input stream.  This function can be called multiple times.
   void Close() ABSL_LOCKS_EXCLUDED(stream_mutex_);
@@ -140,6 +145,14 @@ class InputStreamManager {
   // Timestamp::Done() after the pop.
   Packet PopQueueHead(bool* stream_is_done) ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
+  // Pops up to "max_packets" packets, or all of them if "max_packets" is -1,
+  // from the head of the queue and appends them to "packets", advancing time
+  // past the last one. Returns the number of packets popped. Sets
+  // "stream_is_done" as PopQueueHead() does.
+  int PopQueueHeadPackets(int max_packets, std::vector<Packet>* packets,
+                          bool* stream_is_done)
+      ABSL_LOCKS_EXCLUDED(stream_mutex_);
+
   // Returns the number of packets in the queue.
   int QueueSize() const ABSL_LOCKS_EXCLUDED(stream_mutex_);
 
@@ -191,7 +204,7 @@ class InputStreamManager {
   Timestamp MinTimestampOrBoundHelper() const;
 
   mutable absl::Mutex stream_mutex_;
-  std::deque<Packet> queue_ ABSL_GUARDED_BY(stream_mutex_);
+  PacketQueue queue_ ABSL_GUARDED_BY(stream_mutex_);
   // The number of packets added to queue_.  Used to verify a packet at
   // Timestamp::PostStream() is the only Packet in the stream.
   int64 num_packets_added_ ABSL_GUARDED_BY(stream_mutex_);
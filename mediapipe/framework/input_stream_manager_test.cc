@@ -15,13 +15,17 @@
 #include "mediapipe/framework/input_stream_manager.h"
 
 #include <memory>
+#include <vector>
 
 #include "absl/memory/memory.h"
 #include "mediapipe/framework/input_stream_shard.h"
 #include "mediapipe/framework/lifetime_tracker.h"
 #include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/packet_queue.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status_matchers.h"
 
 namespace mediapipe {
@@ -92,7 +96,7 @@ class InputStreamManagerTest : public ::testing::Test {
 TEST_F(InputStreamManagerTest, Init) {}
 
 TEST_F(InputStreamManagerTest, AddPackets) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
@@ -109,7 +113,7 @@ TEST_F(InputStreamManagerTest, AddPackets) {
 }
 
 TEST_F(InputStreamManagerTest, MovePackets) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
@@ -129,7 +133,7 @@ TEST_F(InputStreamManagerTest, MovePackets) {
 // a stream: Timestamp::Unset(), Timestamp::Unstarted(),
 // Timestamp::OneOverPostStream(), and Timestamp::Done().
 TEST_F(InputStreamManagerTest, AddPacketUnset) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Unset()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 
@@ -140,7 +144,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnset) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::Unstarted()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -152,7 +156,7 @@ TEST_F(InputStreamManagerTest, AddPacketUnstarted) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::OneOverPostStream()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -165,7 +169,7 @@ TEST_F(InputStreamManagerTest, AddPacketOneOverPostStream) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketDone) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp::Done()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 
@@ -176,7 +180,7 @@ TEST_F(InputStreamManagerTest, AddPacketDone) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -190,7 +194,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPreStream) {
 // An attempt to add a packet after Timestamp::PreStream() should be rejected
 // because the next timestamp bound is Timestamp::OneOverPostStream().
 TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(10)));
@@ -204,7 +208,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStream) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PostStream()));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -218,7 +222,7 @@ TEST_F(InputStreamManagerTest, AddPacketsOnlyPostStream) {
 // A packet at Timestamp::PostStream() must be the only Packet in an input
 // stream.
 TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(
       MakePacket<std::string>("packet 2").At(Timestamp::PostStream()));
@@ -231,7 +235,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStream) {
 }
 
 TEST_F(InputStreamManagerTest, AddPacketsReverseTimestamps) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
@@ -249,7 +253,7 @@ TEST_F(InputStreamManagerTest, PopPacketAtTimestamp) {
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
   std::string expected_value_at_30("packet 3");
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>(expected_value_at_10).At(Timestamp(10)));
   packets.push_back(
@@ -334,7 +338,7 @@ TEST_F(InputStreamManagerTest, PopQueueHead) {
   std::string expected_value_at_10("packet 1");
   std::string expected_value_at_20("packet 2");
   std::string expected_value_at_30("packet 3");
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>(expected_value_at_10).At(Timestamp(10)));
   packets.push_back(
@@ -394,7 +398,7 @@ TEST_F(InputStreamManagerTest, PopQueueHead) {
 }
 
 TEST_F(InputStreamManagerTest, BadPacketType) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<int>(10).At(Timestamp(10)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
 
@@ -405,7 +409,7 @@ TEST_F(InputStreamManagerTest, BadPacketType) {
 }
 
 TEST_F(InputStreamManagerTest, Close) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
@@ -428,7 +432,7 @@ TEST_F(InputStreamManagerTest, Close) {
 }
 
 TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   packets.push_back(MakePacket<std::string>("packet 3").At(Timestamp(30)));
@@ -481,7 +485,7 @@ TEST_F(InputStreamManagerTest, ReuseInputStreamManager) {
 }
 
 TEST_F(InputStreamManagerTest, MultipleNotifications) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -526,7 +530,7 @@ TEST_F(InputStreamManagerTest, SetHeader) {
 }
 
 TEST_F(InputStreamManagerTest, BackwardsInTime) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -593,7 +597,7 @@ TEST_F(InputStreamManagerTest, BackwardsInTime) {
 }
 
 TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -637,7 +641,7 @@ TEST_F(InputStreamManagerTest, SelectBackwardsInTime) {
 }
 
 TEST_F(InputStreamManagerTest, TimestampBound) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -747,7 +751,7 @@ TEST_F(InputStreamManagerTest, TimestampBound) {
 }
 
 TEST_F(InputStreamManagerTest, QueueSizeTest) {
-  std::list<Packet> packets;
+  PacketQueue packets;
   int max_queue_size = 2;
   input_stream_manager_->SetMaxQueueSize(max_queue_size);
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
@@ -833,7 +837,7 @@ TEST_F(InputStreamManagerTest, InputReleaseTest) {
 // if packet timestamps don't need to be increasing.
 TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(
       MakePacket<std::string>("packet 1").At(Timestamp::PreStream()));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(10)));
@@ -849,7 +853,7 @@ TEST_F(InputStreamManagerTest, AddPacketsAfterPreStreamUntimed) {
 // an input stream if packet timestamps don't need to be increasing.
 TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
   input_stream_manager_->DisableTimestamps();
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(
       MakePacket<std::string>("packet 2").At(Timestamp::PostStream()));
@@ -863,7 +867,7 @@ TEST_F(InputStreamManagerTest, AddPacketsBeforePostStreamUntimed) {
 
 TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
   input_stream_manager_->DisableTimestamps();
-  std::list<Packet> packets;
+  PacketQueue packets;
   packets.push_back(MakePacket<std::string>("packet 1").At(Timestamp(10)));
   packets.push_back(MakePacket<std::string>("packet 2").At(Timestamp(20)));
   EXPECT_TRUE(input_stream_manager_->IsEmpty());
@@ -922,5 +926,41 @@ TEST_F(InputStreamManagerTest, BackwardsInTimeUntimed) {
   EXPECT_TRUE(notify_);
 }
 
+// Sends packets from an output queue to as many input streams as the benchmark
+// argument, as OutputStreamManager::PropagateUpdatesToMirrors() does, and pops
+// them from the input streams, as the input stream handlers do.
+void BM_PropagateAndPopPackets(benchmark::State& state) {
+  PacketType packet_type;
+  packet_type.Set<int>();
+  std::vector<std::unique_ptr<InputStreamManager>> streams(state.range(0));
+  for (auto& stream : streams) {
+    stream = absl::make_unique<InputStreamManager>();
+    CHECK(stream->Initialize("a_test", &packet_type, /*back_edge=*/false).ok());
+    stream->SetQueueSizeCallbacks([](InputStreamManager*, bool*) {},
+                                  [](InputStreamManager*, bool*) {});
+    stream->SetMaxQueueSize(100);
+  }
+  PacketQueue output_queue;
+  int64 timestamp = 0;
+  bool notify;
+  int num_packets_dropped;
+  bool stream_is_done;
+  for (auto _ : state) {
+    output_queue.push_back(MakePacket<int>(0).At(Timestamp(timestamp)));
+    for (size_t i = 0; i + 1 < streams.size(); ++i) {
+      CHECK(streams[i]->AddPackets(output_queue, &notify).ok());
+    }
+    CHECK(streams.back()->MovePackets(&output_queue, &notify).ok());
+    output_queue.clear();
+    for (auto& stream : streams) {
+      benchmark::DoNotOptimize(stream->PopPacketAtTimestamp(
+          Timestamp(timestamp), &num_packets_dropped, &stream_is_done));
+    }
+    ++timestamp;
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PropagateAndPopPackets)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace
 }  // namespace mediapipe
@@ -16,6 +16,7 @@
 #define MEDIAPIPE_FRAMEWORK_OUTPUT_STREAM_POLLER_H_
 
 #include <memory>
+#include <vector>
 
 #include "mediapipe/framework/graph_output_stream.h"
 
@@ -48,6 +49,19 @@ class OutputStreamPoller {
     return poller->Next(packet);
   }
 
+  // Gets all the packets queued so far, or at most "max_packets" of them, and
+  // appends them to "packets" (blocks until at least one is available or the
+  // stream is done). Draining many packets per call takes the poller and
+  // stream locks once for the batch. Returns true if successful.
+  ABSL_MUST_USE_RESULT bool NextBatch(std::vector<Packet>* packets,
+                                      int max_packets = -1) {
+    auto poller = internal_poller_impl_.lock();
+    if (!poller) {
+      return false;
+    }
+    return poller->NextBatch(packets, max_packets);
+  }
+
   void SetMaxQueueSize(int queue_size) {
     auto poller = internal_poller_impl_.lock();
     CHECK(poller) << "OutputStreamPollerImpl is already destroyed.";
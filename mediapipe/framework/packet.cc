@@ -14,7 +14,13 @@
 
 #include "mediapipe/framework/packet.h"
 
+#include <new>
+#include <vector>
+
+#include "absl/base/config.h"
+#include "absl/base/thread_annotations.h"
 #include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/integral_types.h"
@@ -22,25 +28,208 @@
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/port/status_builder.h"
 
+// The holder pool hides use-after-free bugs from the sanitizers, so they get
+// holders from the global heap.
+#if defined(MEDIAPIPE_DISABLE_PACKET_HOLDER_POOL) || \
+    defined(ABSL_HAVE_ADDRESS_SANITIZER) ||          \
+    defined(ABSL_HAVE_MEMORY_SANITIZER) ||           \
+    defined(ABSL_HAVE_THREAD_SANITIZER)
+#define MEDIAPIPE_PACKET_HOLDER_POOL 0
+#else
+#define MEDIAPIPE_PACKET_HOLDER_POOL 1
+#endif
+
 namespace mediapipe {
 namespace packet_internal {
 
+#if MEDIAPIPE_PACKET_HOLDER_POOL
+namespace {
+
+// Every Holder<T> is a vtable pointer, a type id, a reference count and a
+// payload pointer; this leaves room for holders with a few more members.
+constexpr size_t kHolderBlockSize = 64;
+// The number of blocks that move at once between a thread's cache and the
+// shared pool.
+constexpr int kHolderBatchSize = 64;
+// The most batches the shared pool keeps, 1 MiB of blocks. Batches returned
+// beyond this go back to the heap.
+constexpr size_t kMaxPooledBatches = 256;
+
+struct FreeBlock {
+  FreeBlock* next;
+};
+
+struct FreeList {
+  FreeBlock* head = nullptr;
+  int size = 0;
+};
+
+// The blocks not cached by any thread. Each block is a separate heap
+// allocation, so the pool can give memory back after a burst of holders.
+class HolderPool {
+ public:
+  static HolderPool* Get() {
+    static HolderPool* pool = new HolderPool();
+    return pool;
+  }
+
+  FreeList TakeBatch() ABSL_LOCKS_EXCLUDED(mutex_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (!batches_.empty()) {
+        FreeList batch = batches_.back();
+        batches_.pop_back();
+        return batch;
+      }
+    }
+    FreeList batch;
+    for (int i = 0; i < kHolderBatchSize; ++i) {
+      auto* block = static_cast<FreeBlock*>(::operator new(kHolderBlockSize));
+      block->next = batch.head;
+      batch.head = block;
+    }
+    batch.size = kHolderBatchSize;
+    return batch;
+  }
+
+  void ReturnBatch(FreeList batch) ABSL_LOCKS_EXCLUDED(mutex_) {
+    {
+      absl::MutexLock lock(&mutex_);
+      if (batches_.size() < kMaxPooledBatches) {
+        batches_.push_back(batch);
+        return;
+      }
+    }
+    while (batch.head != nullptr) {
+      FreeBlock* next = batch.head->next;
+      ::operator delete(batch.head);
+      batch.head = next;
+    }
+  }
+
+ private:
+  absl::Mutex mutex_;
+  std::vector<FreeList> batches_ ABSL_GUARDED_BY(mutex_);
+};
+
+// Set once the cache of the current thread is destroyed, after which the
+// thread allocates from the heap and frees straight to the pool.
+thread_local bool thread_holder_cache_destroyed = false;
+
+// The free blocks of one thread. Holders often die on a different thread than
+// the one that created them; blocks flow back through the shared pool once a
+// thread has cached two batches.
+class ThreadHolderCache {
+ public:
+  ~ThreadHolderCache() {
+    while (free_.size > 0) {
+      ReturnBatch();
+    }
+    thread_holder_cache_destroyed = true;
+  }
+
+  void* Allocate() {
+    if (free_.head == nullptr) {
+      free_ = HolderPool::Get()->TakeBatch();
+    }
+    FreeBlock* block = free_.head;
+    free_.head = block->next;
+    --free_.size;
+    return block;
+  }
+
+  void Free(void* ptr) {
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = free_.head;
+    free_.head = block;
+    if (++free_.size >= 2 * kHolderBatchSize) {
+      ReturnBatch();
+    }
+  }
+
+ private:
+  // Returns up to kHolderBatchSize cached blocks to the pool.
+  void ReturnBatch() {
+    FreeList batch;
+    batch.head = free_.head;
+    FreeBlock* last = free_.head;
+    batch.size = 1;
+    while (batch.size < kHolderBatchSize && last->next != nullptr) {
+      last = last->next;
+      ++batch.size;
+    }
+    free_.head = last->next;
+    free_.size -= batch.size;
+    last->next = nullptr;
+    HolderPool::Get()->ReturnBatch(batch);
+  }
+
+  FreeList free_;
+};
+
+ThreadHolderCache* GetThreadHolderCache() {
+  if (thread_holder_cache_destroyed) {
+    return nullptr;
+  }
+  thread_local ThreadHolderCache cache;
+  return &cache;
+}
+
+}  // namespace
+
+void* AllocateHolder(size_t size) {
+  if (size > kHolderBlockSize) {
+    return ::operator new(size);
+  }
+  ThreadHolderCache* cache = GetThreadHolderCache();
+  if (cache == nullptr) {
+    // Any block of the right size can join the pool when it is freed.
+    return ::operator new(kHolderBlockSize);
+  }
+  return cache->Allocate();
+}
+
+void FreeHolder(void* ptr, size_t size) {
+  if (size > kHolderBlockSize) {
+    ::operator delete(ptr);
+    return;
+  }
+  ThreadHolderCache* cache = GetThreadHolderCache();
+  if (cache == nullptr) {
+    FreeList block;
+    block.head = static_cast<FreeBlock*>(ptr);
+    block.head->next = nullptr;
+    block.size = 1;
+    HolderPool::Get()->ReturnBatch(block);
+    return;
+  }
+  cache->Free(ptr);
+}
+
+#else  // MEDIAPIPE_PACKET_HOLDER_POOL
+
+void* AllocateHolder(size_t size) { return ::operator new(size); }
+
+void FreeHolder(void* ptr, size_t size) { ::operator delete(ptr); }
+
+#endif  // MEDIAPIPE_PACKET_HOLDER_POOL
+
 HolderBase::~HolderBase() {}
 
 Packet Create(HolderBase* holder) {
   Packet result;
-  result.holder_.reset(holder);
+  result.holder_ = HolderPtr(holder);
   return result;
 }
 
 Packet Create(HolderBase* holder, Timestamp timestamp) {
   Packet result;
-  result.holder_.reset(holder);
+  result.holder_ = HolderPtr(holder);
   result.timestamp_ = timestamp;
   return result;
 }
 
-Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp) {
+Packet Create(HolderPtr holder, Timestamp timestamp) {
   Packet result;
   result.holder_ = std::move(holder);
   result.timestamp_ = timestamp;
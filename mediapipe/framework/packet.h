@@ -17,6 +17,7 @@
 #ifndef MEDIAPIPE_FRAMEWORK_PACKET_H_
 #define MEDIAPIPE_FRAMEWORK_PACKET_H_
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <string>
@@ -48,12 +49,56 @@ class Packet;
 namespace packet_internal {
 class HolderBase;
 
+// An intrusive reference-counting pointer to a HolderBase, shared by all the
+// packets holding the same payload. Unlike a shared_ptr it needs no separate
+// control block, and the count lives in the pooled holder allocation.
+class HolderPtr {
+ public:
+  HolderPtr() = default;
+  HolderPtr(std::nullptr_t) {}  // NOLINT(runtime/explicit)
+  // Adopts a newly created holder, which no HolderPtr refers to yet.
+  explicit HolderPtr(HolderBase* holder) : holder_(holder) {}
+  HolderPtr(const HolderPtr& other);
+  HolderPtr(HolderPtr&& other) noexcept : holder_(other.holder_) {
+    other.holder_ = nullptr;
+  }
+  HolderPtr& operator=(const HolderPtr& other);
+  HolderPtr& operator=(HolderPtr&& other) noexcept;
+  ~HolderPtr() { reset(); }
+
+  void reset();
+  HolderBase* get() const { return holder_; }
+  HolderBase* operator->() const { return holder_; }
+  HolderBase& operator*() const { return *holder_; }
+  explicit operator bool() const { return holder_ != nullptr; }
+  // Returns true if this is the only reference to the holder. The result is
+  // exact when no other thread is copying or releasing the same holder.
+  bool unique() const;
+
+  friend bool operator==(const HolderPtr& ptr, std::nullptr_t) {
+    return ptr.holder_ == nullptr;
+  }
+  friend bool operator!=(const HolderPtr& ptr, std::nullptr_t) {
+    return ptr.holder_ != nullptr;
+  }
+
+ private:
+  HolderBase* holder_ = nullptr;
+};
+
+// Allocate and free the memory of holders. Holders no larger than a few
+// pointers, which includes every Holder<T>, come from per-thread caches of
+// fixed-size blocks, so creating and destroying packets rarely reaches the
+// global heap. Defined in packet.cc.
+void* AllocateHolder(size_t size);
+void FreeHolder(void* ptr, size_t size);
+
 Packet Create(HolderBase* holder);
 Packet Create(HolderBase* holder, Timestamp timestamp);
-Packet Create(std::shared_ptr<HolderBase> holder, Timestamp timestamp);
+Packet Create(HolderPtr holder, Timestamp timestamp);
 const HolderBase* GetHolder(const Packet& packet);
-const std::shared_ptr<HolderBase>& GetHolderShared(const Packet& packet);
-std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet);
+const HolderPtr& GetHolderShared(const Packet& packet);
+HolderPtr GetHolderShared(Packet&& packet);
 absl::StatusOr<Packet> PacketFromDynamicProto(const std::string& type_name,
                                               const std::string& serialized);
 }  // namespace packet_internal
@@ -208,17 +253,16 @@ class Packet {
   friend Packet packet_internal::Create(packet_internal::HolderBase* holder);
   friend Packet packet_internal::Create(packet_internal::HolderBase* holder,
                                         class Timestamp timestamp);
-  friend Packet packet_internal::Create(
-      std::shared_ptr<packet_internal::HolderBase> holder,
-      class Timestamp timestamp);
+  friend Packet packet_internal::Create(packet_internal::HolderPtr holder,
+                                        class Timestamp timestamp);
   friend const packet_internal::HolderBase* packet_internal::GetHolder(
       const Packet& packet);
-  friend const std::shared_ptr<packet_internal::HolderBase>&
-  packet_internal::GetHolderShared(const Packet& packet);
-  friend std::shared_ptr<packet_internal::HolderBase>
-  packet_internal::GetHolderShared(Packet&& packet);
+  friend const packet_internal::HolderPtr& packet_internal::GetHolderShared(
+      const Packet& packet);
+  friend packet_internal::HolderPtr packet_internal::GetHolderShared(
+      Packet&& packet);
 
-  std::shared_ptr<packet_internal::HolderBase> holder_;
+  packet_internal::HolderPtr holder_;
   class Timestamp timestamp_;
 };
 
@@ -393,10 +437,53 @@ class HolderBase {
   virtual StatusOr<std::vector<const proto_ns::MessageLite*>>
   GetVectorOfProtoMessageLite() = 0;
 
+  static void* operator new(size_t size) { return AllocateHolder(size); }
+  static void operator delete(void* ptr, size_t size) {
+    FreeHolder(ptr, size);
+  }
+
  private:
+  friend class HolderPtr;
+
   size_t type_id_;
+  // The number of HolderPtrs referring to this holder. A new holder starts
+  // with the reference adopted by its first HolderPtr.
+  mutable std::atomic<int> ref_count_{1};
 };
 
+inline HolderPtr::HolderPtr(const HolderPtr& other) : holder_(other.holder_) {
+  if (holder_) {
+    holder_->ref_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+inline HolderPtr& HolderPtr::operator=(const HolderPtr& other) {
+  // Copies first, so that self-assignment keeps the holder alive.
+  HolderPtr copy(other);
+  return *this = std::move(copy);
+}
+
+inline HolderPtr& HolderPtr::operator=(HolderPtr&& other) noexcept {
+  if (this != &other) {
+    reset();
+    holder_ = other.holder_;
+    other.holder_ = nullptr;
+  }
+  return *this;
+}
+
+inline void HolderPtr::reset() {
+  if (holder_ &&
+      holder_->ref_count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    delete holder_;
+  }
+  holder_ = nullptr;
+}
+
+inline bool HolderPtr::unique() const {
+  return holder_ && holder_->ref_count_.load(std::memory_order_acquire) == 1;
+}
+
 // Two helper functions to get the proto base pointers.
 template <typename T>
 const proto_ns::MessageLite* ConvertToProtoMessageLite(const T* data,
@@ -809,12 +896,11 @@ inline bool operator!=(const Packet& p1, const Packet& p2) {
 
 namespace packet_internal {
 
-inline const std::shared_ptr<HolderBase>& GetHolderShared(
-    const Packet& packet) {
+inline const HolderPtr& GetHolderShared(const Packet& packet) {
   return packet.holder_;
 }
 
-inline std::shared_ptr<HolderBase> GetHolderShared(Packet&& packet) {
+inline HolderPtr GetHolderShared(Packet&& packet) {
   return std::move(packet.holder_);
 }
 
@@ -0,0 +1,207 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PACKET_QUEUE_H_
+#define MEDIAPIPE_FRAMEWORK_PACKET_QUEUE_H_
+
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+// A FIFO queue of packets, stored in a ring buffer.
+//
+// PacketQueue carries packets from the OutputStreamShards, through the
+// InputStreamHandlers, into the InputStreamManagers. Unlike std::list and
+// std::deque, it allocates nothing per packet: the ring only grows, to the
+// next power of two, when a packet is pushed into a full ring, and it keeps
+// its capacity when it is emptied or cleared. A queue whose size is bounded,
+// e.g. by the max_queue_size of a throttled input stream, therefore stops
+// allocating once its ring has grown to that size.
+//
+// The slot of a popped packet is reset right away, so that the queue does not
+// extend the lifetime of the packet payloads.
+//
+// PacketQueue is not thread-safe.
+class PacketQueue {
+  template <typename QueueType, typename PacketType>
+  class Iterator;
+
+ public:
+  using value_type = Packet;
+  using size_type = size_t;
+  using reference = Packet&;
+  using const_reference = const Packet&;
+  using iterator = Iterator<PacketQueue, Packet>;
+  using const_iterator = Iterator<const PacketQueue, const Packet>;
+
+  PacketQueue() = default;
+  PacketQueue(std::initializer_list<Packet> packets) {
+    reserve(packets.size());
+    for (const Packet& packet : packets) push_back(packet);
+  }
+
+  PacketQueue(const PacketQueue&) = delete;
+  PacketQueue& operator=(const PacketQueue&) = delete;
+
+  PacketQueue(PacketQueue&& other) noexcept { swap(other); }
+  PacketQueue& operator=(PacketQueue&& other) noexcept {
+    PacketQueue(std::move(other)).swap(*this);
+    return *this;
+  }
+
+  bool empty() const { return size_ == 0; }
+  size_t size() const { return size_; }
+  // Returns the number of packets the queue can hold without growing.
+  size_t capacity() const { return capacity_; }
+
+  // Returns the i-th packet from the front of the queue.
+  Packet& operator[](size_t i) { return buffer_[Slot(i)]; }
+  const Packet& operator[](size_t i) const { return buffer_[Slot(i)]; }
+
+  Packet& front() {
+    DCHECK(!empty());
+    return buffer_[head_];
+  }
+  const Packet& front() const {
+    DCHECK(!empty());
+    return buffer_[head_];
+  }
+  Packet& back() {
+    DCHECK(!empty());
+    return buffer_[Slot(size_ - 1)];
+  }
+  const Packet& back() const {
+    DCHECK(!empty());
+    return buffer_[Slot(size_ - 1)];
+  }
+
+  void push_back(const Packet& packet) {
+    if (size_ == capacity_) Grow(size_ + 1);
+    buffer_[Slot(size_)] = packet;
+    ++size_;
+  }
+  void push_back(Packet&& packet) {
+    if (size_ == capacity_) Grow(size_ + 1);
+    buffer_[Slot(size_)] = std::move(packet);
+    ++size_;
+  }
+
+  void pop_front() {
+    DCHECK(!empty());
+    buffer_[head_] = Packet();
+    head_ = (head_ + 1) & (capacity_ - 1);
+    --size_;
+  }
+
+  // Removes all packets, and keeps the capacity.
+  void clear() {
+    for (size_t i = 0; i < size_; ++i) {
+      buffer_[Slot(i)] = Packet();
+    }
+    head_ = 0;
+    size_ = 0;
+  }
+
+  // Makes room for at least "capacity" packets.
+  void reserve(size_t capacity) {
+    if (capacity > capacity_) Grow(capacity);
+  }
+
+  // Exchanges the packets and the rings of the two queues, in constant time.
+  void swap(PacketQueue& other) noexcept {
+    std::swap(buffer_, other.buffer_);
+    std::swap(capacity_, other.capacity_);
+    std::swap(head_, other.head_);
+    std::swap(size_, other.size_);
+  }
+
+  iterator begin() { return iterator(this, 0); }
+  iterator end() { return iterator(this, size_); }
+  const_iterator begin() const { return const_iterator(this, 0); }
+  const_iterator end() const { return const_iterator(this, size_); }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+ private:
+  // The smallest capacity of an allocated ring.
+  static constexpr size_t kMinCapacity = 4;
+
+  // Forward iterator over the packets, from the front to the back.
+  template <typename QueueType, typename PacketType>
+  class Iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = Packet;
+    using difference_type = std::ptrdiff_t;
+    using pointer = PacketType*;
+    using reference = PacketType&;
+
+    Iterator(QueueType* queue, size_t index) : queue_(queue), index_(index) {}
+
+    reference operator*() const { return (*queue_)[index_]; }
+    pointer operator->() const { return &(*queue_)[index_]; }
+    Iterator& operator++() {
+      ++index_;
+      return *this;
+    }
+    Iterator operator++(int) {
+      Iterator result = *this;
+      ++index_;
+      return result;
+    }
+    bool operator==(const Iterator& other) const {
+      return queue_ == other.queue_ && index_ == other.index_;
+    }
+    bool operator!=(const Iterator& other) const { return !(*this == other); }
+
+   private:
+    QueueType* queue_;
+    size_t index_;
+  };
+
+  // Returns the ring slot of the i-th packet from the front.
+  size_t Slot(size_t i) const { return (head_ + i) & (capacity_ - 1); }
+
+  // Moves the packets into a new ring of at least "min_capacity" slots, with
+  // the front packet in slot 0.
+  void Grow(size_t min_capacity) {
+    size_t capacity = capacity_ == 0 ? kMinCapacity : capacity_;
+    while (capacity < min_capacity) capacity *= 2;
+    std::unique_ptr<Packet[]> buffer(new Packet[capacity]);
+    for (size_t i = 0; i < size_; ++i) {
+      buffer[i] = std::move(buffer_[Slot(i)]);
+    }
+    buffer_ = std::move(buffer);
+    capacity_ = capacity;
+    head_ = 0;
+  }
+
+  // The ring. capacity_ is zero or a power of two.
+  std::unique_ptr<Packet[]> buffer_;
+  size_t capacity_ = 0;
+  // The slot of the front packet, and the number of packets.
+  size_t head_ = 0;
+  size_t size_ = 0;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PACKET_QUEUE_H_
@@ -0,0 +1,149 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/packet_queue.h"
+
+#include <vector>
+
+#include "mediapipe/framework/lifetime_tracker.h"
+#include "mediapipe/framework/packet.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+std::vector<int> Values(const PacketQueue& queue) {
+  std::vector<int> values;
+  for (const Packet& packet : queue) {
+    values.push_back(packet.Get<int>());
+  }
+  return values;
+}
+
+TEST(PacketQueueTest, PushAndPop) {
+  PacketQueue queue;
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.capacity(), 0);
+
+  for (int i = 0; i < 3; ++i) {
+    queue.push_back(MakePacket<int>(i).At(Timestamp(i)));
+  }
+  EXPECT_FALSE(queue.empty());
+  EXPECT_EQ(queue.size(), 3);
+  EXPECT_EQ(queue.front().Get<int>(), 0);
+  EXPECT_EQ(queue.back().Get<int>(), 2);
+  EXPECT_EQ(queue[1].Timestamp(), Timestamp(1));
+
+  queue.pop_front();
+  EXPECT_EQ(queue.size(), 2);
+  EXPECT_EQ(queue.front().Get<int>(), 1);
+  EXPECT_THAT(Values(queue), testing::ElementsAre(1, 2));
+}
+
+// The queue keeps the packet order while the packets wrap around the end of
+// the ring, and while the ring grows.
+TEST(PacketQueueTest, WrapsAroundAndGrows) {
+  PacketQueue queue;
+  int next_pushed = 0;
+  int next_popped = 0;
+  for (int round = 0; round < 50; ++round) {
+    // The queue gets one packet longer every round.
+    for (int i = 0; i < 3; ++i) {
+      queue.push_back(MakePacket<int>(next_pushed++));
+    }
+    for (int i = 0; i < 2; ++i) {
+      ASSERT_EQ(queue.front().Get<int>(), next_popped++);
+      queue.pop_front();
+    }
+    ASSERT_EQ(queue.size(), next_pushed - next_popped);
+    ASSERT_EQ(queue.back().Get<int>(), next_pushed - 1);
+  }
+  std::vector<int> expected;
+  for (int i = next_popped; i < next_pushed; ++i) {
+    expected.push_back(i);
+  }
+  EXPECT_EQ(Values(queue), expected);
+  // The capacity is a power of two.
+  EXPECT_EQ(queue.capacity(), 64);
+}
+
+TEST(PacketQueueTest, BoundedQueueDoesNotGrow) {
+  PacketQueue queue;
+  queue.reserve(5);
+  EXPECT_EQ(queue.capacity(), 8);
+  for (int i = 0; i < 1000; ++i) {
+    if (queue.size() == 8) {
+      queue.pop_front();
+    }
+    queue.push_back(MakePacket<int>(i));
+  }
+  EXPECT_EQ(queue.capacity(), 8);
+  EXPECT_EQ(queue.front().Get<int>(), 992);
+}
+
+TEST(PacketQueueTest, InitializerList) {
+  PacketQueue queue = {MakePacket<int>(1), MakePacket<int>(2)};
+  EXPECT_THAT(Values(queue), testing::ElementsAre(1, 2));
+}
+
+TEST(PacketQueueTest, ClearKeepsCapacity) {
+  PacketQueue queue;
+  for (int i = 0; i < 5; ++i) {
+    queue.push_back(MakePacket<int>(i));
+  }
+  const size_t capacity = queue.capacity();
+  queue.clear();
+  EXPECT_TRUE(queue.empty());
+  EXPECT_EQ(queue.capacity(), capacity);
+  queue.push_back(MakePacket<int>(7));
+  EXPECT_THAT(Values(queue), testing::ElementsAre(7));
+}
+
+// The queue releases the payloads of popped and cleared packets.
+TEST(PacketQueueTest, ReleasesPayloads) {
+  LifetimeTracker tracker;
+  PacketQueue queue;
+  for (int i = 0; i < 3; ++i) {
+    queue.push_back(Adopt(tracker.MakeObject().release()));
+  }
+  EXPECT_EQ(tracker.live_count(), 3);
+  queue.pop_front();
+  EXPECT_EQ(tracker.live_count(), 2);
+  queue.clear();
+  EXPECT_EQ(tracker.live_count(), 0);
+}
+
+TEST(PacketQueueTest, MoveAndSwap) {
+  PacketQueue queue;
+  queue.push_back(MakePacket<int>(1));
+  queue.push_back(MakePacket<int>(2));
+  Packet moved = std::move(queue.front());
+  EXPECT_TRUE(queue.front().IsEmpty());
+  EXPECT_EQ(moved.Get<int>(), 1);
+
+  PacketQueue other;
+  other.push_back(MakePacket<int>(3));
+  queue.swap(other);
+  EXPECT_THAT(Values(queue), testing::ElementsAre(3));
+  EXPECT_EQ(other.size(), 2);
+  EXPECT_EQ(other.back().Get<int>(), 2);
+
+  PacketQueue moved_queue(std::move(other));
+  EXPECT_EQ(moved_queue.size(), 2);
+  EXPECT_TRUE(other.empty());  // NOLINT: checks the moved-from state.
+}
+
+}  // namespace
+}  // namespace mediapipe
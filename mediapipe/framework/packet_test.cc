@@ -17,11 +17,13 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/packet_test.pb.h"
+#include "mediapipe/framework/port/benchmark.h"
 #include "mediapipe/framework/port/core_proto_inc.h"
 #include "mediapipe/framework/port/gmock.h"
 #include "mediapipe/framework/port/gtest.h"
@@ -502,5 +504,107 @@ TEST(PacketTest, SharedPtrWithPacketOwnership) {
   EXPECT_EQ(exist, false);
 }
 
+TEST(PacketTest, CopiesShareHolder) {
+  Packet packet = MakePacket<int>(7);
+  {
+    Packet copy = packet;
+    Packet assigned;
+    assigned = copy;
+    EXPECT_EQ(assigned, packet);
+    EXPECT_EQ(assigned.Get<int>(), 7);
+    // Other packets share the holder, so its payload can't be consumed.
+    EXPECT_EQ(packet.Consume<int>().status().code(),
+              absl::StatusCode::kFailedPrecondition);
+  }
+  auto consumed = packet.Consume<int>();
+  MP_ASSERT_OK(consumed);
+  EXPECT_EQ(*consumed.value(), 7);
+  EXPECT_TRUE(packet.IsEmpty());
+}
+
+// Packets made on one thread and released on others reuse their holders'
+// memory through the shared holder pool.
+TEST(PacketTest, ReleasesPacketsOnOtherThreads) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumPackets = 1000;
+  std::vector<std::vector<Packet>> packets(kNumThreads);
+  for (int i = 0; i < kNumThreads; ++i) {
+    for (int j = 0; j < kNumPackets; ++j) {
+      packets[i].push_back(MakePacket<int>(i * kNumPackets + j));
+    }
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    threads.emplace_back([&packets, i] {
+      for (int j = 0; j < kNumPackets; ++j) {
+        EXPECT_EQ(packets[i][j].Get<int>(), i * kNumPackets + j);
+      }
+      packets[i].clear();
+      // Allocates from the blocks freed above.
+      std::vector<Packet> more;
+      for (int j = 0; j < kNumPackets; ++j) {
+        more.push_back(MakePacket<std::string>(absl::StrCat(j)));
+      }
+      for (int j = 0; j < kNumPackets; ++j) {
+        EXPECT_EQ(more[j].Get<std::string>(), absl::StrCat(j));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+}
+
+// Releasing more packets than the holder pool keeps frees the extra holders,
+// and the pool still hands out working holders afterwards.
+TEST(PacketTest, ReleasesBurstOfPackets) {
+  constexpr int kNumPackets = 64 * 1024;
+  std::vector<Packet> packets;
+  for (int i = 0; i < kNumPackets; ++i) {
+    packets.push_back(MakePacket<int>(i));
+  }
+  std::thread([&packets] { packets.clear(); }).join();
+  for (int i = 0; i < kNumPackets; ++i) {
+    packets.push_back(MakePacket<int>(-i));
+  }
+  for (int i = 0; i < kNumPackets; ++i) {
+    EXPECT_EQ(packets[i].Get<int>(), -i);
+  }
+}
+
+void BM_MakePacket(benchmark::State& state) {
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(1).At(Timestamp(1));
+    benchmark::DoNotOptimize(packet);
+  }
+}
+BENCHMARK(BM_MakePacket);
+
+void BM_CopyPacket(benchmark::State& state) {
+  const Packet packet = MakePacket<int>(1).At(Timestamp(1));
+  for (auto _ : state) {
+    Packet copy = packet;
+    benchmark::DoNotOptimize(copy);
+  }
+}
+BENCHMARK(BM_CopyPacket);
+
+// Copies a packet to as many consumers as the benchmark argument, as an output
+// stream does for its mirrors, then releases all the copies.
+void BM_FanOutPacket(benchmark::State& state) {
+  std::vector<Packet> consumers(state.range(0));
+  for (auto _ : state) {
+    Packet packet = MakePacket<int>(1).At(Timestamp(1));
+    for (Packet& consumer : consumers) {
+      consumer = packet;
+    }
+    for (Packet& consumer : consumers) {
+      consumer = Packet();
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_FanOutPacket)->Arg(1)->Arg(4)->Arg(16);
+
 }  // namespace
 }  // namespace mediapipe
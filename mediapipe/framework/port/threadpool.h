@@ -16,5 +16,6 @@
 #define MEDIAPIPE_PORT_THREADPOOL_H_
 
 #include "mediapipe/framework/deps/threadpool.h"
+#include "mediapipe/framework/deps/work_stealing_threadpool.h"
 
 #endif  // MEDIAPIPE_PORT_THREADPOOL_H_
@@ -0,0 +1,259 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <algorithm>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+
+namespace mediapipe {
+
+namespace {
+
+// The process id reported for all trace events.
+constexpr int kProcessId = 1;
+
+// The number of recent packets remembered for each stream.
+constexpr int kRecentPacketCount = 100;
+
+// Returns a quoted and escaped JSON string.
+std::string JsonString(const std::string& s) {
+  std::string result = "\"";
+  for (char c : s) {
+    switch (c) {
+      case '"':
+        result += "\\\"";
+        break;
+      case '\\':
+        result += "\\\\";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      case '\t':
+        result += "\\t";
+        break;
+      default:
+        if (static_cast<unsigned char>(c) < 0x20) {
+          absl::StrAppendFormat(&result, "\\u%04x", c);
+        } else {
+          result += c;
+        }
+    }
+  }
+  result += "\"";
+  return result;
+}
+
+// Returns true for the events that represent a call into a calculator.
+bool IsCalculatorCall(GraphTrace::EventType event_type) {
+  return event_type == GraphTrace::OPEN || event_type == GraphTrace::PROCESS ||
+         event_type == GraphTrace::CLOSE;
+}
+
+// Returns the name of a calculator node.
+std::string NodeName(const GraphTrace& trace, int node_id) {
+  if (node_id >= 0 && node_id < trace.calculator_name_size()) {
+    return trace.calculator_name(node_id);
+  }
+  return absl::StrCat("node_", node_id);
+}
+
+// Returns the name of a stream.
+std::string StreamName(const GraphTrace& trace, int stream_id) {
+  if (stream_id >= 0 && stream_id < trace.stream_name_size()) {
+    return trace.stream_name(stream_id);
+  }
+  return absl::StrCat("stream_", stream_id);
+}
+
+}  // namespace
+
+void ChromeTraceWriter::SetGraphConfig(const CalculatorGraphConfig& config) {
+  node_executors_.clear();
+  for (const auto& node : config.node()) {
+    node_executors_.push_back(node.executor());
+  }
+}
+
+void ChromeTraceWriter::StartFile(std::string* out) {
+  named_threads_.clear();
+  open_slices_.clear();
+  packet_sources_.clear();
+  executor_queues_.clear();
+  absl::StrAppend(out, "[\n");
+  absl::StrAppend(out, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":",
+                  kProcessId, ",\"args\":{\"name\":\"MediaPipe\"}},\n");
+}
+
+std::string ChromeTraceWriter::ExecutorName(int node_id) const {
+  if (node_id >= 0 && node_id < node_executors_.size() &&
+      !node_executors_[node_id].empty()) {
+    return node_executors_[node_id];
+  }
+  return "default";
+}
+
+void ChromeTraceWriter::WriteThreadName(int32 thread_id, int node_id,
+                                        std::string* out) {
+  if (!named_threads_.insert(thread_id).second) {
+    return;
+  }
+  std::string name = absl::StrCat(ExecutorName(node_id), " ", thread_id);
+  absl::StrAppend(out, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":",
+                  kProcessId, ",\"tid\":", thread_id,
+                  ",\"args\":{\"name\":", JsonString(name), "}},\n");
+}
+
+void ChromeTraceWriter::WriteTrace(const GraphTrace& trace, std::string* out) {
+  std::vector<QueueDelta> queue_deltas;
+  for (const GraphTrace::CalculatorTrace& event : trace.calculator_trace()) {
+    if (event.event_type() == GraphTrace::PACKET_QUEUED) {
+      WriteQueueSizes(trace, event, out);
+      continue;
+    }
+    WriteCalculatorTrace(trace, event, &queue_deltas, out);
+  }
+  WriteExecutorQueues(&queue_deltas, out);
+}
+
+void ChromeTraceWriter::WriteCalculatorTrace(
+    const GraphTrace& trace, const GraphTrace::CalculatorTrace& event,
+    std::vector<QueueDelta>* queue_deltas, std::string* out) {
+  int32 tid = event.thread_id();
+  int64 start_time = trace.base_time() + event.start_time();
+  int64 finish_time = trace.base_time() + event.finish_time();
+  bool is_call = IsCalculatorCall(event.event_type());
+  WriteThreadName(tid, event.node_id(), out);
+
+  // Count the invocations waiting for an executor thread.
+  if (event.event_type() == GraphTrace::READY_FOR_PROCESS) {
+    queue_deltas->push_back({start_time, ExecutorName(event.node_id()), 1});
+  } else if (event.event_type() == GraphTrace::PROCESS &&
+             event.has_start_time()) {
+    queue_deltas->push_back({start_time, ExecutorName(event.node_id()), -1});
+  }
+
+  // A trace interval contains a complete slice for each call, and a log
+  // interval contains separate events for the start and finish of each call.
+  std::string phase;
+  if (event.has_start_time() && event.has_finish_time()) {
+    phase = absl::StrCat("\"ph\":\"X\",\"ts\":", start_time,
+                         ",\"dur\":", finish_time - start_time);
+  } else if (is_call && event.has_start_time()) {
+    phase = absl::StrCat("\"ph\":\"B\",\"ts\":", start_time);
+    open_slices_[tid] = {start_time, true};
+  } else if (is_call && event.has_finish_time()) {
+    // Each output packet is logged separately, so only the first finish
+    // event closes the slice.
+    auto slice = open_slices_.find(tid);
+    if (slice != open_slices_.end() && slice->second.is_open) {
+      phase = absl::StrCat("\"ph\":\"E\",\"ts\":", finish_time);
+      slice->second.is_open = false;
+    }
+  } else {
+    int64 time = event.has_start_time() ? start_time : finish_time;
+    phase = absl::StrCat("\"ph\":\"i\",\"s\":\"t\",\"ts\":", time);
+  }
+  std::string args;
+  if (event.has_input_timestamp()) {
+    args = absl::StrCat(",\"args\":{\"input_timestamp\":",
+                        trace.base_timestamp() + event.input_timestamp(), "}");
+  }
+  if (!phase.empty()) {
+    std::string name = NodeName(trace, event.node_id());
+    const std::string& category =
+        GraphTrace::EventType_Name(event.event_type());
+    absl::StrAppend(out, "{\"name\":", JsonString(name),
+                    ",\"cat\":", JsonString(category), ",", phase,
+                    ",\"pid\":", kProcessId, ",\"tid\":", tid, args, "},\n");
+  }
+  if (!is_call) {
+    return;
+  }
+
+  // Draw an arrow from the producer of each input packet to this call.
+  for (const GraphTrace::StreamTrace& input : event.input_trace()) {
+    if (!event.has_start_time()) break;
+    std::string stream_name = StreamName(trace, input.stream_id());
+    auto sources = packet_sources_.find(stream_name);
+    if (sources == packet_sources_.end()) continue;
+    auto source = sources->second.find(trace.base_timestamp() +
+                                       input.packet_timestamp());
+    if (source == sources->second.end()) continue;
+    int64 flow_id = next_flow_id_++;
+    std::string flow_name = absl::StrCat(
+        "{\"name\":", JsonString(stream_name), ",\"cat\":\"packet\",\"id\":",
+        flow_id, ",\"pid\":", kProcessId);
+    absl::StrAppend(out, flow_name, ",\"ph\":\"s\",\"tid\":",
+                    source->second.thread_id, ",\"ts\":", source->second.time,
+                    "},\n");
+    absl::StrAppend(out, flow_name, ",\"ph\":\"f\",\"bp\":\"e\",\"tid\":", tid,
+                    ",\"ts\":", start_time, "},\n");
+  }
+
+  // Remember the producer of each output packet.
+  int64 slice_start = start_time;
+  if (!event.has_start_time()) {
+    auto open_slice = open_slices_.find(tid);
+    slice_start = (open_slice != open_slices_.end())
+                      ? open_slice->second.start_time
+                      : finish_time;
+  }
+  for (const GraphTrace::StreamTrace& output : event.output_trace()) {
+    auto& sources = packet_sources_[StreamName(trace, output.stream_id())];
+    sources[trace.base_timestamp() + output.packet_timestamp()] = {
+        tid, slice_start};
+    if (sources.size() > kRecentPacketCount) {
+      sources.erase(sources.begin());
+    }
+  }
+}
+
+void ChromeTraceWriter::WriteQueueSizes(
+    const GraphTrace& trace, const GraphTrace::CalculatorTrace& event,
+    std::string* out) {
+  std::string node_name = NodeName(trace, event.node_id());
+  for (const GraphTrace::StreamTrace& input : event.input_trace()) {
+    int64 time = trace.base_time() + (input.has_finish_time()
+                                          ? input.finish_time()
+                                          : event.start_time());
+    std::string name = absl::StrCat(
+        node_name, " ", StreamName(trace, input.stream_id()), " queue");
+    absl::StrAppend(out, "{\"name\":", JsonString(name),
+                    ",\"ph\":\"C\",\"pid\":", kProcessId, ",\"ts\":", time,
+                    ",\"args\":{\"size\":", input.event_data(), "}},\n");
+  }
+}
+
+void ChromeTraceWriter::WriteExecutorQueues(
+    std::vector<QueueDelta>* queue_deltas, std::string* out) {
+  std::stable_sort(queue_deltas->begin(), queue_deltas->end(),
+                   [](const QueueDelta& a, const QueueDelta& b) {
+                     return a.time < b.time;
+                   });
+  for (const QueueDelta& d : *queue_deltas) {
+    // Invocations queued before the file started are not counted.
+    int& depth = executor_queues_[d.executor];
+    depth = std::max(0, depth + d.delta);
+    std::string name = absl::StrCat(d.executor, " executor queue");
+    absl::StrAppend(out, "{\"name\":", JsonString(name),
+                    ",\"ph\":\"C\",\"pid\":", kProcessId, ",\"ts\":", d.time,
+                    ",\"args\":{\"depth\":", depth, "}},\n");
+  }
+}
+
+}  // namespace mediapipe
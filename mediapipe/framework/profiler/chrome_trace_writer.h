@@ -0,0 +1,113 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Converts successive GraphTrace intervals into the Chrome trace-event JSON
+// format, which can be loaded by chrome://tracing and by ui.perfetto.dev.
+//
+// The output is a JSON array that is written incrementally and never closed,
+// which both viewers accept.  This allows each trace interval to be appended
+// to the log file as soon as it is captured.  The output contains:
+//   - a track for each thread, named after the executor running on it,
+//   - a slice for each Open, Process, and Close call,
+//   - a flow arrow from the call producing a packet to each call consuming it,
+//   - a counter for the queue size of each calculator input stream,
+//   - a counter for the number of invocations queued on each executor.
+//
+// ChromeTraceWriter is not thread-safe.
+class ChromeTraceWriter {
+ public:
+  ChromeTraceWriter() = default;
+
+  // Records the graph config, which identifies the executor for each node.
+  void SetGraphConfig(const CalculatorGraphConfig& config);
+
+  // Begins a new JSON array, and forgets threads and packets seen previously.
+  void StartFile(std::string* out);
+
+  // Appends the trace events from one GraphTrace interval.
+  // GraphTrace intervals must be written in order of time.
+  void WriteTrace(const GraphTrace& trace, std::string* out);
+
+ private:
+  // The thread and time at which a packet was produced.
+  struct PacketSource {
+    int32 thread_id;
+    int64 time;
+  };
+
+  // A calculator call logged as separate start and finish events.
+  struct Slice {
+    int64 start_time;
+    bool is_open;
+  };
+
+  // A change in the number of invocations queued on an executor.
+  struct QueueDelta {
+    int64 time;
+    std::string executor;
+    int delta;
+  };
+
+  // Returns the display name for an executor.
+  std::string ExecutorName(int node_id) const;
+
+  // Names the track for a thread the first time the thread is seen.
+  void WriteThreadName(int32 thread_id, int node_id, std::string* out);
+
+  // Appends a slice, flow, or instant event for one CalculatorTrace.
+  void WriteCalculatorTrace(const GraphTrace& trace,
+                            const GraphTrace::CalculatorTrace& event,
+                            std::vector<QueueDelta>* queue_deltas,
+                            std::string* out);
+
+  // Appends the input stream queue sizes for a PACKET_QUEUED event.
+  void WriteQueueSizes(const GraphTrace& trace,
+                       const GraphTrace::CalculatorTrace& event,
+                       std::string* out);
+
+  // Appends the executor queue depths in order of time.
+  void WriteExecutorQueues(std::vector<QueueDelta>* queue_deltas,
+                           std::string* out);
+
+  // The executor name for each node id.
+  std::vector<std::string> node_executors_;
+  // The threads that have been named in the current file.
+  std::set<int32> named_threads_;
+  // The latest slice started on each thread, for instant events.
+  std::map<int32, Slice> open_slices_;
+  // The recent packet sources indexed by stream name and packet timestamp.
+  std::map<std::string, std::map<int64, PacketSource>> packet_sources_;
+  // The number of invocations queued on each executor.
+  std::map<std::string, int> executor_queues_;
+  // The identifier for the next flow arrow.
+  int64 next_flow_id_ = 1;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_CHROME_TRACE_WRITER_H_
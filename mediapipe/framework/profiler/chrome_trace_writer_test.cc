@@ -0,0 +1,191 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
+
+#include <string>
+
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+// A graph where "source" sends one packet to "sink".
+CalculatorGraphConfig SourceSinkConfig() {
+  return ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+    executor { name: "source_executor" }
+    node { calculator: "source" output_stream: "packets" }
+    node {
+      calculator: "sink"
+      input_stream: "packets"
+      executor: "source_executor"
+    }
+  )pb");
+}
+
+TEST(ChromeTraceWriterTest, WritesSlicesFlowsAndCounters) {
+  GraphTrace trace = ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_time: 1000000
+    base_timestamp: 0
+    calculator_name: "source"
+    calculator_name: "sink"
+    stream_name: ""
+    stream_name: "packets"
+    calculator_trace {
+      node_id: 0
+      input_timestamp: 100
+      event_type: PROCESS
+      start_time: 10
+      finish_time: 20
+      output_trace { packet_timestamp: 100 stream_id: 1 }
+      thread_id: 3
+    }
+    calculator_trace {
+      node_id: 1
+      input_timestamp: 100
+      event_type: PACKET_QUEUED
+      start_time: 20
+      input_trace {
+        finish_time: 20
+        packet_timestamp: 100
+        stream_id: 1
+        event_data: 2
+      }
+      thread_id: 3
+    }
+    calculator_trace {
+      node_id: 1
+      event_type: READY_FOR_PROCESS
+      start_time: 21
+      thread_id: 3
+    }
+    calculator_trace {
+      node_id: 1
+      input_timestamp: 100
+      event_type: PROCESS
+      start_time: 30
+      finish_time: 45
+      input_trace {
+        start_time: 20
+        finish_time: 30
+        packet_timestamp: 100
+        stream_id: 1
+      }
+      thread_id: 4
+    }
+  )pb");
+
+  ChromeTraceWriter writer;
+  writer.SetGraphConfig(SourceSinkConfig());
+  std::string json;
+  writer.StartFile(&json);
+  writer.WriteTrace(trace, &json);
+
+  EXPECT_THAT(json, StartsWith("[\n"));
+  // A named track for each thread.
+  EXPECT_THAT(json, HasSubstr(R"("tid":3,"args":{"name":"default 3"})"));
+  EXPECT_THAT(json,
+              HasSubstr(R"("tid":4,"args":{"name":"source_executor 4"})"));
+  // A slice for each Process call.
+  EXPECT_THAT(json, HasSubstr(R"({"name":"source","cat":"PROCESS","ph":"X",)"
+                              R"("ts":1000010,"dur":10,"pid":1,"tid":3,)"
+                              R"("args":{"input_timestamp":100}})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"sink","cat":"PROCESS","ph":"X",)"
+                              R"("ts":1000030,"dur":15,"pid":1,"tid":4,)"));
+  // An arrow from "source" to "sink".
+  EXPECT_THAT(json, HasSubstr(R"({"name":"packets","cat":"packet","id":1,)"
+                              R"("pid":1,"ph":"s","tid":3,"ts":1000010})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"packets","cat":"packet","id":1,)"
+                              R"("pid":1,"ph":"f","bp":"e","tid":4,)"
+                              R"("ts":1000030})"));
+  // The input queue size and the executor queue depth.
+  EXPECT_THAT(json, HasSubstr(R"({"name":"sink packets queue","ph":"C",)"
+                              R"("pid":1,"ts":1000020,"args":{"size":2}})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"source_executor executor queue",)"
+                              R"("ph":"C","pid":1,"ts":1000021,)"
+                              R"("args":{"depth":1}})"));
+  EXPECT_THAT(json, HasSubstr(R"({"name":"source_executor executor queue",)"
+                              R"("ph":"C","pid":1,"ts":1000030,)"
+                              R"("args":{"depth":0}})"));
+}
+
+TEST(ChromeTraceWriterTest, WritesInstantEventsAsBeginAndEnd) {
+  GraphTrace trace = ParseTextProtoOrDie<GraphTrace>(R"pb(
+    base_time: 0
+    calculator_name: "source"
+    stream_name: ""
+    stream_name: "packets"
+    calculator_trace { node_id: 0 event_type: PROCESS start_time: 10 }
+    calculator_trace {
+      node_id: 0
+      event_type: PROCESS
+      finish_time: 20
+      output_trace { packet_timestamp: 100 stream_id: 1 }
+    }
+    calculator_trace {
+      node_id: 0
+      event_type: PROCESS
+      finish_time: 20
+      output_trace { packet_timestamp: 100 stream_id: 1 }
+    }
+    calculator_trace { node_id: 0 event_type: NOT_READY start_time: 25 }
+  )pb");
+
+  ChromeTraceWriter writer;
+  std::string json;
+  writer.StartFile(&json);
+  writer.WriteTrace(trace, &json);
+
+  EXPECT_THAT(json, HasSubstr(R"("ph":"B","ts":10,)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"E","ts":20,)"));
+  EXPECT_THAT(json, HasSubstr(R"("ph":"i","s":"t","ts":25,)"));
+  // The second output event does not close another slice.
+  EXPECT_EQ(json.find(R"("ph":"E")"), json.rfind(R"("ph":"E")"));
+}
+
+TEST(ChromeTraceWriterTest, StartFileForgetsThreads) {
+  GraphTrace trace = ParseTextProtoOrDie<GraphTrace>(R"pb(
+    calculator_name: "source"
+    calculator_trace {
+      node_id: 0
+      event_type: PROCESS
+      start_time: 10
+      finish_time: 20
+      thread_id: 7
+    }
+  )pb");
+
+  ChromeTraceWriter writer;
+  std::string json;
+  writer.StartFile(&json);
+  writer.WriteTrace(trace, &json);
+  writer.WriteTrace(trace, &json);
+  EXPECT_EQ(json.find("thread_name"), json.rfind("thread_name"));
+
+  json.clear();
+  writer.StartFile(&json);
+  writer.WriteTrace(trace, &json);
+  EXPECT_THAT(json, HasSubstr("thread_name"));
+  EXPECT_THAT(json, Not(HasSubstr("]")));
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -152,6 +152,7 @@ void GraphProfiler::Initialize(
                              &profile);
     }
 
+    reset_profiles_[node_name] = profile;
     auto iter = calculator_profiles_.insert({node_name, profile});
     CHECK(iter.second) << absl::Substitute(
         "Calculator \"$0\" has already been added.", node_name);
@@ -188,6 +189,7 @@ void GraphProfiler::Reset() {
   for (auto iter = calculator_profiles_.begin();
        iter != calculator_profiles_.end(); ++iter) {
     CalculatorProfile* calculator_profile = &iter->second;
+    AddProcessHistograms(*calculator_profile, &reset_profiles_[iter->first]);
     ResetTimeHistogram(calculator_profile->mutable_process_runtime());
     ResetTimeHistogram(calculator_profile->mutable_process_input_latency());
     ResetTimeHistogram(calculator_profile->mutable_process_output_latency());
@@ -292,6 +294,21 @@ absl::Status GraphProfiler::GetCalculatorProfiles(
   return absl::OkStatus();
 }
 
+void GraphProfiler::CollectCalculatorProfiles(
+    std::vector<CalculatorProfile>* profiles) const {
+  // calculator_profiles_ gains no entries after is_initialized_ is set.
+  if (!is_initialized_) {
+    return;
+  }
+  for (auto& entry : calculator_profiles_) {
+    profiles->push_back(entry.second);
+    auto reset_profile = reset_profiles_.find(entry.first);
+    if (reset_profile != reset_profiles_.end()) {
+      AddProcessHistograms(reset_profile->second, &profiles->back());
+    }
+  }
+}
+
 void GraphProfiler::InitializeTimeHistogram(int64 interval_size_usec,
                                             int64 num_intervals,
                                             TimeHistogram* histogram) {
@@ -354,6 +371,38 @@ void GraphProfiler::ResetTimeHistogram(TimeHistogram* histogram) {
   }
 }
 
+void GraphProfiler::AddTimeHistogram(const TimeHistogram& source,
+                                     TimeHistogram* histogram) {
+  histogram->set_total(histogram->total() + source.total());
+  for (int i = 0; i < source.count_size() && i < histogram->count_size();
+       ++i) {
+    histogram->set_count(i, histogram->count(i) + source.count(i));
+  }
+}
+
+void GraphProfiler::AddProcessHistograms(const CalculatorProfile& source,
+                                         CalculatorProfile* profile) {
+  if (source.has_process_runtime()) {
+    AddTimeHistogram(source.process_runtime(),
+                     profile->mutable_process_runtime());
+  }
+  if (source.has_process_input_latency()) {
+    AddTimeHistogram(source.process_input_latency(),
+                     profile->mutable_process_input_latency());
+  }
+  if (source.has_process_output_latency()) {
+    AddTimeHistogram(source.process_output_latency(),
+                     profile->mutable_process_output_latency());
+  }
+  for (int i = 0; i < source.input_stream_profiles_size() &&
+                  i < profile->input_stream_profiles_size();
+       ++i) {
+    StreamProfile* stream_profile = profile->mutable_input_stream_profiles(i);
+    AddTimeHistogram(source.input_stream_profiles(i).latency(),
+                     stream_profile->mutable_latency());
+  }
+}
+
 void GraphProfiler::AddPacketInfoInternal(const PacketId& packet_id,
                                           int64 production_time_usec,
                                           int64 source_process_start_usec) {
@@ -634,14 +683,29 @@ absl::Status GraphProfiler::WriteProfile() {
   }
 
   // Write the GraphProfile to the trace_log_path.
+  bool is_chrome_trace = profiler_config_.trace_log_format() ==
+                         ProfilerConfig::CHROME_TRACE_JSON;
   int log_index = previous_log_index_ / log_interval_count % log_file_count;
-  std::string log_path = absl::StrCat(trace_log_path, log_index, ".binarypb");
+  std::string log_path = absl::StrCat(trace_log_path, log_index,
+                                      is_chrome_trace ? ".json" : ".binarypb");
   std::ofstream ofs;
   if (is_new_file) {
     ofs.open(log_path, std::ofstream::out | std::ofstream::trunc);
   } else {
     ofs.open(log_path, std::ofstream::out | std::ofstream::app);
   }
+  if (is_chrome_trace) {
+    // Append the trace events to the open JSON array.
+    std::string json;
+    if (is_new_file) {
+      chrome_trace_writer_.SetGraphConfig(profile.config());
+      chrome_trace_writer_.StartFile(&json);
+    }
+    chrome_trace_writer_.WriteTrace(trace, &json);
+    ofs << json;
+    RET_CHECK(ofs.good()) << "Could not write Chrome trace to: " << log_path;
+    return absl::OkStatus();
+  }
   OstreamStream out(&ofs);
   RET_CHECK(profile.SerializeToZeroCopyStream(&out))
       << "Could not write binary GraphProfile to: " << log_path;
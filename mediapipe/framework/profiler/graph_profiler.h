@@ -17,6 +17,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -30,6 +31,7 @@
 #include "mediapipe/framework/deps/monotonic_clock.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/profiler/chrome_trace_writer.h"
 #include "mediapipe/framework/profiler/graph_tracer.h"
 #include "mediapipe/framework/profiler/sharded_map.h"
 #include "mediapipe/framework/validated_graph_config.h"
@@ -153,6 +155,14 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   absl::Status GetCalculatorProfiles(std::vector<CalculatorProfile>*) const
       ABSL_LOCKS_EXCLUDED(profiler_mutex_);
 
+  // Collects the same CalculatorProfiles as GetCalculatorProfiles, without
+  // acquiring profiler_mutex_, so that periodic metrics collection never
+  // waits for Pause() or Reset().  Each profile is copied under its own
+  // shard lock.  Returns no profiles before the profiler is initialized.
+  // The Process() histograms count every sample since Initialize(), including
+  // those cleared by Reset(), so that exported counters never decrease.
+  void CollectCalculatorProfiles(std::vector<CalculatorProfile>*) const;
+
   // Records recent profiling and tracing data.  Includes events since the
   // previous call to CaptureProfile.
   absl::Status CaptureProfile(GraphProfile* result);
@@ -243,6 +253,13 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
                                       int64 num_intervals,
                                       TimeHistogram* histogram);
   static void ResetTimeHistogram(TimeHistogram* histogram);
+  // Adds the counts of one time histogram to another with the same intervals.
+  static void AddTimeHistogram(const TimeHistogram& source,
+                               TimeHistogram* histogram);
+  // Adds the Process() histograms of one profile to another of the same
+  // calculator.
+  static void AddProcessHistograms(const CalculatorProfile& source,
+                                   CalculatorProfile* profile);
   // Add a sample to a time histogram.
   static void AddTimeSample(int64 start_time_usec, int64 end_time_usec,
                             TimeHistogram* histogram);
@@ -319,6 +336,11 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // Stores all the calculator profiles with the calculator name as the key.
   using CalculatorProfileMap = ShardedMap<std::string, CalculatorProfile>;
   CalculatorProfileMap calculator_profiles_;
+  // Stores the Process() histograms cleared by Reset() with the calculator
+  // name as the key.  It gains no entries after is_initialized_ is set, and
+  // an entry is only accessed under the calculator_profiles_ shard lock of
+  // the same calculator.
+  std::map<std::string, CalculatorProfile> reset_profiles_;
   // Stores the production time of a packet, based on profiler's clock.
   using PacketInfoMap =
       ShardedMap<std::string, std::list<std::pair<int64, PacketInfo>>>;
@@ -342,6 +364,9 @@ class GraphProfiler : public std::enable_shared_from_this<ProfilingContext> {
   // The index number of the previous output log.
   int previous_log_index_;
 
+  // Converts trace log output to Chrome trace-event JSON.
+  ChromeTraceWriter chrome_trace_writer_;
+
   // The configuration for the graph being profiled.
   const ValidatedGraphConfig* validated_graph_;
 
@@ -85,6 +85,8 @@ class GraphProfilerStub {
       std::vector<CalculatorProfile>*) const {
     return absl::OkStatus();
   }
+  inline void CollectCalculatorProfiles(
+      std::vector<CalculatorProfile>*) const {}
   inline void Pause() {}
   inline void Resume() {}
   inline void Reset() {}
@@ -511,6 +511,49 @@ TEST_F(GraphProfilerTestPeer, PauseResumeReset) {
   simulation_clock->ThreadFinish();
 }
 
+// Tests that CollectCalculatorProfiles() keeps the samples cleared by Reset().
+TEST_F(GraphProfilerTestPeer, CollectCalculatorProfilesAfterReset) {
+  InitializeProfilerWithGraphConfig(R"(
+    profiler_config {
+      enable_profiler: true
+    }
+    input_stream: "input_stream"
+    node {
+      calculator: "DummyTestCalculator"
+      input_stream: "input_stream"
+      output_stream: "output_stream"
+    })");
+  std::shared_ptr<mediapipe::SimulationClock> simulation_clock(
+      new SimulationClock());
+  simulation_clock->ThreadStart();
+  profiler_.SetClock(simulation_clock);
+
+  TestContextBuilder context(kDummyTestCalculatorName, /*node_id=*/0,
+                             {"input_stream"}, {"output_stream"});
+  context.AddInputs({MakePacket<std::string>("15").At(Timestamp(100))});
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS, context.get(),
+                                        &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(10));
+  }
+  profiler_.Reset();
+  {
+    GraphProfiler::Scope profiler_scope(GraphTrace::PROCESS, context.get(),
+                                        &profiler_);
+    simulation_clock->Sleep(absl::Microseconds(1000));
+  }
+  ASSERT_THAT(Profiles()[0].process_runtime(),
+              Partially(EqualsProto(CreateTimeHistogram(/*total=*/1000, {1}))));
+
+  std::vector<CalculatorProfile> profiles;
+  profiler_.CollectCalculatorProfiles(&profiles);
+  ASSERT_EQ(profiles.size(), 1);
+  EXPECT_THAT(profiles[0].process_runtime(),
+              Partially(EqualsProto(CreateTimeHistogram(/*total=*/1010, {2}))));
+
+  simulation_clock->ThreadFinish();
+}
+
 // Tests that AddPacketInfo() uses packet timestamp when
 // use_packet_timestamp_for_added_packet is true.
 TEST_F(GraphProfilerTestPeer, AddPacketInfoUsingPacketTimestamp) {
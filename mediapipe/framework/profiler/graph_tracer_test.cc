@@ -1011,6 +1011,22 @@ TEST_F(GraphTracerE2ETest, DemuxGraphLogFile) {
   EXPECT_EQ(113, profile.graph_trace(0).calculator_trace().size());
 }
 
+TEST_F(GraphTracerE2ETest, DemuxGraphChromeTraceFile) {
+  std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/chrome_trace_");
+  SetUpDemuxInFlightGraph();
+  graph_config_.mutable_profiler_config()->set_trace_log_path(log_path);
+  graph_config_.mutable_profiler_config()->set_trace_log_interval_usec(-1);
+  graph_config_.mutable_profiler_config()->set_trace_log_format(
+      ProfilerConfig::CHROME_TRACE_JSON);
+  RunDemuxInFlightGraph();
+  std::string json;
+  MP_ASSERT_OK(file::GetContents(absl::StrCat(log_path, 0, ".json"), &json));
+  EXPECT_THAT(json, testing::StartsWith("[\n"));
+  EXPECT_THAT(json, testing::HasSubstr(R"("cat":"PROCESS","ph":"X")"));
+  EXPECT_THAT(json, testing::HasSubstr(R"("ph":"f","bp":"e")"));
+  EXPECT_THAT(json, testing::HasSubstr("executor queue"));
+}
+
 TEST_F(GraphTracerE2ETest, DemuxGraphLogFiles) {
   std::string log_path = absl::StrCat(getenv("TEST_TMPDIR"), "/log_files_");
   SetUpDemuxInFlightGraph();
@@ -0,0 +1,74 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/metrics_exporter.h"
+
+#include <utility>
+
+#include "absl/memory/memory.h"
+
+namespace mediapipe {
+
+MetricsPublisher::MetricsPublisher(
+    absl::Duration interval, Collector collector,
+    std::vector<std::shared_ptr<MetricsExporter>> exporters)
+    : interval_(interval),
+      collector_(std::move(collector)),
+      exporters_(std::move(exporters)) {}
+
+MetricsPublisher::~MetricsPublisher() { Stop(); }
+
+void MetricsPublisher::Start() {
+  if (thread_) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    is_stopping_ = false;
+  }
+  thread_ = absl::make_unique<std::thread>([this] { RunMetricsThread(); });
+}
+
+void MetricsPublisher::Stop() {
+  if (!thread_) {
+    return;
+  }
+  {
+    absl::MutexLock lock(&mutex_);
+    is_stopping_ = true;
+  }
+  thread_->join();
+  thread_.reset();
+  PublishMetrics();
+}
+
+void MetricsPublisher::PublishMetrics() {
+  GraphMetrics metrics;
+  collector_(&metrics);
+  for (const auto& exporter : exporters_) {
+    exporter->Publish(metrics);
+  }
+}
+
+void MetricsPublisher::RunMetricsThread() {
+  mutex_.Lock();
+  while (!mutex_.AwaitWithTimeout(absl::Condition(&is_stopping_), interval_)) {
+    mutex_.Unlock();
+    PublishMetrics();
+    mutex_.Lock();
+  }
+  mutex_.Unlock();
+}
+
+}  // namespace mediapipe
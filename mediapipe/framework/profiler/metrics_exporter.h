@@ -0,0 +1,93 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_METRICS_EXPORTER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_METRICS_EXPORTER_H_
+
+#include <functional>
+#include <memory>
+#include <thread>  // NOLINT(build/c++11)
+#include <vector>
+
+#include "absl/synchronization/mutex.h"
+#include "absl/time/time.h"
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/deps/registration.h"
+#include "mediapipe/framework/port/statusor.h"
+
+namespace mediapipe {
+
+// Receives periodic snapshots of the metrics of a running CalculatorGraph.
+// Register an exporter with CalculatorGraph::AddMetricsExporter.
+class MetricsExporter {
+ public:
+  virtual ~MetricsExporter() = default;
+
+  // Publishes one GraphMetrics snapshot.  This is called on the metrics
+  // thread of each graph using the exporter, so it must be thread-safe.
+  virtual void Publish(const GraphMetrics& metrics) = 0;
+};
+
+// Creates the MetricsExporter requested by a ProfilerConfig, or returns nullptr
+// if the ProfilerConfig requests none of this type.  CalculatorGraph adds the
+// exporters created by every registered factory, so that an exporter such as
+// PrometheusExporter is available to graphs only when it is linked in.
+using MetricsExporterRegistry =
+    GlobalFactoryRegistry<absl::StatusOr<std::shared_ptr<MetricsExporter>>,
+                          const ProfilerConfig&>;
+
+// Macro for registering a MetricsExporter created by name::CreateFromConfig.
+#define REGISTER_METRICS_EXPORTER(name)                                    \
+  REGISTER_FACTORY_FUNCTION_QUALIFIED(mediapipe::MetricsExporterRegistry,  \
+                                      metrics_exporter_registration, name, \
+                                      name::CreateFromConfig)
+
+// Collects GraphMetrics on a dedicated thread and passes them to exporters.
+// Collection runs once per interval, so the graph threads never wait for
+// exporters or for metrics readers.
+class MetricsPublisher {
+ public:
+  // Fills in a GraphMetrics snapshot.
+  using Collector = std::function<void(GraphMetrics*)>;
+
+  MetricsPublisher(absl::Duration interval, Collector collector,
+                   std::vector<std::shared_ptr<MetricsExporter>> exporters);
+  ~MetricsPublisher();
+
+  // Starts publishing GraphMetrics periodically.
+  void Start();
+
+  // Publishes a final GraphMetrics snapshot and stops publishing.
+  // Does nothing if the publisher is not started.
+  void Stop();
+
+ private:
+  // Collects GraphMetrics once and passes them to each exporter.
+  void PublishMetrics();
+
+  // Publishes GraphMetrics until Stop is called.
+  void RunMetricsThread();
+
+  const absl::Duration interval_;
+  const Collector collector_;
+  const std::vector<std::shared_ptr<MetricsExporter>> exporters_;
+  absl::Mutex mutex_;
+  bool is_stopping_ ABSL_GUARDED_BY(mutex_) = false;
+  std::unique_ptr<std::thread> thread_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_METRICS_EXPORTER_H_
@@ -0,0 +1,693 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/prometheus_exporter.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/match.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/port/canonical_errors.h"
+#include "mediapipe/framework/port/integral_types.h"
+#include "mediapipe/framework/port/logging.h"
+#include "mediapipe/framework/port/ret_check.h"
+#include "mediapipe/framework/port/status_macros.h"
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#ifndef MSG_NOSIGNAL
+#define MSG_NOSIGNAL 0  // SO_NOSIGPIPE is used instead.
+#endif
+#endif  // _WIN32
+
+namespace mediapipe {
+
+namespace {
+
+// The interval at which the server thread checks for shutdown.
+constexpr int kPollTimeoutMsec = 100;
+
+// The time allowed for a scraper to send its request.
+constexpr int kReceiveTimeoutSec = 1;
+
+// The longest HTTP request header that is read.
+constexpr int kMaxRequestSize = 8192;
+
+// Returns a label value escaped for the Prometheus text format.
+std::string EscapeLabel(absl::string_view value) {
+  std::string result;
+  for (char c : value) {
+    switch (c) {
+      case '\\':
+        result += "\\\\";
+        break;
+      case '"':
+        result += "\\\"";
+        break;
+      case '\n':
+        result += "\\n";
+        break;
+      default:
+        result += c;
+    }
+  }
+  return result;
+}
+
+// The metrics of one graph, with the labels identifying the graph.
+struct LabeledMetrics {
+  std::string labels;
+  const GraphMetrics* metrics;
+};
+
+// Returns the labels of a graph followed by other labels.
+std::string JoinLabels(const std::string& graph_labels,
+                       const std::string& labels) {
+  if (graph_labels.empty()) return labels;
+  if (labels.empty()) return graph_labels;
+  return absl::StrCat(graph_labels, ",", labels);
+}
+
+// Returns the labels identifying a calculator node.
+std::string CalculatorLabels(const std::string& graph_labels,
+                             const std::string& calculator) {
+  return JoinLabels(graph_labels, absl::StrCat("calculator=\"",
+                                               EscapeLabel(calculator), "\""));
+}
+
+// Returns the labels identifying a calculator input stream.
+std::string StreamLabels(const std::string& graph_labels,
+                         const std::string& calculator,
+                         const std::string& stream) {
+  return absl::StrCat(CalculatorLabels(graph_labels, calculator), ",stream=\"",
+                      EscapeLabel(stream), "\"");
+}
+
+// Returns the labels identifying an executor.
+std::string ExecutorLabels(const std::string& graph_labels,
+                           const std::string& executor) {
+  return JoinLabels(
+      graph_labels,
+      absl::StrCat("executor=\"",
+                   EscapeLabel(executor.empty() ? "default" : executor), "\""));
+}
+
+// Appends the HELP and TYPE lines for a metric family.
+void AppendHeader(const std::string& name, const std::string& type,
+                  const std::string& help, std::string* out) {
+  absl::StrAppend(out, "# HELP ", name, " ", help, "\n");
+  absl::StrAppend(out, "# TYPE ", name, " ", type, "\n");
+}
+
+// Appends one sample of a gauge or counter.
+void AppendSample(const std::string& name, const std::string& labels,
+                  int64 value, std::string* out) {
+  if (labels.empty()) {
+    absl::StrAppend(out, name, " ", value, "\n");
+  } else {
+    absl::StrAppend(out, name, "{", labels, "} ", value, "\n");
+  }
+}
+
+// Appends the cumulative buckets, sum, and count of a TimeHistogram.
+// The last TimeHistogram interval extends to +Inf.
+void AppendHistogram(const std::string& name, const std::string& labels,
+                     const TimeHistogram& histogram, std::string* out) {
+  int64 count = 0;
+  for (int i = 0; i < histogram.count_size(); ++i) {
+    count += histogram.count(i);
+    if (i + 1 < histogram.count_size()) {
+      absl::StrAppend(out, name, "_bucket{", labels, ",le=\"",
+                      (i + 1) * histogram.interval_size_usec(), "\"} ", count,
+                      "\n");
+    }
+  }
+  absl::StrAppend(out, name, "_bucket{", labels, ",le=\"+Inf\"} ", count,
+                  "\n");
+  absl::StrAppend(out, name, "_sum{", labels, "} ", histogram.total(), "\n");
+  absl::StrAppend(out, name, "_count{", labels, "} ", count, "\n");
+}
+
+// Appends one TimeHistogram family across all calculators.
+void AppendCalculatorHistograms(
+    const std::vector<LabeledMetrics>& graphs, const std::string& name,
+    const std::string& help, bool (CalculatorProfile::*has_histogram)() const,
+    const TimeHistogram& (CalculatorProfile::*histogram)() const,
+    std::string* out) {
+  bool has_header = false;
+  for (const LabeledMetrics& graph : graphs) {
+    for (const CalculatorProfile& profile :
+         graph.metrics->calculator_profiles()) {
+      if (!(profile.*has_histogram)()) continue;
+      if (!has_header) {
+        AppendHeader(name, "histogram", help, out);
+        has_header = true;
+      }
+      AppendHistogram(name, CalculatorLabels(graph.labels, profile.name()),
+                      (profile.*histogram)(), out);
+    }
+  }
+}
+
+// Appends one gauge or counter family with a sample per calculator.
+void AppendCalculatorSamples(const std::vector<LabeledMetrics>& graphs,
+                             const std::string& name, const std::string& help,
+                             int64 (CalculatorProfile::*value)() const,
+                             std::string* out) {
+  bool has_header = false;
+  for (const LabeledMetrics& graph : graphs) {
+    for (const CalculatorProfile& profile :
+         graph.metrics->calculator_profiles()) {
+      if (!has_header) {
+        AppendHeader(name, "gauge", help, out);
+        has_header = true;
+      }
+      AppendSample(name, CalculatorLabels(graph.labels, profile.name()),
+                   (profile.*value)(), out);
+    }
+  }
+}
+
+// Appends one gauge family with a sample per calculator input stream.
+void AppendInputStreamSamples(
+    const std::vector<LabeledMetrics>& graphs, const std::string& name,
+    const std::string& help,
+    int32 (GraphMetrics::InputStreamMetrics::*value)() const,
+    std::string* out) {
+  bool has_header = false;
+  for (const LabeledMetrics& graph : graphs) {
+    for (const auto& stream : graph.metrics->input_stream()) {
+      if (!has_header) {
+        AppendHeader(name, "gauge", help, out);
+        has_header = true;
+      }
+      AppendSample(name,
+                   StreamLabels(graph.labels, stream.calculator_name(),
+                                stream.stream_name()),
+                   (stream.*value)(), out);
+    }
+  }
+}
+
+// Appends one gauge family with a sample per executor.
+void AppendExecutorSamples(
+    const std::vector<LabeledMetrics>& graphs, const std::string& name,
+    const std::string& help,
+    int32 (GraphMetrics::ExecutorMetrics::*value)() const, std::string* out) {
+  bool has_header = false;
+  for (const LabeledMetrics& graph : graphs) {
+    for (const auto& executor : graph.metrics->executor()) {
+      if (!has_header) {
+        AppendHeader(name, "gauge", help, out);
+        has_header = true;
+      }
+      AppendSample(name, ExecutorLabels(graph.labels, executor.name()),
+                   (executor.*value)(), out);
+    }
+  }
+}
+
+// Returns the metrics of several graphs formatted in the Prometheus text
+// format. The samples of each metric family are grouped after its header.
+std::string FormatGraphMetrics(const std::vector<LabeledMetrics>& graphs) {
+  std::string out;
+  AppendCalculatorHistograms(
+      graphs, "mediapipe_calculator_process_runtime_usec",
+      "Calculator::Process runtime in microseconds.",
+      &CalculatorProfile::has_process_runtime,
+      &CalculatorProfile::process_runtime, &out);
+  AppendCalculatorHistograms(
+      graphs, "mediapipe_calculator_process_input_latency_usec",
+      "Time from packet production to Calculator::Process start.",
+      &CalculatorProfile::has_process_input_latency,
+      &CalculatorProfile::process_input_latency, &out);
+  AppendCalculatorHistograms(
+      graphs, "mediapipe_calculator_process_output_latency_usec",
+      "Time from packet production to Calculator::Process finish.",
+      &CalculatorProfile::has_process_output_latency,
+      &CalculatorProfile::process_output_latency, &out);
+
+  bool has_header = false;
+  for (const LabeledMetrics& graph : graphs) {
+    for (const CalculatorProfile& profile :
+         graph.metrics->calculator_profiles()) {
+      for (const StreamProfile& stream : profile.input_stream_profiles()) {
+        if (!stream.has_latency()) continue;
+        if (!has_header) {
+          AppendHeader("mediapipe_input_stream_latency_usec", "histogram",
+                       "Time that packets spend in an input stream.", &out);
+          has_header = true;
+        }
+        AppendHistogram(
+            "mediapipe_input_stream_latency_usec",
+            StreamLabels(graph.labels, profile.name(), stream.name()),
+            stream.latency(), &out);
+      }
+    }
+  }
+
+  AppendCalculatorSamples(graphs, "mediapipe_calculator_open_runtime_usec",
+                          "Calculator::Open runtime in microseconds.",
+                          &CalculatorProfile::open_runtime, &out);
+  AppendCalculatorSamples(graphs, "mediapipe_calculator_close_runtime_usec",
+                          "Calculator::Close runtime in microseconds.",
+                          &CalculatorProfile::close_runtime, &out);
+
+  AppendInputStreamSamples(
+      graphs, "mediapipe_input_stream_queue_size",
+      "Packets queued on a calculator input stream.",
+      &GraphMetrics::InputStreamMetrics::queue_size, &out);
+  AppendInputStreamSamples(
+      graphs, "mediapipe_input_stream_max_queue_size",
+      "Queue size at which an input stream throttles its sources.",
+      &GraphMetrics::InputStreamMetrics::max_queue_size, &out);
+
+  if (!graphs.empty()) {
+    AppendHeader("mediapipe_graph_throttle_events_total", "counter",
+                 "Times an input stream became full and throttled its sources.",
+                 &out);
+    for (const LabeledMetrics& graph : graphs) {
+      AppendSample("mediapipe_graph_throttle_events_total", graph.labels,
+                   graph.metrics->throttle_count(), &out);
+    }
+    AppendHeader("mediapipe_graph_throttled_nodes", "gauge",
+                 "Source nodes and graph input streams currently throttled.",
+                 &out);
+    for (const LabeledMetrics& graph : graphs) {
+      AppendSample("mediapipe_graph_throttled_nodes", graph.labels,
+                   graph.metrics->throttled_node_count(), &out);
+    }
+  }
+
+  AppendExecutorSamples(graphs, "mediapipe_executor_queued_nodes",
+                        "Ready calculator nodes waiting for an executor task.",
+                        &GraphMetrics::ExecutorMetrics::queued_nodes, &out);
+  AppendExecutorSamples(graphs, "mediapipe_executor_pending_tasks",
+                        "Executor tasks submitted and not yet complete.",
+                        &GraphMetrics::ExecutorMetrics::pending_tasks, &out);
+  return out;
+}
+
+// Returns the keys of the endpoints in the server registry.
+std::vector<std::string> EndpointKeys(int port,
+                                      const std::string& unix_socket_path) {
+  std::vector<std::string> keys;
+  if (port > 0) {
+    keys.push_back(absl::StrCat("port:", port));
+  }
+  if (!unix_socket_path.empty()) {
+    keys.push_back(absl::StrCat("unix:", unix_socket_path));
+  }
+  return keys;
+}
+
+// Guards the server registry and the reference counts of the servers.
+ABSL_CONST_INIT absl::Mutex registry_mutex(absl::kConstInit);
+
+}  // namespace
+
+namespace internal {
+
+// Serves the metrics of the PrometheusExporters that share its endpoints.
+class PrometheusServer {
+ public:
+  // Returns the server for the endpoints in options, and creates it if no
+  // server has them. The server is kept until it is released as many times.
+  static absl::StatusOr<PrometheusServer*> Acquire(
+      const PrometheusExporter::Options& options);
+
+  // Releases a server returned by Acquire.
+  static void Release(PrometheusServer* server);
+
+  // Adds a graph and returns the id that labels its metrics.
+  int AddGraph();
+
+  // Stops serving the metrics of a graph.
+  void RemoveGraph(int graph_id);
+
+  // Stores the metrics of a graph.
+  void Publish(int graph_id, const GraphMetrics& metrics);
+
+  // Returns the metrics text of all graphs.
+  std::string GetMetricsText();
+
+  int port() const { return port_; }
+
+ private:
+  PrometheusServer() = default;
+  ~PrometheusServer();
+
+  // Maps the endpoint keys to the servers serving them.
+  static std::map<std::string, PrometheusServer*>* Registry()
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(registry_mutex) {
+    static auto* registry = new std::map<std::string, PrometheusServer*>();
+    return registry;
+  }
+
+  // Opens the listening sockets requested in options.
+  absl::Status Listen(const PrometheusExporter::Options& options);
+
+  // Accepts and serves connections until the server is destroyed.
+  void ServeConnections();
+
+  // Answers one HTTP request on a connected socket.
+  void ServeConnection(int fd);
+
+  // The keys of the endpoints of this server in the registry.
+  std::vector<std::string> keys_;
+  int ref_count_ ABSL_GUARDED_BY(registry_mutex) = 0;
+
+  absl::Mutex mutex_;
+  std::map<int, GraphMetrics> graph_metrics_ ABSL_GUARDED_BY(mutex_);
+  int next_graph_id_ ABSL_GUARDED_BY(mutex_) = 0;
+  std::string metrics_text_ ABSL_GUARDED_BY(mutex_);
+  bool is_text_current_ ABSL_GUARDED_BY(mutex_) = true;
+
+  std::vector<int> listen_fds_;
+  int port_ = -1;
+  std::string unix_socket_path_;
+  // Identifies the socket file bound by this server.
+  uint64 socket_device_ = 0;
+  uint64 socket_inode_ = 0;
+  std::atomic<bool> is_stopping_{false};
+  std::unique_ptr<std::thread> thread_;
+};
+
+// static
+absl::StatusOr<PrometheusServer*> PrometheusServer::Acquire(
+    const PrometheusExporter::Options& options) {
+  RET_CHECK(options.port >= 0 || !options.unix_socket_path.empty())
+      << "PrometheusExporter requires a port or a unix_socket_path.";
+  absl::MutexLock lock(&registry_mutex);
+  std::map<std::string, PrometheusServer*>* registry = Registry();
+  std::vector<std::string> keys =
+      EndpointKeys(options.port, options.unix_socket_path);
+  PrometheusServer* server = nullptr;
+  for (const std::string& key : keys) {
+    auto it = registry->find(key);
+    if (it == registry->end()) continue;
+    server = it->second;
+  }
+  if (server) {
+    if (server->keys_ != keys) {
+      return absl::AlreadyExistsError(absl::StrCat(
+          "The metrics endpoints ", absl::StrJoin(keys, ", "),
+          " overlap those of another PrometheusExporter: ",
+          absl::StrJoin(server->keys_, ", ")));
+    }
+    ++server->ref_count_;
+    return server;
+  }
+
+  server = new PrometheusServer;
+  absl::Status status = server->Listen(options);
+  if (!status.ok()) {
+    delete server;
+    return status;
+  }
+  server->keys_ = EndpointKeys(server->port_, server->unix_socket_path_);
+  for (const std::string& key : server->keys_) {
+    (*registry)[key] = server;
+  }
+  server->ref_count_ = 1;
+  server->thread_ =
+      absl::make_unique<std::thread>([server] { server->ServeConnections(); });
+  return server;
+}
+
+// static
+void PrometheusServer::Release(PrometheusServer* server) {
+  absl::MutexLock lock(&registry_mutex);
+  if (--server->ref_count_ > 0) return;
+  for (const std::string& key : server->keys_) {
+    Registry()->erase(key);
+  }
+  // The endpoints are closed before another server can acquire them.
+  delete server;
+}
+
+PrometheusServer::~PrometheusServer() {
+  is_stopping_ = true;
+  if (thread_) {
+    thread_->join();
+  }
+#ifndef _WIN32
+  for (int fd : listen_fds_) {
+    close(fd);
+  }
+  struct stat socket_stat;
+  if (!unix_socket_path_.empty() &&
+      lstat(unix_socket_path_.c_str(), &socket_stat) == 0 &&
+      socket_stat.st_dev == socket_device_ &&
+      socket_stat.st_ino == socket_inode_) {
+    unlink(unix_socket_path_.c_str());
+  }
+#endif  // _WIN32
+}
+
+int PrometheusServer::AddGraph() {
+  absl::MutexLock lock(&mutex_);
+  return next_graph_id_++;
+}
+
+void PrometheusServer::RemoveGraph(int graph_id) {
+  absl::MutexLock lock(&mutex_);
+  graph_metrics_.erase(graph_id);
+  is_text_current_ = false;
+}
+
+void PrometheusServer::Publish(int graph_id, const GraphMetrics& metrics) {
+  absl::MutexLock lock(&mutex_);
+  graph_metrics_[graph_id] = metrics;
+  is_text_current_ = false;
+}
+
+std::string PrometheusServer::GetMetricsText() {
+  absl::MutexLock lock(&mutex_);
+  if (!is_text_current_) {
+    std::vector<LabeledMetrics> graphs;
+    for (const auto& entry : graph_metrics_) {
+      graphs.push_back(
+          {absl::StrCat("graph=\"", entry.first, "\""), &entry.second});
+    }
+    metrics_text_ = FormatGraphMetrics(graphs);
+    is_text_current_ = true;
+  }
+  return metrics_text_;
+}
+
+#ifdef _WIN32
+
+absl::Status PrometheusServer::Listen(
+    const PrometheusExporter::Options& options) {
+  return absl::UnimplementedError(
+      "PrometheusExporter is not supported on Windows.");
+}
+
+void PrometheusServer::ServeConnections() {}
+
+void PrometheusServer::ServeConnection(int fd) {}
+
+#else
+
+absl::Status PrometheusServer::Listen(
+    const PrometheusExporter::Options& options) {
+  if (options.port >= 0) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    RET_CHECK_GE(fd, 0) << "socket() failed: " << strerror(errno);
+    listen_fds_.push_back(fd);
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    addr.sin_port = htons(options.port);
+    RET_CHECK_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0)
+        << "Cannot bind port " << options.port << ": " << strerror(errno);
+    RET_CHECK_EQ(listen(fd, SOMAXCONN), 0) << strerror(errno);
+    socklen_t addr_len = sizeof(addr);
+    getsockname(fd, reinterpret_cast<sockaddr*>(&addr), &addr_len);
+    port_ = ntohs(addr.sin_port);
+  }
+  if (!options.unix_socket_path.empty()) {
+    sockaddr_un addr = {};
+    RET_CHECK_LT(options.unix_socket_path.size(), sizeof(addr.sun_path))
+        << "unix_socket_path is too long: " << options.unix_socket_path;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    RET_CHECK_GE(fd, 0) << "socket() failed: " << strerror(errno);
+    listen_fds_.push_back(fd);
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, options.unix_socket_path.c_str(),
+            sizeof(addr.sun_path) - 1);
+    struct stat socket_stat;
+    if (lstat(addr.sun_path, &socket_stat) == 0) {
+      // Only a stale socket file, which no server accepts connections on, is
+      // replaced.
+      RET_CHECK(S_ISSOCK(socket_stat.st_mode))
+          << options.unix_socket_path << " exists and is not a socket.";
+      int probe_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+      RET_CHECK_GE(probe_fd, 0) << "socket() failed: " << strerror(errno);
+      const bool is_served =
+          connect(probe_fd, reinterpret_cast<sockaddr*>(&addr),
+                  sizeof(addr)) == 0 ||
+          (errno != ECONNREFUSED && errno != ENOENT);
+      close(probe_fd);
+      if (is_served) {
+        return absl::AlreadyExistsError(
+            absl::StrCat("Another server uses the socket ",
+                         options.unix_socket_path));
+      }
+      unlink(addr.sun_path);
+    }
+    RET_CHECK_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0)
+        << "Cannot bind " << options.unix_socket_path << ": "
+        << strerror(errno);
+    unix_socket_path_ = options.unix_socket_path;
+    if (stat(addr.sun_path, &socket_stat) == 0) {
+      socket_device_ = socket_stat.st_dev;
+      socket_inode_ = socket_stat.st_ino;
+    }
+    RET_CHECK_EQ(listen(fd, SOMAXCONN), 0) << strerror(errno);
+  }
+  return absl::OkStatus();
+}
+
+void PrometheusServer::ServeConnections() {
+  std::vector<pollfd> poll_fds;
+  for (int fd : listen_fds_) {
+    poll_fds.push_back({fd, POLLIN, 0});
+  }
+  while (!is_stopping_) {
+    int ready = poll(poll_fds.data(), poll_fds.size(), kPollTimeoutMsec);
+    if (ready <= 0) continue;
+    for (const pollfd& p : poll_fds) {
+      if (!(p.revents & POLLIN)) continue;
+      int fd = accept(p.fd, nullptr, nullptr);
+      if (fd < 0) continue;
+      ServeConnection(fd);
+      close(fd);
+    }
+  }
+}
+
+void PrometheusServer::ServeConnection(int fd) {
+  timeval timeout = {kReceiveTimeoutSec, 0};
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+  int no_sigpipe = 1;
+  setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+#endif  // SO_NOSIGPIPE
+  std::string request;
+  char buffer[1024];
+  while (request.find("\r\n\r\n") == std::string::npos &&
+         request.size() < kMaxRequestSize) {
+    ssize_t n = recv(fd, buffer, sizeof(buffer), 0);
+    if (n <= 0) break;
+    request.append(buffer, n);
+  }
+
+  std::string status = "200 OK";
+  std::string body;
+  if (absl::StartsWith(request, "GET /metrics ") ||
+      absl::StartsWith(request, "GET /metrics?")) {
+    body = GetMetricsText();
+  } else {
+    status = "404 Not Found";
+    body = "Metrics are served at /metrics.\n";
+  }
+  std::string response = absl::StrCat(
+      "HTTP/1.1 ", status, "\r\n",
+      "Content-Type: text/plain; version=0.0.4; charset=utf-8\r\n",
+      "Content-Length: ", body.size(), "\r\n", "Connection: close\r\n\r\n",
+      body);
+  const char* data = response.data();
+  size_t remaining = response.size();
+  while (remaining > 0) {
+    ssize_t n = send(fd, data, remaining, MSG_NOSIGNAL);
+    if (n <= 0) break;
+    data += n;
+    remaining -= n;
+  }
+}
+
+#endif  // _WIN32
+
+}  // namespace internal
+
+// static
+absl::StatusOr<std::shared_ptr<PrometheusExporter>> PrometheusExporter::Create(
+    const Options& options) {
+  ASSIGN_OR_RETURN(internal::PrometheusServer * server,
+                   internal::PrometheusServer::Acquire(options));
+  return std::shared_ptr<PrometheusExporter>(
+      new PrometheusExporter(server, server->AddGraph()));
+}
+
+// static
+absl::StatusOr<std::shared_ptr<MetricsExporter>>
+PrometheusExporter::CreateFromConfig(const ProfilerConfig& config) {
+  if (config.metrics_port() == 0 && config.metrics_unix_socket_path().empty()) {
+    return std::shared_ptr<MetricsExporter>();
+  }
+  Options options;
+  if (config.metrics_port() != 0) {
+    options.port = config.metrics_port();
+  }
+  options.unix_socket_path = config.metrics_unix_socket_path();
+  ASSIGN_OR_RETURN(std::shared_ptr<PrometheusExporter> exporter,
+                   Create(options));
+  return exporter;
+}
+
+PrometheusExporter::~PrometheusExporter() {
+  server_->RemoveGraph(graph_id_);
+  internal::PrometheusServer::Release(server_);
+}
+
+void PrometheusExporter::Publish(const GraphMetrics& metrics) {
+  server_->Publish(graph_id_, metrics);
+}
+
+int PrometheusExporter::port() const { return server_->port(); }
+
+std::string PrometheusExporter::GetMetricsText() const {
+  return server_->GetMetricsText();
+}
+
+// static
+std::string PrometheusExporter::FormatMetrics(const GraphMetrics& metrics) {
+  return FormatGraphMetrics({{"", &metrics}});
+}
+
+REGISTER_METRICS_EXPORTER(PrometheusExporter);
+
+}  // namespace mediapipe
@@ -0,0 +1,94 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
+#define MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
+
+#include <memory>
+#include <string>
+
+#include "mediapipe/framework/calculator.pb.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/status.h"
+#include "mediapipe/framework/port/statusor.h"
+#include "mediapipe/framework/profiler/metrics_exporter.h"
+
+namespace mediapipe {
+
+namespace internal {
+class PrometheusServer;
+}  // namespace internal
+
+// Serves GraphMetrics in the Prometheus text format at "/metrics", over HTTP
+// on a local TCP port or on a Unix domain socket.
+//
+// The exporters created for the same endpoints share one server through a
+// process-wide registry, which keeps the server while any of them exists. So
+// several graphs, e.g. those of a CalculatorGraphPool, can use the same
+// ProfilerConfig. The metrics of each exporter are labeled graph="<n>".
+//
+// A Unix domain socket is never taken over while another server accepts
+// connections on it, and is only removed by the server that bound it.
+//
+// Each call to Publish stores the metrics, and the next scrape formats them,
+// so scrapes never touch the running graphs.
+class PrometheusExporter : public MetricsExporter {
+ public:
+  struct Options {
+    // The TCP port to serve on 127.0.0.1, 0 to pick any free port, or -1 to
+    // serve no TCP port.
+    int port = -1;
+
+    // The path of a Unix domain socket to serve, or empty to serve none.
+    std::string unix_socket_path;
+  };
+
+  // Creates a PrometheusExporter, and starts serving scrapes unless another
+  // PrometheusExporter already serves the same endpoints. Fails if only some
+  // of the endpoints are served by another PrometheusExporter.
+  static absl::StatusOr<std::shared_ptr<PrometheusExporter>> Create(
+      const Options& options);
+
+  // Creates a PrometheusExporter for ProfilerConfig::metrics_port and
+  // ProfilerConfig::metrics_unix_socket_path, or returns nullptr if neither
+  // is set. CalculatorGraph calls this when this exporter is linked in.
+  static absl::StatusOr<std::shared_ptr<MetricsExporter>> CreateFromConfig(
+      const ProfilerConfig& config);
+
+  ~PrometheusExporter() override;
+
+  // Stores the metrics served to the next scrape.
+  void Publish(const GraphMetrics& metrics) override;
+
+  // Returns the TCP port being served, or -1.
+  int port() const;
+
+  // Returns the metrics text served to the next scrape, which includes the
+  // metrics of every exporter sharing the endpoints.
+  std::string GetMetricsText() const;
+
+  // Returns GraphMetrics formatted in the Prometheus text format.
+  static std::string FormatMetrics(const GraphMetrics& metrics);
+
+ private:
+  PrometheusExporter(internal::PrometheusServer* server, int graph_id)
+      : server_(server), graph_id_(graph_id) {}
+
+  internal::PrometheusServer* const server_;
+  const int graph_id_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_FRAMEWORK_PROFILER_PROMETHEUS_EXPORTER_H_
@@ -0,0 +1,367 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/framework/profiler/prometheus_exporter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "absl/memory/memory.h"
+#include "absl/strings/str_cat.h"
+#include "absl/synchronization/mutex.h"
+#include "mediapipe/framework/calculator_framework.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
+#include "mediapipe/framework/port/gmock.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/parse_text_proto.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+using ::testing::HasSubstr;
+using ::testing::Not;
+using ::testing::StartsWith;
+
+// Sends an HTTP GET request on a connected socket and returns the response.
+std::string HttpGet(int fd, const std::string& path) {
+  std::string request = absl::StrCat("GET ", path, " HTTP/1.1\r\n\r\n");
+  send(fd, request.data(), request.size(), 0);
+  std::string response;
+  char buffer[1024];
+  ssize_t n;
+  while ((n = recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+    response.append(buffer, n);
+  }
+  close(fd);
+  return response;
+}
+
+// Returns the response to an HTTP GET request on a local TCP port.
+std::string HttpGetPort(int port, const std::string& path) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port = htons(port);
+  EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  return HttpGet(fd, path);
+}
+
+// Returns the response to an HTTP GET request on a Unix domain socket.
+std::string HttpGetUnixSocket(const std::string& socket_path,
+                              const std::string& path) {
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+  EXPECT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  return HttpGet(fd, path);
+}
+
+// Returns a path for a Unix domain socket used by a test.
+std::string SocketPath(const std::string& name) {
+  const char* tmp_dir = getenv("TEST_TMPDIR");
+  return absl::StrCat(tmp_dir ? tmp_dir : "/tmp", "/prometheus_exporter_test_",
+                      name);
+}
+
+GraphMetrics TestMetrics() {
+  return ParseTextProtoOrDie<GraphMetrics>(R"pb(
+    calculator_profiles {
+      name: "PassThroughCalculator"
+      open_runtime: 5
+      process_runtime {
+        total: 2500
+        interval_size_usec: 1000
+        num_intervals: 3
+        count: [ 1, 0, 2 ]
+      }
+    }
+    input_stream {
+      calculator_name: "PassThroughCalculator"
+      stream_name: "in"
+      queue_size: 3
+      max_queue_size: 10
+    }
+    executor { name: "" queued_nodes: 2 pending_tasks: 1 }
+    throttle_count: 4
+    throttled_node_count: 1
+  )pb");
+}
+
+TEST(PrometheusExporterTest, FormatsMetrics) {
+  std::string text = PrometheusExporter::FormatMetrics(TestMetrics());
+  EXPECT_THAT(text,
+              HasSubstr("# TYPE mediapipe_calculator_process_runtime_usec "
+                        "histogram\n"
+                        "mediapipe_calculator_process_runtime_usec_bucket{"
+                        "calculator=\"PassThroughCalculator\",le=\"1000\"} 1\n"
+                        "mediapipe_calculator_process_runtime_usec_bucket{"
+                        "calculator=\"PassThroughCalculator\",le=\"2000\"} 1\n"
+                        "mediapipe_calculator_process_runtime_usec_bucket{"
+                        "calculator=\"PassThroughCalculator\",le=\"+Inf\"} 3\n"
+                        "mediapipe_calculator_process_runtime_usec_sum{"
+                        "calculator=\"PassThroughCalculator\"} 2500\n"
+                        "mediapipe_calculator_process_runtime_usec_count{"
+                        "calculator=\"PassThroughCalculator\"} 3\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_calculator_open_runtime_usec{"
+                              "calculator=\"PassThroughCalculator\"} 5\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_queue_size{"
+                              "calculator=\"PassThroughCalculator\","
+                              "stream=\"in\"} 3\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_input_stream_max_queue_size{"
+                              "calculator=\"PassThroughCalculator\","
+                              "stream=\"in\"} 10\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_graph_throttle_events_total 4\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_graph_throttled_nodes 1\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_executor_queued_nodes{"
+                              "executor=\"default\"} 2\n"));
+  EXPECT_THAT(text, HasSubstr("mediapipe_executor_pending_tasks{"
+                              "executor=\"default\"} 1\n"));
+  EXPECT_THAT(text, Not(HasSubstr("process_input_latency")));
+}
+
+TEST(PrometheusExporterTest, ServesMetricsOnPort) {
+  PrometheusExporter::Options options;
+  options.port = 0;
+  auto status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter =
+      std::move(status_or_exporter).value();
+  ASSERT_GT(exporter->port(), 0);
+  exporter->Publish(TestMetrics());
+
+  std::string response = HttpGetPort(exporter->port(), "/metrics");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr(exporter->GetMetricsText()));
+  EXPECT_THAT(response, HasSubstr("mediapipe_graph_throttle_events_total{"
+                                  "graph=\"0\"} 4"));
+
+  response = HttpGetPort(exporter->port(), "/");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 404 Not Found\r\n"));
+}
+
+TEST(PrometheusExporterTest, ServesMetricsOnUnixSocket) {
+  std::string socket_path = SocketPath("serves");
+  PrometheusExporter::Options options;
+  options.unix_socket_path = socket_path;
+  auto status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter =
+      std::move(status_or_exporter).value();
+  EXPECT_EQ(exporter->port(), -1);
+  exporter->Publish(TestMetrics());
+
+  std::string response = HttpGetUnixSocket(socket_path, "/metrics");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response,
+              HasSubstr("mediapipe_graph_throttled_nodes{graph=\"0\"} 1"));
+}
+
+TEST(PrometheusExporterTest, SharesEndpoints) {
+  PrometheusExporter::Options options;
+  options.port = 0;
+  auto status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter_1 =
+      std::move(status_or_exporter).value();
+  options.port = exporter_1->port();
+  status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter_2 =
+      std::move(status_or_exporter).value();
+  EXPECT_EQ(exporter_2->port(), exporter_1->port());
+
+  GraphMetrics metrics = TestMetrics();
+  exporter_1->Publish(metrics);
+  metrics.set_throttle_count(7);
+  exporter_2->Publish(metrics);
+  std::string response = HttpGetPort(options.port, "/metrics");
+  EXPECT_THAT(response,
+              HasSubstr("# TYPE mediapipe_graph_throttle_events_total counter\n"
+                        "mediapipe_graph_throttle_events_total{graph=\"0\"} 4\n"
+                        "mediapipe_graph_throttle_events_total{graph=\"1\"} "
+                        "7\n"));
+
+  // The endpoint is served as long as an exporter uses it.
+  exporter_1.reset();
+  response = HttpGetPort(options.port, "/metrics");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, Not(HasSubstr("graph=\"0\"")));
+  EXPECT_THAT(response, HasSubstr("mediapipe_graph_throttle_events_total{"
+                                  "graph=\"1\"} 7\n"));
+}
+
+TEST(PrometheusExporterTest, RejectsOverlappingEndpoints) {
+  PrometheusExporter::Options options;
+  options.port = 0;
+  auto status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter =
+      std::move(status_or_exporter).value();
+  options.port = exporter->port();
+  options.unix_socket_path = SocketPath("overlapping");
+  EXPECT_EQ(PrometheusExporter::Create(options).status().code(),
+            absl::StatusCode::kAlreadyExists);
+}
+
+TEST(PrometheusExporterTest, KeepsSocketOfAnotherServer) {
+  std::string socket_path = SocketPath("other_server");
+  unlink(socket_path.c_str());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  sockaddr_un addr = {};
+  addr.sun_family = AF_UNIX;
+  strncpy(addr.sun_path, socket_path.c_str(), sizeof(addr.sun_path) - 1);
+  ASSERT_EQ(bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+  ASSERT_EQ(listen(fd, 1), 0);
+
+  PrometheusExporter::Options options;
+  options.unix_socket_path = socket_path;
+  EXPECT_EQ(PrometheusExporter::Create(options).status().code(),
+            absl::StatusCode::kAlreadyExists);
+  EXPECT_EQ(access(socket_path.c_str(), F_OK), 0);
+
+  // Once the other server is gone, its stale socket file is replaced.
+  close(fd);
+  auto status_or_exporter = PrometheusExporter::Create(options);
+  MP_ASSERT_OK(status_or_exporter);
+  std::shared_ptr<PrometheusExporter> exporter =
+      std::move(status_or_exporter).value();
+  exporter->Publish(TestMetrics());
+  EXPECT_THAT(HttpGetUnixSocket(socket_path, "/metrics"),
+              StartsWith("HTTP/1.1 200 OK\r\n"));
+  exporter.reset();
+  EXPECT_NE(access(socket_path.c_str(), F_OK), 0);
+}
+
+TEST(PrometheusExporterTest, RequiresAnAddress) {
+  EXPECT_FALSE(PrometheusExporter::Create({}).ok());
+}
+
+// Records the GraphMetrics passed to Publish.
+class RecordingExporter : public MetricsExporter {
+ public:
+  void Publish(const GraphMetrics& metrics) override {
+    absl::MutexLock lock(&mutex_);
+    metrics_ = metrics;
+    ++publish_count_;
+  }
+  GraphMetrics metrics() {
+    absl::MutexLock lock(&mutex_);
+    return metrics_;
+  }
+  int publish_count() {
+    absl::MutexLock lock(&mutex_);
+    return publish_count_;
+  }
+
+ private:
+  absl::Mutex mutex_;
+  GraphMetrics metrics_;
+  int publish_count_ = 0;
+};
+
+TEST(PrometheusExporterTest, GraphPublishesMetrics) {
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        }
+        profiler_config { enable_profiler: true metrics_interval_usec: 1000 }
+      )pb");
+  CalculatorGraph graph;
+  MP_ASSERT_OK(graph.Initialize(config));
+  auto exporter = std::make_shared<RecordingExporter>();
+  MP_ASSERT_OK(graph.AddMetricsExporter(exporter));
+  MP_ASSERT_OK(graph.StartRun({}));
+  for (int i = 0; i < 5; ++i) {
+    MP_ASSERT_OK(graph.AddPacketToInputStream(
+        "in", MakePacket<int>(i).At(Timestamp(i))));
+  }
+  MP_ASSERT_OK(graph.CloseAllInputStreams());
+  MP_ASSERT_OK(graph.WaitUntilDone());
+  EXPECT_FALSE(graph.AddMetricsExporter(exporter).ok());
+
+  // The final snapshot is published as the run finishes.
+  GraphMetrics metrics = exporter->metrics();
+  EXPECT_GE(exporter->publish_count(), 1);
+  ASSERT_EQ(metrics.calculator_profiles_size(), 1);
+  EXPECT_EQ(metrics.calculator_profiles(0).name(), "PassThroughCalculator");
+  const TimeHistogram& process_runtime =
+      metrics.calculator_profiles(0).process_runtime();
+  int64 process_count = 0;
+  for (int64 count : process_runtime.count()) {
+    process_count += count;
+  }
+  EXPECT_EQ(process_count, 5);
+  ASSERT_EQ(metrics.input_stream_size(), 1);
+  EXPECT_EQ(metrics.input_stream(0).calculator_name(),
+            "PassThroughCalculator");
+  EXPECT_EQ(metrics.input_stream(0).stream_name(), "in");
+  EXPECT_EQ(metrics.input_stream(0).queue_size(), 0);
+  ASSERT_EQ(metrics.executor_size(), 1);
+  EXPECT_EQ(metrics.executor(0).name(), "");
+}
+
+TEST(PrometheusExporterTest, GraphsShareConfiguredSocket) {
+  std::string socket_path = SocketPath("graphs");
+  CalculatorGraphConfig config =
+      ParseTextProtoOrDie<CalculatorGraphConfig>(R"pb(
+        input_stream: "in"
+        node {
+          calculator: "PassThroughCalculator"
+          input_stream: "in"
+          output_stream: "out"
+        }
+        profiler_config { enable_profiler: true }
+      )pb");
+  config.mutable_profiler_config()->set_metrics_unix_socket_path(socket_path);
+  auto graph_1 = absl::make_unique<CalculatorGraph>();
+  MP_ASSERT_OK(graph_1->Initialize(config));
+  auto graph_2 = absl::make_unique<CalculatorGraph>();
+  MP_ASSERT_OK(graph_2->Initialize(config));
+  for (CalculatorGraph* graph : {graph_1.get(), graph_2.get()}) {
+    MP_ASSERT_OK(graph->StartRun({}));
+    MP_ASSERT_OK(graph->CloseAllInputStreams());
+    MP_ASSERT_OK(graph->WaitUntilDone());
+  }
+  std::string response = HttpGetUnixSocket(socket_path, "/metrics");
+  EXPECT_THAT(response, HasSubstr("mediapipe_calculator_open_runtime_usec{"
+                                  "graph=\"0\","));
+  EXPECT_THAT(response, HasSubstr("mediapipe_calculator_open_runtime_usec{"
+                                  "graph=\"1\","));
+
+  // Destroying one graph leaves the socket of the other in place.
+  graph_1.reset();
+  response = HttpGetUnixSocket(socket_path, "/metrics");
+  EXPECT_THAT(response, StartsWith("HTTP/1.1 200 OK\r\n"));
+  EXPECT_THAT(response, HasSubstr("graph=\"1\""));
+  graph_2.reset();
+  EXPECT_NE(access(socket_path.c_str(), F_OK), 0);
+}
+
+}  // namespace
+}  // namespace mediapipe
@@ -74,6 +74,23 @@ void Scheduler::Reset() {
   shared_.has_error = false;
 }
 
+void Scheduler::GetExecutorMetrics(GraphMetrics* metrics) {
+  // The set of queues is fixed once the executors have been set.
+  auto add_executor = [metrics](const std::string& name,
+                                SchedulerQueue* queue) {
+    int queued_nodes, pending_tasks;
+    queue->GetLoad(&queued_nodes, &pending_tasks);
+    GraphMetrics::ExecutorMetrics* executor = metrics->add_executor();
+    executor->set_name(name);
+    executor->set_queued_nodes(queued_nodes);
+    executor->set_pending_tasks(pending_tasks);
+  };
+  add_executor("", &default_queue_);
+  for (auto& item : non_default_queues_) {
+    add_executor(item.first, item.second.get());
+  }
+}
+
 void Scheduler::CloseAllSourceNodes() { shared_.stopping = true; }
 
 void Scheduler::SetExecutor(Executor* executor) {
@@ -102,6 +119,22 @@ absl::Status Scheduler::SetNonDefaultExecutor(const std::string& name,
   return absl::OkStatus();
 }
 
+absl::Status Scheduler::SetMaxNodesPerTask(const std::string& name,
+                                           int max_nodes_per_task) {
+  RET_CHECK_EQ(state_, STATE_NOT_STARTED) << "SetMaxNodesPerTask must not "
+                                             "be called after the scheduler "
+                                             "has started";
+  if (name.empty()) {
+    default_queue_.SetMaxNodesPerTask(max_nodes_per_task);
+    return absl::OkStatus();
+  }
+  auto it = non_default_queues_.find(name);
+  RET_CHECK(it != non_default_queues_.end())
+      << "No scheduler queue for the executor \"" << name << "\"";
+  it->second->SetMaxNodesPerTask(max_nodes_per_task);
+  return absl::OkStatus();
+}
+
 void Scheduler::SetQueuesRunning(bool running) {
   for (auto queue : scheduler_queues_) {
     queue->SetRunning(running);
@@ -27,6 +27,7 @@
 #include "absl/base/macros.h"
 #include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/calculator_node.h"
+#include "mediapipe/framework/calculator_profile.pb.h"
 #include "mediapipe/framework/port/integral_types.h"
 #include "mediapipe/framework/port/status.h"
 #include "mediapipe/framework/scheduler_queue.h"
@@ -59,9 +60,20 @@ class Scheduler {
   absl::Status SetNonDefaultExecutor(const std::string& name,
                                      Executor* executor);
 
+  // Sets the maximum number of ready nodes that one task on the executor
+  // named |name| may run (see SchedulerQueue::SetMaxNodesPerTask). The empty
+  // name refers to the default executor. Must be called after the executor
+  // has been set and before the scheduler is started.
+  absl::Status SetMaxNodesPerTask(const std::string& name,
+                                  int max_nodes_per_task);
+
   // Resets the data members at the beginning of each graph run.
   void Reset();
 
+  // Adds the load on the scheduler queue of each executor to |metrics|.
+  // This method is thread-safe.
+  void GetExecutorMetrics(GraphMetrics* metrics);
+
   // Starts scheduling nodes.
   void Start();
 
@@ -14,11 +14,13 @@
 
 #include "mediapipe/framework/scheduler_queue.h"
 
+#include <algorithm>
 #include <memory>
 #include <queue>
 #include <utility>
 
 #include "absl/synchronization/mutex.h"
+#include "absl/types/optional.h"
 #include "mediapipe/framework/calculator_node.h"
 #include "mediapipe/framework/executor.h"
 #include "mediapipe/framework/port/canonical_errors.h"
@@ -89,12 +91,22 @@ bool SchedulerQueue::Item::operator<(const SchedulerQueue::Item& that) const {
 void SchedulerQueue::Reset() {
   absl::MutexLock lock(&mutex_);
   num_pending_tasks_ = 0;
-  num_tasks_to_add_ = 0;
+  num_claimable_nodes_ = 0;
   running_count_ = 0;
 }
 
 void SchedulerQueue::SetExecutor(Executor* executor) { executor_ = executor; }
 
+void SchedulerQueue::GetLoad(int* queued_nodes, int* pending_tasks) {
+  absl::MutexLock lock(&mutex_);
+  *queued_nodes = queue_.size();
+  *pending_tasks = num_pending_tasks_;
+}
+
+void SchedulerQueue::SetMaxNodesPerTask(int max_nodes_per_task) {
+  max_nodes_per_task_ = std::max(max_nodes_per_task, 1);
+}
+
 bool SchedulerQueue::IsIdle() {
   VLOG(3) << "Scheduler queue empty: " << queue_.empty()
           << ", # of pending tasks: " << num_pending_tasks_;
@@ -138,7 +150,6 @@ void SchedulerQueue::AddItemToQueue(Item&& item) {
     absl::MutexLock lock(&mutex_);
     was_idle = IsIdle();
     queue_.push(item);
-    ++num_tasks_to_add_;
     VLOG(4) << node->DebugName() << " was added to the scheduler queue.";
 
     // Now grab the tasks to execute while still holding the lock. This will
@@ -162,8 +173,18 @@ void SchedulerQueue::AddItemToQueue(Item&& item) {
 }
 
 int SchedulerQueue::GetTasksToSubmitToExecutor() {
-  int tasks_to_add = num_tasks_to_add_;
-  num_tasks_to_add_ = 0;
+  // Submit just enough tasks so that every queued node will be dequeued by a
+  // task, counting the nodes that the tasks already submitted, including the
+  // running ones, can still take. Without batching, this is one task per
+  // queued node.
+  const int unclaimed_nodes =
+      static_cast<int>(queue_.size()) - num_claimable_nodes_;
+  if (unclaimed_nodes <= 0) {
+    return 0;
+  }
+  const int tasks_to_add =
+      (unclaimed_nodes + max_nodes_per_task_ - 1) / max_nodes_per_task_;
+  num_claimable_nodes_ += tasks_to_add * max_nodes_per_task_;
   num_pending_tasks_ += tasks_to_add;
   return tasks_to_add;
 }
@@ -186,45 +207,53 @@ void SchedulerQueue::SubmitWaitingTasksToExecutor() {
 }
 
 void SchedulerQueue::RunNextTask() {
-  CalculatorNode* node;
-  CalculatorContext* calculator_context;
-  bool is_open_node;
-  {
-    absl::MutexLock lock(&mutex_);
-
-    CHECK(!queue_.empty()) << "Called RunNextTask when the queue is empty. "
-                              "This should not happen.";
-
-    node = queue_.top().Node();
-    calculator_context = queue_.top().Context();
-    is_open_node = queue_.top().IsOpenNode();
-    queue_.pop();
-
-    CHECK(!node->Closed())
-        << "Scheduled a node that was closed. This should not happen.";
-  }
+  // Without batching, the task runs exactly one node. With batching, earlier
+  // tasks may have already dequeued the nodes that this task was submitted
+  // for, and the task goes on with the nodes that become ready while it runs.
+  int nodes_left = max_nodes_per_task_;
+  bool is_idle = false;
+  for (bool first_node = true;; first_node = false) {
+    absl::optional<Item> item;
+    {
+      absl::MutexLock lock(&mutex_);
+      CHECK(!first_node || !queue_.empty() || max_nodes_per_task_ > 1)
+          << "Called RunNextTask when the queue is empty. "
+             "This should not happen.";
+      // Once the queue stops running, the task only finishes the node it was
+      // submitted for; SubmitWaitingTasksToExecutor() takes care of the rest.
+      if (nodes_left > 0 && !queue_.empty() &&
+          (first_node || running_count_ > 0)) {
+        item = queue_.top();
+        queue_.pop();
+        --nodes_left;
+        DCHECK_GT(num_claimable_nodes_, 0);
+        --num_claimable_nodes_;
+        CHECK(!item->Node()->Closed())
+            << "Scheduled a node that was closed. This should not happen.";
+      } else {
+        num_claimable_nodes_ -= nodes_left;
+        DCHECK_GT(num_pending_tasks_, 0);
+        --num_pending_tasks_;
+        is_idle = IsIdle();
+        break;
+      }
+    }
 
-  // On iOS, calculators may rely on the existence of an autorelease pool
-  // (either directly, or because system code they call does). We do not
-  // want to rely on executors setting up an autorelease pool for us (e.g.
-  // an executor creating standard pthread will not, by default), so we
-  // do it here to ensure all executors are covered.
-  AUTORELEASEPOOL {
-    if (is_open_node) {
-      DCHECK(!calculator_context);
-      OpenCalculatorNode(node);
-    } else {
-      RunCalculatorNode(node, calculator_context);
+    // On iOS, calculators may rely on the existence of an autorelease pool
+    // (either directly, or because system code they call does). We do not
+    // want to rely on executors setting up an autorelease pool for us (e.g.
+    // an executor creating standard pthread will not, by default), so we
+    // do it here to ensure all executors are covered.
+    AUTORELEASEPOOL {
+      if (item->IsOpenNode()) {
+        DCHECK(!item->Context());
+        OpenCalculatorNode(item->Node());
+      } else {
+        RunCalculatorNode(item->Node(), item->Context());
+      }
     }
   }
 
-  bool is_idle;
-  {
-    absl::MutexLock lock(&mutex_);
-    DCHECK_GT(num_pending_tasks_, 0);
-    --num_pending_tasks_;
-    is_idle = IsIdle();
-  }
   if (is_idle && idle_callback_) {
     // Became idle.
     idle_callback_(true);
@@ -300,8 +329,7 @@ void SchedulerQueue::CleanupAfterRun() {
     absl::MutexLock lock(&mutex_);
     was_idle = IsIdle();
     CHECK_EQ(num_pending_tasks_, 0);
-    CHECK_EQ(num_tasks_to_add_, queue_.size());
-    num_tasks_to_add_ = 0;
+    CHECK_EQ(num_claimable_nodes_, 0);
     while (!queue_.empty()) {
       queue_.pop();
     }
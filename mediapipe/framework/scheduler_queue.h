@@ -82,6 +82,15 @@ class SchedulerQueue : public TaskQueue {
   // scheduler is started.
   void SetExecutor(Executor* executor);
 
+  // Sets the maximum number of queued nodes that a single executor task
+  // dequeues and runs. With the default of 1, every ready node becomes its own
+  // executor task. With larger values, a task keeps dequeuing nodes, including
+  // the ones that become ready while it runs, until it has run that many or
+  // the queue is empty. New tasks are only submitted to the executor for the
+  // queued nodes that the tasks already submitted cannot take. Must be called
+  // before the scheduler is started.
+  void SetMaxNodesPerTask(int max_nodes_per_task);
+
   // Sets the idle callback. It is called exactly once whenever the queue goes
   // from idle to active, or vice versa.
   // Note: if the queue is accessed by multiple threads, it is possible for
@@ -108,9 +117,10 @@ class SchedulerQueue : public TaskQueue {
   void SetRunning(bool running) ABSL_LOCKS_EXCLUDED(mutex_);
 
   // Gets the number of tasks that need to be submitted to the executor, and
-  // updates num_pending_tasks_. If this method is called and returns a
-  // non-zero value, the executor's AddTask method *must* be called for each
-  // task returned, but it can be called without holding the lock.
+  // updates num_pending_tasks_ and num_claimable_nodes_. If this method is
+  // called and returns a non-zero value, the executor's AddTask method *must*
+  // be called for each task returned, but it can be called without holding
+  // the lock.
   int GetTasksToSubmitToExecutor() ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
 
   // Submits tasks that are waiting (e.g. that were added while the queue was
@@ -130,6 +140,11 @@ class SchedulerQueue : public TaskQueue {
   // Adds an Item to queue_.
   void AddItemToQueue(Item&& item);
 
+  // Returns the number of ready nodes waiting in the queue and the number of
+  // tasks added to the executor and not yet complete.
+  void GetLoad(int* queued_nodes, int* pending_tasks)
+      ABSL_LOCKS_EXCLUDED(mutex_);
+
   void CleanupAfterRun() ABSL_LOCKS_EXCLUDED(mutex_);
 
  private:
@@ -159,8 +174,14 @@ class SchedulerQueue : public TaskQueue {
   // Number of tasks added to the Executor and not yet complete.
   int num_pending_tasks_ ABSL_GUARDED_BY(mutex_);
 
-  // Number of tasks that need to be added to the Executor.
-  int num_tasks_to_add_ ABSL_GUARDED_BY(mutex_);
+  // Number of nodes that the tasks added to the Executor may still dequeue.
+  // Each task adds max_nodes_per_task_ when it is submitted, and gives back
+  // what it did not use when it finishes. Invariant while running:
+  //   queue_.size() <= num_claimable_nodes_.
+  int num_claimable_nodes_ ABSL_GUARDED_BY(mutex_);
+
+  // See SetMaxNodesPerTask.
+  int max_nodes_per_task_ = 1;
 
   // Queue of nodes that need to be run.
   std::priority_queue<Item> queue_ ABSL_GUARDED_BY(mutex_);
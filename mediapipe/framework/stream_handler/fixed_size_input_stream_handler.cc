@@ -182,8 +182,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     return result;
   }
 
-  void AddPackets(CollectionItemId id,
-                  const std::list<Packet>& packets) override {
+  void AddPackets(CollectionItemId id, const PacketQueue& packets) override {
     InputStreamHandler::AddPackets(id, packets);
     absl::MutexLock lock(&erase_mutex_);
     if (!pending_) {
@@ -191,7 +190,7 @@ class FixedSizeInputStreamHandler : public DefaultInputStreamHandler {
     }
   }
 
-  void MovePackets(CollectionItemId id, std::list<Packet>* packets) override {
+  void MovePackets(CollectionItemId id, PacketQueue* packets) override {
     InputStreamHandler::MovePackets(id, packets);
     absl::MutexLock lock(&erase_mutex_);
     if (!pending_) {
@@ -18,6 +18,9 @@ namespace mediapipe {
 
 const GraphService<TestServiceObject> kTestService("test_service");
 const GraphService<int> kAnotherService("another_service");
+const GraphService<TestServiceObject> kDefaultInitService(
+    "default_init_service",
+    GraphService<TestServiceObject>::kAllowDefaultInitialization);
 
 absl::Status TestServiceCalculator::GetContract(CalculatorContract* cc) {
   cc->Inputs().Index(0).Set<int>();
@@ -51,4 +54,20 @@ absl::Status TestServiceCalculator::Process(CalculatorContext* cc) {
 
 REGISTER_CALCULATOR(TestServiceCalculator);
 
+absl::Status DefaultInitServiceCalculator::GetContract(
+    CalculatorContract* cc) {
+  cc->Inputs().Index(0).SetAny();
+  cc->Outputs().Index(0).Set<int>();
+  cc->UseService(kDefaultInitService);
+  return absl::OkStatus();
+}
+
+absl::Status DefaultInitServiceCalculator::Process(CalculatorContext* cc) {
+  int count = ++cc->Service(kDefaultInitService).GetObject()["count"];
+  cc->Outputs().Index(0).Add(new int(count), cc->InputTimestamp());
+  return absl::OkStatus();
+}
+
+REGISTER_CALCULATOR(DefaultInitServiceCalculator);
+
 }  // namespace mediapipe
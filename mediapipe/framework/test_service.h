@@ -23,6 +23,8 @@ using TestServiceObject = std::map<std::string, int>;
 
 extern const GraphService<TestServiceObject> kTestService;
 extern const GraphService<int> kAnotherService;
+// The graph creates this one if the application does not provide it.
+extern const GraphService<TestServiceObject> kDefaultInitService;
 
 // Use a service.
 class TestServiceCalculator : public CalculatorBase {
@@ -35,6 +37,14 @@ class TestServiceCalculator : public CalculatorBase {
   int optional_bias_ = 0;
 };
 
+// Counts the packets it receives in kDefaultInitService, and outputs the count
+// so far.
+class DefaultInitServiceCalculator : public CalculatorBase {
+ public:
+  static absl::Status GetContract(CalculatorContract* cc);
+  absl::Status Process(CalculatorContext* cc) final;
+};
+
 }  // namespace mediapipe
 
 #endif  // MEDIAPIPE_FRAMEWORK_TEST_SERVICE_H_
@@ -14,8 +14,10 @@
 
 #include "mediapipe/framework/thread_pool_executor.h"
 
+#include <string>
 #include <utility>
 
+#include "absl/memory/memory.h"
 #include "mediapipe/framework/port/canonical_errors.h"
 #include "mediapipe/framework/port/logging.h"
 #include "mediapipe/framework/port/status_builder.h"
@@ -71,21 +73,29 @@ absl::StatusOr<Executor*> ThreadPoolExecutor::Create(
       break;
   }
 #endif
-  return new ThreadPoolExecutor(thread_options, options.num_threads());
+  return new ThreadPoolExecutor(
+      thread_options, options.num_threads(),
+      options.queue_type() == ThreadPoolExecutorOptions::WORK_STEALING);
 }
 
 ThreadPoolExecutor::ThreadPoolExecutor(int num_threads)
-    : thread_pool_("mediapipe", num_threads) {
+    : thread_pool_(
+          absl::make_unique<mediapipe::ThreadPool>("mediapipe", num_threads)) {
   Start();
 }
 
 ThreadPoolExecutor::ThreadPoolExecutor(const ThreadOptions& thread_options,
-                                       int num_threads)
-    : thread_pool_(thread_options,
-                   thread_options.name_prefix().empty()
-                       ? "mediapipe"
-                       : thread_options.name_prefix(),
-                   num_threads) {
+                                       int num_threads, bool work_stealing) {
+  const std::string name_prefix = thread_options.name_prefix().empty()
+                                      ? "mediapipe"
+                                      : thread_options.name_prefix();
+  if (work_stealing) {
+    work_stealing_pool_ = absl::make_unique<mediapipe::WorkStealingThreadPool>(
+        thread_options, name_prefix, num_threads);
+  } else {
+    thread_pool_ = absl::make_unique<mediapipe::ThreadPool>(
+        thread_options, name_prefix, num_threads);
+  }
   Start();
 }
 
@@ -94,14 +104,28 @@ ThreadPoolExecutor::~ThreadPoolExecutor() {
 }
 
 void ThreadPoolExecutor::Schedule(std::function<void()> task) {
-  thread_pool_.Schedule(std::move(task));
+  if (work_stealing_pool_) {
+    work_stealing_pool_->Schedule(std::move(task));
+  } else {
+    thread_pool_->Schedule(std::move(task));
+  }
+}
+
+int ThreadPoolExecutor::num_threads() const {
+  return work_stealing_pool_ ? work_stealing_pool_->num_threads()
+                             : thread_pool_->num_threads();
 }
 
 void ThreadPoolExecutor::Start() {
-  stack_size_ = thread_pool_.thread_options().stack_size();
-  thread_pool_.StartWorkers();
-  VLOG(2) << "Started thread pool with " << thread_pool_.num_threads()
-          << " threads.";
+  if (work_stealing_pool_) {
+    stack_size_ = work_stealing_pool_->thread_options().stack_size();
+    work_stealing_pool_->StartWorkers();
+  } else {
+    stack_size_ = thread_pool_->thread_options().stack_size();
+    thread_pool_->StartWorkers();
+  }
+  VLOG(2) << "Started " << (work_stealing_pool_ ? "work-stealing " : "")
+          << "thread pool with " << num_threads() << " threads.";
 }
 
 REGISTER_EXECUTOR(ThreadPoolExecutor);
@@ -182,5 +182,40 @@ class ImageFrameTest(absltest.TestCase):
     self.assertEqual(sys.getrefcount(image_frame), initial_ref_count)
 
 
+  def test_image_frame_reference_mode(self):
+    w, h = 641, 481
+    mat = np.random.randint(2**8 - 1, size=(h, w, 3), dtype=np.uint8)
+    initial_ref_count = sys.getrefcount(mat)
+    image_frame = mp.ImageFrame(
+        image_format=mp.ImageFormat.SRGB, data=mat, copy=False)
+    # The image frame refers to the pixel data of mat in place.
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count + 1)
+    self.assertTrue(image_frame.is_contiguous())
+    self.assertTrue(np.array_equal(mat, image_frame.numpy_view()))
+    del image_frame
+    gc.collect()
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count)
+
+    # Unwritable data is still copied by default.
+    mat.flags.writeable = False
+    image_frame = mp.ImageFrame(image_format=mp.ImageFormat.SRGB, data=mat)
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count)
+    self.assertTrue(np.array_equal(mat, image_frame.numpy_view()))
+    image_frame = mp.ImageFrame(
+        image_format=mp.ImageFormat.SRGB, data=mat, copy=False)
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count + 1)
+    del image_frame
+    gc.collect()
+    self.assertEqual(sys.getrefcount(mat), initial_ref_count)
+
+  def test_image_frame_copies_data_by_default(self):
+    w, h = 64, 48
+    mat = np.random.randint(2**8 - 1, size=(h, w, 3), dtype=np.uint8)
+    image_frame = mp.ImageFrame(image_format=mp.ImageFormat.SRGB, data=mat)
+    expected = np.copy(mat)
+    mat[:, :, :] = 0
+    self.assertTrue(np.array_equal(expected, image_frame.numpy_view()))
+
+
 if __name__ == '__main__':
   absltest.main()
@@ -49,6 +49,19 @@ create_string_to_packet_map = _packet_creator.create_string_to_packet_map
 create_matrix = _packet_creator.create_matrix
 
 
+def _has_contiguous_rows(data: np.ndarray) -> bool:
+  """Returns True if the pixels in each row of data are stored contiguously."""
+  if data.ndim not in (2, 3):
+    return False
+  if data.ndim == 3 and data.shape[2] > 1 and data.strides[2] != data.itemsize:
+    return False
+  pixel_size = data.itemsize * (data.shape[2] if data.ndim == 3 else 1)
+  if data.shape[1] > 1 and data.strides[1] != pixel_size:
+    return False
+  return data.shape[0] <= 1 or (data.strides[0] >= pixel_size * data.shape[1]
+                                and data.strides[0] % data.itemsize == 0)
+
+
 def create_image_frame(data: Union[image_frame.ImageFrame, np.ndarray],
                        *,
                        image_format: image_frame.ImageFormat = None,
@@ -89,7 +102,9 @@ def create_image_frame(data: Union[image_frame.ImageFrame, np.ndarray],
   Raises:
     ValueError:
       i) When "data" is a numpy ndarray, "image_format" is not provided or
-        the "data" array is not c_contiguous in the reference mode.
+        the pixels in each row of the "data" array are not stored contiguously
+        in the reference mode. The rows themselves may be padded, e.g. when
+        "data" is a crop of a larger array.
       ii) When "data" is an ImageFrame object, the "image_format" arg doesn't
         match the image format of the "data" ImageFrame object or "copy" is
         explicitly set to False.
@@ -129,11 +144,10 @@ def create_image_frame(data: Union[image_frame.ImageFrame, np.ndarray],
     if copy is None:
       copy = True if data.flags.writeable else False
     if not copy:
-      # TODO: Investigate why the first 2 bytes of the data has data
-      # corruption when "data" is not c_contiguous.
-      if not data.flags.c_contiguous:
+      if not _has_contiguous_rows(data):
         raise ValueError(
-            'Reference mode is unavailable if \'data\' is not c_contiguous.')
+            'Reference mode is unavailable if the pixels in each row of '
+            '\'data\' are not stored contiguously.')
       if data.flags.writeable:
         warnings.warn(
             '\'data\' is still writeable. Taking a reference of the data to create ImageFrame packet is dangerous.',
@@ -362,6 +362,57 @@ class PacketTest(absltest.TestCase):
     # copy mode.
     self.assertEqual(sys.getrefcount(rgb_data), initial_ref_count)
 
+  def test_image_frame_packet_reference_creation_with_cropping(self):
+    w, h, channels = random.randrange(40, 100), random.randrange(40, 100), 3
+    offset = 10
+    rgb_data = np.random.randint(255, size=(h, w, channels), dtype=np.uint8)
+    cropped_data = rgb_data[offset:-offset, offset:-offset, :]
+    # The cropped rows are padded, but the pixels of each row are contiguous.
+    self.assertFalse(cropped_data.flags.c_contiguous)
+    initial_ref_count = sys.getrefcount(cropped_data)
+    p = mp.packet_creator.create_image_frame(
+        image_format=mp.ImageFormat.SRGB, data=cropped_data, copy=False)
+    # Reference mode increases the ref count of the data by 1.
+    self.assertEqual(sys.getrefcount(cropped_data), initial_ref_count + 1)
+    self.assertTrue(
+        np.array_equal(cropped_data,
+                       mp.packet_getter.get_image_frame_numpy_view(p)))
+    del p
+    gc.collect()
+    self.assertEqual(sys.getrefcount(cropped_data), initial_ref_count)
+
+    with self.assertRaisesRegex(ValueError, 'Reference mode is unavailable'):
+      mp.packet_creator.create_image_frame(
+          image_format=mp.ImageFormat.SRGB,
+          data=rgb_data[:, :, ::-1],
+          copy=False)
+
+  def test_image_frame_packet_numpy_view(self):
+    # The row size is not a multiple of the alignment boundary, so the image
+    # frame rows are padded.
+    w, h, channels = 41, 31, 3
+    rgb_data = np.random.randint(255, size=(h, w, channels), dtype=np.uint8)
+    p = mp.packet_creator.create_image_frame(
+        image_format=mp.ImageFormat.SRGB, data=rgb_data)
+    self.assertFalse(mp.packet_getter.get_image_frame(p).is_contiguous())
+    output_ndarray = mp.packet_getter.get_image_frame_numpy_view(p)
+    self.assertFalse(output_ndarray.flags.c_contiguous)
+    self.assertTrue(np.array_equal(output_ndarray, rgb_data))
+    with self.assertRaisesRegex(ValueError,
+                                'assignment destination is read-only'):
+      output_ndarray[0, 0, 0] = 0
+    # The ndarray keeps the pixel data alive after the packet is gone.
+    del p
+    gc.collect()
+    self.assertTrue(np.array_equal(output_ndarray, rgb_data))
+
+    gray_data = np.random.randint(255, size=(h, w), dtype=np.uint8)
+    p = mp.packet_creator.create_image_frame(
+        image_format=mp.ImageFormat.GRAY8, data=gray_data)
+    self.assertTrue(
+        np.array_equal(mp.packet_getter.get_image_frame_numpy_view(p),
+                       gray_data))
+
   def test_matrix_packet(self):
     np_matrix = np.array([[.1, .2, .3], [.4, .5, .6]])
     initial_ref_count = sys.getrefcount(np_matrix)
@@ -14,6 +14,8 @@
 
 #include "mediapipe/python/pybind/calculator_graph.h"
 
+#include <utility>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/calculator.pb.h"
@@ -35,6 +37,20 @@ namespace python {
 // Only one python callback can run at once.
 absl::Mutex callback_mutex;
 
+// Runs "graph_call" with the GIL released and raises its error, if any, once
+// the GIL is reacquired. Blocking graph calls must not hold the GIL: the
+// output stream callbacks need it on the graph threads, and other python
+// threads can keep feeding the graph meanwhile.
+template <typename GraphCall>
+void CallWithoutGil(GraphCall graph_call) {
+  absl::Status status;
+  {
+    py::gil_scoped_release gil_release;
+    status = graph_call();
+  }
+  RaisePyErrorIfNotOk(status);
+}
+
 template <typename T>
 T ParseProto(const py::object& proto_object) {
   T proto;
@@ -165,8 +181,11 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
                            " can't be the timestamp of a Packet in a stream.")
                   .c_str());
         }
-        RaisePyErrorIfNotOk(
-            self->AddPacketToInputStream(stream, packet.At(packet_timestamp)));
+        Packet timestamped_packet = packet.At(packet_timestamp);
+        CallWithoutGil([&] {
+          return self->AddPacketToInputStream(stream,
+                                              std::move(timestamped_packet));
+        });
       },
       R"doc(Add a packet to a graph input stream.
 
@@ -208,7 +227,7 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
   calculator_graph.def(
       "close_input_stream",
       [](CalculatorGraph* self, const std::string& stream) {
-        RaisePyErrorIfNotOk(self->CloseInputStream(stream));
+        CallWithoutGil([&] { return self->CloseInputStream(stream); });
       },
       R"doc(Close the named graph input stream.
 
@@ -223,7 +242,7 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
   calculator_graph.def(
       "close_all_packet_sources",
       [](CalculatorGraph* self) {
-        RaisePyErrorIfNotOk(self->CloseAllPacketSources());
+        CallWithoutGil([&] { return self->CloseAllPacketSources(); });
       },
       R"doc(Closes all the graph input streams and source calculator nodes.)doc");
 
@@ -236,7 +255,7 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
                              kv_pair.first.cast<std::string>(),
                              kv_pair.second.cast<Packet>());
         }
-        RaisePyErrorIfNotOk(self->StartRun(input_side_packet_map));
+        CallWithoutGil([&] { return self->StartRun(input_side_packet_map); });
       },
 
       R"doc(Start a run of the calculator graph.
@@ -288,7 +307,9 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
 
   calculator_graph.def(
       "wait_until_done",
-      [](CalculatorGraph* self) { RaisePyErrorIfNotOk(self->WaitUntilDone()); },
+      [](CalculatorGraph* self) {
+        CallWithoutGil([&] { return self->WaitUntilDone(); });
+      },
       R"doc(Wait for the current run to finish.
 
   A blocking call to wait for the current run to finish (block the current
@@ -313,7 +334,9 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
 
   calculator_graph.def(
       "wait_until_idle",
-      [](CalculatorGraph* self) { RaisePyErrorIfNotOk(self->WaitUntilIdle()); },
+      [](CalculatorGraph* self) {
+        CallWithoutGil([&] { return self->WaitUntilIdle(); });
+      },
       R"doc(Wait until the running graph is in the idle mode.
 
   Wait until the running graph is in the idle mode, which is when nothing can
@@ -341,7 +364,7 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
   calculator_graph.def(
       "wait_for_observed_output",
       [](CalculatorGraph* self) {
-        RaisePyErrorIfNotOk(self->WaitForObservedOutput());
+        CallWithoutGil([&] { return self->WaitForObservedOutput(); });
       },
       R"doc(Wait until a packet is emitted on one of the observed output streams.
 
@@ -394,23 +417,38 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
   calculator_graph.def(
       "observe_output_stream",
       [](CalculatorGraph* self, const std::string& stream_name,
-         pybind11::function callback_fn) {
+         pybind11::function callback_fn, bool observe_timestamp_bounds) {
         RaisePyErrorIfNotOk(self->ObserveOutputStream(
-            stream_name, [callback_fn, stream_name](const Packet& packet) {
+            stream_name,
+            [callback_fn, stream_name](const Packet& packet) {
               absl::MutexLock lock(&callback_mutex);
-              callback_fn(stream_name, packet);
+              // Graph threads don't hold the GIL.
+              py::gil_scoped_acquire gil_acquire;
+              try {
+                callback_fn(stream_name, packet);
+              } catch (py::error_already_set& e) {
+                return absl::UnknownError(
+                    absl::StrCat("Output stream callback of ", stream_name,
+                                 " raised: ", e.what()));
+              }
               return absl::OkStatus();
-            }));
+            },
+            observe_timestamp_bounds));
       },
       R"doc(Observe the named output stream.
 
   callback_fn will be invoked on every packet emitted by the output stream.
-  This method can only be called before start_run().
+  It runs on a graph worker thread, one callback at a time across the graph,
+  and an exception raised by it fails the graph run. This method can only be
+  called before start_run().
 
   Args:
     stream_name: The name of the output stream.
     callback_fn: The callback function to invoke on every packet emitted by the
       output stream.
+    observe_timestamp_bounds: If True, callback_fn is also invoked with an empty
+      packet when the timestamp bound of the stream advances without a packet.
+      The empty packet is at the last timestamp settled by the bound.
 
   Raises:
     RuntimeError: If the calculator graph isn't initialized or the stream
@@ -422,13 +460,15 @@ void CalculatorGraphSubmodule(pybind11::module* module) {
     graph.observe_output_stream('out',
                                 lambda stream_name, packet: out.append(packet))
 
-)doc");
+)doc",
+      py::arg("stream_name"), py::arg("callback_fn"),
+      py::arg("observe_timestamp_bounds") = false);
 
   calculator_graph.def(
       "close",
       [](CalculatorGraph* self) {
-        RaisePyErrorIfNotOk(self->CloseAllPacketSources());
-        RaisePyErrorIfNotOk(self->WaitUntilDone());
+        CallWithoutGil([&] { return self->CloseAllPacketSources(); });
+        CallWithoutGil([&] { return self->WaitUntilDone(); });
       },
       R"doc(Close all the input sources and shutdown the graph.)doc");
 
@@ -187,10 +187,12 @@ void ImageFrameSubmodule(pybind11::module* module) {
   Pixels are encoded row-major in an interleaved fashion. ImageFrame supports
   uint8, uint16, and float as its data types.
 
-  ImageFrame can be created by copying the data from a numpy ndarray that stores
-  the pixel data continuously. An ImageFrame may realign the input data on its
-  default alignment boundary during creation. The data in an ImageFrame will
-  become immutable after creation.
+  ImageFrame can be created from a numpy ndarray whose pixels are stored
+  contiguously in each row. The data is copied and realigned on the ImageFrame
+  default alignment boundary. With copy=False, the ndarray is instead referred
+  to in place and kept alive by the ImageFrame; the caller must then not modify
+  it while the ImageFrame exists. The data in an ImageFrame will become
+  immutable after creation.
 
   Creation examples:
     import cv2
@@ -198,6 +200,10 @@ void ImageFrameSubmodule(pybind11::module* module) {
     rgb_frame = mp.ImageFrame(format=ImageFormat.SRGB, data=cv_mat)
     gray_frame = mp.ImageFrame(
         format=ImageFormat.GRAY, data=cv2.cvtColor(cv_mat, cv2.COLOR_RGB2GRAY))
+    # Refers to the pixel data of a (h, w, 3) uint8 ndarray without a copy.
+    rgb_array.flags.writeable = False
+    rgb_frame = mp.ImageFrame(format=ImageFormat.SRGB, data=rgb_array,
+                              copy=False)
 
     from PIL import Image
     pil_img = Image.new('RGB', (60, 30), color = 'red')
@@ -225,7 +231,8 @@ void ImageFrameSubmodule(pybind11::module* module) {
   image_frame
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint8, py::array::c_style>& data) {
+                      const py::array_t<uint8>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY8 &&
                 format != mediapipe::ImageFormat::SRGB &&
                 format != mediapipe::ImageFormat::SRGBA) {
@@ -233,13 +240,15 @@ void ImageFrameSubmodule(pybind11::module* module) {
                                  "uint8 image data should be one of the GRAY8, "
                                  "SRGB, and SRGBA MediaPipe image formats.");
             }
-            return CreateImageFrame<uint8>(format, data);
+            return CreateImageFrame<uint8>(format, data, copy);
           }),
           R"doc(For uint8 data type, valid ImageFormat are GRAY8, SGRB, and SRGBA.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<uint16, py::array::c_style>& data) {
+                      const py::array_t<uint16>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::GRAY16 &&
                 format != mediapipe::ImageFormat::SRGB48 &&
                 format != mediapipe::ImageFormat::SRGBA64) {
@@ -248,13 +257,15 @@ void ImageFrameSubmodule(pybind11::module* module) {
                   "uint16 image data should be one of the GRAY16, "
                   "SRGB48, and SRGBA64 MediaPipe image formats.");
             }
-            return CreateImageFrame<uint16>(format, data);
+            return CreateImageFrame<uint16>(format, data, copy);
           }),
           R"doc(For uint16 data type, valid ImageFormat are GRAY16, SRGB48, and SRGBA64.)doc",
-          py::arg("image_format"), py::arg("data").noconvert())
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true)
       .def(
           py::init([](mediapipe::ImageFormat::Format format,
-                      const py::array_t<float, py::array::c_style>& data) {
+                      const py::array_t<float>& data,
+                      bool copy) {
             if (format != mediapipe::ImageFormat::VEC32F1 &&
                 format != mediapipe::ImageFormat::VEC32F2) {
               throw RaisePyError(
@@ -262,10 +273,11 @@ void ImageFrameSubmodule(pybind11::module* module) {
                   "float image data should be either VEC32F1 or VEC32F2 "
                   "MediaPipe image formats.");
             }
-            return CreateImageFrame<float>(format, data);
+            return CreateImageFrame<float>(format, data, copy);
           }),
           R"doc(For float data type, valid ImageFormat are VEC32F1 and VEC32F2.)doc",
-          py::arg("image_format"), py::arg("data").noconvert());
+          py::arg("image_format"), py::arg("data").noconvert(),
+          py::arg("copy") = true);
 
   image_frame.def(
       "numpy_view",
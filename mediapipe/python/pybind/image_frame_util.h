@@ -15,11 +15,14 @@
 #ifndef MEDIAPIPE_PYTHON_PYBIND_IMAGE_FRAME_UTIL_H_
 #define MEDIAPIPE_PYTHON_PYBIND_IMAGE_FRAME_UTIL_H_
 
+#include <vector>
+
 #include "absl/memory/memory.h"
 #include "absl/strings/str_cat.h"
 #include "mediapipe/framework/formats/image_format.pb.h"
 #include "mediapipe/framework/formats/image_frame.h"
 #include "mediapipe/framework/port/logging.h"
+#include "mediapipe/python/pybind/util.h"
 #include "pybind11/numpy.h"
 #include "pybind11/pybind11.h"
 
@@ -28,14 +31,53 @@ namespace python {
 
 namespace py = pybind11;
 
+// Returns true if the pixels of each row of "data" are stored contiguously,
+// which is all an ImageFrame needs to refer to the array in place. The rows may
+// be padded, e.g. when "data" is a crop of a wider image.
+template <typename T>
+bool HasImageFrameStrides(mediapipe::ImageFormat::Format format,
+                          const py::array_t<T>& data) {
+  if (data.ndim() != 2 && data.ndim() != 3) {
+    return false;
+  }
+  const py::ssize_t channel_stride = sizeof(T);
+  const py::ssize_t pixel_stride =
+      ImageFrame::NumberOfChannelsForFormat(format) * channel_stride;
+  if (data.ndim() == 3 && data.shape(2) > 1 &&
+      data.strides(2) != channel_stride) {
+    return false;
+  }
+  if (data.shape(1) > 1 && data.strides(1) != pixel_stride) {
+    return false;
+  }
+  return data.shape(0) <= 1 ||
+         (data.strides(0) >= pixel_stride * data.shape(1) &&
+          data.strides(0) % channel_stride == 0);
+}
+
+// Creates an ImageFrame of the pixel data in "data". If "copy" is false, the
+// image frame refers to the array in place and holds a reference to it until
+// the image frame is destroyed. Arrays whose pixels aren't stored contiguously
+// in each row are repacked into a c-contiguous array first.
 template <typename T>
 std::unique_ptr<ImageFrame> CreateImageFrame(
-    mediapipe::ImageFormat::Format format,
-    const py::array_t<T, py::array::c_style>& data, bool copy = true) {
+    mediapipe::ImageFormat::Format format, const py::array_t<T>& input_data,
+    bool copy = true) {
+  const bool has_image_frame_strides = HasImageFrameStrides(format, input_data);
+  py::array_t<T> data = input_data;
+  if (!has_image_frame_strides) {
+    data = py::array_t<T, py::array::c_style>::ensure(input_data);
+    if (!data) {
+      throw py::error_already_set();
+    }
+  }
   int rows = data.shape()[0];
   int cols = data.shape()[1];
   int width_step = ImageFrame::NumberOfChannelsForFormat(format) *
                    ImageFrame::ByteDepthForFormat(format) * cols;
+  if (has_image_frame_strides && rows > 1) {
+    width_step = data.strides()[0];
+  }
   if (copy) {
     auto image_frame = absl::make_unique<ImageFrame>(
         format, /*width=*/cols, /*height=*/rows, width_step,
@@ -52,11 +94,51 @@ std::unique_ptr<ImageFrame> CreateImageFrame(
   auto image_frame = absl::make_unique<ImageFrame>(
       format, /*width=*/cols, /*height=*/rows, width_step,
       static_cast<uint8*>(data.request().ptr),
-      /*deleter=*/[data_pyobject](uint8*) { Py_XDECREF(data_pyobject); });
+      /*deleter=*/[data_pyobject](uint8*) {
+        // The last packet holding the image frame may be released on a graph
+        // thread.
+        py::gil_scoped_acquire gil_acquire;
+        Py_XDECREF(data_pyobject);
+      });
   Py_XINCREF(data_pyobject);
   return image_frame;
 }
 
+// Returns an unwritable numpy ndarray that refers to the pixel data of
+// "image_frame" in place, with the row padding of the image frame skipped by
+// the array strides. "owner" is kept alive as long as the array is.
+inline py::array CreateImageFrameNumpyView(const ImageFrame& image_frame,
+                                           py::handle owner) {
+  py::dtype dtype;
+  switch (image_frame.ChannelSize()) {
+    case sizeof(uint8):
+      dtype = py::dtype::of<uint8>();
+      break;
+    case sizeof(uint16):
+      dtype = py::dtype::of<uint16>();
+      break;
+    case sizeof(float):
+      dtype = py::dtype::of<float>();
+      break;
+    default:
+      throw RaisePyError(PyExc_RuntimeError,
+                         "Unsupported image frame channel size. Data is not "
+                         "uint8, uint16, or float?");
+  }
+  std::vector<py::ssize_t> shape{image_frame.Height(), image_frame.Width()};
+  std::vector<py::ssize_t> strides{
+      image_frame.WidthStep(),
+      image_frame.NumberOfChannels() * image_frame.ChannelSize()};
+  if (image_frame.NumberOfChannels() > 1) {
+    shape.push_back(image_frame.NumberOfChannels());
+    strides.push_back(image_frame.ChannelSize());
+  }
+  py::array view(dtype, shape, strides, image_frame.PixelData(), owner);
+  py::detail::array_proxy(view.ptr())->flags &=
+      ~py::detail::npy_api::NPY_ARRAY_WRITEABLE_;
+  return view;
+}
+
 }  // namespace python
 }  // namespace mediapipe
 
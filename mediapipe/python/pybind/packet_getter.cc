@@ -322,6 +322,40 @@ void PublicPacketGetters(pybind11::module* m) {
 )doc",
       py::return_value_policy::reference_internal);
 
+  m->def(
+      "get_image_frame_numpy_view",
+      [](const Packet& packet) {
+        const ImageFrame& image_frame = GetContent<ImageFrame>(packet);
+        // The capsule shares the ownership of the image frame, so the view
+        // stays valid after the python packet object is gone.
+        auto* owner = new Packet(packet);
+        py::capsule capsule(owner, [](void* packet_copy) {
+          delete reinterpret_cast<Packet*>(packet_copy);
+        });
+        return CreateImageFrameNumpyView(image_frame, capsule);
+      },
+      R"doc(Get the pixel data of a MediaPipe ImageFrame Packet as a numpy ndarray.
+
+  Unlike ImageFrame.numpy_view(), the pixel data is never copied, even if the
+  image frame rows are padded: the unwritable ndarray refers to the pixel data
+  of the packet in place, and strides over the row padding. The ndarray keeps
+  the packet content alive.
+
+  Args:
+    packet: A MediaPipe ImageFrame Packet.
+
+  Returns:
+    An unwritable numpy ndarray of shape (height, width, channels), or
+    (height, width) for single channel image frames.
+
+  Raises:
+    ValueError: If the Packet doesn't contain ImageFrame.
+
+  Examples:
+    packet = packet_creator.create_image_frame(frame)
+    data = packet_getter.get_image_frame_numpy_view(packet)
+)doc");
+
   m->def(
       "get_matrix",
       [](const Packet& packet) {
@@ -22,8 +22,10 @@ class.
 """
 
 import collections
+import concurrent.futures
 import enum
 import os
+import threading
 from typing import Any, Iterable, List, Mapping, NamedTuple, Optional, Union
 
 import numpy as np
@@ -56,6 +58,8 @@ import mediapipe.python.packet_creator as packet_creator
 import mediapipe.python.packet_getter as packet_getter
 
 RGB_CHANNELS = 3
+# The timestamp increment in microseconds used to simulate a 30 fps video input.
+SIMULATED_TIMESTAMP_INCREMENT = 33333
 # TODO: Enable calculator options modification for more calculators.
 CALCULATOR_TO_OPTIONS = {
     'ConstantSidePacketCalculator':
@@ -162,6 +166,16 @@ NAME_TO_TYPE: Mapping[str, '_PacketDataType'] = {
 }
 
 
+class _PendingFrame:
+  """A set of input data submitted by SolutionBase.submit() to be resolved."""
+
+  def __init__(self, timestamp: int):
+    self.timestamp = timestamp
+    self.future = concurrent.futures.Future()
+    # A mapping from the output stream name to the output packet at timestamp.
+    self.outputs = {}
+
+
 class SolutionBase:
   """The common base class for the high-level MediaPipe Solution APIs.
 
@@ -178,6 +192,12 @@ class SolutionBase:
       results = hand_tracker.process(input_image)
       print(results.palm_detections)
       print(results.multi_hand_landmarks)
+
+  Several frames can also be pipelined through the graph by submit(), which
+  returns a future of the outputs of each frame without waiting for them:
+      futures = [hand_tracker.submit(frame) for frame in frames]
+      for future in futures:
+        print(future.result().multi_hand_landmarks)
   """
 
   def __init__(
@@ -237,12 +257,26 @@ class SolutionBase:
         graph_config=canonical_graph_config_proto)
     self._simulated_timestamp = 0
     self._graph_outputs = {}
+    # Guards the pending frames and output stream bounds below, which are
+    # updated by the output stream callback on the graph threads.
+    self._pending_lock = threading.Lock()
+    # The frames submitted by submit() that are not resolved yet, in timestamp
+    # order.
+    self._pending_frames = collections.deque()
+    # A mapping from the output stream name to the latest timestamp settled by
+    # the stream, either by a packet or by its timestamp bound.
+    self._output_stream_bounds = {}
 
     def callback(stream_name: str, output_packet: packet.Packet) -> None:
-      self._graph_outputs[stream_name] = output_packet
+      # Empty packets only report that the timestamp bound of the stream
+      # advanced.
+      if not output_packet.is_empty():
+        self._graph_outputs[stream_name] = output_packet
+      self._record_pending_frame_output(stream_name, output_packet)
 
     for stream_name in self._output_stream_type_info.keys():
-      self._graph.observe_output_stream(stream_name, callback)
+      self._graph.observe_output_stream(
+          stream_name, callback, observe_timestamp_bounds=True)
 
     input_side_packets = {
         name: self._make_packet(self._side_input_type_info[name], data)
@@ -281,8 +315,99 @@ class SolutionBase:
           {'video_in' : cv2.imread('/tmp/hand1.png')[:, :, ::-1]})
       print(results.hand_landmarks)
     """
+    if self._pending_frames:
+      self.flush()
     self._graph_outputs.clear()
+    self._simulated_timestamp += SIMULATED_TIMESTAMP_INCREMENT
+    self._add_input_packets(input_data, self._simulated_timestamp)
+    self._graph.wait_until_idle()
+    return self._make_solution_outputs(self._graph_outputs)
+
+  def submit(self,
+             input_data: Union[np.ndarray, Mapping[str, np.ndarray]],
+             timestamp: Optional[int] = None) -> concurrent.futures.Future:
+    """Submits a set of RGB image data without waiting for its outputs.
+
+    Unlike process(), submit() returns as soon as the input data is added to the
+    graph, so that the graph can work on several frames at once. The futures of
+    the submitted frames are resolved in timestamp order, as soon as every
+    observed output stream has emitted a packet or advanced its timestamp bound
+    past the frame timestamp. The outputs of streams that skip the frame are
+    None. A stream whose calculators don't propagate timestamp bounds can keep
+    the futures pending until flush() or close(). Calling process() flushes the
+    submitted frames first.
+
+    Args:
+      input_data: Either a single numpy ndarray object representing the solo
+        image input of a graph or a mapping from the stream name to the image
+        data that represents every input streams of a graph.
+      timestamp: The timestamp of the input data in microseconds, which must be
+        greater than the timestamps of the earlier inputs. If not provided, the
+        input is timestamped as the next frame of a 30 fps video.
+
+    Raises:
+      NotImplementedError: If input_data contains non image data.
+      RuntimeError: If the underlying graph occurs any error.
+      ValueError: If the input image data is not three channel RGB.
+
+    Returns:
+      A concurrent.futures.Future object of the NamedTuple object that
+        process() would return for the input data. If the graph occurs any
+        error, the future gets the RuntimeError raised by flush() or close().
+
+    Examples:
+      solution = solution_base.SolutionBase(graph_config=hand_landmark_graph)
+      futures = [solution.submit(frame) for frame in video_frames]
+      for future in futures:
+        print(future.result().hand_landmarks)
+    """
+    if timestamp is None:
+      timestamp = self._simulated_timestamp + SIMULATED_TIMESTAMP_INCREMENT
+    frame = _PendingFrame(timestamp)
+    with self._pending_lock:
+      self._pending_frames.append(frame)
+    try:
+      self._add_input_packets(input_data, timestamp)
+    except Exception:
+      with self._pending_lock:
+        self._pending_frames.remove(frame)
+      raise
+    self._simulated_timestamp = timestamp
+    return frame.future
+
+  def flush(self) -> None:
+    """Waits until the graph is idle and resolves all the submitted frames.
+
+    The output streams that don't emit a packet at the timestamp of a submitted
+    frame are None in its outputs.
 
+    Raises:
+      RuntimeError: If the underlying graph occurs any error. The error is also
+        set to the futures of the unresolved frames.
+    """
+    try:
+      self._graph.wait_until_idle()
+    except RuntimeError as e:
+      self._settle_pending_frames(e)
+      raise
+    self._settle_pending_frames()
+
+  def close(self) -> None:
+    """Closes all the input sources and the graph."""
+    try:
+      self._graph.close()
+    except RuntimeError as e:
+      self._settle_pending_frames(e)
+      raise
+    self._settle_pending_frames()
+    self._graph = None
+    self._input_stream_type_info = None
+    self._output_stream_type_info = None
+
+  def _add_input_packets(self, input_data: Union[np.ndarray,
+                                                 Mapping[str, np.ndarray]],
+                         timestamp: int) -> None:
+    """Adds the input data packets at timestamp to the graph input streams."""
     if isinstance(input_data, np.ndarray):
       if len(self._input_stream_type_info.keys()) != 1:
         raise ValueError(
@@ -292,9 +417,6 @@ class SolutionBase:
     else:
       input_dict = input_data
 
-    # Set the timestamp increment to 33333 us to simulate the 30 fps video
-    # input.
-    self._simulated_timestamp += 33333
     for stream_name, data in input_dict.items():
       if self._input_stream_type_info[stream_name] == _PacketDataType.IMAGE:
         if data.shape[2] != RGB_CHANNELS:
@@ -302,7 +424,7 @@ class SolutionBase:
         self._graph.add_packet_to_input_stream(
             stream=stream_name,
             packet=self._make_packet(_PacketDataType.IMAGE,
-                                     data).at(self._simulated_timestamp))
+                                     data).at(timestamp))
       else:
         # TODO: Support audio data.
         raise NotImplementedError(
@@ -310,28 +432,64 @@ class SolutionBase:
             f'{self._input_stream_type_info[stream_name].name} '
             f'type is not supported yet.')
 
-    self._graph.wait_until_idle()
+  def _make_solution_outputs(
+      self, graph_outputs: Mapping[str, packet.Packet]) -> NamedTuple:
+    """Makes the NamedTuple object of the output packets of a graph run."""
     # Create a NamedTuple object where the field names are mapping to the graph
     # output stream names.
     solution_outputs = collections.namedtuple(
         'SolutionOutputs', self._output_stream_type_info.keys())
     for stream_name in self._output_stream_type_info.keys():
-      if stream_name in self._graph_outputs:
+      if stream_name in graph_outputs:
         setattr(
             solution_outputs, stream_name,
             self._get_packet_content(self._output_stream_type_info[stream_name],
-                                     self._graph_outputs[stream_name]))
+                                     graph_outputs[stream_name]))
       else:
         setattr(solution_outputs, stream_name, None)
 
     return solution_outputs
 
-  def close(self) -> None:
-    """Closes all the input sources and the graph."""
-    self._graph.close()
-    self._graph = None
-    self._input_stream_type_info = None
-    self._output_stream_type_info = None
+  def _record_pending_frame_output(self, stream_name: str,
+                                   output_packet: packet.Packet) -> None:
+    """Stores an output packet into its pending frame and resolves the frames that are complete.
+
+    An empty output packet only advances the timestamp bound of the stream.
+    """
+    timestamp = output_packet.timestamp.value
+    resolved_frames = []
+    with self._pending_lock:
+      self._output_stream_bounds[stream_name] = timestamp
+      if not output_packet.is_empty():
+        for frame in self._pending_frames:
+          if frame.timestamp >= timestamp:
+            if frame.timestamp == timestamp:
+              frame.outputs[stream_name] = output_packet
+            break
+      # Output streams emit packets and bounds in timestamp order, so a frame
+      # is complete once every output stream has settled its timestamp.
+      while self._pending_frames and all(
+          self._output_stream_bounds.get(name, float('-inf')) >=
+          self._pending_frames[0].timestamp
+          for name in self._output_stream_type_info):
+        resolved_frames.append(self._pending_frames.popleft())
+    self._resolve_frames(resolved_frames)
+
+  def _settle_pending_frames(self,
+                             error: Optional[Exception] = None) -> None:
+    """Resolves all the pending frames, or sets error to their futures."""
+    with self._pending_lock:
+      frames = list(self._pending_frames)
+      self._pending_frames.clear()
+    if error:
+      for frame in frames:
+        frame.future.set_exception(error)
+    else:
+      self._resolve_frames(frames)
+
+  def _resolve_frames(self, frames: Iterable[_PendingFrame]) -> None:
+    for frame in frames:
+      frame.future.set_result(self._make_solution_outputs(frame.outputs))
 
   def _initialize_graph_interface(
       self,
@@ -487,7 +645,7 @@ class SolutionBase:
     if packet_data_type == _PacketDataType.STRING:
       return packet_getter.get_str(output_packet)
     elif packet_data_type == _PacketDataType.IMAGE:
-      return packet_getter.get_image_frame(output_packet).numpy_view()
+      return packet_getter.get_image_frame_numpy_view(output_packet)
     else:
       return getattr(packet_getter, 'get_' + packet_data_type.value)(
           output_packet)
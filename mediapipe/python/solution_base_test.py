@@ -267,6 +267,61 @@ class SolutionBaseTest(parameterized.TestCase):
             'ImageTransformation.output_height': 0
         })
 
+  def test_solution_submit(self):
+    config_proto = text_format.Parse(CALCULATOR_OPTIONS_TEST_GRAPH_CONFIG,
+                                     calculator_pb2.CalculatorGraphConfig())
+    config_proto.node[0].ClearField('options')
+    config_proto.node[0].ClearField('node_options')
+    input_images = [np.full((3, 3, 3), i, dtype=np.uint8) for i in range(10)]
+    with solution_base.SolutionBase(graph_config=config_proto) as solution:
+      futures = [solution.submit(image) for image in input_images]
+      solution.flush()
+      for future, input_image in zip(futures, input_images):
+        self.assertTrue(future.done())
+        self.assertTrue(
+            np.array_equal(input_image, future.result().image_out))
+      # process() still works after submit() and uses later timestamps.
+      outputs = solution.process(input_images[0])
+      self.assertTrue(np.array_equal(input_images[0], outputs.image_out))
+      last_future = solution.submit(input_images[1], timestamp=10**7)
+    self.assertTrue(np.array_equal(input_images[1],
+                                   last_future.result().image_out))
+
+  def test_solution_submit_with_skipped_outputs(self):
+    config_proto = text_format.Parse(
+        """
+      input_stream: 'image_in'
+      input_side_packet: 'allow_signal'
+      output_stream: 'image_out'
+      output_stream: 'gated_image_out'
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:image_in'
+        output_stream: 'IMAGE:image_out'
+      }
+      node {
+        calculator: 'GateCalculator'
+        input_stream: 'image_in'
+        input_side_packet: 'ALLOW:allow_signal'
+        output_stream: 'gated_image_in'
+      }
+      node {
+        calculator: 'ImageTransformationCalculator'
+        input_stream: 'IMAGE:gated_image_in'
+        output_stream: 'IMAGE:gated_image_out'
+      }""", calculator_pb2.CalculatorGraphConfig())
+    input_images = [np.full((3, 3, 3), i, dtype=np.uint8) for i in range(5)]
+    with solution_base.SolutionBase(
+        graph_config=config_proto,
+        side_inputs={'allow_signal': False}) as solution:
+      futures = [solution.submit(image) for image in input_images]
+      # gated_image_out skips every frame, but its timestamp bound resolves
+      # the futures without a flush().
+      for future, input_image in zip(futures, input_images):
+        outputs = future.result(timeout=10)
+        self.assertTrue(np.array_equal(input_image, outputs.image_out))
+        self.assertIsNone(outputs.gated_image_out)
+
   def _process_and_verify(self,
                           config_proto,
                           side_inputs=None,
@@ -0,0 +1,132 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+static const double kEpsilon = 0.000001;
+
+OneEuroFilterBank::OneEuroFilterBank(int num_values, double frequency,
+                                     double min_cutoff, double beta,
+                                     double derivate_cutoff)
+    : num_values_(num_values),
+      beta_(beta),
+      raw_values_(num_values),
+      filtered_values_(num_values),
+      filtered_derivatives_(num_values) {
+  CHECK_GE(num_values, 0);
+  SetFrequency(frequency);
+  SetMinCutoff(min_cutoff);
+  SetDerivateCutoff(derivate_cutoff);
+}
+
+void OneEuroFilterBank::Apply(absl::Duration timestamp,
+                              absl::Span<float> values) {
+  CHECK_EQ(values.size(), num_values_);
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_time_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    return;
+  }
+
+  // update the sampling frequency based on timestamps
+  if (last_time_ != 0 && new_timestamp != 0) {
+    static constexpr double kNanoSecondsToSecond = 1e-9;
+    frequency_ = 1.0 / ((new_timestamp - last_time_) * kNanoSecondsToSecond);
+  }
+  last_time_ = new_timestamp;
+
+  const int n = num_values_;
+  float* value = values.data();
+  float* raw_value = raw_values_.data();
+  float* filtered_value = filtered_values_.data();
+  float* filtered_derivative = filtered_derivatives_.data();
+
+  if (!initialized_) {
+    // The first values are returned as they are, and their derivatives are
+    // estimated as zero.
+    std::copy_n(value, n, raw_value);
+    std::copy_n(value, n, filtered_value);
+    std::fill_n(filtered_derivative, n, 0.0f);
+    initialized_ = true;
+    return;
+  }
+
+  // The arithmetic below, including the conversions between float and double,
+  // matches OneEuroFilter and LowPassFilter, so that the results are the same.
+  const float derivate_alpha = GetAlpha(derivate_cutoff_);
+  const double frequency = frequency_;
+  const double te = 1.0 / frequency;
+  const double min_cutoff = min_cutoff_;
+  const double beta = beta_;
+  for (int i = 0; i < n; ++i) {
+    // estimate the current variation per second
+    const double dvalue =
+        (static_cast<double>(value[i]) - raw_value[i]) * frequency;
+    filtered_derivative[i] =
+        derivate_alpha * static_cast<float>(dvalue) +
+        (1.0 - derivate_alpha) * filtered_derivative[i];
+    // use it to update the cutoff frequency
+    const double cutoff =
+        min_cutoff +
+        beta * std::fabs(static_cast<double>(filtered_derivative[i]));
+    const double tau = 1.0 / (2 * M_PI * cutoff);
+    const float alpha = 1.0 / (1.0 + tau / te);
+
+    // filter the given value
+    filtered_value[i] = alpha * value[i] + (1.0 - alpha) * filtered_value[i];
+    raw_value[i] = value[i];
+    value[i] = filtered_value[i];
+  }
+}
+
+double OneEuroFilterBank::GetAlpha(double cutoff) const {
+  double te = 1.0 / frequency_;
+  double tau = 1.0 / (2 * M_PI * cutoff);
+  return 1.0 / (1.0 + tau / te);
+}
+
+void OneEuroFilterBank::SetFrequency(double frequency) {
+  if (frequency <= kEpsilon) {
+    LOG(ERROR) << "frequency should be > 0";
+    return;
+  }
+  frequency_ = frequency;
+}
+
+void OneEuroFilterBank::SetMinCutoff(double min_cutoff) {
+  if (min_cutoff <= kEpsilon) {
+    LOG(ERROR) << "min_cutoff should be > 0";
+    return;
+  }
+  min_cutoff_ = min_cutoff;
+}
+
+void OneEuroFilterBank::SetDerivateCutoff(double derivate_cutoff) {
+  if (derivate_cutoff <= kEpsilon) {
+    LOG(ERROR) << "derivate_cutoff should be > 0";
+    return;
+  }
+  derivate_cutoff_ = derivate_cutoff;
+}
+
+}  // namespace mediapipe
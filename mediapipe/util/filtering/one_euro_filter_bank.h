@@ -0,0 +1,69 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+
+namespace mediapipe {
+
+// A bank of `num_values` OneEuroFilters that are always applied together, with
+// the same timestamp, e.g. to one coordinate of every landmark of an object.
+//
+// Apply returns the same results as applying a separate OneEuroFilter to each
+// value, but keeps the low pass filter states of all filters in contiguous
+// arrays and filters all values in loops that the compiler vectorizes. The
+// sampling frequency, which the filters have in common, is only estimated
+// once.
+class OneEuroFilterBank {
+ public:
+  OneEuroFilterBank(int num_values, double frequency, double min_cutoff,
+                    double beta, double derivate_cutoff);
+
+  // Filters `values` in place. `values` must hold `num_values` values.
+  void Apply(absl::Duration timestamp, absl::Span<float> values);
+
+  int num_values() const { return num_values_; }
+
+ private:
+  double GetAlpha(double cutoff) const;
+
+  void SetFrequency(double frequency);
+
+  void SetMinCutoff(double min_cutoff);
+
+  void SetDerivateCutoff(double derivate_cutoff);
+
+  const int num_values_;
+  double frequency_ = 0.0;
+  double min_cutoff_ = 0.0;
+  double beta_ = 0.0;
+  double derivate_cutoff_ = 0.0;
+  int64_t last_time_ = 0;
+  bool initialized_ = false;
+
+  // Last raw and filtered values, and filtered derivatives of the values.
+  std::vector<float> raw_values_;
+  std::vector<float> filtered_values_;
+  std::vector<float> filtered_derivatives_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_ONE_EURO_FILTER_BANK_H_
@@ -0,0 +1,117 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/one_euro_filter_bank.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/one_euro_filter.h"
+
+namespace mediapipe {
+namespace {
+
+// Number of values filtered per frame for a face mesh: 3 coordinates of 468
+// landmarks.
+constexpr int kNumValues = 3 * 468;
+
+TEST(OneEuroFilterBankTest, SameAsFilters) {
+  constexpr int kNumValuesTested = 37;
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> values(-100.0f, 100.0f);
+  std::uniform_int_distribution<int> frame_gaps(0, 4);
+
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kNumValuesTested; ++i) {
+    filters.emplace_back(/*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  }
+  OneEuroFilterBank bank(kNumValuesTested, /*frequency=*/30.0,
+                         /*min_cutoff=*/0.05, /*beta=*/80.0,
+                         /*derivate_cutoff=*/1.0);
+
+  // Starts at timestamp 0, which is ignored like a repeated timestamp.
+  int64_t timestamp_ms = 0;
+  std::vector<float> bank_values(kNumValuesTested);
+  for (int frame = 0; frame < 200; ++frame) {
+    const absl::Duration timestamp = absl::Milliseconds(timestamp_ms);
+    for (float& value : bank_values) value = values(rng);
+
+    std::vector<float> expected(kNumValuesTested);
+    for (int i = 0; i < kNumValuesTested; ++i) {
+      expected[i] = filters[i].Apply(timestamp, bank_values[i]);
+    }
+    bank.Apply(timestamp, absl::MakeSpan(bank_values));
+    for (int i = 0; i < kNumValuesTested; ++i) {
+      ASSERT_EQ(bank_values[i], expected[i])
+          << "frame " << frame << " value " << i;
+    }
+
+    // Vary the frame rate, and sometimes repeat a timestamp.
+    const int gap = frame_gaps(rng);
+    timestamp_ms += gap == 0 && frame % 7 != 0 ? 0 : 33 * gap + 1;
+  }
+}
+
+std::vector<std::vector<float>> RandomFrames(int num_frames) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> distribution(0.0f, 1000.0f);
+  std::vector<std::vector<float>> frames(num_frames,
+                                         std::vector<float>(kNumValues));
+  for (auto& frame : frames) {
+    for (float& value : frame) value = distribution(rng);
+  }
+  return frames;
+}
+
+void BM_OneEuroFilters(benchmark::State& state) {
+  const auto frames = RandomFrames(64);
+  std::vector<OneEuroFilter> filters;
+  for (int i = 0; i < kNumValues; ++i) {
+    filters.emplace_back(/*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  }
+  int64_t timestamp_ms = 0;
+  for (auto _ : state) {
+    const auto& frame = frames[timestamp_ms % frames.size()];
+    const absl::Duration timestamp = absl::Milliseconds(++timestamp_ms * 33);
+    for (int i = 0; i < kNumValues; ++i) {
+      benchmark::DoNotOptimize(filters[i].Apply(timestamp, frame[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_OneEuroFilters);
+
+void BM_OneEuroFilterBank(benchmark::State& state) {
+  const auto frames = RandomFrames(64);
+  OneEuroFilterBank bank(kNumValues, /*frequency=*/30.0, /*min_cutoff=*/0.05,
+                         /*beta=*/80.0, /*derivate_cutoff=*/1.0);
+  std::vector<float> values(kNumValues);
+  int64_t timestamp_ms = 0;
+  for (auto _ : state) {
+    values = frames[timestamp_ms % frames.size()];
+    const absl::Duration timestamp = absl::Milliseconds(++timestamp_ms * 33);
+    bank.Apply(timestamp, absl::MakeSpan(values));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_OneEuroFilterBank);
+
+}  // namespace
+}  // namespace mediapipe
@@ -0,0 +1,130 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+RelativeVelocityFilterBank::RelativeVelocityFilterBank(
+    int num_values, int window_size, float velocity_scale,
+    DistanceEstimationMode distance_mode)
+    : num_values_(num_values),
+      window_size_(window_size),
+      velocity_scale_(velocity_scale),
+      distance_mode_(distance_mode),
+      last_values_(num_values),
+      filtered_values_(num_values),
+      window_distances_(static_cast<size_t>(window_size) * num_values, 0.0f),
+      window_durations_(window_size, 0),
+      distances_(num_values),
+      cumulative_distances_(num_values) {
+  CHECK_GE(num_values, 0);
+  CHECK_GE(window_size, 0);
+}
+
+void RelativeVelocityFilterBank::Apply(absl::Duration timestamp,
+                                       float value_scale,
+                                       absl::Span<float> values) {
+  CHECK_EQ(values.size(), num_values_);
+  const int64_t new_timestamp = absl::ToInt64Nanoseconds(timestamp);
+  if (last_timestamp_ >= new_timestamp) {
+    // Results are unpredictable in this case, so nothing to do but
+    // return same values
+    LOG(WARNING) << "New timestamp is equal or less than the last one.";
+    return;
+  }
+
+  const int n = num_values_;
+  float* value = values.data();
+  float* last_value = last_values_.data();
+  float* filtered_value = filtered_values_.data();
+
+  if (last_timestamp_ == -1) {
+    // The first values are returned as they are.
+    std::copy_n(value, n, last_value);
+    std::copy_n(value, n, filtered_value);
+  } else {
+    float* distance = distances_.data();
+    if (distance_mode_ == DistanceEstimationMode::kLegacyTransition) {
+      const float last_value_scale = last_value_scale_;
+      for (int i = 0; i < n; ++i) {
+        distance[i] =
+            value[i] * value_scale - last_value[i] * last_value_scale;
+      }
+    } else {
+      for (int i = 0; i < n; ++i) {
+        distance[i] = value_scale * (value[i] - last_value[i]);
+      }
+    }
+
+    // The window durations, and so the window elements that are summed, are
+    // the same for all values.
+    const int64_t duration = new_timestamp - last_timestamp_;
+    int64_t cumulative_duration = duration;
+    constexpr int64_t kAssumedMaxDuration = 1000000000 / 30;
+    const int64_t max_cumulative_duration =
+        (1 + window_size_) * kAssumedMaxDuration;
+    int num_summed = 0;
+    for (; num_summed < window_size_; ++num_summed) {
+      const int64_t element_duration = window_durations_[Slot(num_summed)];
+      if (cumulative_duration + element_duration > max_cumulative_duration) {
+        break;
+      }
+      cumulative_duration += element_duration;
+    }
+
+    // Sum the distances in the order RelativeVelocityFilter does, from the
+    // newest element to the oldest, so that the results are the same.
+    float* cumulative_distance = cumulative_distances_.data();
+    std::copy_n(distance, n, cumulative_distance);
+    for (int age = 0; age < num_summed; ++age) {
+      const float* element_distance =
+          &window_distances_[static_cast<size_t>(Slot(age)) * n];
+      for (int i = 0; i < n; ++i) {
+        cumulative_distance[i] += element_distance[i];
+      }
+    }
+
+    constexpr double kNanoSecondsToSecond = 1e-9;
+    const double cumulative_seconds =
+        cumulative_duration * kNanoSecondsToSecond;
+    const float velocity_scale = velocity_scale_;
+    for (int i = 0; i < n; ++i) {
+      const float velocity = cumulative_distance[i] / cumulative_seconds;
+      const float alpha =
+          1.0f - 1.0f / (1.0f + velocity_scale * std::abs(velocity));
+      filtered_value[i] = alpha * value[i] + (1.0 - alpha) * filtered_value[i];
+      last_value[i] = value[i];
+      value[i] = filtered_value[i];
+    }
+
+    // Push the new element, which replaces the oldest one.
+    if (window_size_ > 0) {
+      newest_slot_ = Slot(window_size_ - 1);
+      std::copy_n(distance, n,
+                  &window_distances_[static_cast<size_t>(newest_slot_) * n]);
+      window_durations_[newest_slot_] = duration;
+    }
+  }
+
+  last_value_scale_ = value_scale;
+  last_timestamp_ = new_timestamp;
+}
+
+}  // namespace mediapipe
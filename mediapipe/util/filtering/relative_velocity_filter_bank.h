@@ -0,0 +1,80 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+#define MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
+
+#include <cstdint>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "absl/types/span.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+
+// A bank of `num_values` RelativeVelocityFilters that are always applied
+// together, with the same timestamp and value scale, e.g. to one coordinate of
+// every landmark of an object.
+//
+// Apply returns the same results as applying a separate RelativeVelocityFilter
+// to each value, but keeps the state of all filters in contiguous arrays and
+// the window in a fixed-size ring, and filters all values in loops that the
+// compiler vectorizes. The timestamps, window durations and value scales the
+// filters have in common are only stored and processed once.
+class RelativeVelocityFilterBank {
+ public:
+  using DistanceEstimationMode = RelativeVelocityFilter::DistanceEstimationMode;
+
+  RelativeVelocityFilterBank(
+      int num_values, int window_size, float velocity_scale,
+      DistanceEstimationMode distance_mode = DistanceEstimationMode::kDefault);
+
+  // Filters `values` in place. `values` must hold `num_values` values.
+  // See RelativeVelocityFilter::Apply for the parameters.
+  void Apply(absl::Duration timestamp, float value_scale,
+             absl::Span<float> values);
+
+  int num_values() const { return num_values_; }
+
+ private:
+  // Returns the ring slot of the `age`-th newest window element.
+  int Slot(int age) const { return (newest_slot_ + age) % window_size_; }
+
+  const int num_values_;
+  const int window_size_;
+  const float velocity_scale_;
+  const DistanceEstimationMode distance_mode_;
+
+  float last_value_scale_ = 1.0f;
+  int64_t last_timestamp_ = -1;
+
+  // Per value state.
+  std::vector<float> last_values_;
+  std::vector<float> filtered_values_;
+  // Window distances, `num_values_` per slot, and window durations, which
+  // are the same for all values. Like the window of RelativeVelocityFilter,
+  // the ring starts full of zero elements.
+  std::vector<float> window_distances_;
+  std::vector<int64_t> window_durations_;
+  int newest_slot_ = 0;
+
+  // Scratch arrays of `num_values_` values.
+  std::vector<float> distances_;
+  std::vector<float> cumulative_distances_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_FILTERING_RELATIVE_VELOCITY_FILTER_BANK_H_
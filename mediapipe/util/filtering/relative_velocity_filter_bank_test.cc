@@ -0,0 +1,139 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/filtering/relative_velocity_filter_bank.h"
+
+#include <random>
+#include <vector>
+
+#include "absl/time/time.h"
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/util/filtering/relative_velocity_filter.h"
+
+namespace mediapipe {
+namespace {
+
+using DistanceEstimationMode =
+    mediapipe::RelativeVelocityFilter::DistanceEstimationMode;
+
+// Number of values filtered per frame for a face mesh: 3 coordinates of 468
+// landmarks.
+constexpr int kNumValues = 3 * 468;
+
+void ExpectSameAsFilters(int window_size, DistanceEstimationMode mode) {
+  constexpr int kNumValuesTested = 37;
+  std::mt19937 rng(window_size);
+  std::uniform_real_distribution<float> values(-100.0f, 100.0f);
+  std::uniform_real_distribution<float> scales(0.5f, 2.0f);
+  std::uniform_int_distribution<int> frame_gaps(0, 4);
+
+  std::vector<RelativeVelocityFilter> filters(
+      kNumValuesTested,
+      RelativeVelocityFilter(window_size, /*velocity_scale=*/10.0f, mode));
+  RelativeVelocityFilterBank bank(kNumValuesTested, window_size,
+                                  /*velocity_scale=*/10.0f, mode);
+
+  int64_t timestamp_ms = 0;
+  std::vector<float> bank_values(kNumValuesTested);
+  for (int frame = 0; frame < 200; ++frame) {
+    // Vary the frame rate, and sometimes repeat a timestamp, which is ignored.
+    const int gap = frame_gaps(rng);
+    timestamp_ms += gap == 0 && frame % 7 != 0 ? 0 : 33 * gap + 1;
+    const absl::Duration timestamp = absl::Milliseconds(timestamp_ms);
+    const float value_scale = scales(rng);
+    for (float& value : bank_values) value = values(rng);
+
+    std::vector<float> expected(kNumValuesTested);
+    for (int i = 0; i < kNumValuesTested; ++i) {
+      expected[i] = filters[i].Apply(timestamp, value_scale, bank_values[i]);
+    }
+    bank.Apply(timestamp, value_scale, absl::MakeSpan(bank_values));
+    for (int i = 0; i < kNumValuesTested; ++i) {
+      ASSERT_EQ(bank_values[i], expected[i])
+          << "frame " << frame << " value " << i;
+    }
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, SameAsFiltersLegacyTransition) {
+  for (int window_size : {0, 1, 5, 10}) {
+    ExpectSameAsFilters(window_size, DistanceEstimationMode::kLegacyTransition);
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, SameAsFiltersForceCurrentScale) {
+  for (int window_size : {0, 1, 5, 10}) {
+    ExpectSameAsFilters(window_size,
+                        DistanceEstimationMode::kForceCurrentScale);
+  }
+}
+
+TEST(RelativeVelocityFilterBankTest, IgnoresOutdatedTimestamps) {
+  RelativeVelocityFilterBank bank(2, /*window_size=*/5,
+                                  /*velocity_scale=*/1.0f);
+  std::vector<float> values = {1.0f, 2.0f};
+  bank.Apply(absl::Milliseconds(2), 1.0f, absl::MakeSpan(values));
+  EXPECT_EQ(values, std::vector<float>({1.0f, 2.0f}));
+  values = {10.0f, 20.0f};
+  bank.Apply(absl::Milliseconds(1), 1.0f, absl::MakeSpan(values));
+  EXPECT_EQ(values, std::vector<float>({10.0f, 20.0f}));
+}
+
+std::vector<std::vector<float>> RandomFrames(int num_frames) {
+  std::mt19937 rng(1);
+  std::uniform_real_distribution<float> distribution(0.0f, 1000.0f);
+  std::vector<std::vector<float>> frames(num_frames,
+                                         std::vector<float>(kNumValues));
+  for (auto& frame : frames) {
+    for (float& value : frame) value = distribution(rng);
+  }
+  return frames;
+}
+
+void BM_RelativeVelocityFilters(benchmark::State& state) {
+  const auto frames = RandomFrames(64);
+  std::vector<RelativeVelocityFilter> filters(
+      kNumValues, RelativeVelocityFilter(/*window_size=*/5,
+                                         /*velocity_scale=*/10.0f));
+  int64_t timestamp_ms = 0;
+  for (auto _ : state) {
+    const auto& frame = frames[timestamp_ms % frames.size()];
+    const absl::Duration timestamp = absl::Milliseconds(++timestamp_ms * 33);
+    for (int i = 0; i < kNumValues; ++i) {
+      benchmark::DoNotOptimize(filters[i].Apply(timestamp, 0.01f, frame[i]));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_RelativeVelocityFilters);
+
+void BM_RelativeVelocityFilterBank(benchmark::State& state) {
+  const auto frames = RandomFrames(64);
+  RelativeVelocityFilterBank bank(kNumValues, /*window_size=*/5,
+                                  /*velocity_scale=*/10.0f);
+  std::vector<float> values(kNumValues);
+  int64_t timestamp_ms = 0;
+  for (auto _ : state) {
+    values = frames[timestamp_ms % frames.size()];
+    const absl::Duration timestamp = absl::Milliseconds(++timestamp_ms * 33);
+    bank.Apply(timestamp, 0.01f, absl::MakeSpan(values));
+    benchmark::DoNotOptimize(values.data());
+  }
+  state.SetItemsProcessed(state.iterations() * kNumValues);
+}
+BENCHMARK(BM_RelativeVelocityFilterBank);
+
+}  // namespace
+}  // namespace mediapipe
@@ -14,20 +14,76 @@
 
 #include "mediapipe/util/tflite/tflite_model_loader.h"
 
+#include <sys/stat.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
 #include "mediapipe/framework/port/ret_check.h"
 #include "mediapipe/util/resource_util.h"
 
 namespace mediapipe {
 
+namespace {
+
+// Process-wide cache of the models loaded from files, keyed by path. Entries
+// only hold weak references: a model is unmapped once the last packet using
+// it is released, and a file whose modification time or size changed is
+// loaded again.
+class ModelCache {
+ public:
+  static ModelCache& GetInstance() {
+    static ModelCache* cache = new ModelCache();
+    return *cache;
+  }
+
+  absl::StatusOr<std::shared_ptr<tflite::FlatBufferModel>> Get(
+      const std::string& path) {
+    struct stat file_stat;
+    RET_CHECK_EQ(stat(path.c_str(), &file_stat), 0)
+        << "Failed to stat model file " << path;
+    const int64_t mtime = file_stat.st_mtime;
+    const int64_t size = file_stat.st_size;
+
+    absl::MutexLock lock(&mutex_);
+    auto& entry = entries_[path];
+    if (entry.mtime == mtime && entry.size == size) {
+      if (auto model = entry.model.lock()) return model;
+    }
+    // FlatBufferModel maps the file read-only where mmap is supported.
+    std::shared_ptr<tflite::FlatBufferModel> model =
+        tflite::FlatBufferModel::BuildFromFile(path.c_str());
+    RET_CHECK(model) << "Failed to load model from path " << path;
+    entry = {mtime, size, model};
+    return model;
+  }
+
+ private:
+  struct Entry {
+    int64_t mtime = -1;
+    int64_t size = -1;
+    std::weak_ptr<tflite::FlatBufferModel> model;
+  };
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, Entry> entries_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace
+
 absl::StatusOr<api2::Packet<TfLiteModelPtr>> TfLiteModelLoader::LoadFromPath(
     const std::string& path) {
   std::string model_path = path;
 
   ASSIGN_OR_RETURN(model_path, mediapipe::PathToResourceAsFile(model_path));
-  auto model = tflite::FlatBufferModel::BuildFromFile(model_path.c_str());
-  RET_CHECK(model) << "Failed to load model from path " << model_path;
+  ASSIGN_OR_RETURN(auto model, ModelCache::GetInstance().Get(model_path));
+  // The deleter keeps the shared model alive for as long as the packet.
+  tflite::FlatBufferModel* model_ptr = model.get();
   return api2::MakePacket<TfLiteModelPtr>(
-      model.release(), [](tflite::FlatBufferModel* model) { delete model; });
+      model_ptr, [model = std::move(model)](tflite::FlatBufferModel*) {});
 }
 
 }  // namespace mediapipe
@@ -30,6 +30,10 @@ class TfLiteModelLoader {
  public:
   // Returns a Packet containing a TfLiteModelPtr, pointing to a model loaded
   // from the specified file path.
+  //
+  // Models are shared process-wide: while any packet for a file is alive,
+  // loading the same path again (from any graph) returns the same read-only
+  // mapped model, unless the file's modification time or size changed.
   static absl::StatusOr<api2::Packet<TfLiteModelPtr>> LoadFromPath(
       const std::string& path);
 };
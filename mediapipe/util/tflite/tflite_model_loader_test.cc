@@ -0,0 +1,64 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tflite/tflite_model_loader.h"
+
+#include <utime.h>
+
+#include <cstdlib>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "mediapipe/framework/port/file_helpers.h"
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/status_matchers.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr char kModelPath[] = "mediapipe/calculators/tflite/testdata/add.bin";
+
+TEST(TfLiteModelLoaderTest, SharesModelWhileInUse) {
+  auto packet_or = TfLiteModelLoader::LoadFromPath(kModelPath);
+  MP_ASSERT_OK(packet_or);
+  const auto packet = packet_or.value();
+  auto other_packet_or = TfLiteModelLoader::LoadFromPath(kModelPath);
+  MP_ASSERT_OK(other_packet_or);
+  EXPECT_EQ(packet.Get().get(), other_packet_or.value().Get().get());
+}
+
+TEST(TfLiteModelLoaderTest, ReloadsChangedFile) {
+  std::string contents;
+  MP_ASSERT_OK(file::GetContents(kModelPath, &contents));
+  const std::string path =
+      absl::StrCat(std::getenv("TEST_TMPDIR"), "/reloaded_model.tflite");
+  MP_ASSERT_OK(file::SetContents(path, contents));
+  struct utimbuf times = {1000, 1000};
+  ASSERT_EQ(utime(path.c_str(), &times), 0);
+
+  auto first_or = TfLiteModelLoader::LoadFromPath(path);
+  MP_ASSERT_OK(first_or);
+  const auto first = first_or.value();
+
+  times = {2000, 2000};
+  ASSERT_EQ(utime(path.c_str(), &times), 0);
+  auto second_or = TfLiteModelLoader::LoadFromPath(path);
+  MP_ASSERT_OK(second_or);
+  EXPECT_NE(first.Get().get(), second_or.value().Get().get());
+  // The earlier model stays valid while its packet is alive.
+  EXPECT_TRUE(first.Get()->initialized());
+}
+
+}  // namespace
+}  // namespace mediapipe
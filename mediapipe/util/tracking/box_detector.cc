@@ -14,6 +14,8 @@
 
 #include "mediapipe/util/tracking/box_detector.h"
 
+#include <algorithm>
+#include <utility>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -22,6 +24,7 @@
 #include "mediapipe/framework/port/opencv_video_inc.h"
 #include "mediapipe/util/tracking/box_detector.pb.h"
 #include "mediapipe/util/tracking/box_tracker.h"
+#include "mediapipe/util/tracking/hamming_lsh_index.h"
 #include "mediapipe/util/tracking/measure_time.h"
 
 namespace mediapipe {
@@ -76,6 +79,39 @@ cv::Mat GetDescriptorsWithIndices(const cv::Mat &frame_descriptors,
   return mat;
 }
 
+// Converts binary `descriptors`, one byte per element, to a continuous CV_8U
+// matrix. Binary descriptors come as CV_8U matrices, e.g. from ORB, and are
+// stored in the index as CV_32F matrices with the byte values as elements.
+// Returns false for other descriptors, e.g. float descriptors like KNIFT,
+// which can't be compared under the Hamming distance.
+bool ToBinaryDescriptors(const cv::Mat &descriptors, cv::Mat *binary) {
+  if (descriptors.type() == CV_8U) {
+    *binary = descriptors;
+  } else if (descriptors.type() == CV_32F) {
+    descriptors.convertTo(*binary, CV_8U);
+    cv::Mat byte_values;
+    binary->convertTo(byte_values, CV_32F);
+    if (cv::norm(descriptors, byte_values, cv::NORM_INF) != 0) {
+      return false;
+    }
+  } else {
+    return false;
+  }
+  if (!binary->isContinuous()) {
+    *binary = binary->clone();
+  }
+  return true;
+}
+
+HammingLshIndex::Options GetLshIndexOptions(const BoxDetectorOptions &options) {
+  const auto &settings = options.lsh_index_settings();
+  HammingLshIndex::Options lsh_options;
+  lsh_options.num_tables = settings.num_tables();
+  lsh_options.key_bits = settings.key_bits();
+  lsh_options.probe_radius = settings.probe_radius();
+  return lsh_options;
+}
+
 }  // namespace
 
 // Using OpenCV brute force matcher along with cross validate match to conduct
@@ -92,10 +128,36 @@ class BoxDetectorOpencvBfImpl : public BoxDetectorInterface {
   cv::BFMatcher bf_matcher_;
 };
 
+// Using a locality sensitive hashing index over the binary descriptors of all
+// boxes. Each frame is queried once for all boxes, so the detection time
+// depends on the number of candidate matches instead of the index size.
+class BoxDetectorHammingLshImpl : public BoxDetectorInterface {
+ public:
+  explicit BoxDetectorHammingLshImpl(const BoxDetectorOptions &options);
+
+ private:
+  std::vector<FeatureCorrespondence> MatchFeatureDescriptors(
+      const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+      int box_idx) override;
+
+  void PrepareFeatureMatching(const cv::Mat &descriptors) override;
+
+  void OnBoxFeaturesAdded(int box_idx, int first_feature) override;
+
+  void OnBoxRemoved(int box_idx) override;
+
+  HammingLshIndex lsh_index_;
+  // Cross validated matches of the current frame for each box id, as pairs of
+  // frame feature index and box feature index.
+  absl::flat_hash_map<int, std::vector<std::pair<int, int>>> frame_matches_;
+};
+
 std::unique_ptr<BoxDetectorInterface> BoxDetectorInterface::Create(
     const BoxDetectorOptions &options) {
   if (options.index_type() == BoxDetectorOptions::OPENCV_BF) {
     return absl::make_unique<BoxDetectorOpencvBfImpl>(options);
+  } else if (options.index_type() == BoxDetectorOptions::HAMMING_LSH) {
+    return absl::make_unique<BoxDetectorHammingLshImpl>(options);
   } else {
     LOG(FATAL) << "index type undefined.";
   }
@@ -153,6 +215,10 @@ void BoxDetectorInterface::DetectAndAddBoxFromFeatures(
     }
   }
 
+  if (size_before_add > 0) {
+    PrepareFeatureMatching(descriptors);
+  }
+
   for (int idx = 0; idx < size_before_add; ++idx) {
     if ((options_.has_detect_every_n_frame() > 0 &&
          cnt_detect_called_ % options_.detect_every_n_frame() == 0) ||
@@ -574,6 +640,7 @@ void BoxDetectorInterface::AddBoxFeaturesToIndex(
 
     // Create a frame
     int frame_id = frame_box_[box_idx].size();
+    const int first_feature = feature_keypoints_[box_idx].size();
     frame_box_[box_idx].push_back(box);
 
     cv::Mat box_descriptors =
@@ -619,6 +686,8 @@ void BoxDetectorInterface::AddBoxFeaturesToIndex(
     for (int j = 0; j < insider_idx.size(); ++j) {
       feature_to_frame_[box_idx].push_back(frame_id);
     }
+
+    OnBoxFeaturesAdded(box_idx, first_feature);
   }
 }
 
@@ -630,6 +699,7 @@ void BoxDetectorInterface::CancelBoxDetection(int box_id) {
     return;
   } else {
     const int erase_idx = iter->second;
+    OnBoxRemoved(erase_idx);
     frame_box_.erase(frame_box_.begin() + erase_idx);
     feature_to_frame_.erase(feature_to_frame_.begin() + erase_idx);
     feature_keypoints_.erase(feature_keypoints_.begin() + erase_idx);
@@ -746,4 +816,124 @@ BoxDetectorOpencvBfImpl::MatchFeatureDescriptors(
   return correspondence_result;
 }
 
+BoxDetectorHammingLshImpl::BoxDetectorHammingLshImpl(
+    const BoxDetectorOptions &options)
+    : BoxDetectorInterface(options), lsh_index_(GetLshIndexOptions(options)) {}
+
+void BoxDetectorHammingLshImpl::OnBoxFeaturesAdded(int box_idx,
+                                                   int first_feature) {
+  const cv::Mat &box_descriptors = feature_descriptors_[box_idx];
+  if (first_feature >= box_descriptors.rows) return;
+
+  cv::Mat binary_descriptors;
+  if (!ToBinaryDescriptors(
+          box_descriptors.rowRange(first_feature, box_descriptors.rows),
+          &binary_descriptors)) {
+    LOG(ERROR) << "HAMMING_LSH index requires binary descriptors. Features of "
+               << "box " << box_idx_to_id_[box_idx] << " are not indexed.";
+    return;
+  }
+  lsh_index_.Insert(box_idx_to_id_[box_idx], binary_descriptors.ptr<uint8>(0),
+                    binary_descriptors.rows, binary_descriptors.cols);
+}
+
+void BoxDetectorHammingLshImpl::OnBoxRemoved(int box_idx) {
+  lsh_index_.Remove(box_idx_to_id_[box_idx]);
+}
+
+void BoxDetectorHammingLshImpl::PrepareFeatureMatching(
+    const cv::Mat &descriptors) {
+  frame_matches_.clear();
+  if (descriptors.rows == 0 || lsh_index_.size() == 0) return;
+
+  cv::Mat binary_descriptors;
+  if (!ToBinaryDescriptors(descriptors, &binary_descriptors)) {
+    LOG(ERROR) << "HAMMING_LSH index requires binary descriptors. Detection "
+               << "skipped.";
+    return;
+  }
+  if (binary_descriptors.cols != lsh_index_.descriptor_bytes()) {
+    LOG(ERROR) << "Descriptor size " << binary_descriptors.cols
+               << " doesn't match index descriptor size "
+               << lsh_index_.descriptor_bytes() << ".";
+    return;
+  }
+
+  // Closest candidate for each (frame feature, box id) pair and for each
+  // (box id, box feature) pair, to cross validate matches as the OpenCV brute
+  // force matcher does within each box.
+  struct BestMatch {
+    int feature;
+    int distance;
+  };
+  absl::flat_hash_map<std::pair<int, int>, BestMatch> best_in_box;
+  absl::flat_hash_map<std::pair<int, int>, BestMatch> best_in_frame;
+  const int max_distance = options_.lsh_index_settings().max_hamming_distance();
+  std::vector<HammingLshIndex::Match> matches;
+  for (int j = 0; j < binary_descriptors.rows; ++j) {
+    matches.clear();
+    lsh_index_.Search(binary_descriptors.ptr<uint8>(j), max_distance,
+                      &matches);
+    for (const auto &match : matches) {
+      BestMatch &box_match =
+          best_in_box
+              .try_emplace(std::make_pair(j, match.group_id),
+                           BestMatch{match.index, match.distance})
+              .first->second;
+      if (match.distance < box_match.distance) {
+        box_match = {match.index, match.distance};
+      }
+      BestMatch &frame_match =
+          best_in_frame
+              .try_emplace(std::make_pair(match.group_id, match.index),
+                           BestMatch{j, match.distance})
+              .first->second;
+      if (match.distance < frame_match.distance) {
+        frame_match = {j, match.distance};
+      }
+    }
+  }
+
+  for (const auto &entry : best_in_box) {
+    const int frame_feature = entry.first.first;
+    const int box_id = entry.first.second;
+    const int box_feature = entry.second.feature;
+    if (best_in_frame.at(std::make_pair(box_id, box_feature)).feature ==
+        frame_feature) {
+      frame_matches_[box_id].emplace_back(frame_feature, box_feature);
+    }
+  }
+  // Keep the correspondences in frame feature order, independent of the hash
+  // map iteration order.
+  for (auto &entry : frame_matches_) {
+    std::sort(entry.second.begin(), entry.second.end());
+  }
+}
+
+std::vector<FeatureCorrespondence>
+BoxDetectorHammingLshImpl::MatchFeatureDescriptors(
+    const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
+    int box_idx) {
+  CHECK_EQ(features.size(), descriptors.rows);
+
+  std::vector<FeatureCorrespondence> correspondence_result(
+      frame_box_[box_idx].size());
+  const auto iter = frame_matches_.find(box_idx_to_id_[box_idx]);
+  if (iter == frame_matches_.end()) {
+    return correspondence_result;
+  }
+
+  for (const auto &match : iter->second) {
+    const Vector2_f &frame_point = features[match.first];
+    const Vector2_f &index_point = feature_keypoints_[box_idx][match.second];
+    int match_idx = feature_to_frame_[box_idx][match.second];
+    correspondence_result[match_idx].points_frame.push_back(
+        cv::Point2f(frame_point.x(), frame_point.y()));
+    correspondence_result[match_idx].points_index.push_back(
+        cv::Point2f(index_point.x(), index_point.y()));
+  }
+
+  return correspondence_result;
+}
+
 }  // namespace mediapipe
@@ -136,6 +136,18 @@ class BoxDetectorInterface {
       const std::vector<Vector2_f> &features, const cv::Mat &descriptors,
       int box_idx) = 0;
 
+  // Called once per frame with the frame's `descriptors`, before
+  // MatchFeatureDescriptors is called for the boxes to detect. Lets an index
+  // query all boxes at once instead of box by box.
+  virtual void PrepareFeatureMatching(const cv::Mat &descriptors) {}
+
+  // Called after features starting at `first_feature` were appended to the
+  // box with `box_idx`, so that an index can insert them incrementally.
+  virtual void OnBoxFeaturesAdded(int box_idx, int first_feature) {}
+
+  // Called before the box with `box_idx` is removed from the index.
+  virtual void OnBoxRemoved(int box_idx) {}
+
   // Specifies which box the correspondences come from with `box_id`, so that we
   // can figure out the transformation accordingly.
   TimedBoxProtoList FindBoxesFromFeatureCorrespondence(
@@ -0,0 +1,223 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/box_detector.h"
+
+#include <memory>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/gtest.h"
+#include "mediapipe/framework/port/opencv_core_inc.h"
+#include "mediapipe/framework/port/opencv_imgproc_inc.h"
+#include "mediapipe/util/tracking/box_detector.pb.h"
+
+namespace mediapipe {
+namespace {
+
+constexpr int kBoxId = 1;
+constexpr int kGridSize = 20;
+constexpr int kDescriptorBytes = 32;
+
+// Features on a regular grid over the unit square, moved by (dx, dy).
+std::vector<Vector2_f> GridFeatures(float dx, float dy) {
+  std::vector<Vector2_f> features;
+  for (int y = 0; y < kGridSize; ++y) {
+    for (int x = 0; x < kGridSize; ++x) {
+      features.emplace_back((x + 0.5f) / kGridSize + dx,
+                            (y + 0.5f) / kGridSize + dy);
+    }
+  }
+  return features;
+}
+
+// Random binary descriptors, one per grid feature.
+cv::Mat BinaryDescriptors() {
+  std::mt19937 random(1234);
+  std::uniform_int_distribution<int> byte_dist(0, 255);
+  cv::Mat descriptors(kGridSize * kGridSize, kDescriptorBytes, CV_8U);
+  for (int j = 0; j < descriptors.rows; ++j) {
+    for (int i = 0; i < descriptors.cols; ++i) {
+      descriptors.at<uint8>(j, i) = byte_dist(random);
+    }
+  }
+  return descriptors;
+}
+
+// Random float descriptors in [0, 1), as KNIFT gives.
+cv::Mat FloatDescriptors() {
+  std::mt19937 random(1234);
+  std::uniform_real_distribution<float> value_dist(0.0f, 1.0f);
+  cv::Mat descriptors(kGridSize * kGridSize, 40, CV_32F);
+  for (int j = 0; j < descriptors.rows; ++j) {
+    for (int i = 0; i < descriptors.cols; ++i) {
+      descriptors.at<float>(j, i) = value_dist(random);
+    }
+  }
+  return descriptors;
+}
+
+TimedBoxProtoList ReacquisitionBox() {
+  TimedBoxProtoList boxes;
+  TimedBoxProto *box = boxes.add_box();
+  box->set_id(kBoxId);
+  box->set_left(0.2f);
+  box->set_top(0.2f);
+  box->set_right(0.6f);
+  box->set_bottom(0.6f);
+  box->set_reacquisition(true);
+  return boxes;
+}
+
+BoxDetectorOptions Options(BoxDetectorOptions::IndexType index_type) {
+  BoxDetectorOptions options;
+  options.set_index_type(index_type);
+  return options;
+}
+
+// Adds the box to the index from a frame at timestamp 0.
+void AddBox(const cv::Mat &descriptors, BoxDetectorInterface *detector) {
+  TimedBoxProtoList detected;
+  detector->DetectAndAddBoxFromFeatures(
+      GridFeatures(0.0f, 0.0f), descriptors, ReacquisitionBox(),
+      /*timestamp_msec=*/0, /*scale_x=*/1.0f, /*scale_y=*/1.0f, &detected);
+  EXPECT_EQ(detected.box_size(), 0);
+}
+
+// Returns the boxes detected in a frame at timestamp 100, in which the features
+// moved by (0.1, 0.05) and the box is not tracked.
+TimedBoxProtoList DetectMovedBox(const cv::Mat &descriptors,
+                                 BoxDetectorInterface *detector) {
+  TimedBoxProtoList detected;
+  detector->DetectAndAddBoxFromFeatures(
+      GridFeatures(0.1f, 0.05f), descriptors, TimedBoxProtoList(),
+      /*timestamp_msec=*/100, /*scale_x=*/1.0f, /*scale_y=*/1.0f, &detected);
+  return detected;
+}
+
+void ExpectMovedBox(const TimedBoxProtoList &detected) {
+  ASSERT_EQ(detected.box_size(), 1);
+  const TimedBoxProto &box = detected.box(0);
+  EXPECT_EQ(box.id(), kBoxId);
+  EXPECT_EQ(box.time_msec(), 100);
+  EXPECT_NEAR(box.left(), 0.3f, 1e-3f);
+  EXPECT_NEAR(box.top(), 0.25f, 1e-3f);
+  EXPECT_NEAR(box.right(), 0.7f, 1e-3f);
+  EXPECT_NEAR(box.bottom(), 0.65f, 1e-3f);
+}
+
+TEST(BoxDetectorTest, HammingLshDetectsMovedBox) {
+  const cv::Mat descriptors = BinaryDescriptors();
+  auto detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  AddBox(descriptors, detector.get());
+  ExpectMovedBox(DetectMovedBox(descriptors, detector.get()));
+}
+
+TEST(BoxDetectorTest, HammingLshMatchesBruteForce) {
+  // The brute force matcher needs the frame descriptors in the CV_32F type of
+  // the indexed ones. The Hamming LSH index takes them as long as they hold
+  // byte values.
+  cv::Mat descriptors;
+  BinaryDescriptors().convertTo(descriptors, CV_32F);
+  auto lsh_detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  auto bf_detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::OPENCV_BF));
+  AddBox(descriptors, lsh_detector.get());
+  AddBox(descriptors, bf_detector.get());
+  const TimedBoxProtoList lsh_detected =
+      DetectMovedBox(descriptors, lsh_detector.get());
+  const TimedBoxProtoList bf_detected =
+      DetectMovedBox(descriptors, bf_detector.get());
+  ASSERT_EQ(lsh_detected.box_size(), 1);
+  ASSERT_EQ(bf_detected.box_size(), 1);
+  EXPECT_NEAR(lsh_detected.box(0).left(), bf_detected.box(0).left(), 1e-5f);
+  EXPECT_NEAR(lsh_detected.box(0).top(), bf_detected.box(0).top(), 1e-5f);
+  EXPECT_NEAR(lsh_detected.box(0).right(), bf_detected.box(0).right(), 1e-5f);
+  EXPECT_NEAR(lsh_detected.box(0).bottom(), bf_detected.box(0).bottom(),
+              1e-5f);
+}
+
+TEST(BoxDetectorTest, HammingLshRejectsFloatDescriptors) {
+  const cv::Mat descriptors = FloatDescriptors();
+  auto lsh_detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  AddBox(descriptors, lsh_detector.get());
+  EXPECT_EQ(DetectMovedBox(descriptors, lsh_detector.get()).box_size(), 0);
+
+  // The brute force matcher compares float descriptors under L2.
+  auto bf_detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::OPENCV_BF));
+  AddBox(descriptors, bf_detector.get());
+  ExpectMovedBox(DetectMovedBox(descriptors, bf_detector.get()));
+}
+
+TEST(BoxDetectorTest, HammingLshCancelBoxDetection) {
+  const cv::Mat descriptors = BinaryDescriptors();
+  auto detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  AddBox(descriptors, detector.get());
+  detector->CancelBoxDetection(kBoxId);
+  EXPECT_EQ(detector->ObtainBoxDetectorIndex().box_entry_size(), 0);
+  EXPECT_EQ(DetectMovedBox(descriptors, detector.get()).box_size(), 0);
+
+  // The box can be added again after it was cancelled.
+  AddBox(descriptors, detector.get());
+  ExpectMovedBox(DetectMovedBox(descriptors, detector.get()));
+}
+
+TEST(BoxDetectorTest, HammingLshIndexRoundTrip) {
+  const cv::Mat descriptors = BinaryDescriptors();
+  auto detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  AddBox(descriptors, detector.get());
+  const BoxDetectorIndex index = detector->ObtainBoxDetectorIndex();
+  ASSERT_EQ(index.box_entry_size(), 1);
+
+  auto restored_detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+  restored_detector->AddBoxDetectorIndex(index);
+  EXPECT_EQ(restored_detector->ObtainBoxDetectorIndex().SerializeAsString(),
+            index.SerializeAsString());
+  ExpectMovedBox(DetectMovedBox(descriptors, restored_detector.get()));
+}
+
+// Detects a box in an image from its ORB features, which are binary.
+TEST(BoxDetectorTest, HammingLshDetectsBoxInImage) {
+  cv::Mat image(480, 640, CV_8UC1);
+  cv::randu(image, 0, 255);
+  cv::GaussianBlur(image, image, cv::Size(5, 5), 0);
+  auto detector =
+      BoxDetectorInterface::Create(Options(BoxDetectorOptions::HAMMING_LSH));
+
+  TimedBoxProtoList detected;
+  detector->DetectAndAddBox(image, ReacquisitionBox(), /*timestamp_msec=*/0,
+                            &detected);
+  EXPECT_EQ(detected.box_size(), 0);
+  ASSERT_EQ(detector->ObtainBoxDetectorIndex().box_entry_size(), 1);
+
+  // The box is no longer tracked, so it is detected in the next image.
+  detector->DetectAndAddBox(image, TimedBoxProtoList(), /*timestamp_msec=*/100,
+                            &detected);
+  ASSERT_EQ(detected.box_size(), 1);
+  EXPECT_EQ(detected.box(0).id(), kBoxId);
+  EXPECT_NEAR(detected.box(0).left(), 0.2f, 0.01f);
+  EXPECT_NEAR(detected.box(0).top(), 0.2f, 0.01f);
+  EXPECT_NEAR(detected.box(0).right(), 0.6f, 0.01f);
+  EXPECT_NEAR(detected.box(0).bottom(), 0.6f, 0.01f);
+}
+
+}  // namespace
+}  // namespace mediapipe
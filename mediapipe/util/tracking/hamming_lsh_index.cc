@@ -0,0 +1,194 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/hamming_lsh_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <random>
+
+#include "absl/container/flat_hash_set.h"
+#include "mediapipe/framework/port/logging.h"
+
+namespace mediapipe {
+
+namespace {
+
+int CountOnes(uint64 n) {
+#if defined(__GNUC__)
+  return __builtin_popcountll(n);
+#else
+  n -= (n >> 1) & 0x5555555555555555ULL;
+  n = (n & 0x3333333333333333ULL) + ((n >> 2) & 0x3333333333333333ULL);
+  n = (n + (n >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+  return static_cast<int>((n * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+}  // namespace
+
+HammingLshIndex::HammingLshIndex(const Options& options)
+    : options_(options), tables_(options.num_tables) {
+  CHECK_GT(options_.num_tables, 0);
+  CHECK_GT(options_.key_bits, 0);
+  CHECK_LE(options_.key_bits, 32);
+  CHECK_GE(options_.probe_radius, 0);
+  CHECK_LE(options_.probe_radius, 1);
+}
+
+int HammingLshIndex::HammingDistance(const uint8* a, const uint8* b,
+                                     int num_bytes) {
+  int distance = 0;
+  int i = 0;
+  for (; i + 8 <= num_bytes; i += 8) {
+    uint64 word_a, word_b;
+    memcpy(&word_a, a + i, sizeof(word_a));
+    memcpy(&word_b, b + i, sizeof(word_b));
+    distance += CountOnes(word_a ^ word_b);
+  }
+  for (; i < num_bytes; ++i) {
+    distance += CountOnes(a[i] ^ b[i]);
+  }
+  return distance;
+}
+
+void HammingLshIndex::InitializeKeyBits(int descriptor_bytes) {
+  descriptor_bytes_ = descriptor_bytes;
+  const int num_bits = descriptor_bytes * 8;
+  const int key_bits = std::min(options_.key_bits, num_bits);
+  std::mt19937 random(options_.seed);
+  std::vector<int> positions(num_bits);
+  key_bit_positions_.clear();
+  for (int t = 0; t < options_.num_tables; ++t) {
+    // Partial Fisher-Yates shuffle, so that the key bits of a table differ.
+    std::iota(positions.begin(), positions.end(), 0);
+    for (int k = 0; k < key_bits; ++k) {
+      std::uniform_int_distribution<int> distribution(k, num_bits - 1);
+      std::swap(positions[k], positions[distribution(random)]);
+      key_bit_positions_.push_back(positions[k]);
+    }
+  }
+}
+
+uint32 HammingLshIndex::ComputeKey(int table_idx,
+                                   const uint8* descriptor) const {
+  const int key_bits = key_bit_positions_.size() / options_.num_tables;
+  const int* positions = &key_bit_positions_[table_idx * key_bits];
+  uint32 key = 0;
+  for (int k = 0; k < key_bits; ++k) {
+    const int position = positions[k];
+    const uint32 bit = (descriptor[position >> 3] >> (position & 7)) & 1;
+    key |= bit << k;
+  }
+  return key;
+}
+
+void HammingLshIndex::Insert(int group_id, const uint8* descriptors,
+                             int num_descriptors, int descriptor_bytes) {
+  CHECK_GT(descriptor_bytes, 0);
+  if (num_descriptors <= 0) {
+    return;
+  }
+  if (descriptor_bytes_ == 0) {
+    InitializeKeyBits(descriptor_bytes);
+  }
+  CHECK_EQ(descriptor_bytes, descriptor_bytes_)
+      << "All descriptors in the index must have the same size.";
+
+  std::vector<uint8>& group = group_descriptors_[group_id];
+  const int first_index = group.size() / descriptor_bytes_;
+  group.insert(group.end(), descriptors,
+               descriptors + num_descriptors * descriptor_bytes_);
+  for (int j = 0; j < num_descriptors; ++j) {
+    const uint8* descriptor = descriptors + j * descriptor_bytes_;
+    for (int t = 0; t < options_.num_tables; ++t) {
+      tables_[t][ComputeKey(t, descriptor)].push_back(
+          {group_id, first_index + j});
+    }
+  }
+  size_ += num_descriptors;
+}
+
+void HammingLshIndex::Remove(int group_id) {
+  auto group_iter = group_descriptors_.find(group_id);
+  if (group_iter == group_descriptors_.end()) {
+    return;
+  }
+  const std::vector<uint8>& group = group_iter->second;
+  const int num_descriptors = group.size() / descriptor_bytes_;
+  for (int j = 0; j < num_descriptors; ++j) {
+    const uint8* descriptor = &group[j * descriptor_bytes_];
+    for (int t = 0; t < options_.num_tables; ++t) {
+      auto bucket_iter = tables_[t].find(ComputeKey(t, descriptor));
+      if (bucket_iter == tables_[t].end()) {
+        // Already emptied by a previous descriptor of the group.
+        continue;
+      }
+      std::vector<Entry>& bucket = bucket_iter->second;
+      bucket.erase(std::remove_if(bucket.begin(), bucket.end(),
+                                  [group_id](const Entry& entry) {
+                                    return entry.group_id == group_id;
+                                  }),
+                   bucket.end());
+      if (bucket.empty()) {
+        tables_[t].erase(bucket_iter);
+      }
+    }
+  }
+  size_ -= num_descriptors;
+  group_descriptors_.erase(group_iter);
+}
+
+void HammingLshIndex::Search(const uint8* descriptor, int max_distance,
+                             std::vector<Match>* matches) const {
+  if (size_ == 0) {
+    return;
+  }
+  const int key_bits = key_bit_positions_.size() / options_.num_tables;
+  absl::flat_hash_set<uint64> visited;
+  auto probe = [&](int table_idx, uint32 key) {
+    auto bucket_iter = tables_[table_idx].find(key);
+    if (bucket_iter == tables_[table_idx].end()) {
+      return;
+    }
+    for (const Entry& entry : bucket_iter->second) {
+      const uint64 entry_key =
+          (static_cast<uint64>(static_cast<uint32>(entry.group_id)) << 32) |
+          static_cast<uint32>(entry.index);
+      if (!visited.insert(entry_key).second) {
+        continue;
+      }
+      const std::vector<uint8>& group = group_descriptors_.at(entry.group_id);
+      const int distance =
+          HammingDistance(descriptor, &group[entry.index * descriptor_bytes_],
+                          descriptor_bytes_);
+      if (distance <= max_distance) {
+        matches->push_back({entry.group_id, entry.index, distance});
+      }
+    }
+  };
+
+  for (int t = 0; t < options_.num_tables; ++t) {
+    const uint32 key = ComputeKey(t, descriptor);
+    probe(t, key);
+    if (options_.probe_radius > 0) {
+      for (int k = 0; k < key_bits; ++k) {
+        probe(t, key ^ (1u << k));
+      }
+    }
+  }
+}
+
+}  // namespace mediapipe
@@ -0,0 +1,117 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef MEDIAPIPE_UTIL_TRACKING_HAMMING_LSH_INDEX_H_
+#define MEDIAPIPE_UTIL_TRACKING_HAMMING_LSH_INDEX_H_
+
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "mediapipe/framework/port/integral_types.h"
+
+namespace mediapipe {
+
+// Approximate nearest neighbor index for binary feature descriptors (e.g.
+// ORB) under the Hamming distance, using bit sampling locality sensitive
+// hashing.
+//
+// Each of `num_tables` hash tables keys a descriptor by `key_bits` of its
+// bits, sampled at fixed pseudo-random positions. A query only compares
+// descriptors that share a key with it in some table, so its cost depends on
+// the bucket sizes rather than on the number of indexed descriptors. With
+// `probe_radius` 1, buckets whose key differs from the query key by one bit
+// are probed too, which raises recall for the same number of tables.
+//
+// Descriptors are grouped by an integer group id (the box id for the box
+// detector) and numbered within their group in insertion order. Groups can be
+// removed as a whole. The bit positions only depend on the options and on the
+// descriptor size, so an index rebuilt from the same descriptors returns the
+// same results.
+//
+// The class is not thread-safe.
+class HammingLshIndex {
+ public:
+  struct Options {
+    // Number of hash tables.
+    int num_tables = 8;
+    // Number of descriptor bits used as key in each table, at most 32.
+    int key_bits = 16;
+    // Whether to also probe keys at Hamming distance 1 from the query key.
+    int probe_radius = 1;
+    // Seed used to sample the key bit positions.
+    uint32 seed = 0x9e3779b9;
+  };
+
+  // Descriptor found by Search.
+  struct Match {
+    int group_id;
+    // Position of the descriptor within its group.
+    int index;
+    // Hamming distance to the query descriptor.
+    int distance;
+  };
+
+  explicit HammingLshIndex(const Options& options);
+
+  // Adds `num_descriptors` descriptors stored consecutively at `descriptors`
+  // to the group `group_id`, after any descriptors already in the group. All
+  // descriptors in the index must have the same size, `descriptor_bytes`.
+  void Insert(int group_id, const uint8* descriptors, int num_descriptors,
+              int descriptor_bytes);
+
+  // Removes all descriptors of the group `group_id`.
+  void Remove(int group_id);
+
+  // Appends to `matches` the indexed descriptors found within
+  // `max_distance` bits of `descriptor`, in no particular order. Descriptors
+  // not sharing a probed key with `descriptor` are not found.
+  void Search(const uint8* descriptor, int max_distance,
+              std::vector<Match>* matches) const;
+
+  // Returns the number of descriptors in the index.
+  int size() const { return size_; }
+
+  // Returns the number of bytes per descriptor, or 0 while the index has
+  // never held a descriptor.
+  int descriptor_bytes() const { return descriptor_bytes_; }
+
+  // Returns the Hamming distance between two descriptors of `num_bytes` bytes.
+  static int HammingDistance(const uint8* a, const uint8* b, int num_bytes);
+
+ private:
+  struct Entry {
+    int group_id;
+    int index;
+  };
+  using Table = absl::flat_hash_map<uint32, std::vector<Entry>>;
+
+  // Samples the key bit positions for descriptors of `descriptor_bytes`.
+  void InitializeKeyBits(int descriptor_bytes);
+
+  // Returns the key of `descriptor` in the table `table_idx`.
+  uint32 ComputeKey(int table_idx, const uint8* descriptor) const;
+
+  const Options options_;
+  int descriptor_bytes_ = 0;
+  int size_ = 0;
+  // Sampled bit positions, `key_bits` per table.
+  std::vector<int> key_bit_positions_;
+  std::vector<Table> tables_;
+  // Descriptors of each group, stored consecutively.
+  absl::flat_hash_map<int, std::vector<uint8>> group_descriptors_;
+};
+
+}  // namespace mediapipe
+
+#endif  // MEDIAPIPE_UTIL_TRACKING_HAMMING_LSH_INDEX_H_
@@ -0,0 +1,254 @@
+// Copyright 2021 The MediaPipe Authors.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "mediapipe/util/tracking/hamming_lsh_index.h"
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "mediapipe/framework/port/benchmark.h"
+#include "mediapipe/framework/port/gtest.h"
+
+namespace mediapipe {
+namespace {
+
+// Size of an ORB descriptor.
+constexpr int kDescriptorBytes = 32;
+
+std::vector<uint8> RandomDescriptors(int num_descriptors, std::mt19937* rng) {
+  std::uniform_int_distribution<int> distribution(0, 255);
+  std::vector<uint8> descriptors(num_descriptors * kDescriptorBytes);
+  for (uint8& byte : descriptors) {
+    byte = distribution(*rng);
+  }
+  return descriptors;
+}
+
+// Returns a copy of `descriptor` with `num_bits` distinct bits flipped.
+std::vector<uint8> FlipBits(const uint8* descriptor, int num_bits,
+                            std::mt19937* rng) {
+  std::vector<uint8> result(descriptor, descriptor + kDescriptorBytes);
+  std::vector<int> positions(kDescriptorBytes * 8);
+  for (int i = 0; i < positions.size(); ++i) positions[i] = i;
+  std::shuffle(positions.begin(), positions.end(), *rng);
+  for (int i = 0; i < num_bits; ++i) {
+    result[positions[i] >> 3] ^= 1 << (positions[i] & 7);
+  }
+  return result;
+}
+
+bool ContainsMatch(const std::vector<HammingLshIndex::Match>& matches,
+                   int group_id, int index) {
+  for (const auto& match : matches) {
+    if (match.group_id == group_id && match.index == index) return true;
+  }
+  return false;
+}
+
+TEST(HammingLshIndexTest, HammingDistance) {
+  std::vector<uint8> a(13, 0);
+  std::vector<uint8> b(13, 0);
+  EXPECT_EQ(HammingLshIndex::HammingDistance(a.data(), b.data(), 13), 0);
+  b[0] = 0xff;
+  b[12] = 0x81;
+  EXPECT_EQ(HammingLshIndex::HammingDistance(a.data(), b.data(), 13), 10);
+}
+
+TEST(HammingLshIndexTest, FindsIndexedDescriptors) {
+  std::mt19937 rng(1);
+  HammingLshIndex index({});
+  std::vector<uint8> group_0 = RandomDescriptors(50, &rng);
+  std::vector<uint8> group_1 = RandomDescriptors(30, &rng);
+  index.Insert(10, group_0.data(), 20, kDescriptorBytes);
+  index.Insert(11, group_1.data(), 30, kDescriptorBytes);
+  // Appending to a group continues its numbering.
+  index.Insert(10, &group_0[20 * kDescriptorBytes], 30, kDescriptorBytes);
+  EXPECT_EQ(index.size(), 80);
+  EXPECT_EQ(index.descriptor_bytes(), kDescriptorBytes);
+
+  for (int j = 0; j < 50; ++j) {
+    std::vector<HammingLshIndex::Match> matches;
+    index.Search(&group_0[j * kDescriptorBytes], 0, &matches);
+    ASSERT_EQ(matches.size(), 1);
+    EXPECT_EQ(matches[0].group_id, 10);
+    EXPECT_EQ(matches[0].index, j);
+    EXPECT_EQ(matches[0].distance, 0);
+  }
+}
+
+TEST(HammingLshIndexTest, FindsNearNeighbors) {
+  std::mt19937 rng(2);
+  HammingLshIndex index({});
+  const int kNumDescriptors = 1000;
+  std::vector<uint8> descriptors = RandomDescriptors(kNumDescriptors, &rng);
+  index.Insert(0, descriptors.data(), kNumDescriptors, kDescriptorBytes);
+
+  int num_found = 0;
+  for (int j = 0; j < kNumDescriptors; ++j) {
+    std::vector<uint8> query =
+        FlipBits(&descriptors[j * kDescriptorBytes], 16, &rng);
+    std::vector<HammingLshIndex::Match> matches;
+    index.Search(query.data(), 32, &matches);
+    if (ContainsMatch(matches, 0, j)) ++num_found;
+    for (const auto& match : matches) {
+      EXPECT_LE(match.distance, 32);
+    }
+  }
+  // Each of the 8 tables keys on 16 of the 256 bits and tolerates one flipped
+  // key bit, so a neighbor 16 bits away is missed with probability < 1e-4.
+  EXPECT_GE(num_found, kNumDescriptors * 99 / 100);
+}
+
+TEST(HammingLshIndexTest, RemovesGroups) {
+  std::mt19937 rng(3);
+  HammingLshIndex index({});
+  std::vector<uint8> descriptors = RandomDescriptors(40, &rng);
+  index.Insert(1, descriptors.data(), 20, kDescriptorBytes);
+  index.Insert(2, &descriptors[20 * kDescriptorBytes], 20, kDescriptorBytes);
+  index.Remove(1);
+  index.Remove(3);
+  EXPECT_EQ(index.size(), 20);
+
+  for (int j = 0; j < 40; ++j) {
+    std::vector<HammingLshIndex::Match> matches;
+    index.Search(&descriptors[j * kDescriptorBytes], 0, &matches);
+    if (j < 20) {
+      EXPECT_TRUE(matches.empty());
+    } else {
+      EXPECT_TRUE(ContainsMatch(matches, 2, j - 20));
+    }
+  }
+
+  // A removed group can be added again and is numbered from zero.
+  index.Insert(1, descriptors.data(), 20, kDescriptorBytes);
+  std::vector<HammingLshIndex::Match> matches;
+  index.Search(&descriptors[5 * kDescriptorBytes], 0, &matches);
+  EXPECT_TRUE(ContainsMatch(matches, 1, 5));
+}
+
+TEST(HammingLshIndexTest, RebuiltIndexReturnsSameMatches) {
+  std::mt19937 rng(4);
+  std::vector<uint8> descriptors = RandomDescriptors(500, &rng);
+  HammingLshIndex index_a({});
+  HammingLshIndex index_b({});
+  index_a.Insert(0, descriptors.data(), 500, kDescriptorBytes);
+  for (int j = 0; j < 500; j += 100) {
+    index_b.Insert(0, &descriptors[j * kDescriptorBytes], 100,
+                   kDescriptorBytes);
+  }
+  for (int j = 0; j < 100; ++j) {
+    std::vector<uint8> query = RandomDescriptors(1, &rng);
+    std::vector<HammingLshIndex::Match> matches_a, matches_b;
+    index_a.Search(query.data(), 100, &matches_a);
+    index_b.Search(query.data(), 100, &matches_b);
+    ASSERT_EQ(matches_a.size(), matches_b.size());
+    for (const auto& match : matches_a) {
+      EXPECT_TRUE(ContainsMatch(matches_b, match.group_id, match.index));
+    }
+  }
+}
+
+HammingLshIndex::Options OptionsWithKeyBits(int key_bits) {
+  HammingLshIndex::Options options;
+  options.key_bits = key_bits;
+  return options;
+}
+
+// Index of `num_boxes` boxes with 100 descriptors each, queried with noisy
+// copies of indexed descriptors, as when a target is detected again.
+struct BenchmarkData {
+  BenchmarkData(int num_boxes, int num_queries, int key_bits)
+      : index(OptionsWithKeyBits(key_bits)) {
+    std::mt19937 rng(5);
+    const int num_descriptors = num_boxes * kDescriptorsPerBox;
+    descriptors = RandomDescriptors(num_descriptors, &rng);
+    for (int b = 0; b < num_boxes; ++b) {
+      index.Insert(b, &descriptors[b * kDescriptorsPerBox * kDescriptorBytes],
+                   kDescriptorsPerBox, kDescriptorBytes);
+    }
+    std::uniform_int_distribution<int> distribution(0, num_descriptors - 1);
+    for (int q = 0; q < num_queries; ++q) {
+      targets.push_back(distribution(rng));
+      queries.push_back(
+          FlipBits(&descriptors[targets.back() * kDescriptorBytes],
+                   kNoiseBits, &rng));
+    }
+  }
+
+  static constexpr int kDescriptorsPerBox = 100;
+  static constexpr int kNoiseBits = 20;
+  static constexpr int kMaxDistance = 48;
+  HammingLshIndex index;
+  std::vector<uint8> descriptors;
+  std::vector<int> targets;
+  std::vector<std::vector<uint8>> queries;
+};
+
+// Reports as "recall" the fraction of queries for which the descriptor they
+// were derived from is found. The cost of a query grows with the bucket size,
+// about index size / 2^key_bits, so key_bits should grow with the index.
+void BM_LshSearch(benchmark::State& state) {
+  BenchmarkData data(state.range(0), 500, state.range(1));
+  int num_found = 0;
+  int num_searched = 0;
+  std::vector<HammingLshIndex::Match> matches;
+  for (auto _ : state) {
+    for (int q = 0; q < data.queries.size(); ++q) {
+      matches.clear();
+      data.index.Search(data.queries[q].data(), BenchmarkData::kMaxDistance,
+                        &matches);
+      const int target = data.targets[q];
+      num_found += ContainsMatch(matches,
+                                 target / BenchmarkData::kDescriptorsPerBox,
+                                 target % BenchmarkData::kDescriptorsPerBox);
+    }
+    num_searched += data.queries.size();
+  }
+  state.SetItemsProcessed(num_searched);
+  state.counters["recall"] = static_cast<double>(num_found) / num_searched;
+}
+BENCHMARK(BM_LshSearch)
+    ->ArgPair(10, 16)
+    ->ArgPair(100, 16)
+    ->ArgPair(1000, 16)
+    ->ArgPair(5000, 16)
+    ->ArgPair(1000, 20)
+    ->ArgPair(5000, 20);
+
+// Exhaustive search over the same data, the cost of the OPENCV_BF index.
+void BM_BruteForceSearch(benchmark::State& state) {
+  BenchmarkData data(state.range(0), 500, /*key_bits=*/16);
+  const int num_descriptors = data.descriptors.size() / kDescriptorBytes;
+  int num_searched = 0;
+  for (auto _ : state) {
+    for (const auto& query : data.queries) {
+      int best_distance = kDescriptorBytes * 8 + 1;
+      for (int j = 0; j < num_descriptors; ++j) {
+        best_distance = std::min(
+            best_distance,
+            HammingLshIndex::HammingDistance(
+                query.data(), &data.descriptors[j * kDescriptorBytes],
+                kDescriptorBytes));
+      }
+      benchmark::DoNotOptimize(best_distance);
+    }
+    num_searched += data.queries.size();
+  }
+  state.SetItemsProcessed(num_searched);
+}
+BENCHMARK(BM_BruteForceSearch)->Arg(10)->Arg(100)->Arg(1000)->Arg(5000);
+
+}  // namespace
+}  // namespace mediapipe